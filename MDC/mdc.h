@@ -69,6 +69,7 @@
 #define    MDC_INIT             'I'       /* Service Initialisation request */
 #define    MDC_NAK              'N'       /* Negative comms reply */
 #define    MDC_PREQ             'P'       /* Process request command */
+#define    MDC_ROW              'R'       /* Data row coded against the last */
 
 /* Service types
 */
@@ -132,6 +133,13 @@ int    MDC_GetStatus(UINT, UINT *);
 */
 int    MDC_Server( UINT *, UCHAR *, int (*)(UCHAR *, int, UCHAR *), void (*)( UCHAR ) );
 int    MDC_ReturnData( UCHAR *, int );
+int    MDC_SetRowEncoding( UCHAR );
 int    MDC_TimerCB( ULNG, UINT, UINT, void (*)(void) );
 
+/* Prototypes externally visible for both Client and Server API.
+*/
+int    MDC_SetLowLatency( ULNG );
+int    MDC_SetCapture( UCHAR * );
+int    MDC_SetDictionary( UCHAR, UCHAR * );
+
 #endif    /* MDC_H */
@@ -69,16 +69,52 @@ void _MDC_DataCB(UINT nChanId, UCHAR *szData, UINT nDataLen)
     void        (*pUserCB) (UINT, UCHAR *, UINT);
     UCHAR       *pszNAKErrStr;        /* pointer to Error string in      */
                                       /* channel status structure           */
+    LZW_CTX     *spDecCtx;            /* Channels decompression context  */
+    ROW_CTX     *spRowCtx;            /* Channels row context            */
+    UCHAR       *szRow;               /* Row rebuilt as a data packet    */
+    UINT        nRowLen;
 
-    /* Decompress 
+    /* Decompress, with the channels own context as the daemon may be
+       continuing a stream of earlier packets.
     */
-    szDeComData = Decompress(szData, &nDataLen);
+    if (_MDC_GetCtx(nChanId, NULL, &spDecCtx) == MDC_OK)
+        szDeComData = DecompressCtx(spDecCtx, szData, &nDataLen);
+    else
+        szDeComData = Decompress(szData, &nDataLen);
     if (szDeComData == NULL)
     {
         Lgr(LOG_DEBUG, szFunc, "Cannot malloc");
         return;
     }
 
+    /* A row coded against the last the daemon sent is rebuilt whatever
+       state the channel is in, so that the next can be, then handled as
+       the data packet it was.
+    */
+    if (nDataLen > 0 && szDeComData[0] == MDC_ROW)
+    {
+        szRow = NULL;
+        if (_MDC_GetRowCtx(nChanId, &spRowCtx) != MDC_OK ||
+            ROW_Size(szDeComData + 1, nDataLen - 1, &nRowLen) != R_OK ||
+            (szRow = (UCHAR *) malloc(nRowLen + 1)) == NULL ||
+            ROW_Decode(spRowCtx, szDeComData + 1, nDataLen - 1, szRow + 1,
+                       nRowLen, &nRowLen) != R_OK)
+        {
+            Lgr(LOG_DEBUG, szFunc,
+                "Cannot rebuild row on channel %d", nChanId);
+            if (szRow != NULL)
+                free(szRow);
+            if (szDeComData != szData)
+                free(szDeComData);
+            return;
+        }
+        if (szDeComData != szData)
+            free(szDeComData);
+        szRow[0] = MDC_DATA;
+        szDeComData = szRow;
+        nDataLen = nRowLen + 1;
+    }
+
     /* Check if the data is a service request reply
     */
     if (MDC.nPendSRChanId > 0 && nChanId == MDC.nPendSRChanId)
@@ -90,6 +126,21 @@ void _MDC_DataCB(UINT nChanId, UCHAR *szData, UINT nDataLen)
         {
             Lgr(LOG_DEBUG, szFunc, "NAK received for service request");
             _MDC_PrintErrMsg((szDeComData + 1), (nDataLen - 1));
+        } else
+        if (MDC.cReplyType == MDC_ACK && nDataLen >= 2 &&
+            szDeComData[1] <= CMP_MAXCODEC &&
+            (CMP_ALLCODECS & (1 << szDeComData[1])) != 0)
+        {
+            /* Daemon has picked a codec from those we offered, use it for
+               everything sent on this channel from now on.
+            */
+            _MDC_SetCodec(nChanId, szDeComData[1]);
+
+            /* A third byte confirms the dictionary we offered, which
+               starts the history of both directions.
+            */
+            if (nDataLen >= 3 && szDeComData[2] == TRUE && MDC.nPendDict != 0)
+                _MDC_SetDict(nChanId, MDC.nPendDict);
         }
 
         MDC.nPendSRChanId = 0;
@@ -359,6 +410,7 @@ int    _MDC_SendPacket(UINT nChanId, char cPacketType, UCHAR *psnzBuf, UINT nBuf
     char  *psnzComBuf;         /* pointer to buffer containing compressed message */
     UCHAR *szFunc = "_MDC_SendPacket";
     UINT  nlocalBufLen;        /* Local buffer length variable */
+    LZW_CTX *spCmpCtx;         /* Channels compression context */
 
     nlocalBufLen = nBuflen + 1;
 
@@ -378,9 +430,20 @@ int    _MDC_SendPacket(UINT nChanId, char cPacketType, UCHAR *psnzBuf, UINT nBuf
     Lgr(LOG_DEBUG, szFunc, "Sending packet (Before Compress): Data=%s, Len=%d",
         psnzPktMsgBuf, nlocalBufLen);
 
-    /* Compress packet to be sent
+    /* Compress packet to be sent, with the codec agreed for the channel
     */
-    psnzComBuf = Compress(psnzPktMsgBuf, &nlocalBufLen);
+    if (_MDC_GetCtx(nChanId, &spCmpCtx, NULL) == MDC_OK)
+    {
+        /* Requests of each type of service are tracked apart by the
+           adaptive policy, a service starts with its type.
+        */
+        if ((cPacketType == MDC_INIT || cPacketType == MDC_CHANGE) &&
+            nBuflen > 0)
+            LZW_SetClass(spCmpCtx, psnzBuf[0]);
+        psnzComBuf = CompressCtx(spCmpCtx, psnzPktMsgBuf, &nlocalBufLen);
+    }
+    else
+        psnzComBuf = Compress(psnzPktMsgBuf, &nlocalBufLen);
     if (psnzComBuf == NULL)
     {
         Lgr(LOG_DEBUG, szFunc, "Cannot malloc for Compress");
@@ -476,8 +539,22 @@ int    _MDC_CreateChStatus(UINT nChanId)         /* Channel ID */
     psNewChanSt->nChanId = nLocalChanId;
     psNewChanSt->State = MAKING_CONN;
     psNewChanSt->UserDataCB = NULL;
+    psNewChanSt->spCmpCtx = LZW_CreateCtx();
+    psNewChanSt->spDecCtx = LZW_CreateCtx();
+    psNewChanSt->spRowCtx = ROW_CreateCtx();
+    if (psNewChanSt->spCmpCtx == NULL || psNewChanSt->spDecCtx == NULL ||
+        psNewChanSt->spRowCtx == NULL ||
+        LZW_SetAdaptive(psNewChanSt->spCmpCtx, TRUE) != R_OK)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Cannot create compression contexts");
+        LZW_FreeCtx(psNewChanSt->spCmpCtx);
+        LZW_FreeCtx(psNewChanSt->spDecCtx);
+        ROW_FreeCtx(psNewChanSt->spRowCtx);
+        free(psNewChanSt);
+        return(MDC_FAIL);
+    }
 
-    if (AddItem(&MDC.spChanDetHead, &MDC.spChanDetTail, SORT_NONE, &nLocalChanId, 
+    if (AddItem(&MDC.spChanDetHead, &MDC.spChanDetTail, SORT_NONE|LST_HASH_NKEY, &nLocalChanId, 
                 NULL, NULL, psNewChanSt) != R_OK)
     {
         Lgr(LOG_DEBUG, szFunc, "AddItem failed for Channel ID %d",
@@ -499,6 +576,7 @@ int    _MDC_DelChStatus(UINT nChanId)         /* Channel ID */
     UINT        nLocalChanId = nChanId;
     UCHAR       *szFunc = "_MDC_DelChStatus";
     CHANSTATUS  *ChanSt;
+    CMP_STATS   sStats;
 
     if ((ChanSt = FindItem(MDC.spChanDetHead, &nLocalChanId, NULL, NULL)) == NULL)
     {
@@ -518,6 +596,18 @@ int    _MDC_DelChStatus(UINT nChanId)         /* Channel ID */
      * the following statement sends a request to UX to close the channel.
     */
     SL_DelClient(nChanId);
+
+    /* Report how much compression work was done and avoided.
+    */
+    LZW_GetStats(ChanSt->spCmpCtx, &sStats);
+    Lgr(LOG_MESSAGE, szFunc,
+        "Channel %d compression: blocks=%ld, tried=%ld, shrunk=%ld, "
+        "skipped=%ld, cpu=%lduS, saved=%lduS", nChanId, sStats.lBlocks,
+        sStats.lTried, sStats.lShrunk, sStats.lSkipped, sStats.lTryUs,
+        sStats.lSavedUs);
+    LZW_FreeCtx(ChanSt->spCmpCtx);
+    LZW_FreeCtx(ChanSt->spDecCtx);
+    ROW_FreeCtx(ChanSt->spRowCtx);
     free(ChanSt);
 
     return(MDC_OK);
@@ -549,6 +639,124 @@ int    _MDC_SetChState( UINT nChanId,        /* Channel ID */
 }
  
 
+/******************************************************************************
+ * Function:    _MDC_SetCodec
+ * Description: Set the codec used to compress packets on a channel, which
+ *              the daemon uses for its replies too
+ * Returns:     MDC_OK or MDC_FAIL
+ ******************************************************************************/
+int    _MDC_SetCodec( UINT nChanId,        /* Channel ID */
+                      UINT nCodec)         /* Codec agreed with daemon */
+{
+    UINT        nLocalChanId = nChanId;
+    UCHAR       *szFunc = "_MDC_SetCodec";
+    CHANSTATUS  *ChanSt;
+ 
+    if ((ChanSt = FindItem(MDC.spChanDetHead, &nLocalChanId, NULL, NULL)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc,
+            "FindItem failed: Channel ID %d not found", nLocalChanId);
+        return(MDC_FAIL);
+    }
+ 
+    if (LZW_SetCodec(ChanSt->spCmpCtx, nCodec) != R_OK ||
+        LZW_SetCodec(ChanSt->spDecCtx, nCodec) != R_OK)
+    {
+        Lgr(LOG_DEBUG, szFunc,
+            "Bad codec %d for Channel ID %d", nCodec, nLocalChanId);
+        return(MDC_FAIL);
+    }
+ 
+    return(MDC_OK);
+}
+ 
+/******************************************************************************
+ * Function:    _MDC_SetDict
+ * Description: Set the shared dictionary used on a channel in both
+ *              directions, once the daemon has confirmed it holds the same
+ * Returns:     MDC_OK or MDC_FAIL
+ ******************************************************************************/
+int    _MDC_SetDict( UINT nChanId,         /* Channel ID */
+                     UINT nDict)           /* Dictionary agreed with daemon */
+{
+    UINT        nLocalChanId = nChanId;
+    UCHAR       *szFunc = "_MDC_SetDict";
+    CHANSTATUS  *ChanSt;
+ 
+    if ((ChanSt = FindItem(MDC.spChanDetHead, &nLocalChanId, NULL, NULL)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc,
+            "FindItem failed: Channel ID %d not found", nLocalChanId);
+        return(MDC_FAIL);
+    }
+ 
+    if (LZW_SetDict(ChanSt->spCmpCtx, nDict) != R_OK ||
+        LZW_SetDict(ChanSt->spDecCtx, nDict) != R_OK)
+    {
+        Lgr(LOG_DEBUG, szFunc,
+            "Bad dictionary %d for Channel ID %d", nDict, nLocalChanId);
+        return(MDC_FAIL);
+    }
+ 
+    return(MDC_OK);
+}
+ 
+
+/******************************************************************************
+ * Function:    _MDC_GetCtx
+ * Description: Get the compression contexts of a channel, either pointer
+ *              may be NULL if not wanted
+ * Returns:     MDC_OK or MDC_FAIL
+ ******************************************************************************/
+int    _MDC_GetCtx( UINT nChanId,            /* Channel ID */
+                    LZW_CTX **spCmpCtx,      /* Compresses packets sent */
+                    LZW_CTX **spDecCtx)      /* Decompresses packets rcvd */
+{
+    UINT        nLocalChanId = nChanId;
+    UCHAR       *szFunc = "_MDC_GetCtx";
+    CHANSTATUS  *ChanSt;
+ 
+    if ((ChanSt = FindItem(MDC.spChanDetHead, &nLocalChanId, NULL, NULL)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc,
+            "FindItem failed: Channel ID %d not found", nLocalChanId);
+        return(MDC_FAIL);
+    }
+ 
+    if (spCmpCtx != NULL)
+        *spCmpCtx = ChanSt->spCmpCtx;
+    if (spDecCtx != NULL)
+        *spDecCtx = ChanSt->spDecCtx;
+ 
+    return(MDC_OK);
+}
+ 
+
+/******************************************************************************
+ * Function:    _MDC_GetRowCtx
+ * Description: Get the context rebuilding the rows a channel receives
+ * Returns:     MDC_OK or MDC_FAIL
+ ******************************************************************************/
+int    _MDC_GetRowCtx( UINT nChanId,         /* Channel ID */
+                       ROW_CTX **spRowCtx)   /* Rebuilds rows rcvd */
+{
+    UINT        nLocalChanId = nChanId;
+    UCHAR       *szFunc = "_MDC_GetRowCtx";
+    CHANSTATUS  *ChanSt;
+ 
+    if ((ChanSt = FindItem(MDC.spChanDetHead, &nLocalChanId, NULL, NULL)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc,
+            "FindItem failed: Channel ID %d not found", nLocalChanId);
+        return(MDC_FAIL);
+    }
+ 
+    *spRowCtx = ChanSt->spRowCtx;
+ 
+    return(MDC_OK);
+}
+ 
+
 /******************************************************************************
  * Function:    _MDC_SetSRResult
  * Description: Set Channel Send Request result
@@ -1007,6 +1215,9 @@ int    MDC_CreateService( UCHAR             *szHostName,    /* I: Host for conne
     int         nTotalTime;  /* total time waiting for connection to be made */
     int         ChanId;
     char        ReplyPktType;
+    UINT        nInitLen = sizeof(SERVICEDETAILS)+1;
+    UINT        nCheck;
+    UCHAR       snzInitBuf[sizeof(SERVICEDETAILS)+3];
 
     /* If threading is enabled, then lock this function so that no other
      * thread can enter.
@@ -1116,10 +1327,22 @@ int    MDC_CreateService( UCHAR             *szHostName,    /* I: Host for conne
         THREAD_UNLOCK_RETURN(MDC_FAIL);
     }
 
-    /* Send service request structure to the daemon
+    /* Send service request structure to the daemon, followed by a byte
+       listing the codecs we can read. Old daemons ignore the extra byte.
+       When we hold a dictionary for the service its check follows, the
+       daemon only confirms it if it holds the same.
     */
-    if (_MDC_SendPacket((UINT) ChanId, MDC_INIT, (UCHAR *) serviceDet,
-                        (UINT) sizeof(SERVICEDETAILS)) != MDC_OK)
+    memcpy(snzInitBuf, serviceDet, sizeof(SERVICEDETAILS));
+    snzInitBuf[sizeof(SERVICEDETAILS)] = (UCHAR) CMP_ALLCODECS;
+    MDC.nPendDict = 0;
+    if (LZW_DictCheck((UINT) serviceDet->cServiceType, &nCheck) == R_OK)
+    {
+        MDC.nPendDict = (UINT) serviceDet->cServiceType;
+        snzInitBuf[nInitLen++] = (UCHAR) (nCheck >> 8);
+        snzInitBuf[nInitLen++] = (UCHAR) (nCheck & 0xff);
+    }
+    if (_MDC_SendPacket((UINT) ChanId, MDC_INIT, snzInitBuf,
+                        nInitLen) != MDC_OK)
     {
         Lgr(LOG_DEBUG, szFunc, "_MDC_SendData failed");
         SL_DelClient((UINT) ChanId);
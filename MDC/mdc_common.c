@@ -89,11 +89,15 @@ int    _MDC_Init( void  )
     {
         /* Initialise all so-called globals.
         */
-        MDC.spIFifoHead = NULL;
-        MDC.spIFifoTail = NULL;
-        MDC.spOFifoHead = NULL;
-        MDC.spOFifoTail = NULL;
+        MDC.spIFifo = NULL;
+        MDC.spOFifo = NULL;
+        MDC.spArena = NULL;
         MDC.nClientChanId = 0;
+        MDC.spCmpCtx = NULL;
+        MDC.spDecCtx = NULL;
+        MDC.spRowCtx = NULL;
+        MDC.cRowSep = '\0';
+        MDC.nRowPeer = FALSE;
         MDC.nCloseDown = FALSE;
         MDC.nInitialised = TRUE;
         MDC.nNewSrvTimeout = DEF_NEW_SERVICE_TIMEOUT;
@@ -110,6 +114,22 @@ int    _MDC_Init( void  )
             Lgr(LOG_DEBUG, szFunc, "SL_Init failed");
             return(MDC_FAIL);
         }
+
+        /* Re-apply low latency mode if the user selected it, SL_Init resets
+         * it.
+        */
+        if(MDC.lSpinMax > 0)
+        {
+            SL_LowLatency(TRUE, MDC.lSpinMax);
+        }
+
+        /* Likewise, start traffic capture if requested.
+        */
+        if(MDC.szCapFile[0] != '\0' && SL_CaptureStart(MDC.szCapFile) == R_FAIL)
+        {
+            Lgr(LOG_WARNING, szFunc, "Couldnt start capture to (%s)",
+                MDC.szCapFile);
+        }
     }
 
     /* Return result to caller.
@@ -130,10 +150,25 @@ int    _MDC_Terminate( void )
 {
     /* Local variables.
     */
+    SL_SPINSTATS  sSpin;
+    UCHAR         *szFunc = "_MDC_Terminate";
 
     /* Free up all resources that weve used to return us to a virgin state.
     */
 
+    /* If running in low latency mode, log what it cost versus what it
+     * gained.
+    */
+    if(MDC.lSpinMax > 0)
+    {
+        SL_GetSpinStats(&sSpin);
+        Lgr(LOG_MESSAGE, szFunc,
+            "Low latency: %lu spins, %lu hits, %luuS CPU spent, "
+            "%luuS latency saved (wakeup %luuS, budget %luuS)",
+            sSpin.lSpinCount, sSpin.lSpinHits, sSpin.lSpinUs,
+            sSpin.lSavedUs, sSpin.lWakeupUs, sSpin.lSpinBudget);
+    }
+
     /* Give the UX library a slice of CPU so that it can tidy up.
     */
     SL_Poll(MAX_TERMINATE_TIME);
@@ -146,3 +181,123 @@ int    _MDC_Terminate( void )
     */
     return(MDC_OK);
 }
+
+/******************************************************************************
+ * Function:    MDC_SetLowLatency
+ * Description: Function to select the low latency comms mode. Polls which
+ *              would block first spin on the sockets for up to the given
+ *              number of microseconds, trading CPU for faster response to
+ *              request/reply traffic. A value of 0 disables the mode. May be
+ *              called before or after MDC_Start/MDC_Server.
+ * 
+ * Returns:     MDC_FAIL- Couldnt change mode.
+ *              MDC_OK    - Mode changed.
+ ******************************************************************************/
+int    MDC_SetLowLatency( ULNG    lSpinMax )    /* I: Max spin in uS, 0 = off */
+{
+    /* Local variables.
+    */
+    UCHAR         *szFunc = "MDC_SetLowLatency";
+
+    /* Store the setting, it is applied at initialisation time.
+    */
+    MDC.lSpinMax = lSpinMax;
+
+    /* If comms are already running, apply it now.
+    */
+    if(MDC.nInitialised == TRUE &&
+       SL_LowLatency((lSpinMax > 0 ? TRUE : FALSE), lSpinMax) == R_FAIL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt set low latency mode (%lu)", lSpinMax);
+        return(MDC_FAIL);
+    }
+
+    /* Return result to caller.
+    */
+    return(MDC_OK);
+}
+
+/******************************************************************************
+ * Function:    MDC_SetCapture
+ * Description: Function to capture all comms traffic to a file for later
+ *              replay. A NULL or empty filename stops the capture. May be
+ *              called before or after MDC_Start/MDC_Server.
+ * 
+ * Returns:     MDC_FAIL  - Couldnt start capture.
+ *              MDC_OK    - Capture started/stopped.
+ ******************************************************************************/
+int    MDC_SetCapture( UCHAR    *szCapFile )    /* I: Capture file, NULL = off */
+{
+    /* Local variables.
+    */
+    UCHAR         *szFunc = "MDC_SetCapture";
+
+    /* Store the setting, it is applied at initialisation time.
+    */
+    if(szCapFile == NULL)
+    {
+        MDC.szCapFile[0] = '\0';
+    } else
+     {
+        strncpy(MDC.szCapFile, szCapFile, MAX_PATHLEN);
+        MDC.szCapFile[MAX_PATHLEN] = '\0';
+    }
+
+    /* If comms are already running, apply it now.
+    */
+    if(MDC.nInitialised == TRUE)
+    {
+        if(MDC.szCapFile[0] == '\0')
+        {
+            SL_CaptureStop();
+        } else
+        if(SL_CaptureStart(MDC.szCapFile) == R_FAIL)
+        {
+            Lgr(LOG_DEBUG, szFunc, "Couldnt start capture to (%s)",
+                MDC.szCapFile);
+            return(MDC_FAIL);
+        }
+    }
+
+    /* Return result to caller.
+    */
+    return(MDC_OK);
+}
+
+/******************************************************************************
+ * Function:    MDC_SetDictionary
+ * Description: Function to load the shared compression dictionary for a
+ *              service type from a file, such as one built from captured
+ *              traffic by ux_test/cm_dict. A client offers it when it
+ *              requests that type of service and a daemon holding the same
+ *              dictionary accepts, after which both compress against it so
+ *              that short messages shrink. A NULL filename unloads it.
+ *              Call before MDC_CreateService/MDC_Server.
+ * 
+ * Returns:     MDC_FAIL  - Couldnt load dictionary.
+ *              MDC_OK    - Dictionary loaded/unloaded.
+ ******************************************************************************/
+int    MDC_SetDictionary( UCHAR    cServiceType,   /* I: Service type */
+                          UCHAR    *szDictFile )   /* I: Dictionary, NULL = off */
+{
+    /* Local variables.
+    */
+    UCHAR         *szFunc = "MDC_SetDictionary";
+
+    /* Dictionaries are held under the service type they serve.
+    */
+    if(szDictFile == NULL)
+    {
+        LZW_FreeDict((UINT)cServiceType);
+    } else
+    if(LZW_LoadDictFile((UINT)cServiceType, szDictFile) == R_FAIL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt load dictionary (%s) for (%c)",
+            szDictFile, cServiceType);
+        return(MDC_FAIL);
+    }
+
+    /* Return result to caller.
+    */
+    return(MDC_OK);
+}
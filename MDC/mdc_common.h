@@ -42,6 +42,9 @@
 #define    DEF_SERVICENAME         "vdwd"  /* Name of service in /etc/services */
 #define    MDC_SRV_KEEPALIVE       1000    /* TCP/IP keep alive for MDC Server */
 #define    MAX_TERMINATE_TIME      2000    /* Time for termination of MDC layer */
+#define    MDC_FIFO_SIZE           4096    /* Packets held on a server FIFO */
+#define    MDC_ARENA_SIZE          65536   /* Server packet arena block size */
+#define    MDC_CMPWORKERS          0       /* Compression workers, 0 = per CPU */
 
 /* Timeout definitions.
 */
@@ -66,15 +69,22 @@ typedef struct {
     /* Shared Globals
     */
     UCHAR        szErrMsg[MAX_ERRMSGLEN];    /* Storage for error messages */
+    ULNG         lSpinMax;         /* Low latency spin budget in uS, 0 = off */
+    UCHAR        szCapFile[MAX_PATHLEN+1]; /* Traffic capture file, "" = off */
 
     /* Server Globals
     */
-    LINKLIST    *spIFifoHead;      /* Pointer to head of Incoming FIFO list */
-    LINKLIST    *spIFifoTail;      /* Pointer to tail of Incoming FIFO list */
-    LINKLIST    *spOFifoHead;      /* Pointer to head of Outgoing FIFO list */
-    LINKLIST    *spOFifoTail;      /* Pointer to tail of Outgoing FIfO list */
+    MQ_QUEUE    *spIFifo;          /* Incoming FIFO queue */
+    MQ_QUEUE    *spOFifo;          /* Outgoing FIFO queue */
+    UX_ARENA    *spArena;          /* Carriers of queued incoming packets */
     UINT        nClientChanId;     /* Server to client comms channel Id */
     UINT        nCloseDown;        /* Shutdown flag */
+    LZW_CTX     *spCmpCtx;         /* Compresses replies with the codec */
+                                   /* agreed with the client            */
+    LZW_CTX     *spDecCtx;         /* Decompresses packets from client  */
+    ROW_CTX     *spRowCtx;         /* Codes data rows against the last  */
+    UCHAR       cRowSep;           /* Field separator of rows, 0 = none */
+    UINT        nRowPeer;          /* Client can rebuild coded rows     */
     UINT        nInitialised;      /* Flag to indicate if library initialised */
     void        (*fCntrlCB)( UCHAR );    /* User Control callback */
 
@@ -97,6 +107,8 @@ typedef struct {
     UINT        nPendSRChanId;     /* Indicates chanid for a pending        */
                                    /* service request reply                 */
                                    /* 0: no pending service request reply   */
+    UINT        nPendDict;         /* Dictionary offered in the pending     */
+                                   /* service request, 0: none              */
     char        cReplyType;        /* Reply to service request ACK or NAK   */
 #if defined(MDC_CLIENT_C) && defined(SOLARIS)
     mutex_t        thMDCLock;      /* Single thread lock for MT environment */
@@ -151,6 +163,10 @@ typedef struct {
         UCHAR pszErrStr[MAX_ERRMSGLEN];        
                                 /* If NAK returned then contains       */
                                 /* the NAK Error String                      */
+        LZW_CTX *spCmpCtx;      /* Compresses packets to the daemon with */
+                                /* the codec agreed for the channel      */
+        LZW_CTX *spDecCtx;      /* Decompresses packets from the daemon  */
+        ROW_CTX *spRowCtx;      /* Rebuilds rows coded by the daemon     */
     } CHANSTATUS;
     
     int _MDC_SendPacket(UINT, char, UCHAR *, UINT);
@@ -160,6 +176,10 @@ typedef struct {
     int _MDC_DelChStatus(UINT);
     int _MDC_SetChState(UINT, CHSTATE);
     int _MDC_GetChState(UINT, CHSTATE *);
+    int _MDC_SetCodec(UINT, UINT);
+    int _MDC_SetDict(UINT, UINT);
+    int _MDC_GetCtx(UINT, LZW_CTX **, LZW_CTX **);
+    int _MDC_GetRowCtx(UINT, ROW_CTX **);
     int _MDC_SetSRResult(UINT, UINT);
     int _MDC_GetSRResult(UINT, UINT *);
     int _MDC_GetNAKErrStr(UINT, UCHAR **);
@@ -186,7 +206,7 @@ typedef struct {
 
     /* Prototypes for functions internal to MDC Server module.
     */
-    int        _MDC_SendACK( void );
+    int        _MDC_SendACK( int, int );
     int        _MDC_SendNAK( UCHAR    * );
     void    _MDC_ServerCntlCB(    int, ... );
     void    _MDC_ServerDataCB(    UINT, UCHAR *, UINT );
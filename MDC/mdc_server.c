@@ -58,17 +58,21 @@
  * Function:    _MDC_SendACK
  * Description: Function to send an acknowledge to the client in response to
  *              a data block received correctly or a request processed
- *              successfully.
+ *              successfully. When accepting a new service the ACK also
+ *              carries the codec the server will compress its replies with,
+ *              and whether it holds the dictionary the client offered.
  * 
  * Returns:     MDC_FAIL- Couldnt transmit an ACK message to the client.
  *              MDC_OK    - ACK sent successfully.
  ******************************************************************************/
-int    _MDC_SendACK( void )
+int    _MDC_SendACK( int    nCodec,     /* I: Agreed codec, -1 for none */
+                     int    nDict )     /* I: Dictionary, -1 if none offered */
 {
     /* Local variables.
     */
     int          nReturn = MDC_OK;
-    UCHAR        szAckBuf[2];
+    UINT         nAckLen = 1;
+    UCHAR        szAckBuf[3];
     UCHAR        *szFunc = "_MDC_SendACK";
 
     /* Make sure that we have a valid channel connection in case of rogue
@@ -79,10 +83,14 @@ int    _MDC_SendACK( void )
         /* Build up the message to transmit.
         */
         sprintf(szAckBuf, "%c", MDC_ACK);
+        if(nCodec >= 0)
+            szAckBuf[nAckLen++] = (UCHAR)nCodec;
+        if(nCodec >= 0 && nDict >= 0)
+            szAckBuf[nAckLen++] = (UCHAR)(nDict != 0 ? TRUE : FALSE);
 
         /* Try and transmit it.
         */
-        if(SL_BlockSendData(MDC.nClientChanId, szAckBuf, 1) == R_FAIL)
+        if(SL_BlockSendData(MDC.nClientChanId, szAckBuf, nAckLen) == R_FAIL)
         {
             /* Log a message as this condition shouldnt occur.
             */
@@ -166,7 +174,7 @@ int    _MDC_SendNAK( UCHAR    *szErrMsg )    /* I: Error msg to send with NAK */
             /* Compress it to save on transmission overheads.
             */
             nXmitLen=nErrLen+1;
-            if((psnzCmpBuf=Compress(psnzTmpBuf, &nXmitLen)) != NULL)
+            if((psnzCmpBuf=CompressCtx(MDC.spCmpCtx, psnzTmpBuf, &nXmitLen)) != NULL)
             {
                 /* Free up memory we used to store the original message.
                 */
@@ -260,6 +268,19 @@ void    _MDC_ServerCntlCB( int     nType,    /* I: Type of callback */
              * for async communications.
             */
             MDC.nClientChanId = nChanId;
+
+            /* Packets go both ways as LZW until the client offers
+             * something better in its service request, any stream
+             * history belonged to the last client.
+            */
+            LZW_SetDict(MDC.spCmpCtx, 0);
+            LZW_SetDict(MDC.spDecCtx, 0);
+            LZW_SetCodec(MDC.spCmpCtx, CMP_LZW);
+            LZW_SetCodec(MDC.spDecCtx, CMP_LZW);
+            LZW_SetAdaptive(MDC.spCmpCtx, TRUE);
+            LZW_SetParallel(MDC.spCmpCtx, FALSE);
+            ROW_ResetCtx(MDC.spRowCtx);
+            MDC.nRowPeer = FALSE;
             break;
 
         /* Given connection has become temporarily unavailable.
@@ -339,6 +360,8 @@ void    _MDC_ServerDataCB(  UINT        nChanId,    /* I: Channel data rcv on*/
     */
     UINT        nDLen = nDataLen;
     FIFO        *psFifo;
+    UCHAR       *pszDeComData;
+    UCHAR       *pszTmp;
     UCHAR       *szFunc = "_MDC_ServerDataCB";
 
     /* Special case processing for out of bands message. Normally messages
@@ -374,18 +397,33 @@ void    _MDC_ServerDataCB(  UINT        nChanId,    /* I: Channel data rcv on*/
         }
     }
 
-    /* Allocate memory to store a FIFO carrier. This FIFO carrier is then
-     * populated with the FIFO data below.
+    /* Data block arrives in a compressed format, so uncompress it straight
+     * into the server arena ready for the incoming FIFO, its size being
+     * given in its header. An uncompressed block is copied there too, as it
+     * is still in the comms receive buffer, which is reused before the
+     * server gets to it. Callbacks only run within SL_Poll on the server
+     * thread, and the arena is only reset once the server has drained the
+     * FIFO, so it needs no locking.
     */
-    if( (psFifo=(FIFO *)malloc(sizeof(FIFO))) == NULL )
+    pszDeComData = NULL;
+    if( DecompressSize(szData, nDataLen, &nDLen) == R_OK &&
+        (pszDeComData=(UCHAR *)UA_Alloc(MDC.spArena, nDLen+1)) == NULL )
     {
+        /* A block carrying on the clients stream must be read into its
+         * history whatever happens to it, so without room in the arena it
+         * is decompressed into a buffer of its own and dropped.
+        */
+        if( (pszTmp=DecompressCtx(MDC.spDecCtx, szData, &nDLen)) != NULL &&
+            pszTmp != szData )
+            free(pszTmp);
+
         /* Log a message if needed.
         */
-        Lgr(LOG_DEBUG, szFunc, "Memory exhausted, couldnt create FIFO carrier");
+        Lgr(LOG_DEBUG, szFunc, "Memory exhausted, couldnt hold FIFO data");
 
         /* Send a NAK to client to indicate that we've run out of memory.
         */
-        if( _MDC_SendNAK("Memory exhausted on server, packet rejected (1)")
+        if( _MDC_SendNAK("Memory exhausted on server, packet rejected (3)")
                                                                 == MDC_FAIL )
         {
             /* Log a message if needed.
@@ -393,21 +431,16 @@ void    _MDC_ServerDataCB(  UINT        nChanId,    /* I: Channel data rcv on*/
             Lgr(LOG_ALERT, szFunc,
                 "Couldnt send a NAK message, Houston we have problems!!");
         }
-
-        /* Get out, nothing more can be done.
-        */
         return;
     }
-
-    /* Data block arrives in a compressed format, so uncompress prior to
-     * placing it into the incoming FIFO list.
-    */
-    if( (psFifo->pszData=Decompress(szData, &nDLen)) == NULL )
+    if( pszDeComData == NULL ||
+        DecompressInto(MDC.spDecCtx, szData, nDataLen, pszDeComData, nDLen,
+                       &nDLen) == R_FAIL )
     {
         /* Log a message if needed.
         */
         Lgr(LOG_DEBUG, szFunc, "Couldnt decompress buffer, Chan (%d), Len (%d)",
-            nChanId, nDLen);
+            nChanId, nDataLen);
 
         /* Send a NAK to client to indicate that the buffer sent cant be
          * processed.
@@ -421,34 +454,59 @@ void    _MDC_ServerDataCB(  UINT        nChanId,    /* I: Channel data rcv on*/
                 "Couldnt send a NAK message, Houston we have problems!!");
         }
 
-        /* Free up used resources and get out as nothing more can be done.
+        /* Get out as nothing more can be done.
+        */
+        return;
+    }
+    pszDeComData[nDLen] = '\0';
+
+    /* Allocate memory to store a FIFO carrier from the server arena. This
+     * FIFO carrier is then populated with the data decompressed above.
+    */
+    if( (psFifo=(FIFO *)UA_Alloc(MDC.spArena, sizeof(FIFO))) == NULL )
+    {
+        /* Log a message if needed.
+        */
+        Lgr(LOG_DEBUG, szFunc, "Memory exhausted, couldnt create FIFO carrier");
+
+        /* Send a NAK to client to indicate that we've run out of memory.
+        */
+        if( _MDC_SendNAK("Memory exhausted on server, packet rejected (1)")
+                                                                == MDC_FAIL )
+        {
+            /* Log a message if needed.
+            */
+            Lgr(LOG_ALERT, szFunc,
+                "Couldnt send a NAK message, Houston we have problems!!");
+        }
+
+        /* Get out, nothing more can be done.
         */
-        free(psFifo);
         return;
     }
 
     /* Complete the FIFO carrier information set.
     */
     psFifo->nDataLen = nDLen;
+    psFifo->pszData = pszDeComData;
 
     /* Log message as to what has been received, may help track bugs.
     */
     Lgr(LOG_DEBUG, szFunc,
         "Message received: Data=%s, Len=%d", psFifo->pszData, psFifo->nDataLen);
 
-    /* Add buffer to the end of the incoming FIFO list.
+    /* Add buffer to the end of the incoming FIFO queue.
     */
-    if( AddItem(&MDC.spIFifoHead, &MDC.spIFifoTail, SORT_NONE, NULL, NULL, NULL,
-                psFifo) == R_FAIL )
+    if( MQ_Push(MDC.spIFifo, psFifo) == R_FAIL )
     {
         /* Log a message if needed.
         */
         Lgr(LOG_DEBUG, szFunc,
-            "Memory exhausted, couldnt add packet onto the FIFO link list");
+            "FIFO full, couldnt add packet onto the FIFO queue");
 
-        /* Send a NAK to client to indicate that we've run out of memory.
+        /* Send a NAK to client to indicate that we're too busy.
         */
-        if(_MDC_SendNAK("Memory exhausted on server, packet rejected (2)")
+        if(_MDC_SendNAK("Server FIFO full, packet rejected (2)")
                                                                 == MDC_FAIL )
         {
             /* Log a message if needed.
@@ -457,10 +515,8 @@ void    _MDC_ServerDataCB(  UINT        nChanId,    /* I: Channel data rcv on*/
                 "Couldnt send a NAK message, Houston we have problems!!");
         }
 
-        /* Free up used resources and get out as nothing more can be done.
+        /* Get out as nothing more can be done.
         */
-        free(psFifo->pszData);
-        free(psFifo);
         return;
     }
 
@@ -490,7 +546,13 @@ int    MDC_Server( UINT        *nPortNo,             /* I: TCP/IP port number */
     /* Local variables.
     */
     FIFO        *psFifo;
-    LINKLIST    *psNext;
+    CMP_STATS   sStats;
+    int         nCodec;
+    UINT        nParallel;
+    UINT        nRows;
+    int         nDict;
+    UINT        nCheck;
+    UINT        nDictCheck;
     UINT        nServicePort;
     static int  nInitialised = FALSE;
     int         nReturn;
@@ -523,6 +585,34 @@ int    MDC_Server( UINT        *nPortNo,             /* I: TCP/IP port number */
         return(nReturn);
     }
 
+    /* Create the incoming FIFO queue which data callbacks hand packets
+     * over on.
+    */
+    if( (MDC.spIFifo == NULL &&
+         (MDC.spIFifo=MQ_Create(MDC_FIFO_SIZE, 0)) == NULL) ||
+        (MDC.spArena == NULL &&
+         (MDC.spArena=UA_Create(MDC_ARENA_SIZE)) == NULL) ||
+        (MDC.spCmpCtx == NULL &&
+         (MDC.spCmpCtx=LZW_CreateCtx()) == NULL) ||
+        (MDC.spDecCtx == NULL &&
+         (MDC.spDecCtx=LZW_CreateCtx()) == NULL) ||
+        (MDC.spRowCtx == NULL &&
+         (MDC.spRowCtx=ROW_CreateCtx()) == NULL) )
+    {
+        /* Log a message if needed.
+        */
+        Lgr(LOG_DEBUG, szFunc, "Couldnt create incoming FIFO queue");
+
+        /* Exit as nothing more can be done.
+        */
+        return(MDC_FAIL);
+    }
+
+    /* Large replies, such as file reads, are compressed in parallel for
+     * clients which can read them. Without threads they stay serial.
+    */
+    LZW_StartPool(MDC_CMPWORKERS);
+
     /* Do we need to work out the TCP port number by looking in /etc/services?
     */
     if( nPortNo == NULL )
@@ -582,58 +672,145 @@ ML_Init(8080, MON_SERVICE_HTML, "MDC Server/2.2.aaa", NULL, NULL, NULL);
         */
         SL_Poll(DEF_POLLTIME);
 
-        /* Any packets on the incoming FIFO? If there are, then grab the
-         * first one.
+        /* Any packets on the incoming FIFO? If there are, then take each
+         * off the queue in turn, guaranteeing that we never call the user
+         * twice with the same data.
         */
-        if( (psFifo=StartItem(MDC.spIFifoHead, &psNext)) != NULL )
+        while( (psFifo=MQ_Pop(MDC.spIFifo)) != NULL )
         {
-            /* Delete the entry off the FIFO before working with it to
-             * guarantee that we never call the user twice with the same
-             * data.
+            /* A new client offers the codecs it can read in a byte after
+             * the service details, and the check of its dictionary for
+             * the service if it has one. Pick a codec, accept the
+             * dictionary if ours matches and hide the bytes from the
+             * callback which expects the details alone.
+            */
+            nCodec = -1;
+            nDict = -1;
+            nParallel = FALSE;
+            nRows = FALSE;
+            if( psFifo->pszData[0] == MDC_INIT &&
+                psFifo->nDataLen == sizeof(SERVICEDETAILS)+4 )
+            {
+                nDict = 0;
+                nCheck = ((UINT)psFifo->pszData[psFifo->nDataLen-2] << 8) |
+                         psFifo->pszData[psFifo->nDataLen-1];
+                if( LZW_DictCheck(psFifo->pszData[1], &nDictCheck) == R_OK &&
+                    nDictCheck == nCheck )
+                {
+                    nDict = psFifo->pszData[1];
+                }
+                psFifo->nDataLen -= 2;
+            }
+            if( psFifo->pszData[0] == MDC_INIT &&
+                psFifo->nDataLen == sizeof(SERVICEDETAILS)+2 )
+            {
+                psFifo->nDataLen--;
+                nCodec = (int)CompressBestCodec(
+                                    psFifo->pszData[psFifo->nDataLen]);
+                if( psFifo->pszData[psFifo->nDataLen] & (1 << CMP_PAR) )
+                    nParallel = TRUE;
+                if( psFifo->pszData[psFifo->nDataLen] & (1 << CMP_ROWS) )
+                    nRows = TRUE;
+                psFifo->pszData[psFifo->nDataLen] = '\0';
+            }
+
+            /* Replies to a service are tracked apart from those of any
+             * other type of service, whether they are worth compressing
+             * differs from one to the next.
             */
-            if(DelItem(&MDC.spIFifoHead, &MDC.spIFifoTail, psFifo, NULL, NULL,
-                        NULL) == R_FAIL)
+            if( (psFifo->pszData[0] == MDC_INIT ||
+                 psFifo->pszData[0] == MDC_CHANGE) && psFifo->nDataLen > 1 )
             {
-                /* Log a message if needed.
+                LZW_SetClass(MDC.spCmpCtx, psFifo->pszData[1]);
+            }
+
+            /* Likewise a service returns rows only if its driver says so
+             * as it starts, see MDC_SetRowEncoding.
+            */
+            if( psFifo->pszData[0] == MDC_INIT ||
+                psFifo->pszData[0] == MDC_CHANGE )
+            {
+                MDC.cRowSep = '\0';
+            }
+
+            /* OK, weve got the data and we know its no longer on the FIFO,
+             * so lets call the users callback with this data.
+            */
+            MDC.szErrMsg[0] = '\0';
+            if(fLinkDataCB(psFifo->pszData, psFifo->nDataLen, MDC.szErrMsg) 
+                                                            == MDC_FAIL)
+            {
+                /* The callback failed, need to send a NAK to the client
+                 * plus the provided error message.
                 */
-                Lgr(LOG_DEBUG, szFunc,
-                    "Couldnt delete first FIFO entry, will retry later..");
+                if( _MDC_SendNAK(MDC.szErrMsg) == MDC_FAIL )
+                {
+                    /* Log a message if needed.
+                    */
+                    Lgr(LOG_ALERT, szFunc,
+                        "Couldnt send a NAK message, we have problems!!");
+                }
             } else
              {
-                /* OK, weve got the data and we know its no longer on the FIFO,
-                 * so lets call the users callback with this data.
+                /* The callback succeeded, so send out an ACK to the client
+                 * to let him continue on his merry way.
                 */
-                MDC.szErrMsg[0] = '\0';
-                if(fLinkDataCB(psFifo->pszData, psFifo->nDataLen, MDC.szErrMsg) 
-                                                                == MDC_FAIL)
+                if( _MDC_SendACK(nCodec, nDict) == MDC_FAIL )
                 {
-                    /* The callback failed, need to send a NAK to the client
-                     * plus the provided error message.
+                    /* Log a message to indicate problem.
                     */
-                    if( _MDC_SendNAK(MDC.szErrMsg) == MDC_FAIL )
-                    {
-                        /* Log a message if needed.
-                        */
-                        Lgr(LOG_ALERT, szFunc,
-                            "Couldnt send a NAK message, we have problems!!");
-                    }
+                    Lgr(LOG_ALERT, szFunc,
+                        "Couldnt send an ACK to the client...");
                 } else
-                 {
-                    /* The callback succeeded, so send out an ACK to the client
-                     * to let him continue on his merry way.
+                if( nCodec >= 0 )
+                {
+                    /* The client now knows which codec to expect, and
+                     * will send with it too.
                     */
-                    if( _MDC_SendACK() == MDC_FAIL )
+                    LZW_SetCodec(MDC.spCmpCtx, (UINT)nCodec);
+                    LZW_SetCodec(MDC.spDecCtx, (UINT)nCodec);
+                    LZW_SetParallel(MDC.spCmpCtx, nParallel);
+                    MDC.nRowPeer = nRows;
+                    if( nDict > 0 )
                     {
-                        /* Log a message to indicate problem.
-                        */
-                        Lgr(LOG_ALERT, szFunc,
-                            "Couldnt send an ACK to the client...");
+                        LZW_SetDict(MDC.spCmpCtx, (UINT)nDict);
+                        LZW_SetDict(MDC.spDecCtx, (UINT)nDict);
                     }
                 }
             }
         }
+
+        /* The FIFO is empty, so every carrier handed out from the arena
+         * has been processed and can be released in one go.
+        */
+        UA_Reset(MDC.spArena);
     } while( MDC.nCloseDown == FALSE );
 
+    /* Report how much compression work was done and avoided.
+    */
+    LZW_GetStats(MDC.spCmpCtx, &sStats);
+    Lgr(LOG_MESSAGE, szFunc,
+        "Compression: blocks=%ld, tried=%ld, shrunk=%ld, skipped=%ld, "
+        "in=%ld, out=%ld, cpu=%lduS, saved=%lduS", sStats.lBlocks,
+        sStats.lTried, sStats.lShrunk, sStats.lSkipped, sStats.lBytesIn,
+        sStats.lBytesOut + (sStats.lBytesIn - sStats.lTriedBytes),
+        sStats.lTryUs, sStats.lSavedUs);
+
+    /* Release the queue and the arena, along with any packets which never
+     * got processed.
+    */
+    MQ_Destroy(MDC.spIFifo);
+    MDC.spIFifo = NULL;
+    UA_Destroy(MDC.spArena);
+    MDC.spArena = NULL;
+    LZW_FreeCtx(MDC.spCmpCtx);
+    MDC.spCmpCtx = NULL;
+    LZW_FreeCtx(MDC.spDecCtx);
+    MDC.spDecCtx = NULL;
+    ROW_FreeCtx(MDC.spRowCtx);
+    MDC.spRowCtx = NULL;
+    LZW_StopPool();
+
     /* Where exitting cleanly, so toggle flag so that a new entry can
      * succeed.
     */
@@ -674,29 +851,42 @@ int    MDC_ReturnData( UCHAR    *snzDataBuf,    /* I: Data to return */
     if( MDC.nClientChanId != 0 )
     {
         /* Allocate enough memory to hold a message id and the data prior
-         * to transmission.
+         * to transmission, or the data coded as a row.
         */
-        if((psnzTmpBuf=(UCHAR *)malloc(nDataLen+1)) == NULL)
+        if((psnzTmpBuf=(UCHAR *)malloc(ROW_MAXLEN(nDataLen)+1)) == NULL)
         {
             /* Log a message as this condition shouldnt occur.
             */
             Lgr(LOG_DEBUG, szFunc, "Couldnt allocate (%d) bytes memory",
-                nDataLen+1);
+                ROW_MAXLEN(nDataLen)+1);
 
             /* Set exit code to indicate failure.
             */
             nReturn = MDC_FAIL;
         } else
          {
-            /* Build up the message to transmit.
+            /* Build up the message to transmit. Padded text rows from a
+             * driver which has said it returns them go to a client which
+             * can rebuild them coded against the row before, the rest as
+             * they are. Should coding fail, the row context stays unusable
+             * so the client never sees a row it cannot rebuild.
             */
-            *psnzTmpBuf = (UCHAR)MDC_DATA;
-            memcpy(psnzTmpBuf+1, snzDataBuf, nDataLen);
+            if( MDC.cRowSep != '\0' && MDC.nRowPeer == TRUE &&
+                ROW_Encode(MDC.spRowCtx, MDC.cRowSep, snzDataBuf,
+                           (UINT)nDataLen, psnzTmpBuf+1, &nXmitLen) == R_OK )
+            {
+                *psnzTmpBuf = (UCHAR)MDC_ROW;
+            } else
+             {
+                *psnzTmpBuf = (UCHAR)MDC_DATA;
+                memcpy(psnzTmpBuf+1, snzDataBuf, nDataLen);
+                nXmitLen = nDataLen;
+            }
 
             /* Compress it to save on transmission overheads.
             */
-            nXmitLen=nDataLen+1;
-            if((psnzCmpBuf=Compress(psnzTmpBuf, &nXmitLen)) != NULL)
+            nXmitLen++;
+            if((psnzCmpBuf=CompressCtx(MDC.spCmpCtx, psnzTmpBuf, &nXmitLen)) != NULL)
             {
                 /* Free up memory we used to store the original message.
                 */
@@ -745,6 +935,30 @@ int    MDC_ReturnData( UCHAR    *snzDataBuf,    /* I: Data to return */
     return(nReturn);
 }
 
+/******************************************************************************
+ * Function:    MDC_SetRowEncoding
+ * Description: Function called by a driver as its service starts to say
+ *              that the data it returns are text rows, with fields padded
+ *              out to their width and separated by the given character.
+ *              Rows then go to a client which can rebuild them coded
+ *              against the row before, see ROW_Encode, which shrinks the
+ *              padding and repeated fields before they are compressed.
+ *              Every new or changed service starts with it off.
+ * 
+ * Returns:     MDC_OK    - Row encoding set.
+ ******************************************************************************/
+int    MDC_SetRowEncoding( UCHAR    cSep )    /* I: Field separator, 0 = off */
+{
+    /* Store the separator for MDC_ReturnData, any rows already coded stay
+     * the history of those to come.
+    */
+    MDC.cRowSep = cSep;
+
+    /* Return result to caller.
+    */
+    return(MDC_OK);
+}
+
 /******************************************************************************
  * Function:    MDC_TimerCB
  * Description: Function to allow user code to register a callback event
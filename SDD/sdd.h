@@ -44,6 +44,7 @@
 /* Define any default values common to all drivers.
 */
 #define    DEF_COLSEP            "|"
+#define    DEF_COLSEPCHR         '|'      /* DEF_COLSEP as a character */
 #define    DEF_PADCHR            " "
 
 /* Define return types.
@@ -118,42 +119,48 @@
 */
 int        java_InitService( SERVICEDETAILS *, UCHAR * );
 int        java_CloseService( UCHAR * );
-int        java_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
+int        java_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *,
+                               UCHAR * );
 void       java_ProcessOOB( UCHAR );
 
 /* ODBC Driver.
 */
 int        odbc_InitService( SERVICEDETAILS *, UCHAR * );
 int        odbc_CloseService( UCHAR * );
-int        odbc_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
+int        odbc_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *,
+                               UCHAR * );
 void       odbc_ProcessOOB( UCHAR );
 
 /* System Command Driver.
 */
 int        scmd_InitService( SERVICEDETAILS *, UCHAR * );
 int        scmd_CloseService( UCHAR * );
-int        scmd_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
+int        scmd_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *,
+                               UCHAR * );
 void       scmd_ProcessOOB( UCHAR );
 
 /* FTP Driver.
 */
 int        ftpx_InitService( SERVICEDETAILS *, UCHAR * );
 int        ftpx_CloseService( UCHAR * );
-int        ftpx_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
+int        ftpx_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *,
+                               UCHAR * );
 void       ftpx_ProcessOOB( UCHAR );
 
 /* SYBASE Driver.
 */
 int        sybc_InitService( SERVICEDETAILS *, UCHAR * );
 int        sybc_CloseService( UCHAR * );
-int        sybc_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
+int        sybc_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *,
+                               UCHAR * );
 void       sybc_ProcessOOB( UCHAR );
 
 /* Audio Player Driver.
 */
 int        aupl_InitService( SERVICEDETAILS *, UCHAR * );
 int        aupl_CloseService( UCHAR * );
-int        aupl_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
+int        aupl_ProcessRequest( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *,
+                               UCHAR * );
 void       aupl_ProcessOOB( UCHAR );
 
 #endif    /* SDD_H */
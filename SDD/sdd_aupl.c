@@ -229,6 +229,7 @@ int    _AUPL_PlayZ( UCHAR    *pszAudioPath,        /* I: Path to Audio File */
                     UCHAR    *pszAudioFile,        /* I: Audio Filename */
                     int      (*fSendDataCB)(UCHAR *, UINT),
                                                    /* I: Func for returning data */
+                    UX_ARENA *spArena,             /* IO: Request memory */
                     UCHAR    *szErrMsg )           /* O: Error message generated */
 {
     /* Local variables.
@@ -258,7 +259,7 @@ int    _AUPL_PlayZ( UCHAR    *pszAudioPath,        /* I: Path to Audio File */
      * ahead.
     */
     nNdx=strlen(AUPL.szDecompExec)+strlen(pszAudioPath)+strlen(pszAudioFile)+10;
-    if((pszTmpBuf=(UCHAR *)malloc(nNdx)) == NULL)
+    if((pszTmpBuf=(UCHAR *)UA_Alloc(spArena, nNdx)) == NULL)
     {
         return(SDD_FAIL);
     }
@@ -306,11 +307,6 @@ int    _AUPL_PlayZ( UCHAR    *pszAudioPath,        /* I: Path to Audio File */
     */
     nResult=pclose(fpStdOut);
 
-
-    /* Free up allocated memory block.
-    */
-    free(pszTmpBuf);
-
     /* Return result code to caller.
     */
     return(nReturn);
@@ -386,6 +382,8 @@ int    aupl_CloseService( UCHAR        *szErrMsg )    /* O: Error message if fai
  *              to the driver which represents a request with relevant
  *              parameters. The data within the structure is only relevant
  *              to the original client and this driver code.
+ *              Temporary memory for the request is taken from spArena,
+ *              which the daemon resets once the request completes.
  * 
  * Returns:     SDD_FAIL- An error occurred within the driver whilst trying to
  *                        process the request, see error text.
@@ -395,6 +393,7 @@ int    aupl_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
                             int      nDataLen,              /* I: Len of data */
                             int      (*fSendDataCB)(UCHAR *, UINT),
                                                             /* I: CB to send reply*/
+                            UX_ARENA *spArena,              /* IO: Request memory */
                             UCHAR    *szErrMsg )            /* O: Error text */
 {
     /* Static variables.
@@ -463,7 +462,7 @@ int    aupl_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
              * command was a success or failure.
             */
             if(_AUPL_PlayZ(pszAudioPath, pszAudioFile, fSendDataCB,
-                                                        szErrMsg) == SDD_FAIL)
+                                               spArena, szErrMsg) == SDD_FAIL)
             {
                 return(SDD_FAIL);
             }
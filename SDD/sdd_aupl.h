@@ -65,7 +65,8 @@ int    _AUPL_GetStrArg( UCHAR *, int, UCHAR *, UCHAR ** );
 int    _AUPL_ValidatePath( UCHAR * );
 int    _AUPL_ValidateFile( UCHAR *, UCHAR *, UINT );
 #if defined(SOLARIS) || defined(SUNOS)
-int    _AUPL_PlayZ(UCHAR *, UCHAR *, int(*)(UCHAR *, UINT), UCHAR * );
+int    _AUPL_PlayZ(UCHAR *, UCHAR *, int(*)(UCHAR *, UINT), UX_ARENA *,
+                   UCHAR * );
 #endif
 
 #endif    /* SDD_AUPL_H */
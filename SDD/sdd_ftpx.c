@@ -1101,6 +1101,7 @@ int    _FTPX_SetMode( UINT     nBinaryMode,    /* I: Select binary mode = TRUE *
  *              SDD_OK     - Current Working Directory set.
  ******************************************************************************/
 int    _FTPX_SetCwd( UCHAR    *szPath,        /* I: Path to set CWD */
+                     UX_ARENA *spArena,       /* IO: Request memory */
                      UCHAR    *szErrMsg )     /* O: Generated error messages */
 {
     /* Local variables.
@@ -1112,7 +1113,7 @@ int    _FTPX_SetCwd( UCHAR    *szPath,        /* I: Path to set CWD */
 
     /* Allocate required memory for the command buffer.
     */
-    if((pszCmd=(UCHAR *)malloc(strlen(szPath)+7)) == NULL)
+    if((pszCmd=(UCHAR *)UA_Alloc(spArena, strlen(szPath)+7)) == NULL)
     {
         sprintf(szErrMsg, "Couldnt allocate memory for CWD command");
         return(SDD_FAIL);
@@ -1132,10 +1133,6 @@ int    _FTPX_SetCwd( UCHAR    *szPath,        /* I: Path to set CWD */
     */
     nReturn=_FTPX_PISendCmd(pszCmd, anResponses, szErrMsg);
 
-    /* Free up resources, no longer needed.
-    */
-    free(pszCmd);
-
     /* If a failure occurred, tag on our reason code as well.
     */
     if(nReturn == SDD_FAIL)
@@ -1354,6 +1351,7 @@ int    _FTPX_FTPClose( UCHAR    *szErrMsg )        /* O: Generated error message
 int    _FTPX_FTPRenFile( UCHAR    *szPath,       /* I: Path to remote file */
                          UCHAR    *szSrcFile,    /* I: Original remote file name */
                          UCHAR    *szDstFile,    /* I: New remote file name */
+                         UX_ARENA *spArena,      /* IO: Request memory */
                          UCHAR    *szErrMsg )    /* O: Generated error messages */
 {
     /* Local variables.
@@ -1365,14 +1363,15 @@ int    _FTPX_FTPRenFile( UCHAR    *szPath,       /* I: Path to remote file */
 
     /* Change to correct directory on remote.
     */
-    if(_FTPX_SetCwd(szPath, szErrMsg) == SDD_FAIL)
+    if(_FTPX_SetCwd(szPath, spArena, szErrMsg) == SDD_FAIL)
     {
         return(SDD_FAIL);
     }
 
     /* Allocate required memory for the command buffer.
     */
-    if((pszCmd=(UCHAR *)malloc(strlen(szSrcFile)+strlen(szDstFile)+10))==NULL)
+    if((pszCmd=(UCHAR *)UA_Alloc(spArena,
+                                 strlen(szSrcFile)+strlen(szDstFile)+10))==NULL)
     {
         sprintf(szErrMsg, "Couldnt allocate memory for command buffer");
         return(SDD_FAIL);
@@ -1393,7 +1392,6 @@ int    _FTPX_FTPRenFile( UCHAR    *szPath,       /* I: Path to remote file */
     {
         sprintf(&szErrMsg[strlen(szErrMsg)],
                 ": FTP server couldnt locate file '%s'", szSrcFile);
-        free(pszCmd);
         return(SDD_FAIL);
     }
 
@@ -1411,10 +1409,6 @@ int    _FTPX_FTPRenFile( UCHAR    *szPath,       /* I: Path to remote file */
     */
     nReturn=_FTPX_PISendCmd(pszCmd, anResponses, szErrMsg);
 
-    /* Free up command buffer, no longer needed.
-    */
-    free(pszCmd);
-
     /* If the above command failed, tag on our reason code and exit.
     */
     if(nReturn == SDD_FAIL)
@@ -1441,6 +1435,7 @@ int    _FTPX_FTPRcvFile( UCHAR    *szRcvFile,    /* I: Name of file to store in
                          UCHAR    *szPath,       /* I: Path to remote file */
                          UCHAR    *szFile,       /* I: Remote file */
                          UINT     nBinaryMode,   /* I: Select binary transfer mode */
+                         UX_ARENA *spArena,      /* IO: Request memory */
                          UCHAR    *szErrMsg )    /* O: Generated error messages */
 {
     /* Local variables.
@@ -1459,7 +1454,7 @@ int    _FTPX_FTPRcvFile( UCHAR    *szRcvFile,    /* I: Name of file to store in
 
     /* Change to correct directory on remote.
     */
-    if(_FTPX_SetCwd(szPath, szErrMsg) == SDD_FAIL)
+    if(_FTPX_SetCwd(szPath, spArena, szErrMsg) == SDD_FAIL)
     {
         return(SDD_FAIL);
     }
@@ -1474,7 +1469,7 @@ int    _FTPX_FTPRcvFile( UCHAR    *szRcvFile,    /* I: Name of file to store in
 
     /* Allocate required memory for the command buffer.
     */
-    if((pszCmd=(UCHAR *)malloc(strlen(szFile)+8))==NULL)
+    if((pszCmd=(UCHAR *)UA_Alloc(spArena, strlen(szFile)+8))==NULL)
     {
         sprintf(szErrMsg, "Couldnt allocate memory for command buffer");
         return(SDD_FAIL);
@@ -1493,10 +1488,6 @@ int    _FTPX_FTPRcvFile( UCHAR    *szRcvFile,    /* I: Name of file to store in
     */
     nReturn=_FTPX_PISendDTPCmd(pszCmd, anResponses, szErrMsg);
 
-    /* Free up command buffer, no longer needed.
-    */
-    free(pszCmd);
-
     /* If the above command failed, tag on our reason code and exit.
     */
     if(nReturn == SDD_FAIL)
@@ -1540,6 +1531,7 @@ int    _FTPX_FTPXmitFile( UCHAR   *szXmitFile,   /* I: Name of file to transmit
                          UCHAR    *szPath,       /* I: Path to remote destination */
                          UCHAR    *szFile,       /* I: Remote file */
                          UINT     nBinaryMode,   /* I: Select binary transfer Mode */
+                         UX_ARENA *spArena,      /* IO: Request memory */
                          UCHAR    *szErrMsg )    /* O: Generated error messages */
 {
     /* Local variables.
@@ -1562,7 +1554,7 @@ int    _FTPX_FTPXmitFile( UCHAR   *szXmitFile,   /* I: Name of file to transmit
 
     /* Change to correct directory on remote.
     */
-    if(_FTPX_SetCwd(szPath, szErrMsg) == SDD_FAIL)
+    if(_FTPX_SetCwd(szPath, spArena, szErrMsg) == SDD_FAIL)
     {
         return(SDD_FAIL);
     }
@@ -1577,7 +1569,7 @@ int    _FTPX_FTPXmitFile( UCHAR   *szXmitFile,   /* I: Name of file to transmit
 
     /* Allocate required memory for the command buffer.
     */
-    if((pszCmd=(UCHAR *)malloc(strlen(szFile)+8))==NULL)
+    if((pszCmd=(UCHAR *)UA_Alloc(spArena, strlen(szFile)+8))==NULL)
     {
         sprintf(szErrMsg, "Couldnt allocate memory for command buffer");
         return(SDD_FAIL);
@@ -1596,10 +1588,6 @@ int    _FTPX_FTPXmitFile( UCHAR   *szXmitFile,   /* I: Name of file to transmit
     */
     nReturn=_FTPX_PISendDTPCmd(pszCmd, anResponses, szErrMsg);
 
-    /* Free up command buffer, no longer needed.
-    */
-    free(pszCmd);
-
     /* If last command failed, tag on our reason code and exit.
     */
     if(nReturn == SDD_FAIL)
@@ -1611,7 +1599,7 @@ int    _FTPX_FTPXmitFile( UCHAR   *szXmitFile,   /* I: Name of file to transmit
 
     /* Allocate required memory for the transmit data buffer.
     */
-    if((pszDataBuf=(UCHAR *)malloc(DEF_FTP_XMIT_SIZE+1))==NULL)
+    if((pszDataBuf=(UCHAR *)UA_Alloc(spArena, DEF_FTP_XMIT_SIZE+1))==NULL)
     {
         sprintf(szErrMsg, "Couldnt allocate memory for xmit data buffer");
         return(SDD_FAIL);
@@ -1647,16 +1635,11 @@ int    _FTPX_FTPXmitFile( UCHAR   *szXmitFile,   /* I: Name of file to transmit
             if(SL_BlockSendData(FTPX.nDTPChanId,(UCHAR *)pszDataBuf,nNdx)!=R_OK)
             {
                 sprintf(szErrMsg, "Couldnt send data to FTP server");
-                free(pszDataBuf);
                 return(SDD_FAIL);
             }
         }
     }
 
-    /* Free up memory, no longer needed.
-    */
-    free(pszDataBuf);
-
     /* Close the DTP channel, which in turn indicates to the FTP server that
      * data transmission is complete.
     */    
@@ -1774,6 +1757,8 @@ int    ftpx_CloseService( UCHAR        *szErrMsg )    /* O: Error message if fai
  *              to the driver which represents a request with relevant
  *              parameters. The data within the structure is only relevant
  *              to the original client and this driver code.
+ *              Temporary memory for the request is taken from spArena,
+ *              which the daemon resets once the request completes.
  * 
  * Returns:     SDD_FAIL- An error occurred within the driver whilst trying to
  *                        process the request, see error text.
@@ -1783,6 +1768,7 @@ int    ftpx_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
                             int      nDataLen,              /* I: Len of data */
                             int      (*fSendDataCB)(UCHAR *, UINT),
                                                             /* I: CB to send reply*/
+                            UX_ARENA *spArena,              /* IO: Request memory */
                             UCHAR    *szErrMsg )            /* O: Error text */
 {
     /* Static variables.
@@ -1962,7 +1948,8 @@ int    ftpx_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
                  * is still open, it will fail otherwise.
                 */
                 nReturn=_FTPX_FTPXmitFile(szXmitFile, pszRemotePath,
-                                          pszRemoteFile, nXmitMode, szErrMsg);
+                                          pszRemoteFile, nXmitMode, spArena,
+                                          szErrMsg);
 
                 /* Free the permanent path and file store, no longer needed.
                 */
@@ -2024,7 +2011,7 @@ int    ftpx_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
              * maybe the client is the ?A.dasd?.
             */
             if(_FTPX_FTPRcvFile(szRcvFile, szPath, szSrcFile, nRcvMode,
-                                                        szErrMsg) == SDD_FAIL)
+                                               spArena, szErrMsg) == SDD_FAIL)
             {
                 /* Delete temporary file as we dont want thousands of these
                  * populating the temporary directory.
@@ -2117,7 +2104,8 @@ int    ftpx_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
 
             /* Call the FTP function to perform the rename.
             */
-            if(_FTPX_FTPRenFile(szPath,szSrcFile,szDstFile,szErrMsg)==SDD_FAIL)
+            if(_FTPX_FTPRenFile(szPath, szSrcFile, szDstFile, spArena,
+                                                        szErrMsg) == SDD_FAIL)
             {
                 /* Exit directly as we have nothing open to tidy up.
                 */
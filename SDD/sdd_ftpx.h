@@ -116,11 +116,13 @@ int        _FTPX_PISendCmd( UCHAR *, UINT *, UCHAR * );
 int        _FTPX_PIGetDTPResponse( void );
 int        _FTPX_PISendDTPCmd( UCHAR *, UINT *, UCHAR * );
 int        _FTPX_SetMode( UINT, UCHAR * );
-int        _FTPX_SetCwd( UCHAR *, UCHAR * );
+int        _FTPX_SetCwd( UCHAR *, UX_ARENA *, UCHAR * );
 int        _FTPX_FTPInit( UCHAR *, UCHAR *, UCHAR *, UCHAR * );
 int        _FTPX_FTPClose( UCHAR * );
-int        _FTPX_FTPRenFile( UCHAR *, UCHAR *, UCHAR *, UCHAR * );
-int        _FTPX_FTPRcvFile( UCHAR *, UCHAR *, UCHAR *, UINT, UCHAR * );
-int        _FTPX_FTPXmitFile( UCHAR *, UCHAR *, UCHAR *, UINT, UCHAR * );
+int        _FTPX_FTPRenFile( UCHAR *, UCHAR *, UCHAR *, UX_ARENA *, UCHAR * );
+int        _FTPX_FTPRcvFile( UCHAR *, UCHAR *, UCHAR *, UINT, UX_ARENA *,
+                             UCHAR * );
+int        _FTPX_FTPXmitFile( UCHAR *, UCHAR *, UCHAR *, UINT, UX_ARENA *,
+                              UCHAR * );
 
 #endif    /* SDD_FTPX_H */
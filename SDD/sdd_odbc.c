@@ -160,6 +160,7 @@ int    _ODBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
                      int        nDataLen,                /* I: Len of data */
                      int        (*fSendDataCB)(UCHAR *, UINT),
                                                          /* I: CB to send reply */
+                     UX_ARENA *spArena,                  /* IO: Request memory */
                      UCHAR    *szErrMsg )                /* O: Error text */
 {
     /* Local variables.
@@ -208,7 +209,7 @@ int    _ODBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
 
     /* Allocate memory to null terminate inbound SQL prior to preparing it.
     */
-    if((pszSqlBuf=(UCHAR *)malloc(nDataLen+1)) == NULL)
+    if((pszSqlBuf=(UCHAR *)UA_Alloc(spArena, nDataLen+1)) == NULL)
     {
         /* Build exit message to let caller know why we failed.
         */
@@ -234,11 +235,6 @@ int    _ODBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
     */
     nResult=SQLPrepare(hStmt, pszSqlBuf, (SDWORD)nDataLen);
 
-    /* Free up memory, no need to hang on to it..
-    */
-    free(pszSqlBuf);
-    pszSqlBuf = NULL;
-
     /* Check result code to see if prepare created errors.
     */
     if(nResult != SQL_SUCCESS && nResult != SQL_SUCCESS_WITH_INFO)
@@ -280,7 +276,7 @@ int    _ODBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
 
     /* Allocate memory to bind the returning column lengths on.
     */
-    if((panColLen=(SDWORD *)malloc(nNumCols * sizeof(SDWORD))) == NULL)
+    if((panColLen=(SDWORD *)UA_Alloc(spArena, nNumCols * sizeof(SDWORD))) == NULL)
     {
         /* Build exit message to let caller know why we failed.
         */
@@ -328,7 +324,7 @@ int    _ODBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
 
     /* Allocate memory to bind the returning columns on.
     */
-    if((pacRowCol=(UCHAR *)malloc(nNumCols*nMaxColLen)) == NULL)
+    if((pacRowCol=(UCHAR *)UA_Alloc(spArena, nNumCols*nMaxColLen)) == NULL)
     {
         /* Build exit message to let caller know why we failed.
         */
@@ -372,7 +368,7 @@ int    _ODBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
      * row, seperated by the pipe symbol.
     */
     nRowBufLen=nMaxColLen * nNumCols;
-    if((pszRowBuf=(UCHAR *)malloc(nRowBufLen+1)) == NULL)
+    if((pszRowBuf=(UCHAR *)UA_Alloc(spArena, nRowBufLen+1)) == NULL)
     {
         /* Build exit message to let caller know why we failed.
         */
@@ -578,15 +574,6 @@ int    _ODBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
     }
 
 _ODBC_RunSql_Exit:
-    /* Free memory prior to exit.
-    */
-    if(panColLen != NULL)
-        free(panColLen);
-    if(pacRowCol != NULL)
-        free(pacRowCol);
-    if(pszRowBuf != NULL)
-        free(pszRowBuf);
-
     /* Clear SQL Cursor prior to exit.
     */
     nResult=SQLFreeStmt(hStmt, SQL_CLOSE);
@@ -750,6 +737,7 @@ int    _ODBC_ListTables( UCHAR    *snzDataBuf,               /* I: Input data */
                          int        nDataLen,                /* I: Len of data */
                          int        (*fSendDataCB)(UCHAR *, UINT),
                                                              /* I: CB to send reply */
+                         UX_ARENA *spArena,                  /* IO: Request memory */
                          UCHAR    *szErrMsg )                /* O: Error text */
 {
     /* Local variables.
@@ -860,7 +848,7 @@ int    _ODBC_ListTables( UCHAR    *snzDataBuf,               /* I: Input data */
     /* Allocate memory to hold all column data as one continous character
      * row, seperated by the pipe symbol.
     */
-    if((pszRowBuf=(UCHAR *)malloc( ((MAX_TABLE_DESCR_LEN+1)*5) +1)) == NULL)
+    if((pszRowBuf=(UCHAR *)UA_Alloc(spArena, ((MAX_TABLE_DESCR_LEN+1)*5) +1)) == NULL)
     {
         /* Build exit message to let caller know why we failed.
         */
@@ -962,11 +950,6 @@ int    _ODBC_ListTables( UCHAR    *snzDataBuf,               /* I: Input data */
     }
 
 _ODBC_ListTables_Exit:
-    /* Free memory prior to exit.
-    */
-    if(pszRowBuf != NULL)
-        free(pszRowBuf);
-
     /* Clear SQL Cursor prior to exit.
     */
     nResult=SQLFreeStmt(hStmt, SQL_CLOSE);
@@ -1020,6 +1003,7 @@ int    _ODBC_ListCols( UCHAR    *snzDataBuf,               /* I: Input data */
                        int      nDataLen,                  /* I: Len of data */
                        int      (*fSendDataCB)(UCHAR *, UINT),
                                                            /* I: CB to send reply */
+                       UX_ARENA *spArena,                  /* IO: Request memory */
                        UCHAR    *szErrMsg )                /* O: Error text */
 {
     /* Local variables.
@@ -1169,7 +1153,7 @@ int    _ODBC_ListCols( UCHAR    *snzDataBuf,               /* I: Input data */
     /* Allocate memory to hold all column data as one continous character
      * row, seperated by the pipe symbol.
     */
-    if((pszRowBuf=(UCHAR *)malloc( ((MAX_TABLE_DESCR_LEN+1)*12) +1)) == NULL)
+    if((pszRowBuf=(UCHAR *)UA_Alloc(spArena, ((MAX_TABLE_DESCR_LEN+1)*12) +1)) == NULL)
     {
         /* Build exit message to let caller know why we failed.
         */
@@ -1307,11 +1291,6 @@ int    _ODBC_ListCols( UCHAR    *snzDataBuf,               /* I: Input data */
     }
 
 _ODBC_ListColumns_Exit:
-    /* Free memory prior to exit.
-    */
-    if(pszRowBuf != NULL)
-        free(pszRowBuf);
-
     /* Clear SQL Cursor prior to exit.
     */
     nResult=SQLFreeStmt(hStmt, SQL_CLOSE);
@@ -1543,6 +1522,8 @@ int    odbc_CloseService( UCHAR        *szErrMsg )    /* O: Error message if fai
  *              to the driver which represents a request with relevant
  *              parameters. The data within the structure is only relevant
  *              to the original client and this driver code.
+ *              Temporary memory for the request is taken from spArena,
+ *              which the daemon resets once the request completes.
  * 
  * Returns:     SDD_FAIL- An error occurred within the driver whilst trying to
  *                        process the request, see error text.
@@ -1552,6 +1533,7 @@ int    odbc_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
                             int      nDataLen,              /* I: Len of data */
                             int      (*fSendDataCB)(UCHAR *, UINT),
                                                             /* I: CB to send reply*/
+                            UX_ARENA *spArena,              /* IO: Request memory */
                             UCHAR    *szErrMsg )            /* O: Error text */
 {
     /* Local variables.
@@ -1585,7 +1567,8 @@ int    odbc_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
 
             /* Execute the SQL.
             */
-            nReturn=_ODBC_RunSql(&snzDataBuf[1],nDataLen,fSendDataCB,szErrMsg);
+            nReturn=_ODBC_RunSql(&snzDataBuf[1], nDataLen, fSendDataCB, spArena,
+                                 szErrMsg);
             break;
 
         case SDD_LIST_DB:
@@ -1608,7 +1591,7 @@ int    odbc_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
             /* Call function to extract names of all tables in a database.
             */
             nReturn=_ODBC_ListTables(&snzDataBuf[1], nDataLen, fSendDataCB,
-                                     szErrMsg);
+                                     spArena, szErrMsg);
             break;
 
         case SDD_LIST_COLS:
@@ -1620,7 +1603,7 @@ int    odbc_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
             /* Call function to extract details of all columns in a table.
             */
             nReturn=_ODBC_ListCols(&snzDataBuf[1], nDataLen, fSendDataCB,
-                                   szErrMsg);
+                                   spArena, szErrMsg);
             break;
  
         default:
@@ -72,9 +72,12 @@ static    ODBC_DRIVER        ODBC;
 */
 void      _ODBC_LogODBCError(    HSTMT );
 int       _ODBC_GetArg( UCHAR *, UCHAR *, int, UCHAR ** );
-int       _ODBC_RunSql( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
+int       _ODBC_RunSql( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *,
+                        UCHAR * );
 int       _ODBC_ListDB( int (*)(UCHAR *, UINT), UCHAR * );
-int       _ODBC_ListTables( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
-int       _ODBC_ListCols( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
+int       _ODBC_ListTables( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *,
+                            UCHAR * );
+int       _ODBC_ListCols( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *,
+                          UCHAR * );
 
 #endif    /* SDD_ODBC_H */
@@ -245,7 +245,8 @@ int    _SCMD_ValidateTime( UCHAR   *pszTime,        /* I: Time to verify */
  * Description: Function to execute a given command via a fork and exec,
  *              attaching the parent to the childs I/O so that any data
  *              output by the child can be captured by the parent and fed
- *              back to the caller.
+ *              back to the caller. Buffers are taken from the request
+ *              arena.
  * 
  * Returns:     SDD_FAIL- Command failed during execution.
  *              SDD_OK    - Command executed successfully.
@@ -257,6 +258,7 @@ int    _SCMD_Exec( int      nTimedExec,        /* I: Is this a timed exec (T/F)?
                    ULNG     lTimeToExec,       /* I: Time to execution */
                    int      (*fSendDataCB)(UCHAR *, UINT),
                                                /* I: Func for returning data */
+                   UX_ARENA *spArena,          /* IO: Request memory */
                    UCHAR    *szErrMsg )        /* O: Error message generated */
 {
     /* Local variables.
@@ -284,7 +286,7 @@ int    _SCMD_Exec( int      nTimedExec,        /* I: Is this a timed exec (T/F)?
 
     /* Allocate memory for return buffer.
     */
-    if((pszRetBuf=(UCHAR *)malloc(nRetBufSize)) == NULL)
+    if((pszRetBuf=(UCHAR *)UA_Alloc(spArena, nRetBufSize)) == NULL)
     {
         return(SDD_FAIL);
     }
@@ -300,7 +302,7 @@ int    _SCMD_Exec( int      nTimedExec,        /* I: Is this a timed exec (T/F)?
      * for the system command to use.
     */
     nNdx=strlen(pszPath)+strlen(pszCmd)+strlen(pszArgs)+10;
-    if((pszTmpBuf=(UCHAR *)malloc(nNdx)) == NULL)
+    if((pszTmpBuf=(UCHAR *)UA_Alloc(spArena, nNdx)) == NULL)
     {
         return(SDD_FAIL);
     }
@@ -405,10 +407,6 @@ int    _SCMD_Exec( int      nTimedExec,        /* I: Is this a timed exec (T/F)?
         nReturn = SDD_FAIL;
     }
 
-    /* Free up allocated memory block.
-    */
-    free(pszTmpBuf);
-
     /* Return result code to caller.
     */
     return(nReturn);
@@ -826,6 +824,8 @@ int    scmd_CloseService( UCHAR        *szErrMsg )    /* O: Error message if fai
  *              to the driver which represents a request with relevant
  *              parameters. The data within the structure is only relevant
  *              to the original client and this driver code.
+ *              Temporary memory for the request is taken from spArena,
+ *              which the daemon resets once the request completes.
  * 
  * Returns:     SDD_FAIL- An error occurred within the driver whilst trying to
  *                        process the request, see error text.
@@ -835,6 +835,7 @@ int    scmd_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
                             int      nDataLen,              /* I: Len of data */
                             int      (*fSendDataCB)(UCHAR *, UINT),
                                                             /* I: CB to send reply*/
+                            UX_ARENA *spArena,              /* IO: Request memory */
                             UCHAR    *szErrMsg )            /* O: Error text */
 {
     /* Static variables.
@@ -1054,7 +1055,7 @@ int    scmd_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
              * failure.
             */
             if(_SCMD_Exec(FALSE,pszSrcPath,pszCmd,pszArgs,0,fSendDataCB,
-                                                        szErrMsg) == SDD_FAIL)
+                                               spArena, szErrMsg) == SDD_FAIL)
             {
                 return(SDD_FAIL);
             }
@@ -1074,7 +1075,7 @@ int    scmd_ProcessRequest( UCHAR    *snzDataBuf,           /* I: Input data */
              * code and text message.
             */
             if(_SCMD_Exec(TRUE,pszSrcPath,pszCmd,pszArgs,lTime,fSendDataCB,
-                                                        szErrMsg) == SDD_FAIL)
+                                               spArena, szErrMsg) == SDD_FAIL)
             {
                 return(SDD_FAIL);
             }
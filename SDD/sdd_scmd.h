@@ -81,7 +81,8 @@ int    _SCMD_ValidatePath( UCHAR * );
 int    _SCMD_ValidateFile( UCHAR *, UCHAR *, UINT );
 int    _SCMD_ValidateTime( UCHAR *, ULNG * );
 #if defined(SOLARIS) || defined(SUNOS)
-int    _SCMD_Exec(int, UCHAR *, UCHAR *, UCHAR *, ULNG, int(*)(UCHAR *, UINT), UCHAR * );
+int    _SCMD_Exec(int, UCHAR *, UCHAR *, UCHAR *, ULNG, int(*)(UCHAR *, UINT),
+                  UX_ARENA *, UCHAR * );
 #endif
 
 #endif    /* SDD_SCMD_H */
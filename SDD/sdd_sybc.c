@@ -123,6 +123,7 @@ int    _SYBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
                      int      nDataLen,                  /* I: Len of data */
                      int      (*fSendDataCB)(UCHAR *, UINT),
                                                          /* I: CB to send reply */
+                     UX_ARENA *spArena,                  /* IO: Request memory */
                      UCHAR    *szErrMsg )                /* O: Error text */
 {
     /* Local variables.
@@ -135,7 +136,7 @@ int    _SYBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
     /* Need to NULL terminate the buffer prior to executing it, so allocate
      * some memory and copy the original buffer into it.
     */
-    if((pszTmpBuf=(UCHAR *)malloc(nDataLen+1)) == NULL)
+    if((pszTmpBuf=(UCHAR *)UA_Alloc(spArena, nDataLen+1)) == NULL)
     {
         sprintf(szErrMsg,
                 "%s: Out of memory trying to exec SQL buffer",
@@ -153,19 +154,12 @@ int    _SYBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
     */
     if(dbcmd(SYB.dbProc, pszTmpBuf) == FAIL)
     {
-        /* Free up memory as it can no longer be used.
-        */
-        free(pszTmpBuf);
         sprintf(szErrMsg,
                 "%s: Couldnt load SQL into sybase exec buffer",
                 SDD_EMSG_SQLLOAD);
         return(SDD_FAIL);
     }
 
-    /* Free up memory, no longer needed.
-    */
-    free(pszTmpBuf);
-
     /* Execute the SQL on the server, paying attention to the results.
     */
     if(dbsqlexec(SYB.dbProc) == FAIL)
@@ -211,7 +205,7 @@ int    _SYBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
 
         /* Allocate memory to hold returned results.
         */
-        if((pszTmpBuf=(UCHAR *)malloc(lResultBufLen+1)) == NULL)
+        if((pszTmpBuf=(UCHAR *)UA_Alloc(spArena, lResultBufLen+1)) == NULL)
         {
             /* Cancel the query to avoid future results-pending errors.
             */
@@ -239,10 +233,6 @@ int    _SYBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
                     */
                     dbcancel(SYB.dbProc);
 
-                    /* Free up memory used.
-                    */
-                    free(pszTmpBuf);
-
                     /* Build error message for return.
                     */
                     sprintf(szErrMsg,
@@ -264,10 +254,6 @@ int    _SYBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
                     */
                     dbcancel(SYB.dbProc);
 
-                    /* Free up memory used.
-                    */
-                    free(pszTmpBuf);
-
                     /* Build error message for return.
                     */
                     sprintf(szErrMsg,
@@ -289,10 +275,6 @@ int    _SYBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
                 */
                 dbcancel(SYB.dbProc);
 
-                /* Free up memory used.
-                */
-                free(pszTmpBuf);
-
                 /* Build error message for return.
                 */
                 sprintf(szErrMsg,
@@ -302,10 +284,6 @@ int    _SYBC_RunSql( UCHAR    *snzDataBuf,               /* I: Input data */
             }
         } while( (SYB.nAbortPending == FALSE) && 
                  (dbnextrow(SYB.dbProc) != NO_MORE_ROWS) );
-
-        /* Free up memory used.
-        */
-        free(pszTmpBuf);
     } while(SYB.nAbortPending == FALSE && 
             dbresults(SYB.dbProc) != NO_MORE_RESULTS);
 
@@ -441,6 +419,7 @@ int    sybc_InitService( SERVICEDETAILS   *sServiceDet,    /* I: Init data */
  ******************************************************************************/
 int    _SYBC_ListDB( int      (*fSendDataCB)(UCHAR *, UINT),
                                                          /* I: CB to send reply */
+                     UX_ARENA *spArena,                  /* IO: Request memory */
                      UCHAR    *szErrMsg )                /* O: Error text */
 {
     /* Local variables.
@@ -499,7 +478,7 @@ int    _SYBC_ListDB( int      (*fSendDataCB)(UCHAR *, UINT),
 
     /* Allocate memory to hold returned results.
     */
-    if((pszTmpBuf=(UCHAR *)malloc(lResultBufLen+1)) == NULL)
+    if((pszTmpBuf=(UCHAR *)UA_Alloc(spArena, lResultBufLen+1)) == NULL)
     {
         /* Cancel the query to avoid future results-pending errors.
         */
@@ -538,10 +517,6 @@ int    _SYBC_ListDB( int      (*fSendDataCB)(UCHAR *, UINT),
                 */
                 dbcancel(SYB.dbProc);
 
-                /* Free up memory used.
-                */
-                free(pszTmpBuf);
-
                 /* Build error message for return.
                 */
                 sprintf(szErrMsg,
@@ -553,10 +528,6 @@ int    _SYBC_ListDB( int      (*fSendDataCB)(UCHAR *, UINT),
     } while(SYB.nAbortPending == FALSE && 
             dbresults(SYB.dbProc) != NO_MORE_RESULTS);
 
-    /* Free up memory used.
-    */
-    free(pszTmpBuf);
-
     /* If an abort command arrived halfway through processing then tidy up
      * and exit.
     */
@@ -591,6 +562,7 @@ int    _SYBC_ListTables( UCHAR    *snzDataBuf,             /* I: Input data */
                          int      nDataLen,                /* I: Len of data */
                          int      (*fSendDataCB)(UCHAR *, UINT),
                                                            /* I: CB to send reply */
+                         UX_ARENA *spArena,                /* IO: Request memory */
                          UCHAR    *szErrMsg )              /* O: Error text */
 {
     /* Local variables.
@@ -682,7 +654,7 @@ int    _SYBC_ListTables( UCHAR    *snzDataBuf,             /* I: Input data */
 
     /* Allocate memory to hold returned results.
     */
-    if((pszTmpBuf=(UCHAR *)malloc(lResultBufLen+1)) == NULL)
+    if((pszTmpBuf=(UCHAR *)UA_Alloc(spArena, lResultBufLen+1)) == NULL)
     {
         /* Cancel the query to avoid future results-pending errors.
         */
@@ -722,10 +694,6 @@ int    _SYBC_ListTables( UCHAR    *snzDataBuf,             /* I: Input data */
                 */
                 dbcancel(SYB.dbProc);
 
-                /* Free up memory used.
-                */
-                free(pszTmpBuf);
-
                 /* Build error message for return.
                 */
                 sprintf(szErrMsg,
@@ -737,10 +705,6 @@ int    _SYBC_ListTables( UCHAR    *snzDataBuf,             /* I: Input data */
     } while(SYB.nAbortPending == FALSE && 
             dbresults(SYB.dbProc) != NO_MORE_RESULTS);
 
-    /* Free up memory used.
-    */
-    free(pszTmpBuf);
-
     /* If an abort command arrived halfway through processing then tidy up
      * and exit.
     */
@@ -776,6 +740,7 @@ int    _SYBC_ListCols( UCHAR    *snzDataBuf,               /* I: Input data */
                        int      nDataLen,                  /* I: Len of data */
                        int      (*fSendDataCB)(UCHAR *, UINT),
                                                            /* I: CB to send reply */
+                       UX_ARENA *spArena,                  /* IO: Request memory */
                        UCHAR    *szErrMsg )                /* O: Error text */
 {
     /* Local variables.
@@ -890,7 +855,7 @@ int    _SYBC_ListCols( UCHAR    *snzDataBuf,               /* I: Input data */
 
     /* Allocate memory to hold returned results.
     */
-    if((pszTmpBuf=(UCHAR *)malloc(lResultBufLen+1)) == NULL)
+    if((pszTmpBuf=(UCHAR *)UA_Alloc(spArena, lResultBufLen+1)) == NULL)
     {
         /* Cancel the query to avoid future results-pending errors.
         */
@@ -950,10 +915,6 @@ int    _SYBC_ListCols( UCHAR    *snzDataBuf,               /* I: Input data */
                     */
                     dbcancel(SYB.dbProc);
 
-                    /* Free up memory used.
-                    */
-                    free(pszTmpBuf);
-
                     /* Build error message for return.
                     */
                     sprintf(szErrMsg,
@@ -972,10 +933,6 @@ int    _SYBC_ListCols( UCHAR    *snzDataBuf,               /* I: Input data */
     } while(SYB.nAbortPending == FALSE && 
             dbresults(SYB.dbProc) != NO_MORE_RESULTS);
 
-    /* Free up memory used.
-    */
-    free(pszTmpBuf);
-
     /* If no rows where detected or returned then there was an error with 
      * the column, table or database name.
     */
@@ -1060,6 +1017,8 @@ int    sybc_CloseService( UCHAR        *szErrMsg )    /* O: Error message if fai
  *              to the driver which represents a request with relevant
  *              parameters. The data within the structure is only relevant
  *              to the original client and this driver code.
+ *              Temporary memory for the request is taken from spArena,
+ *              which the daemon resets once the request completes.
  * 
  * Returns:     SDD_FAIL- An error occurred within the driver whilst trying to
  *                        process the request, see error text.
@@ -1069,6 +1028,7 @@ int    sybc_ProcessRequest( UCHAR    *snzDataBuf,       /* I: Input data */
                             int      nDataLen,          /* I: Len of data */
                             int      (*fSendDataCB)(UCHAR *, UINT),
                                                         /* I: CB to send reply */
+                            UX_ARENA *spArena,          /* IO: Request memory */
                             UCHAR    *szErrMsg )        /* O: Error text */
 {
     /* Local variables.
@@ -1103,7 +1063,8 @@ int    sybc_ProcessRequest( UCHAR    *snzDataBuf,       /* I: Input data */
 
             /* Execute the SQL.
             */
-            nReturn=_SYBC_RunSql(&snzDataBuf[1],nDataLen,fSendDataCB,szErrMsg);
+            nReturn=_SYBC_RunSql(&snzDataBuf[1], nDataLen, fSendDataCB, spArena,
+                                 szErrMsg);
             break;
 
         /* Request to list all the names of the databases on the current open
@@ -1117,7 +1078,7 @@ int    sybc_ProcessRequest( UCHAR    *snzDataBuf,       /* I: Input data */
 
             /* Call function to extract names of all databases in data source.
             */
-            nReturn=_SYBC_ListDB(fSendDataCB, szErrMsg);
+            nReturn=_SYBC_ListDB(fSendDataCB, spArena, szErrMsg);
             break;
 
         /* Request to list all the table names of a given database on the
@@ -1132,7 +1093,7 @@ int    sybc_ProcessRequest( UCHAR    *snzDataBuf,       /* I: Input data */
             /* Call function to extract names of all tables in a database.
             */
             nReturn=_SYBC_ListTables(&snzDataBuf[1], nDataLen, fSendDataCB,
-                                     szErrMsg);
+                                     spArena, szErrMsg);
             break;
 
         /* Request to list all the column names and their attributes of a
@@ -1147,7 +1108,7 @@ int    sybc_ProcessRequest( UCHAR    *snzDataBuf,       /* I: Input data */
             /* Call function to extract details of all columns in a table.
             */
             nReturn=_SYBC_ListCols(&snzDataBuf[1], nDataLen, fSendDataCB,
-                                   szErrMsg);
+                                   spArena, szErrMsg);
             break;
 
         default:
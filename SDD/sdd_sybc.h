@@ -77,9 +77,10 @@ static    SYB_DRIVER        SYB;
 /* Prototypes of internal functions, not seen by any outside module.
 */
 int    _SYBC_GetArg( UCHAR *, UCHAR *, int, UCHAR ** );
-int    _SYBC_RunSql( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
-int    _SYBC_ListDB( int (*)(UCHAR *, UINT), UCHAR * );
-int    _SYBC_ListTables( UCHAR    *, int, int (*)(UCHAR *, UINT), UCHAR * );
-int    _SYBC_ListCols( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
+int    _SYBC_RunSql( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *, UCHAR * );
+int    _SYBC_ListDB( int (*)(UCHAR *, UINT), UX_ARENA *, UCHAR * );
+int    _SYBC_ListTables( UCHAR    *, int, int (*)(UCHAR *, UINT), UX_ARENA *,
+                         UCHAR * );
+int    _SYBC_ListCols( UCHAR *, int, int (*)(UCHAR *, UINT), UX_ARENA *, UCHAR * );
 
 #endif    /* SDD_SYBC_H */
@@ -102,6 +102,8 @@ int    xxxx_CloseService( UCHAR        *szErrMsg )    /* O: Error message if fai
  *              to the driver which represents a request with relevant
  *              parameters. The data within the structure is only relevant
  *              to the original client and this driver code.
+ *              Temporary memory for the request is taken from spArena,
+ *              which the daemon resets once the request completes.
  * 
  * Returns:     SDD_FAIL- An error occurred within the driver whilst trying to
  *                        process the request, see error text.
@@ -110,6 +112,7 @@ int    xxxx_CloseService( UCHAR        *szErrMsg )    /* O: Error message if fai
 int    xxxx_ProcessRequest( UCHAR    *snzDataBuf,        /* I: Input data */
                             int      nDataLen,           /* I: Len of data */
                             int      (*fSendDataCB)(),   /* I: CB to send reply*/
+                            UX_ARENA *spArena,           /* IO: Request memory */
                             UCHAR    *szErrMsg )         /* O: Error text */
 {
     /* Local variables.
@@ -58,20 +58,27 @@
 VDWD_DRIVERS    Driver[]={
 /* #if defined(SOLARIS) || defined(_WIN32)
 #    { SRV_ODBC,     odbc_InitService,       odbc_CloseService,    
-#                    odbc_ProcessRequest,    odbc_ProcessOOB },
+#                    odbc_ProcessRequest,    odbc_ProcessOOB,
+#                    DEF_COLSEPCHR },
 #endif */
 #if defined(SOLARIS) || defined(SUNOS) || defined(_WIN32)
     { SRV_SYBASE,    sybc_InitService,       sybc_CloseService,
-                     sybc_ProcessRequest,    sybc_ProcessOOB },
+                     sybc_ProcessRequest,    sybc_ProcessOOB,
+                     DEF_COLSEPCHR },
 #endif
     { SRV_JAVA,      java_InitService,       java_CloseService,
-                     java_ProcessRequest,    java_ProcessOOB },
+                     java_ProcessRequest,    java_ProcessOOB,
+                     '\0' },
     { SRV_SCMD,      scmd_InitService,       scmd_CloseService,
-                     scmd_ProcessRequest,    scmd_ProcessOOB },
+                     scmd_ProcessRequest,    scmd_ProcessOOB,
+                     '\0' },
     { SRV_FTPX,      ftpx_InitService,       ftpx_CloseService,
-                     ftpx_ProcessRequest,    ftpx_ProcessOOB },
+                     ftpx_ProcessRequest,    ftpx_ProcessOOB,
+                     '\0' },
 /* #    { SRV_AUPL,  aupl_InitService,       aupl_CloseService,
-#                    aupl_ProcessRequest,    aupl_ProcessOOB }, */
+#                    aupl_ProcessRequest,    aupl_ProcessOOB,
+#                    '\0' }, */
     { 0,             NULL,                   NULL,
-                     NULL,                   NULL }
+                     NULL,                   NULL,
+                     '\0' }
 };
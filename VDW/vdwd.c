@@ -124,6 +124,40 @@ int    GetConfig( int     argc,          /* I: CLI argument count */
         VDWD.nLogMode = LOG_MESSAGE;
     }
 
+    /* Get low latency spin period from command line, off by default.
+    */
+    if(GetCLIParam(argc, argv, FLG_SPINMAX, T_LONG, (UCHAR *)&VDWD.lSpinMax,
+                   0, 0) != R_OK)
+    {
+        VDWD.lSpinMax = 0L;
+    }
+
+    /* Get traffic capture filename from command line, off by default.
+    */
+    if(GetCLIParam(argc, argv, FLG_CAPFILE, T_STR, VDWD.szCapFile,
+                   MAX_LOGFILELEN, FALSE) != R_OK)
+    {
+        VDWD.szCapFile[0] = '\0';
+    }
+
+    /* Get size of the asynchronous log ring from command line, 0 logs
+     * synchronously.
+    */
+    if(GetCLIParam(argc, argv, FLG_LOGRING, T_INT, (UCHAR *)&VDWD.nLogRing,
+                   0, 0) != R_OK)
+    {
+        VDWD.nLogRing = DEF_LOGRING;
+    }
+
+    /* Get shared compression dictionary directory from command line, none
+     * by default.
+    */
+    if(GetCLIParam(argc, argv, FLG_DICTDIR, T_STR, VDWD.szDictDir,
+                   MAX_LOGFILELEN, FALSE) != R_OK)
+    {
+        VDWD.szDictDir[0] = '\0';
+    }
+
     /* Finished, get out!
     */
     return( nReturn );
@@ -180,9 +214,23 @@ int    VDWDInit( UCHAR        *szErrMsg    )    /* O: Generated error message */
     umask(0);
 #endif
 
-    /* Setup logger mode.
+    /* Setup logger mode. Logging at LOG_DEBUG writes a line for every row
+     * returned, so the lines are handed to a writer thread, and below
+     * alerts are dropped rather than hold up a reply if it falls behind.
     */
     Lgr(LOG_CONFIG, LGM_FLATFILE, VDWD.nLogMode, VDWD.szLogFile);
+    if(VDWD.nLogRing > 0 && LgrStart(VDWD.nLogRing * 1024, LGR_DROP) == R_FAIL)
+    {
+        Lgr(LOG_WARNING, "VDWDInit", "Couldnt log asynchronously (%d)", Errno);
+    }
+
+    /* Create the arena from which drivers take their per request memory.
+    */
+    if((VDWD.spArena=UA_Create(DEF_ARENASIZE)) == NULL)
+    {
+        sprintf(szErrMsg, "Couldnt allocate request arena");
+        return(VDWD_FAIL);
+    }
 
     /* All done, lets get out.
     */
@@ -218,6 +266,16 @@ int    VDWDClose(    UCHAR        *szErrMsg    )    /* O: Generated error messag
         VDWD.nActiveService = 0;
     }
 
+    /* Release the request arena.
+    */
+    if(VDWD.spArena != NULL)
+    {
+        Lgr(LOG_DEBUG, "VDWDClose", "Request arena peaked at (%ld) bytes",
+            VDWD.spArena->lPeak);
+        UA_Destroy(VDWD.spArena);
+        VDWD.spArena = NULL;
+    }
+
     /* Exit with success.
     */
     return(VDWD_OK);
@@ -288,6 +346,12 @@ int    VDWDInitService( int                nServiceType,     /* I: Type of servi
             if(Driver[nNdx].InitService(sServiceDet, szErrMsg) == SDD_FAIL)
             {
                 nReturn = VDWD_FAIL;
+            } else
+             {
+                /* Rows the driver returns can now be coded against the
+                 * row before.
+                */
+                MDC_SetRowEncoding(Driver[nNdx].cRowSep);
             }
         } else
          {
@@ -373,7 +437,8 @@ int    VDWDCloseService( int       nServiceType,     /* I: Type of service*/
 /******************************************************************************
  * Function:    VDWDProcessRequest
  * Description: Function to call a given drivers function to process a
- *              service request.
+ *              service request. Memory the driver takes from the request
+ *              arena is released in one go once the driver returns.
  * 
  * Returns:     VDWD_OK        - Request was processed successfully.
  *              VDWD_FAIL    - Failure, see error message.
@@ -407,10 +472,11 @@ int    VDWDProcessRequest( int         nServiceType,    /* I: Type of service */
             /* Call the driver function to process the request.
             */
             if(Driver[nNdx].ProcessRequest(snzData, nDataLen, VDWDSendToClient,
-                                           szErrMsg) == SDD_FAIL)
+                                           VDWD.spArena, szErrMsg) == SDD_FAIL)
             {
                 nReturn=VDWD_FAIL;
             }
+            UA_Reset(VDWD.spArena);
         } else
          {
             /* Log the fact that there is no driver.
@@ -666,6 +732,8 @@ int    main( int     argc,       /* I: Count of available arguments */
     /* Local variables.
     */
     UCHAR        szErrMsg[MAX_ERRMSG_LEN];
+    UINT         nNdx;
+    UCHAR        szDictFile[MAX_LOGFILELEN+8];
     UCHAR        *szFunc = "main";
 
     /* Bring in any configuration parameters passed on the command line etc.
@@ -675,7 +743,11 @@ int    main( int     argc,       /* I: Count of available arguments */
         printf( "%s\n"
                 "Usage:                 %s <parameters>\n"
                 "<parameters>:          -l<LogFile Name>\n"
-                "                       -m<Logging Mode>\n",
+                "                       -m<Logging Mode>\n"
+                "                       -s<Low latency spin uS>\n"
+                "                       -c<Capture File Name>\n"
+                "                       -d<Dictionary Directory>\n"
+                "                       -a<Log ring KB, 0 = synchronous>\n",
                 szErrMsg, argv[0]);
     }
 
@@ -689,6 +761,38 @@ int    main( int     argc,       /* I: Count of available arguments */
         exit(-1);
     }
 
+    /* Select low latency comms if requested.
+    */
+    if( VDWD.lSpinMax > 0 )
+    {
+        MDC_SetLowLatency(VDWD.lSpinMax);
+    }
+
+    /* Capture traffic for later replay if requested.
+    */
+    if( VDWD.szCapFile[0] != '\0' )
+    {
+        MDC_SetCapture(VDWD.szCapFile);
+    }
+
+    /* Load the shared compression dictionary of each service which has
+     * one in the dictionary directory, clients holding the same use them.
+    */
+    if( VDWD.szDictDir[0] != '\0' )
+    {
+        for(nNdx=0; Driver[nNdx].nType != 0; nNdx++)
+        {
+            sprintf(szDictFile, DICT_FILEFMT, VDWD.szDictDir,
+                    Driver[nNdx].nType);
+            if( access(szDictFile, R_OK) == 0 &&
+                MDC_SetDictionary((UCHAR)Driver[nNdx].nType, szDictFile)
+                                                                == MDC_OK )
+            {
+                Lgr(LOG_MESSAGE, szFunc, "Loaded dictionary (%s)", szDictFile);
+            }
+        }
+    }
+
     /* Start the daemon running by passing control into the MDC library and
      * letting it generate callbacks as events occur.
     */
@@ -50,6 +50,8 @@
 /* Definitions for defaults.
 */
 #define    DEF_SERVICENAME      "vdwd"
+#define    DEF_ARENASIZE        65536
+#define    DEF_LOGRING          256       /* KB in the log ring of a thread */
 #if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
 #define    DEF_LOGFILE          "/tmp/vdwd.log"
 #endif
@@ -61,6 +63,15 @@
 */
 #define    FLG_LOGFILE          "-l"
 #define    FLG_LOGMODE          "-m"
+#define    FLG_SPINMAX          "-s"
+#define    FLG_CAPFILE          "-c"
+#define    FLG_DICTDIR          "-d"
+#define    FLG_LOGRING          "-a"
+
+/* Name of the shared compression dictionary of a service type within the
+ * dictionary directory, as written by ux_test/cm_dict.
+*/
+#define    DICT_FILEFMT         "%s/%c.dct"
 
 /* Define error return codes which are embedded into returned error messages
  * for the user to decipher.
@@ -72,14 +83,18 @@
 
 /* Structure to provide the interface between the VDW Daemon and its
  * linked in driver modules. Provides entry points into the driver for the
- * daemon.
+ * daemon, and the separator of the padded text rows a driver returns,
+ * which are then coded against the row before for clients which can
+ * rebuild them.
 */
 typedef struct {
     int        nType;
     int        (*InitService)( SERVICEDETAILS *, UCHAR * );
     int        (*CloseService)( UCHAR * );
-    int        (*ProcessRequest)( UCHAR *, int, int (*)(UCHAR *, UINT), UCHAR * );
+    int        (*ProcessRequest)( UCHAR *, int, int (*)(UCHAR *, UINT),
+                                 UX_ARENA *, UCHAR * );
     void       (*ProcessOOB)( UCHAR );
+    UCHAR      cRowSep;                /* Row field separator, 0 = not rows */
 } VDWD_DRIVERS;
 
 /* Globals (yuggghhh!) for the VDW Daemon. They are contained within a
@@ -91,13 +106,19 @@ typedef struct {
     UINT       nLogMode;
     UINT       nServiceInitialised;
     UCHAR      szLogFile[MAX_LOGFILELEN];
+    ULNG       lSpinMax;
+    UCHAR      szCapFile[MAX_LOGFILELEN];
+    UCHAR      szDictDir[MAX_LOGFILELEN];
+    UX_ARENA   *spArena;
+    UINT       nLogRing;
 } VDWD_GLOBALS;
 
 /* Declare any globals required by the daemon, or any specifics to the
  * C module.
 */
 #if defined(VDWD_C)
-    static     VDWD_GLOBALS    VDWD={0, LOG_DEBUG, FALSE, ""};
+    static     VDWD_GLOBALS    VDWD={0, LOG_DEBUG, FALSE, "", 0L, "", "", NULL,
+                                             DEF_LOGRING};
     extern     VDWD_DRIVERS    Driver[];
 #endif
 
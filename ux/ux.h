@@ -37,9 +37,15 @@
 
 #include    "ux_dtype.h"
 #include    "ux_comon.h"
+#include    "ux_ctnr.h"
+#include    "ux_cache.h"
+#include    "ux_arena.h"
+#include    "ux_intern.h"
 #include    "ux_comms.h"
 #include    "ux_cmprs.h"
 #include    "ux_mon.h"
+#include    "ux_queue.h"
+#include    "ux_lgr.h"
 
 /* Version Control.
 */
@@ -0,0 +1,312 @@
+/******************************************************************************
+ * Product:       #     # #     #         #         ###   ######
+ *                #     #  #   #          #          #    #     #
+ *                #     #   # #           #          #    #     #
+ *                #     #    #            #          #    ######
+ *                #     #   # #           #          #    #     #
+ *                #     #  #   #          #          #    #     #
+ *                 #####  #     # ####### #######   ###   ######
+ *
+ * File:          ux_arena.c
+ * Description:   An arena allocator. Memory is handed out by advancing a
+ *                pointer through a chain of blocks and is never freed
+ *                piece by piece, instead the whole arena is reset once the
+ *                work it served, typically one request, is complete. Blocks
+ *                are kept over a reset so a steady load settles down to no
+ *                calls on the system allocator at all.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1994-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Bring in system header files.
+*/
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <ctype.h>
+#include    <stdarg.h>
+#include    <sys/types.h>
+#include    <errno.h>
+#include    <sys/timeb.h>
+#include    <sys/stat.h>
+#include    <fcntl.h>
+
+#if defined(SUNOS) || defined(SOLARIS) || defined(LINUX)
+#include    <sys/socket.h>
+#include    <sys/time.h>
+#include    <string.h>
+#endif
+
+#if defined(SOLARIS)
+#include    <sys/file.h>
+#endif
+
+#if defined(LINUX)
+#include    <term.h>
+#endif
+
+#if !defined(_WIN32)
+#include    <unistd.h>
+#endif
+
+#if defined(_WIN32)
+#include    <winsock.h>
+#include    <time.h>
+#endif
+
+#if defined(SUNOS) || defined(SOLARIS)
+#include    <netinet/in.h>
+#include    <sys/wait.h>
+#endif
+
+/* Indicate that we are a C module for any header specifics.
+*/
+#define        UX_ARENA_C
+
+/* Bring in specific header files.
+*/
+#include    "ux.h"
+
+/******************************************************************************
+ * Function:    _UA_NewBlock
+ * Description: Allocate a block for an arena.
+ * Returns:     NOTNULL   - New empty block.
+ *              NULL      - Memory exhaustion.
+ ******************************************************************************/
+UA_BLOCK *_UA_NewBlock( UINT    nSize )    /* I: Usable bytes wanted */
+{
+    /* Local variables.
+    */
+    UA_BLOCK    *spBlock;
+
+    if((spBlock=(UA_BLOCK *)malloc(sizeof(UA_BLOCK) + nSize)) != NULL)
+    {
+        spBlock->spNext = NULL;
+        spBlock->nSize = nSize;
+        spBlock->nUsed = 0;
+    }
+    return(spBlock);
+}
+
+/******************************************************************************
+ * Function:    UA_Create
+ * Description: Create an arena with one block ready for use.
+ * Thread Safe: Yes.
+ * Returns:     NOTNULL   - The new arena.
+ *              NULL      - Failure, see Errno.
+ * <Errno>      E_NOMEM   - Memory exhaustion.
+ ******************************************************************************/
+UX_ARENA *UA_Create( UINT    nBlockSize )    /* I: Block size, 0 = default */
+{
+    /* Local variables.
+    */
+    UX_ARENA    *spArena;
+    char        *szFunc = "UA_Create";
+
+    if(nBlockSize == 0)
+        nBlockSize = UA_DEFBLOCKSIZE;
+    nBlockSize = (nBlockSize + UA_ALIGN - 1) & ~(UA_ALIGN - 1);
+
+    if((spArena=(UX_ARENA *)malloc(sizeof(UX_ARENA))) == NULL ||
+       (spArena->spHead=_UA_NewBlock(nBlockSize)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt allocate arena of (%d) bytes",
+            nBlockSize);
+        if(spArena != NULL)
+            free(spArena);
+        Errno = E_NOMEM;
+        return(NULL);
+    }
+    spArena->spCur = spArena->spHead;
+    spArena->nBlockSize = nBlockSize;
+    spArena->lAllocs = 0;
+    spArena->lBytes = 0;
+    spArena->lPeak = 0;
+
+    /* Return the new arena to caller.
+    */
+    return(spArena);
+}
+
+/******************************************************************************
+ * Function:    UA_Destroy
+ * Description: Release an arena and all memory allocated from it.
+ * Thread Safe: No, arena must not be in use.
+ * Returns:     R_OK      - Arena released.
+ *              R_FAIL    - Failure, see Errno.
+ * <Errno>      E_BADPARM - Bad arena passed.
+ ******************************************************************************/
+int UA_Destroy( UX_ARENA    *spArena )    /* I: Arena to release */
+{
+    /* Local variables.
+    */
+    UA_BLOCK    *spBlock;
+
+    if(spArena == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+
+    while((spBlock=spArena->spHead) != NULL)
+    {
+        spArena->spHead = spBlock->spNext;
+        free(spBlock);
+    }
+    free(spArena);
+
+    /* Return result code to caller.
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    UA_Alloc
+ * Description: Allocate memory from an arena. The memory is aligned for any
+ *              basic type and remains valid until the arena is reset or
+ *              destroyed, it must not be passed to free. A request larger
+ *              than a block gets a block of its own.
+ * Thread Safe: No, an arena belongs to one thread at a time.
+ * Returns:     NOTNULL   - Allocated memory.
+ *              NULL      - Failure, see Errno.
+ * <Errno>      E_BADPARM - Bad arena passed.
+ *              E_NOMEM   - Memory exhaustion.
+ ******************************************************************************/
+void *UA_Alloc( UX_ARENA    *spArena,    /* IO: Arena to allocate from */
+                UINT        nSize )      /* I: Bytes required */
+{
+    /* Local variables.
+    */
+    UA_BLOCK    *spBlock;
+    void        *spMem;
+
+    if(spArena == NULL)
+    {
+        Errno = E_BADPARM;
+        return(NULL);
+    }
+    nSize = (nSize + UA_ALIGN - 1) & ~(UA_ALIGN - 1);
+
+    /* If the current block is full, an oversized request gets a block of
+     * its own chained in behind the current one, otherwise move on to the
+     * next empty block, left by a reset, or chain in a new one. Blocks
+     * behind the current one are only ever empty or oversized.
+    */
+    spBlock = spArena->spCur;
+    if(spBlock->nSize - spBlock->nUsed < nSize)
+    {
+        if(nSize <= spArena->nBlockSize)
+        {
+            for(spBlock=spBlock->spNext; spBlock != NULL && spBlock->nUsed != 0;
+                spBlock=spBlock->spNext);
+        } else
+         {
+            spBlock = NULL;
+        }
+
+        if(spBlock == NULL)
+        {
+            if((spBlock=_UA_NewBlock(nSize > spArena->nBlockSize ?
+                                       nSize : spArena->nBlockSize)) == NULL)
+            {
+                Errno = E_NOMEM;
+                return(NULL);
+            }
+            spBlock->spNext = spArena->spCur->spNext;
+            spArena->spCur->spNext = spBlock;
+        }
+        if(nSize <= spArena->nBlockSize)
+            spArena->spCur = spBlock;
+    }
+
+    spMem = (UCHAR *)(spBlock + 1) + spBlock->nUsed;
+    spBlock->nUsed += nSize;
+    spArena->lAllocs++;
+    if((spArena->lBytes += nSize) > spArena->lPeak)
+        spArena->lPeak = spArena->lBytes;
+
+    /* Return memory to caller.
+    */
+    return(spMem);
+}
+
+/******************************************************************************
+ * Function:    UA_StrDup
+ * Description: Copy a string into an arena.
+ * Thread Safe: No, an arena belongs to one thread at a time.
+ * Returns:     NOTNULL   - Copy of string.
+ *              NULL      - Failure, see Errno.
+ * <Errno>      E_BADPARM - Bad parameters.
+ *              E_NOMEM   - Memory exhaustion.
+ ******************************************************************************/
+UCHAR *UA_StrDup( UX_ARENA    *spArena,    /* IO: Arena to allocate from */
+                  UCHAR       *szStr )     /* I: String to copy */
+{
+    /* Local variables.
+    */
+    UINT        nLen;
+    UCHAR       *szCopy;
+
+    if(szStr == NULL)
+    {
+        Errno = E_BADPARM;
+        return(NULL);
+    }
+    nLen = strlen((char *)szStr) + 1;
+    if((szCopy=(UCHAR *)UA_Alloc(spArena, nLen)) != NULL)
+        memcpy(szCopy, szStr, nLen);
+    return(szCopy);
+}
+
+/******************************************************************************
+ * Function:    UA_Reset
+ * Description: Release everything allocated from an arena in one go. Blocks
+ *              of the standard size are kept for reuse, oversized blocks
+ *              made for single large requests are freed.
+ * Thread Safe: No, an arena belongs to one thread at a time.
+ * Returns:     Non.
+ ******************************************************************************/
+void UA_Reset( UX_ARENA    *spArena )    /* IO: Arena to reset */
+{
+    /* Local variables.
+    */
+    UA_BLOCK    *spBlock;
+    UA_BLOCK    **spLink;
+
+    if(spArena == NULL)
+        return;
+
+    spArena->spHead->nUsed = 0;
+    for(spLink=&spArena->spHead->spNext; (spBlock=*spLink) != NULL; )
+    {
+        if(spBlock->nSize > spArena->nBlockSize)
+        {
+            *spLink = spBlock->spNext;
+            free(spBlock);
+        } else
+         {
+            spBlock->nUsed = 0;
+            spLink = &spBlock->spNext;
+        }
+    }
+    spArena->spCur = spArena->spHead;
+    spArena->lAllocs = 0;
+    spArena->lBytes = 0;
+}
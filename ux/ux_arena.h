@@ -0,0 +1,79 @@
+/******************************************************************************
+ * Product:       #     # #     #         #         ###   ######
+ *                #     #  #   #          #          #    #     #
+ *                #     #   # #           #          #    #     #
+ *                #     #    #            #          #    ######
+ *                #     #   # #           #          #    #     #
+ *                #     #  #   #          #          #    #     #
+ *                 #####  #     # ####### #######   ###   ######
+ *
+ * File:          ux_arena.h
+ * Description:   Header file for the arena allocator, a bump allocator over
+ *                chained blocks released all at once by a reset.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1994-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    UX_ARENA_H
+#define    UX_ARENA_H
+
+/* Arena sizes.
+*/
+#define    UA_DEFBLOCKSIZE   65536     /* Block size when none given */
+#define    UA_ALIGN          8         /* Alignment of every allocation */
+
+/* A block of arena memory, the usable space follows it.
+*/
+typedef struct uablock {
+    struct uablock  *spNext;           /* Next block in chain */
+    UINT            nSize;             /* Usable bytes in block */
+    UINT            nUsed;             /* Bytes handed out */
+    double          dAlign;            /* Align space following the header */
+} UA_BLOCK;
+
+/* An arena.
+*/
+typedef struct {
+    UA_BLOCK        *spHead;           /* First block, kept over a reset */
+    UA_BLOCK        *spCur;            /* Block being allocated from */
+    UINT            nBlockSize;        /* Size of a standard block */
+    ULNG            lAllocs;           /* Allocations since the last reset */
+    ULNG            lBytes;            /* Bytes allocated since last reset */
+    ULNG            lPeak;             /* Most bytes held between resets */
+} UX_ARENA;
+
+/* Prototypes for internal functions.
+*/
+#if defined(UX_ARENA_C)
+UA_BLOCK    *_UA_NewBlock( UINT );
+#endif
+
+/* Prototypes for API functions.
+*/
+UX_ARENA    *UA_Create( UINT );
+int         UA_Destroy( UX_ARENA * );
+void        *UA_Alloc( UX_ARENA *, UINT );
+UCHAR       *UA_StrDup( UX_ARENA *, UCHAR * );
+void        UA_Reset( UX_ARENA * );
+
+#endif    /* UX_ARENA_H */
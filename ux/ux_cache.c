@@ -0,0 +1,686 @@
+/******************************************************************************
+ * Product:       #     # #     #         #         ###   ######
+ *                #     #  #   #          #          #    #     #
+ *                #     #   # #           #          #    #     #
+ *                #     #    #            #          #    ######
+ *                #     #   # #           #          #    #     #
+ *                #     #  #   #          #          #    #     #
+ *                 #####  #     # ####### #######   ###   ######
+ *
+ * File:          ux_cache.c
+ * Description:   A bounded cache of byte string keys to byte string values.
+ *                Lookup is by hash, and entries are kept on an LRU list so
+ *                that the least recently used go first when an entry or
+ *                byte limit is reached. Entries may carry a time to live.
+ *                The cache is split into stripes, each with its own lock,
+ *                hash, list and share of the limits, so that threads
+ *                working on different keys rarely meet.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1994-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Bring in system header files.
+*/
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <ctype.h>
+#include    <stdarg.h>
+#include    <sys/types.h>
+#include    <errno.h>
+#include    <sys/timeb.h>
+#include    <sys/stat.h>
+#include    <fcntl.h>
+
+#if defined(SUNOS) || defined(SOLARIS) || defined(LINUX)
+#include    <sys/socket.h>
+#include    <sys/time.h>
+#include    <string.h>
+#endif
+
+#if defined(SOLARIS)
+#include    <sys/file.h>
+#endif
+
+#if defined(LINUX)
+#include    <term.h>
+#endif
+
+#if !defined(_WIN32)
+#include    <unistd.h>
+#include    <sched.h>
+#endif
+
+#if defined(_WIN32)
+#include    <winsock.h>
+#include    <time.h>
+#endif
+
+#if defined(SUNOS) || defined(SOLARIS)
+#include    <netinet/in.h>
+#include    <sys/wait.h>
+#endif
+
+/* Indicate that we are a C module for any header specifics.
+*/
+#define        UX_CACHE_C
+
+/* Bring in specific header files.
+*/
+#include    "ux.h"
+
+/******************************************************************************
+ * Function:    _UC_GetTimeMs
+ * Description: Get the current time in milliseconds, for entry expiry.
+ * Returns:     Time in mS.
+ ******************************************************************************/
+ULNG _UC_GetTimeMs( void )
+{
+    /* Local variables.
+    */
+#if defined(_WIN32)
+    struct timeb    sTp;
+
+    ftime(&sTp);
+    return((ULNG)sTp.time * 1000L + (ULNG)sTp.millitm);
+#else
+    struct timeval  sTv;
+
+    gettimeofday(&sTv, NULL);
+    return((ULNG)sTv.tv_sec * 1000L + (ULNG)sTv.tv_usec / 1000L);
+#endif
+}
+
+/******************************************************************************
+ * Function:    _UC_Hash
+ * Description: FNV-1a hash of a key.
+ * Returns:     Hash value.
+ ******************************************************************************/
+UINT _UC_Hash( UCHAR    *spKey,      /* I: Key */
+               UINT     nKeyLen )    /* I: Bytes of key */
+{
+    /* Local variables.
+    */
+    UINT        nHash = 2166136261U;
+
+    while(nKeyLen-- > 0)
+        nHash = (nHash ^ *spKey++) * 16777619U;
+    return(nHash);
+}
+
+/******************************************************************************
+ * Function:    _UC_Lock
+ * Description: Take the lock of a stripe, spinning briefly then yielding
+ *              whilst another thread holds it. Without the GNU atomic
+ *              builtins the cache is only safe within a single thread.
+ * Returns:     Non.
+ ******************************************************************************/
+void _UC_Lock( UC_STRIPE    *spStripe )    /* IO: Stripe to lock */
+{
+#if defined(__GNUC__)
+    /* Local variables.
+    */
+    UINT        nSpin = 0;
+
+    while(__atomic_exchange_n(&spStripe->nLock, 1, __ATOMIC_ACQUIRE) != 0)
+    {
+        while(__atomic_load_n(&spStripe->nLock, __ATOMIC_RELAXED) != 0)
+        {
+#if !defined(_WIN32)
+            if(++nSpin > 100)
+                sched_yield();
+#endif
+        }
+    }
+#endif
+}
+
+/******************************************************************************
+ * Function:    _UC_Unlock
+ * Description: Release the lock of a stripe.
+ * Returns:     Non.
+ ******************************************************************************/
+void _UC_Unlock( UC_STRIPE    *spStripe )    /* IO: Stripe to unlock */
+{
+#if defined(__GNUC__)
+    __atomic_store_n(&spStripe->nLock, 0, __ATOMIC_RELEASE);
+#endif
+}
+
+/******************************************************************************
+ * Function:    _UC_Find
+ * Description: Locate the entry for a key within a stripe.
+ * Returns:     NOTNULL   - Entry.
+ *              NULL      - No such key.
+ ******************************************************************************/
+UC_ENTRY *_UC_Find( UC_STRIPE    *spStripe,    /* I: Stripe holding key */
+                    UCHAR        *spKey,       /* I: Key */
+                    UINT         nKeyLen,      /* I: Bytes of key */
+                    UINT         nHash )       /* I: Hash of key */
+{
+    /* Local variables.
+    */
+    UC_ENTRY    *spEntry;
+
+    for(spEntry=spStripe->spBucket[nHash & (spStripe->nBuckets - 1)];
+        spEntry != NULL; spEntry=spEntry->spHNext)
+    {
+        if(spEntry->nHash == nHash && spEntry->nKeyLen == nKeyLen &&
+           memcmp((UCHAR *)(spEntry + 1), spKey, nKeyLen) == 0)
+            break;
+    }
+    return(spEntry);
+}
+
+/******************************************************************************
+ * Function:    _UC_Drop
+ * Description: Remove an entry from its stripe, tell the owner why through
+ *              the eviction callback and release it.
+ * Returns:     Non.
+ ******************************************************************************/
+void _UC_Drop( UX_CACHE     *spCache,     /* I: Cache */
+               UC_STRIPE    *spStripe,    /* IO: Stripe holding entry */
+               UC_ENTRY     *spEntry,     /* I: Entry to remove */
+               UINT         nReason )     /* I: UCE_... reason */
+{
+    /* Local variables.
+    */
+    UC_ENTRY    **spLink;
+
+    /* Out of the hash chain.
+    */
+    for(spLink=&spStripe->spBucket[spEntry->nHash & (spStripe->nBuckets - 1)];
+        *spLink != spEntry; spLink=&(*spLink)->spHNext);
+    *spLink = spEntry->spHNext;
+
+    /* Out of the LRU list.
+    */
+    if(spEntry->spPrev == NULL)
+        spStripe->spHead = spEntry->spNext;
+    else
+        spEntry->spPrev->spNext = spEntry->spNext;
+    if(spEntry->spNext == NULL)
+        spStripe->spTail = spEntry->spPrev;
+    else
+        spEntry->spNext->spPrev = spEntry->spPrev;
+
+    spStripe->sStats.lEntries--;
+    spStripe->sStats.lBytes -= sizeof(UC_ENTRY) + spEntry->nKeyLen +
+                                                  spEntry->nValLen;
+    if(nReason == UCE_LIMIT)
+        spStripe->sStats.lEvictions++;
+    if(nReason == UCE_EXPIRED)
+        spStripe->sStats.lExpired++;
+
+    if(spCache->fEvict != NULL)
+    {
+        spCache->fEvict((UCHAR *)(spEntry + 1), spEntry->nKeyLen,
+                        (UCHAR *)(spEntry + 1) + spEntry->nKeyLen,
+                        spEntry->nValLen, nReason, spCache->lCBData);
+    }
+    free(spEntry);
+}
+
+/******************************************************************************
+ * Function:    _UC_Grow
+ * Description: Double the hash buckets of a stripe. If memory is short the
+ *              stripe carries on with longer chains.
+ * Returns:     Non.
+ ******************************************************************************/
+void _UC_Grow( UC_STRIPE    *spStripe )    /* IO: Stripe to grow */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    UINT        nBuckets = spStripe->nBuckets * 2;
+    UC_ENTRY    *spEntry;
+    UC_ENTRY    *spNext;
+    UC_ENTRY    **spBucket;
+
+    if((spBucket=(UC_ENTRY **)calloc(nBuckets, sizeof(UC_ENTRY *))) == NULL)
+        return;
+    for(nNdx=0; nNdx < spStripe->nBuckets; nNdx++)
+    {
+        for(spEntry=spStripe->spBucket[nNdx]; spEntry != NULL; spEntry=spNext)
+        {
+            spNext = spEntry->spHNext;
+            spEntry->spHNext = spBucket[spEntry->nHash & (nBuckets - 1)];
+            spBucket[spEntry->nHash & (nBuckets - 1)] = spEntry;
+        }
+    }
+    free(spStripe->spBucket);
+    spStripe->spBucket = spBucket;
+    spStripe->nBuckets = nBuckets;
+}
+
+/******************************************************************************
+ * Function:    UC_Create
+ * Description: Create a cache. The entry and byte limits, either of which
+ *              may be 0 for none, are shared out between the stripes so
+ *              that their shares add up to the limit. A limit smaller than
+ *              the stripe count takes fewer stripes, and an entry bigger
+ *              than the byte share of a stripe cannot be put. Entries put
+ *              without a time to live take the default given here, 0 for
+ *              none. The eviction callback, if given, is called with the
+ *              key, value, UCE_ reason and the callback data whenever an
+ *              entry leaves the cache. It is called with the stripe locked,
+ *              so must not use the cache.
+ * Thread Safe: Yes.
+ * Returns:     NOTNULL   - The new cache.
+ *              NULL      - Failure, see Errno.
+ * <Errno>      E_BADPARM - Bad stripe count.
+ *              E_NOMEM   - Memory exhaustion.
+ ******************************************************************************/
+UX_CACHE *UC_Create( ULNG    lMaxEntries,     /* I: Entry limit, 0 = none */
+                     ULNG    lMaxBytes,       /* I: Byte limit, 0 = none */
+                     ULNG    lTtl,            /* I: Default TTL mS, 0 = none */
+                     UINT    nStripes,        /* I: Stripes, 0 = default */
+                     void    (*fEvict)(UCHAR *, UINT, void *, UINT, UINT, ULNG),
+                                              /* I: Eviction callback */
+                     ULNG    lCBData )        /* I: Data for callback */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    UX_CACHE    *spCache;
+    UC_STRIPE   *spStripe;
+    char        *szFunc = "UC_Create";
+
+    if(nStripes == 0)
+        nStripes = UC_DEFSTRIPES;
+    if(nStripes > UC_MAXSTRIPES || (nStripes & (nStripes - 1)) != 0)
+    {
+        Errno = E_BADPARM;
+        return(NULL);
+    }
+    while(nStripes > 1 && ((lMaxEntries != 0 && lMaxEntries < nStripes) ||
+                           (lMaxBytes != 0 && lMaxBytes < nStripes)))
+    {
+        nStripes >>= 1;
+    }
+
+    if((spCache=(UX_CACHE *)malloc(sizeof(UX_CACHE))) == NULL ||
+       (spCache->spStripe=(UC_STRIPE *)calloc(nStripes, sizeof(UC_STRIPE)))
+                                                                      == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt allocate cache of (%d) stripes",
+            nStripes);
+        if(spCache != NULL)
+            free(spCache);
+        Errno = E_NOMEM;
+        return(NULL);
+    }
+    spCache->nStripes = nStripes;
+    spCache->lTtl = lTtl;
+    spCache->fEvict = fEvict;
+    spCache->lCBData = lCBData;
+
+    /* Each stripe takes its share of the limits, the first few taking one
+     * more of any remainder so that the whole cache keeps to the limit.
+     * There are never more stripes than a limit, so no share is none.
+    */
+    for(nNdx=0; nNdx < nStripes; nNdx++)
+    {
+        spStripe = &spCache->spStripe[nNdx];
+        spStripe->lMaxEntries = lMaxEntries / nStripes +
+                                (nNdx < lMaxEntries % nStripes ? 1 : 0);
+        spStripe->lMaxBytes = lMaxBytes / nStripes +
+                              (nNdx < lMaxBytes % nStripes ? 1 : 0);
+        spStripe->nBuckets = UC_HASHINIT;
+        if((spStripe->spBucket=(UC_ENTRY **)calloc(UC_HASHINIT,
+                                               sizeof(UC_ENTRY *))) == NULL)
+        {
+            Lgr(LOG_DEBUG, szFunc, "Couldnt allocate stripe hash");
+            UC_Destroy(spCache);
+            Errno = E_NOMEM;
+            return(NULL);
+        }
+    }
+
+    /* Return the new cache to caller.
+    */
+    return(spCache);
+}
+
+/******************************************************************************
+ * Function:    UC_Destroy
+ * Description: Empty a cache, through the eviction callback, and release it.
+ * Thread Safe: No, no other thread may be using the cache.
+ * Returns:     R_OK      - Cache released.
+ *              R_FAIL    - Failure, see Errno.
+ * <Errno>      E_BADPARM - Bad cache passed.
+ ******************************************************************************/
+int UC_Destroy( UX_CACHE    *spCache )    /* I: Cache to release */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+
+    if(spCache == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+
+    UC_Purge(spCache);
+    for(nNdx=0; nNdx < spCache->nStripes; nNdx++)
+    {
+        if(spCache->spStripe[nNdx].spBucket != NULL)
+            free(spCache->spStripe[nNdx].spBucket);
+    }
+    free(spCache->spStripe);
+    free(spCache);
+
+    /* Return result code to caller.
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    UC_Get
+ * Description: Look up a key, copying its value into the callers buffer and
+ *              making it the most recently used entry. An entry whose time
+ *              to live has passed is dropped and counts as a miss. A NULL
+ *              or too small buffer just obtains the length of the value,
+ *              which neither counts as a hit nor moves the entry.
+ * Thread Safe: Yes.
+ * Returns:     R_OK      - Value obtained, nValLen holds its length.
+ *              R_FAIL    - Not obtained, see Errno.
+ * <Errno>      E_BADPARM - Bad parameters, or buffer too small in which case
+ *                          nValLen holds the length needed.
+ *              E_NODATA  - Key not in cache.
+ ******************************************************************************/
+int UC_Get( UX_CACHE    *spCache,    /* I: Cache to search */
+            UCHAR       *spKey,      /* I: Key */
+            UINT        nKeyLen,     /* I: Bytes of key */
+            void        *spVal,      /* O: Value, or NULL */
+            UINT        *nValLen )   /* IO: Size of spVal, length of value */
+{
+    /* Local variables.
+    */
+    int         nReturn = R_OK;
+    UINT        nHash;
+    UC_ENTRY    *spEntry;
+    UC_STRIPE   *spStripe;
+
+    if(spCache == NULL || spKey == NULL || nValLen == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    nHash = _UC_Hash(spKey, nKeyLen);
+    spStripe = &spCache->spStripe[(nHash >> 24) & (spCache->nStripes - 1)];
+
+    _UC_Lock(spStripe);
+    if((spEntry=_UC_Find(spStripe, spKey, nKeyLen, nHash)) != NULL &&
+       spEntry->lExpire != 0 && spEntry->lExpire <= _UC_GetTimeMs())
+    {
+        _UC_Drop(spCache, spStripe, spEntry, UCE_EXPIRED);
+        spEntry = NULL;
+    }
+
+    if(spEntry == NULL)
+    {
+        spStripe->sStats.lMisses++;
+        Errno = E_NODATA;
+        nReturn = R_FAIL;
+    } else
+    if(spVal != NULL && *nValLen < spEntry->nValLen)
+    {
+        /* Too small, the caller learns the length but nothing is used.
+        */
+        Errno = E_BADPARM;
+        nReturn = R_FAIL;
+    } else
+    if(spVal != NULL)
+    {
+        /* Hand over the value and move to the front of the LRU list.
+        */
+        spStripe->sStats.lHits++;
+        memcpy(spVal, (UCHAR *)(spEntry + 1) + spEntry->nKeyLen,
+               spEntry->nValLen);
+        if(spEntry->spPrev != NULL)
+        {
+            if((spEntry->spPrev->spNext = spEntry->spNext) == NULL)
+                spStripe->spTail = spEntry->spPrev;
+            else
+                spEntry->spNext->spPrev = spEntry->spPrev;
+            spEntry->spPrev = NULL;
+            spEntry->spNext = spStripe->spHead;
+            spStripe->spHead->spPrev = spEntry;
+            spStripe->spHead = spEntry;
+        }
+    }
+    if(spEntry != NULL)
+        *nValLen = spEntry->nValLen;
+    _UC_Unlock(spStripe);
+
+    /* Return result code to caller.
+    */
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    UC_Put
+ * Description: Add a key and value to a cache, replacing any existing entry
+ *              for the key. Least recently used entries of the stripe are
+ *              evicted until it is back within its limits, and expired
+ *              ones found at the end of the list go with them.
+ * Thread Safe: Yes.
+ * Returns:     R_OK      - Entry added.
+ *              R_FAIL    - Not added, see Errno.
+ * <Errno>      E_BADPARM - Bad parameters, or entry larger than a stripe
+ *                          may hold.
+ *              E_NOMEM   - Memory exhaustion.
+ ******************************************************************************/
+int UC_Put( UX_CACHE    *spCache,    /* I: Cache to add to */
+            UCHAR       *spKey,      /* I: Key */
+            UINT        nKeyLen,     /* I: Bytes of key */
+            void        *spVal,      /* I: Value */
+            UINT        nValLen,     /* I: Bytes of value */
+            ULNG        lTtl )       /* I: TTL in mS, 0 = cache default */
+{
+    /* Local variables.
+    */
+    UINT        nHash;
+    ULNG        lSize;
+    ULNG        lNow;
+    UC_ENTRY    *spEntry;
+    UC_ENTRY    *spOld;
+    UC_STRIPE   *spStripe;
+
+    if(spCache == NULL || spKey == NULL || (spVal == NULL && nValLen != 0))
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    nHash = _UC_Hash(spKey, nKeyLen);
+    spStripe = &spCache->spStripe[(nHash >> 24) & (spCache->nStripes - 1)];
+    lSize = sizeof(UC_ENTRY) + nKeyLen + nValLen;
+    if(spStripe->lMaxBytes != 0 && lSize > spStripe->lMaxBytes)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+
+    /* Build the entry before taking the lock.
+    */
+    if((spEntry=(UC_ENTRY *)malloc(lSize)) == NULL)
+    {
+        Errno = E_NOMEM;
+        return(R_FAIL);
+    }
+    if(lTtl == 0)
+        lTtl = spCache->lTtl;
+    lNow = _UC_GetTimeMs();
+    spEntry->nHash = nHash;
+    spEntry->nKeyLen = nKeyLen;
+    spEntry->nValLen = nValLen;
+    spEntry->lExpire = (lTtl == 0 ? 0 : lNow + lTtl);
+    memcpy((UCHAR *)(spEntry + 1), spKey, nKeyLen);
+    memcpy((UCHAR *)(spEntry + 1) + nKeyLen, spVal, nValLen);
+
+    _UC_Lock(spStripe);
+    if((spOld=_UC_Find(spStripe, spKey, nKeyLen, nHash)) != NULL)
+        _UC_Drop(spCache, spStripe, spOld, UCE_REPLACED);
+
+    /* Make room, least recently used first.
+    */
+    while(spStripe->spTail != NULL &&
+          ((spStripe->lMaxEntries != 0 &&
+            spStripe->sStats.lEntries + 1 > spStripe->lMaxEntries) ||
+           (spStripe->lMaxBytes != 0 &&
+            spStripe->sStats.lBytes + lSize > spStripe->lMaxBytes) ||
+           (spStripe->spTail->lExpire != 0 &&
+            spStripe->spTail->lExpire <= lNow)))
+    {
+        _UC_Drop(spCache, spStripe, spStripe->spTail,
+                 spStripe->spTail->lExpire != 0 &&
+                 spStripe->spTail->lExpire <= lNow ? UCE_EXPIRED : UCE_LIMIT);
+    }
+
+    /* Link in at the front of the LRU list and into the hash.
+    */
+    spEntry->spPrev = NULL;
+    if((spEntry->spNext = spStripe->spHead) == NULL)
+        spStripe->spTail = spEntry;
+    else
+        spStripe->spHead->spPrev = spEntry;
+    spStripe->spHead = spEntry;
+    if(spStripe->sStats.lEntries >= spStripe->nBuckets)
+        _UC_Grow(spStripe);
+    spEntry->spHNext = spStripe->spBucket[nHash & (spStripe->nBuckets - 1)];
+    spStripe->spBucket[nHash & (spStripe->nBuckets - 1)] = spEntry;
+    spStripe->sStats.lEntries++;
+    spStripe->sStats.lBytes += lSize;
+    _UC_Unlock(spStripe);
+
+    /* Return result code to caller.
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    UC_Del
+ * Description: Remove a key from a cache.
+ * Thread Safe: Yes.
+ * Returns:     R_OK      - Entry removed.
+ *              R_FAIL    - Not removed, see Errno.
+ * <Errno>      E_BADPARM - Bad parameters.
+ *              E_NODATA  - Key not in cache.
+ ******************************************************************************/
+int UC_Del( UX_CACHE    *spCache,    /* I: Cache to remove from */
+            UCHAR       *spKey,      /* I: Key */
+            UINT        nKeyLen )    /* I: Bytes of key */
+{
+    /* Local variables.
+    */
+    int         nReturn = R_OK;
+    UINT        nHash;
+    UC_ENTRY    *spEntry;
+    UC_STRIPE   *spStripe;
+
+    if(spCache == NULL || spKey == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    nHash = _UC_Hash(spKey, nKeyLen);
+    spStripe = &spCache->spStripe[(nHash >> 24) & (spCache->nStripes - 1)];
+
+    _UC_Lock(spStripe);
+    if((spEntry=_UC_Find(spStripe, spKey, nKeyLen, nHash)) == NULL)
+    {
+        Errno = E_NODATA;
+        nReturn = R_FAIL;
+    } else
+     {
+        _UC_Drop(spCache, spStripe, spEntry, UCE_DELETED);
+    }
+    _UC_Unlock(spStripe);
+
+    /* Return result code to caller.
+    */
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    UC_Purge
+ * Description: Remove every entry from a cache, stripe by stripe.
+ * Thread Safe: Yes.
+ * Returns:     Non.
+ ******************************************************************************/
+void UC_Purge( UX_CACHE    *spCache )    /* I: Cache to empty */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    UC_STRIPE   *spStripe;
+
+    if(spCache == NULL)
+        return;
+
+    for(nNdx=0; nNdx < spCache->nStripes; nNdx++)
+    {
+        spStripe = &spCache->spStripe[nNdx];
+        _UC_Lock(spStripe);
+        while(spStripe->spTail != NULL)
+            _UC_Drop(spCache, spStripe, spStripe->spTail, UCE_DELETED);
+        _UC_Unlock(spStripe);
+    }
+}
+
+/******************************************************************************
+ * Function:    UC_GetStats
+ * Description: Obtain the counters of a cache, summed over its stripes.
+ * Thread Safe: Yes.
+ * Returns:     R_OK      - Statistics returned.
+ *              R_FAIL    - Bad parameters, see Errno.
+ * <Errno>      E_BADPARM - No cache or buffer given.
+ ******************************************************************************/
+int UC_GetStats( UX_CACHE    *spCache,    /* I: Cache to examine */
+                 UC_STATS    *spStats )   /* O: Statistics */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    UC_STRIPE   *spStripe;
+
+    if(spCache == NULL || spStats == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+
+    memset((UCHAR *)spStats, '\0', sizeof(UC_STATS));
+    for(nNdx=0; nNdx < spCache->nStripes; nNdx++)
+    {
+        spStripe = &spCache->spStripe[nNdx];
+        _UC_Lock(spStripe);
+        spStats->lHits      += spStripe->sStats.lHits;
+        spStats->lMisses    += spStripe->sStats.lMisses;
+        spStats->lEvictions += spStripe->sStats.lEvictions;
+        spStats->lExpired   += spStripe->sStats.lExpired;
+        spStats->lEntries   += spStripe->sStats.lEntries;
+        spStats->lBytes     += spStripe->sStats.lBytes;
+        _UC_Unlock(spStripe);
+    }
+    return(R_OK);
+}
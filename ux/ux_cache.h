@@ -0,0 +1,126 @@
+/******************************************************************************
+ * Product:       #     # #     #         #         ###   ######
+ *                #     #  #   #          #          #    #     #
+ *                #     #   # #           #          #    #     #
+ *                #     #    #            #          #    ######
+ *                #     #   # #           #          #    #     #
+ *                #     #  #   #          #          #    #     #
+ *                 #####  #     # ####### #######   ###   ######
+ *
+ * File:          ux_cache.h
+ * Description:   Header file for the bounded LRU cache, hash lookup over an
+ *                LRU list split into independently locked stripes.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1994-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    UX_CACHE_H
+#define    UX_CACHE_H
+
+/* Cache limits and defaults.
+*/
+#define    UC_DEFSTRIPES     16        /* Stripes when none given */
+#define    UC_MAXSTRIPES     256       /* Stripe index is 8 bits of the hash */
+#define    UC_HASHINIT       16        /* Initial buckets per stripe */
+#define    UC_CACHELINE      64        /* Padding between stripes */
+
+/* Reasons an entry leaves the cache, passed to the eviction callback.
+*/
+#define    UCE_LIMIT         0         /* Evicted to honour a limit */
+#define    UCE_EXPIRED       1         /* Time to live passed */
+#define    UCE_REPLACED      2         /* Overwritten by UC_Put */
+#define    UCE_DELETED       3         /* Removed by UC_Del or UC_Purge */
+
+/* A cache entry, the key then the value follow it in the same allocation.
+*/
+typedef struct ucentry {
+    struct ucentry  *spHNext;          /* Next in hash bucket */
+    struct ucentry  *spPrev;           /* More recently used */
+    struct ucentry  *spNext;           /* Less recently used */
+    UINT            nHash;             /* Hash of key */
+    UINT            nKeyLen;           /* Bytes of key */
+    UINT            nValLen;           /* Bytes of value */
+    ULNG            lExpire;           /* Expiry time in mS, 0 = never */
+} UC_ENTRY;
+
+/* Counters, per stripe and summed over the cache by UC_GetStats.
+*/
+typedef struct {
+    ULNG            lHits;             /* Lookups which found an entry */
+    ULNG            lMisses;           /* Lookups which didnt */
+    ULNG            lEvictions;        /* Entries evicted for a limit */
+    ULNG            lExpired;          /* Entries dropped on expiry */
+    ULNG            lEntries;          /* Entries held */
+    ULNG            lBytes;            /* Bytes held, entries included */
+} UC_STATS;
+
+/* A stripe, a cache in its own right over a share of the key space and of
+ * the limits.
+*/
+typedef struct {
+    int             nLock;             /* Spin lock, non zero when held */
+    UINT            nBuckets;          /* Hash buckets, power of 2 */
+    UC_ENTRY        **spBucket;        /* Hash chains */
+    UC_ENTRY        *spHead;           /* Most recently used */
+    UC_ENTRY        *spTail;           /* Least recently used */
+    ULNG            lMaxEntries;       /* Entry limit, 0 = none */
+    ULNG            lMaxBytes;         /* Byte limit, 0 = none */
+    UC_STATS        sStats;            /* Counters */
+    UCHAR           cPad[UC_CACHELINE];/* Keep stripe locks apart */
+} UC_STRIPE;
+
+/* A cache.
+*/
+typedef struct {
+    UINT            nStripes;          /* Stripes, power of 2 */
+    ULNG            lTtl;              /* Default time to live mS, 0 = none */
+    void            (*fEvict)( UCHAR *, UINT, void *, UINT, UINT, ULNG );
+    ULNG            lCBData;           /* Passed to fEvict */
+    UC_STRIPE       *spStripe;         /* Stripes */
+} UX_CACHE;
+
+/* Prototypes for internal functions.
+*/
+#if defined(UX_CACHE_C)
+ULNG        _UC_GetTimeMs( void );
+UINT        _UC_Hash( UCHAR *, UINT );
+void        _UC_Lock( UC_STRIPE * );
+void        _UC_Unlock( UC_STRIPE * );
+UC_ENTRY    *_UC_Find( UC_STRIPE *, UCHAR *, UINT, UINT );
+void        _UC_Drop( UX_CACHE *, UC_STRIPE *, UC_ENTRY *, UINT );
+void        _UC_Grow( UC_STRIPE * );
+#endif
+
+/* Prototypes for API functions.
+*/
+UX_CACHE    *UC_Create( ULNG, ULNG, ULNG, UINT,
+                        void (*)(UCHAR *, UINT, void *, UINT, UINT, ULNG),
+                        ULNG );
+int         UC_Destroy( UX_CACHE * );
+int         UC_Get( UX_CACHE *, UCHAR *, UINT, void *, UINT * );
+int         UC_Put( UX_CACHE *, UCHAR *, UINT, void *, UINT, ULNG );
+int         UC_Del( UX_CACHE *, UCHAR *, UINT );
+void        UC_Purge( UX_CACHE * );
+int         UC_GetStats( UX_CACHE *, UC_STATS * );
+
+#endif    /* UX_CACHE_H */
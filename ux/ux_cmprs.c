@@ -61,6 +61,11 @@
 #include    <sys/file.h>
 #endif
 
+#if defined(SOLARIS) || defined(LINUX)
+#include    <pthread.h>
+#include    <unistd.h>
+#endif
+
 #if defined(LINUX)
 #include    <term.h>
 #endif
@@ -83,610 +88,2916 @@
 */
 #include    "ux.h"
 
-#define LZSIZE  4096    /* Should stay < 32768 */ 
 #define CLEAR   256     /* Clear Code */
 #define REPEAT  257
 #define START   258
 
-static code Prefix, Prefix0, Index;
-static int code_len, new_entry;        /* For repeated strings */
-static int bits, off, size;
-static code *scode;
-static byte *sbyte;
-static unsigned int pcode, pbyte, length;
-static int nInit = 0;
-static int nNdx;
+/* Hash of the FLZ_MINMATCH bytes at a position, the bytes are assembled
+ * explicitly so that both byte orders hash alike.
+*/
+#define FLZ_HASH(p) ((((UINT)(p)[0] | ((UINT)(p)[1] << 8) | \
+                       ((UINT)(p)[2] << 16) | ((UINT)(p)[3] << 24)) * \
+                      2654435761U) >> (32 - FLZ_HASHBITS))
+
 static unsigned short nEndian = 0xff00;
 static unsigned char *pEndian = (unsigned char *)&nEndian;
-static unsigned char *pC, cTmp;
+static LZW_CTX *spDefCtx = NULL;
+static CMP_DICT *spDicts[CMP_MAXDICT];
 
-code *PTable, *NTable;
-byte *CTable;
+#if defined(CMP_THREADS)
+static CMP_GLOBALS Cmp = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+                           PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER };
+#endif
 
-/******************************************************************************
- * Function:    Compress
- * Description: A generic function to compress a buffer of text. 
- * Returns:     NULL - Memory problems.
- *              Memory buffer containing compressed copy of input.
- ******************************************************************************/
-UCHAR *Compress( UCHAR    *spInBuf,      /* I: Buffer to be compressed. */
-                 UINT     *nLen )        /* IO: Length of dec/compressed buffer. */
+static int FLZStore(LZW_CTX *, byte *, byte *, int);
+static void FLZInsert(LZW_CTX *, byte *, int, int, int);
+static int FLZStreamRoom(LZW_CTX *, UINT);
+static int FLZEncode(LZW_CTX *, byte *, int, int, byte *, int, CMP_DICT *);
+static int FLZDecode(byte *, int, byte *, int, int);
+
+/* Current time in microseconds, for the codec timings in the stats. Kept
+ * here so that compression needs nothing from the comms module.
+*/
+static ULNG CMPGetTimeUs(void)
 {
     /* Local variables.
     */
-    int            nSize;
-    UINT        nInLen = *nLen;
-    UINT        nOutLen = nInLen+10;
-    UCHAR        *spReturn = spInBuf;
-    UCHAR        *spOut;
-    char        *szFunc = "Compress";
-
-    /* If the input buffer is smaller than a given threshold then dont
-     * waste CPU trying to compress it.
-    */
-    if(nInLen < MIN_COMPRESSLEN)
-    {
-        return(spInBuf);
-    }
+#if defined(_WIN32)
+    struct timeb    sTp;
 
-    /* Allocate a buffer to hold the compressed data.
-    */
-    if((spOut=(UCHAR *)malloc(sizeof(USHRT) * nOutLen)) == NULL)
-    {
-        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes", nOutLen);
-        Errno = E_NOMEM;
-        return(NULL);
-    }
+    ftime(&sTp);
+    return((ULNG)sTp.time * 1000000L + (ULNG)sTp.millitm * 1000L);
+#else
+    struct timeval  sTv;
 
-    /* Compress the buffer.
-    */
-    nSize=WLZW(spInBuf, (unsigned short *)&spOut[6], nInLen, nOutLen-4);
+    gettimeofday(&sTv, NULL);
+    return((ULNG)sTv.tv_sec * 1000000L + (ULNG)sTv.tv_usec);
+#endif
+}
 
-    /* Could we compress it?
+/* Does a block look random? Chunks spread over the block are sampled and
+ * the pairs of equal bytes counted, random data has about one pair in 256
+ * where text and rows have one in 20 or so.
+*/
+static int CMPLooksRandom(UCHAR *spBuf, UINT nLen)
+{
+    /* Local variables.
     */
-    if(nSize > 0 && (UINT)nSize < nInLen)
+    UINT    nCount[256];
+    UINT    nChunk;
+    UINT    nChunkLen;
+    UINT    nPos;
+    UINT    nEnd;
+    ULNG    lSample = 0;
+    ULNG    lPairs = 0;
+
+    memset(nCount, 0, sizeof(nCount));
+    nChunkLen = nLen / CMP_SAMPLECHUNKS;
+    if(nChunkLen > CMP_SAMPLECHUNK)
+        nChunkLen = CMP_SAMPLECHUNK;
+    for(nChunk=0; nChunk < CMP_SAMPLECHUNKS; nChunk++)
     {
-        /* OK, add in the compressed id-byte and the original buffer size.
-        */
-        spOut[0] = spOut[1] =0xff;
-        PutCharFromLong( &spOut[2], (ULNG)nInLen );
-        spReturn = spOut;
-        if(nLen != NULL) *nLen = nSize + 6;
+        nPos = nChunk * (nLen / CMP_SAMPLECHUNKS);
+        for(nEnd=nPos+nChunkLen; nPos < nEnd; nPos++, lSample++)
+            lPairs += nCount[spBuf[nPos]]++;
+    }
+    return(lPairs * CMP_RANDOMCOLL < lSample * (lSample - 1) / 2);
+}
 
-/* Debugging code.
+/* Record a test of a class of content, a failure once too many in a row
+ * starting a run of skipped blocks.
 */
-#if defined(UX_DEBUG)
-        printf("Compressed from (%d) to (%d) bytes\n", nInLen, nSize);
-#endif
+static void CMPPolicy(CMP_POLICY *spPolicy, UINT nIn, UINT nOut)
+{
+    spPolicy->nRatio = (spPolicy->nRatio +
+                        (nOut >= nIn ? 256 : (UINT)(((ULNG)nOut << 8) / nIn))) / 2;
+    if(nOut + nIn / CMP_MINGAIN <= nIn)
+    {
+        spPolicy->nMisses = 0;
+        spPolicy->nBackoff = CMP_BACKOFFMIN;
     } else
-     {
-        Lgr(LOG_DEBUG, szFunc, "Couldnt compress data (%d)", nSize);
-        if(nLen != NULL) *nLen = nInLen;
-        free(spOut);
+    if(++spPolicy->nMisses >= CMP_MISSLIMIT)
+    {
+        /* A test after the skip which fails again skips straight away,
+         * for twice as long.
+        */
+        spPolicy->nSkip = spPolicy->nBackoff;
+        if(spPolicy->nBackoff < CMP_BACKOFFMAX)
+            spPolicy->nBackoff <<= 1;
+        spPolicy->nMisses = CMP_MISSLIMIT - 1;
     }
+}
 
-    /* Return buffer or NULL to caller.
+/* Decide whether to try compressing a block, counting it either way.
+*/
+static int CMPTry(LZW_CTX *spCtx, UCHAR *spBuf, UINT nLen)
+{
+    /* Local variables.
     */
-    return(spReturn);
+    CMP_POLICY  *spPolicy = &spCtx->sPolicy[spCtx->nClass];
+
+    spCtx->sStats.lBlocks++;
+    spCtx->sStats.lBytesIn += nLen;
+    if(spCtx->nAdaptive == FALSE || nLen < MIN_COMPRESSLEN)
+        return(TRUE);
+
+    if(spPolicy->nSkip > 0)
+        spPolicy->nSkip--;
+    else
+    if(CMPLooksRandom(spBuf, nLen))
+        CMPPolicy(spPolicy, nLen, nLen);
+    else
+        return(TRUE);
+
+    spCtx->sStats.lSkipped++;
+    spCtx->sStats.lSkipBytes += nLen;
+    return(FALSE);
 }
 
-/******************************************************************************
- * Function:    Decompress
- * Description: A generic function to de-compress a buffer to text. 
- * Returns:     NULL - Memory problems.
- *              Memory buffer containing decompressed copy of input.
- ******************************************************************************/
-UCHAR *Decompress( UCHAR    *spInBuf,         /* I: Buffer to be decompressed. */
-                   UINT     *nCmpLen )        /* IO: Length of comp/dec buffer */
+/* Account for a block which was tried.
+*/
+static void CMPResult(LZW_CTX *spCtx, UINT nIn, UINT nOut, ULNG lStartUs)
+{
+    spCtx->sStats.lTried++;
+    spCtx->sStats.lTriedBytes += nIn;
+    spCtx->sStats.lBytesOut += nOut;
+    spCtx->sStats.lTryUs += CMPGetTimeUs() - lStartUs;
+    if(nOut < nIn)
+        spCtx->sStats.lShrunk++;
+    if(spCtx->nAdaptive == TRUE && nIn >= MIN_COMPRESSLEN)
+        CMPPolicy(&spCtx->sPolicy[spCtx->nClass], nIn, nOut);
+}
+
+/* Compress or expand one block of a batch, with the given context.
+*/
+static int CMPBlock(LZW_CTX *spCtx, CMP_BATCH *spBatch, UINT nBlock)
 {
     /* Local variables.
     */
-    UINT        nSize;
-    UINT        nOutLen;
-    UINT        nShift;
-    UCHAR        *spTmp;
-    UCHAR        *spReturn = spInBuf;
-    char        *szFunc = "Decompress";
-
-    /* Is the input buffer in compressed format..? The first byte should 
-     * contain the value 0xff if its compressed.
+    int     nSize;
+    UINT    nLen;
+    UINT    nPackLen;
+    UCHAR   *spRaw;
+    UCHAR   *spPack;
+
+    spRaw = spBatch->spRaw + nBlock * spBatch->nBlockSize;
+    nLen = spBatch->nRawLen - nBlock * spBatch->nBlockSize;
+    if(nLen > spBatch->nBlockSize)
+        nLen = spBatch->nBlockSize;
+    spPack = spBatch->spPack + spBatch->nBlkOff[nBlock];
+
+    /* A block which doesnt shrink is held as is.
     */
-    if(spInBuf[0] == 0xff && spInBuf[1] == 0xff)
+    if(spBatch->nOp == CMP_PARCOMPRESS)
     {
-        /* Extract the expanded size from the buffer.
-        */
-        nOutLen = GetLongFromChar(&spInBuf[2]);
-
-        /* Allocate a buffer to hold the de-compressed data.
-        */
-        if((spTmp=(UCHAR *)malloc(nOutLen+2)) == NULL)
+        if(spBatch->nCodec == CMP_LZW)
+            nSize=WLZW(spCtx, spRaw, (code *)spPack, (int)nLen, (int)nLen);
+        else
+            nSize=WFLZ(spCtx, spRaw, spPack, (int)nLen, (int)nLen);
+        if(nSize <= 0 || (UINT)nSize >= nLen)
         {
-            Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes", nOutLen);
-            Errno = E_NOMEM;
-            return(NULL);
+            memcpy(spPack, spRaw, nLen);
+            spBatch->nBlkLen[nBlock] = nLen | CMP_PARSTORED;
+        } else
+         {
+            spBatch->nBlkLen[nBlock] = (UINT)nSize;
         }
+        return(R_OK);
+    }
 
-        /* Ensure that the data beings on a LONG boundary as the compression/
-         * Decompression works with integers/shorts.
-        */
-        nShift=(int)((long)(&spInBuf[6]) % sizeof(long));
+    nPackLen = spBatch->nBlkLen[nBlock] & ~CMP_PARSTORED;
+    if(spBatch->nBlkLen[nBlock] & CMP_PARSTORED)
+    {
+        if(nPackLen != nLen)
+            return(R_FAIL);
+        memcpy(spRaw, spPack, nLen);
+        return(R_OK);
+    }
+    if(spBatch->nCodec == CMP_LZW)
+        nSize = RLZW(spCtx, spPack, spRaw, (int)nPackLen, (int)nLen) > 0 ?
+                                                                (int)nLen : -1;
+    else
+        nSize = RFLZ(spPack, spRaw, (int)nPackLen, (int)nLen);
+    return(nSize == (int)nLen ? R_OK : R_FAIL);
+}
 
-        /* Shift the memory block onto a long boundary.
-        */
-        memcpy(&spInBuf[6-nShift], &spInBuf[6], (*nCmpLen)-(6-nShift));
+#if defined(CMP_THREADS)
+/* A worker, taking blocks from the batch posted until the pool stops.
+*/
+static void *CMPWorker(void *pArg)
+{
+    /* Local variables.
+    */
+    LZW_CTX     *spCtx = (LZW_CTX *)pArg;
+    CMP_BATCH   *spBatch;
+    UINT        nBlock;
+    int         nResult;
 
-        /* Decompress data.
-        */
-        if((nSize=RLZW((unsigned short *)&spInBuf[6-nShift], spTmp,
-                        (*nCmpLen)-6, nOutLen)) <= 0)
+    pthread_mutex_lock(&Cmp.sLock);
+    while(Cmp.nStop == FALSE)
+    {
+        spBatch = Cmp.spBatch;
+        if(spBatch == NULL || spBatch->nNext >= spBatch->nBlocks)
         {
-            Lgr(LOG_WARNING,szFunc, "Couldnt Decompress data (%s)",nSize);
-            free(spTmp);
-            return(NULL);
+            pthread_cond_wait(&Cmp.sWork, &Cmp.sLock);
+            continue;
         }
+        nBlock = spBatch->nNext++;
+        pthread_mutex_unlock(&Cmp.sLock);
 
-        /* Terminate string as this may just be a character string.
-        */
-        spTmp[nOutLen] = '\0';
-
-        /* Setup pointer to new buffer containing decompressed data.
-        */
-        spReturn = spTmp;
+        nResult = CMPBlock(spCtx, spBatch, nBlock);
 
-        /* Update the callers length parameter to indicate buffers new
-         * length.
-        */
-        *nCmpLen = nOutLen;
-    } else
-     {
-        /* The buffer is not compressed, terminate it in case its a character
-         * string. No need to update the callers lenght parameter as it
-         * has not changed.
-        */
-        spInBuf[*nCmpLen] = '\0';
+        pthread_mutex_lock(&Cmp.sLock);
+        if(nResult == R_FAIL)
+            spBatch->nFail = TRUE;
+        if(++spBatch->nDone == spBatch->nBlocks)
+            pthread_cond_signal(&Cmp.sDone);
+    }
+    pthread_mutex_unlock(&Cmp.sLock);
+    return(NULL);
+}
 
-/* Debugging code.
+/* Fork handler, holding both pool locks across the fork so that the child
+ * gets them, and the batch they guard, in a consistent state.
 */
-#if defined(UX_DEBUG)
-        printf("Buffer not compressed (%c, %x)\n", spInBuf[0], spInBuf[1]);
-#endif
-    }
+static void CMPPrepare(void)
+{
+    pthread_mutex_lock(&Cmp.sBatchLock);
+    pthread_mutex_lock(&Cmp.sLock);
+}
 
-    /* Return buffer or NULL to caller.
-    */
-    return(spReturn);
+/* Fork handler, the parent carries on as it was.
+*/
+static void CMPParent(void)
+{
+    pthread_mutex_unlock(&Cmp.sLock);
+    pthread_mutex_unlock(&Cmp.sBatchLock);
 }
 
-/*
- * LZW_init - Initialise compression routines.
+/* Fork handler. The child has none of the workers, so the locks and
+ * conditions start afresh and workers of its own start when first needed.
+ * The contexts are idle, as no batch can be posted across the fork, and
+ * are kept for reuse.
 */
-void LZW_init()
+static void CMPChild(void)
 {
-    PTable = (code *) malloc(LZSIZE*sizeof(code));
-    NTable = (code *) malloc(LZSIZE*sizeof(code));
-    CTable = (byte *) malloc(LZSIZE*sizeof(byte));
+    pthread_mutex_init(&Cmp.sBatchLock, NULL);
+    pthread_mutex_init(&Cmp.sLock, NULL);
+    pthread_cond_init(&Cmp.sWork, NULL);
+    pthread_cond_init(&Cmp.sDone, NULL);
+    Cmp.nRunning = 0;
+    Cmp.nStop = FALSE;
+    Cmp.spBatch = NULL;
 }
 
-/* Write Next Code */
-static int WCode(code wcode)
+/* Start the workers of the pool if they are not running, called holding
+ * the batch lock.
+*/
+static int CMPPoolUp(void)
 {
     /* Local variables.
     */
-    int todo;
+    UINT        nWorker;
+
+    if(Cmp.nWorkers == 0)
+        return(R_FAIL);
+    if(Cmp.nRunning > 0)
+        return(R_OK);
+    Cmp.nStop = FALSE;
+    for(nWorker=0; nWorker < Cmp.nWorkers; nWorker++)
+    {
+        if(Cmp.spCtx[nWorker] == NULL &&
+           (Cmp.spCtx[nWorker]=LZW_CreateCtx()) == NULL)
+            break;
+        if(pthread_create(&Cmp.sThread[nWorker], NULL, CMPWorker,
+                          (void *)Cmp.spCtx[nWorker]) != 0)
+            break;
+        Cmp.nRunning++;
+    }
+    if(Cmp.nRunning == 0)
+    {
+        Lgr(LOG_DEBUG, "CMPPoolUp", "Couldnt start compression workers");
+        return(R_FAIL);
+    }
+    return(R_OK);
+}
+#endif
 
-    pcode+=bits;
+/* Have the worker pool process a batch, returning once every block is
+ * done. Fails if there is no pool, the caller must then do the work.
+*/
+static int CMPPoolRun(CMP_BATCH *spBatch)
+{
+#if defined(CMP_THREADS)
+    pthread_mutex_lock(&Cmp.sBatchLock);
+    if(CMPPoolUp() == R_FAIL)
+    {
+        pthread_mutex_unlock(&Cmp.sBatchLock);
+        return(R_FAIL);
+    }
+    pthread_mutex_lock(&Cmp.sLock);
+    Cmp.spBatch = spBatch;
+    pthread_cond_broadcast(&Cmp.sWork);
+    while(spBatch->nDone < spBatch->nBlocks)
+        pthread_cond_wait(&Cmp.sDone, &Cmp.sLock);
+    Cmp.spBatch = NULL;
+    pthread_mutex_unlock(&Cmp.sLock);
+    pthread_mutex_unlock(&Cmp.sBatchLock);
+    return(R_OK);
+#else
+    return(R_FAIL);
+#endif
+}
 
-    /* Quickly check output buffer size for insufficient compression.
+/* Compress a large buffer as a CMP_PAR container of blocks on the worker
+ * pool. Returns the container, the input if it didnt shrink or NULL if
+ * the pool couldnt take it, the caller then compresses it serially.
+*/
+static UCHAR *CMPParCompress(LZW_CTX *spCtx, UCHAR *spInBuf, UINT nInLen,
+                             UINT *nOutLen)
+{
+    /* Local variables.
     */
-    if((pcode>>3) > length)
-        return 0;
+    UINT        nBlock;
+    UINT        nIndexEnd;
+    UINT        nSlot = CMP_PARBLOCK + 16;
+    UINT        nPos;
+    UCHAR       *spOut;
+    CMP_BATCH   sBatch;
+    char        *szFunc = "CMPParCompress";
+
+    memset(&sBatch, 0, sizeof(sBatch));
+    sBatch.nOp = CMP_PARCOMPRESS;
+    sBatch.nCodec = spCtx->nCodec == CMP_LZW ? CMP_LZW : CMP_FLZ;
+    sBatch.nBlockSize = CMP_PARBLOCK;
+    sBatch.nBlocks = (nInLen - 1) / CMP_PARBLOCK + 1;
+    sBatch.spRaw = spInBuf;
+    sBatch.nRawLen = nInLen;
+
+    /* Each block is compressed into a slot of its own, after room for the
+     * header and index, and the blocks closed up once all are done. Slots
+     * start on a code boundary for LZW.
+    */
+    nIndexEnd = CMP_PARHDRLEN + 4 * sBatch.nBlocks;
+    nPos = (nIndexEnd + 1) & ~1;
+    if((spOut=(UCHAR *)malloc(nPos + sBatch.nBlocks * nSlot)) == NULL ||
+       (sBatch.nBlkOff=(UINT *)malloc(2 * sBatch.nBlocks * sizeof(UINT))) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc for (%d) blocks", sBatch.nBlocks);
+        if(spOut != NULL)
+            free(spOut);
+        return(NULL);
+    }
+    sBatch.nBlkLen = sBatch.nBlkOff + sBatch.nBlocks;
+    sBatch.spPack = spOut;
+    for(nBlock=0; nBlock < sBatch.nBlocks; nBlock++)
+        sBatch.nBlkOff[nBlock] = nPos + nBlock * nSlot;
 
-    if((todo = bits+off-16)>=0)
+    if(CMPPoolRun(&sBatch) == R_FAIL)
     {
-        *scode++ |= wcode>>todo;
-        *scode = wcode<<(16-todo);
-        off = todo;
-    } else
-     {
-        *scode |= wcode<<(-todo);
-        off += bits;
+        free(sBatch.nBlkOff);
+        free(spOut);
+        return(NULL);
     }
 
-    /* Finished, get out.
+    /* Build the index and close up the blocks behind it.
     */
-    return(1);
+    for(nBlock=0, nPos=nIndexEnd; nBlock < sBatch.nBlocks; nBlock++)
+    {
+        PutCharFromLong(&spOut[CMP_PARHDRLEN + 4 * nBlock],
+                        (ULNG)sBatch.nBlkLen[nBlock]);
+        memmove(&spOut[nPos], &spOut[sBatch.nBlkOff[nBlock]],
+                sBatch.nBlkLen[nBlock] & ~CMP_PARSTORED);
+        nPos += sBatch.nBlkLen[nBlock] & ~CMP_PARSTORED;
+    }
+    free(sBatch.nBlkOff);
+    if(nPos >= nInLen)
+    {
+        free(spOut);
+        return(spInBuf);
+    }
+    spOut[0] = spOut[1] = CMP_MARKER;
+    spOut[2] = (UCHAR)(CMP_CODECFLAG | CMP_PAR);
+    PutCharFromLong(&spOut[CMP_CODECHDRLEN-4], (ULNG)nInLen);
+    spOut[CMP_CODECHDRLEN] = (UCHAR)sBatch.nCodec;
+    PutCharFromLong(&spOut[CMP_CODECHDRLEN+1], (ULNG)sBatch.nBlockSize);
+    PutCharFromLong(&spOut[CMP_CODECHDRLEN+5], (ULNG)sBatch.nBlocks);
+    *nOutLen = nPos;
+    return(spOut);
 }
 
-/* Read Next Code */
-static short RCode(void)
+/* Expand a CMP_PAR container on the worker pool, or with the callers
+ * context where there is no pool.
+*/
+static int CMPParDecompress(LZW_CTX *spCtx, UCHAR *spInBuf, UINT nInLen,
+                            UCHAR *spOutBuf, UINT nOutLen)
 {
     /* Local variables.
     */
-    code rcode; /* 15 bits maximum, with LZSIZE=32768; never negative */
-    short todo;
+    UINT        nBlock;
+    UINT        nPos;
+    CMP_BATCH   sBatch;
+    char        *szFunc = "CMPParDecompress";
+
+    memset(&sBatch, 0, sizeof(sBatch));
+    if(nInLen < CMP_PARHDRLEN || nOutLen == 0)
+        return(R_FAIL);
+    sBatch.nOp = CMP_PARDECOMPRESS;
+    sBatch.nCodec = spInBuf[CMP_CODECHDRLEN];
+    sBatch.nBlockSize = GetLongFromChar(&spInBuf[CMP_CODECHDRLEN+1]);
+    sBatch.nBlocks = GetLongFromChar(&spInBuf[CMP_CODECHDRLEN+5]);
+    sBatch.spRaw = spOutBuf;
+    sBatch.nRawLen = nOutLen;
+    if(sBatch.nCodec > CMP_FLZ || sBatch.nBlockSize == 0 ||
+       sBatch.nBlocks != (nOutLen - 1) / sBatch.nBlockSize + 1 ||
+       sBatch.nBlocks > (nInLen - CMP_PARHDRLEN) / 4)
+        return(R_FAIL);
+
+    if((sBatch.nBlkOff=(UINT *)malloc(2 * sBatch.nBlocks * sizeof(UINT))) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc for (%d) blocks", sBatch.nBlocks);
+        return(R_FAIL);
+    }
+    sBatch.nBlkLen = sBatch.nBlkOff + sBatch.nBlocks;
+    sBatch.spPack = spInBuf;
 
-    if((todo = bits+off-16)>=0)
+    /* Locate each block from the index, which must account for the input
+     * exactly.
+    */
+    for(nBlock=0, nPos=CMP_PARHDRLEN + 4 * sBatch.nBlocks;
+        nBlock < sBatch.nBlocks; nBlock++)
     {
-        rcode = (*scode++)<<todo;
-        rcode |= (*scode)>>(16-todo);
-        off = todo;
-    } else
-     {
-        rcode = (*scode)>>(-todo);
-        off += bits;
+        sBatch.nBlkLen[nBlock] = GetLongFromChar(&spInBuf[CMP_PARHDRLEN + 4 * nBlock]);
+        sBatch.nBlkOff[nBlock] = nPos;
+        if((sBatch.nBlkLen[nBlock] & ~CMP_PARSTORED) > nInLen - nPos)
+        {
+            free(sBatch.nBlkOff);
+            return(R_FAIL);
+        }
+        nPos += sBatch.nBlkLen[nBlock] & ~CMP_PARSTORED;
+    }
+    if(nPos != nInLen)
+    {
+        free(sBatch.nBlkOff);
+        return(R_FAIL);
     }
 
-    rcode&=size-1;
-    return((short)rcode);
+    if(CMPPoolRun(&sBatch) == R_FAIL)
+    {
+        for(nBlock=0; nBlock < sBatch.nBlocks && sBatch.nFail == FALSE; nBlock++)
+            if(CMPBlock(spCtx, &sBatch, nBlock) == R_FAIL)
+                sBatch.nFail = TRUE;
+    }
+    free(sBatch.nBlkOff);
+    return(sBatch.nFail == TRUE ? R_FAIL : R_OK);
 }
 
-/* Initialization (R/W) */
-static void InitTable(void)
+/******************************************************************************
+ * Function:    LZW_CreateCtx
+ * Description: Create a compression context. A context holds all of the
+ *              state and tables of one compression or decompression, so
+ *              threads each using their own context can run concurrently.
+ *              The tables are part of the context and are reused, not
+ *              reallocated, on every call made with it.
+ * Thread Safe: Yes.
+ * Returns:     NOTNULL  - The new context.
+ *              NULL     - Memory exhaustion, see Errno.
+ * <Errno>      E_NOMEM  - Memory exhaustion.
+ ******************************************************************************/
+LZW_CTX *LZW_CreateCtx( void )
 {
-    bits = 8;
-    size = 256;
-    pbyte = pcode = off = 0;
+    /* Local variables.
+    */
+    LZW_CTX     *spCtx;
+
+    if((spCtx=(LZW_CTX *)malloc(sizeof(LZW_CTX))) == NULL)
+    {
+        Errno = E_NOMEM;
+        return(NULL);
+    }
+    memset((UCHAR *)spCtx, '\0', sizeof(LZW_CTX));
+    return(spCtx);
+}
 
-    memset(PTable, -1, LZSIZE*sizeof(code));
-    Index = START;
+/******************************************************************************
+ * Function:    LZW_FreeCtx
+ * Description: Release a compression context.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     Non.
+ ******************************************************************************/
+void LZW_FreeCtx( LZW_CTX    *spCtx )    /* I: Context to release */
+{
+    if(spCtx == NULL)
+        return;
+    if(spCtx->spStream != NULL)
+        free(spCtx->spStream);
+    if(spCtx->spDictBuf != NULL)
+        free(spCtx->spDictBuf);
+    free(spCtx);
 }
 
-/* Initialization for decompression */
-static void RInitTable(void)
+/* Start the history of a stream with the dictionary of its context, as
+ * the other end does, chaining all of it.
+*/
+static void CMPStreamDict(LZW_CTX *spCtx)
 {
     /* Local variables.
     */
-    int i;
-    byte *p;
+    CMP_DICT    *spDict = spDicts[spCtx->nDict];
 
-    InitTable();
-    for(i = 0, p = CTable; i < CLEAR; i++)
-        *p++ = i;
+    if(spDict == NULL)
+        return;
+    if(FLZStreamRoom(spCtx, spDict->nLen) == R_FAIL)
+    {
+        spCtx->nStreamBad = TRUE;
+        return;
+    }
+    memcpy(spCtx->spStream, spDict->spData, spDict->nLen);
+    FLZInsert(spCtx, spCtx->spStream, 0, (int)spDict->nLen, (int)spDict->nLen);
+    spCtx->nStreamLen = spDict->nLen;
+    spCtx->nStreamNext = spDict->nLen >= FLZ_MINMATCH ?
+                                     spDict->nLen - FLZ_MINMATCH + 1 : 0;
 }
 
-/* Lookup Table */
-static short LookUp(byte Car)
+/******************************************************************************
+ * Function:    LZW_ResetCtx
+ * Description: Forget the history of a stream, as is needed at both ends
+ *              whenever a connection carrying it starts again. The codec
+ *              set for the context is kept, as is its dictionary, which
+ *              starts the new history.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     Non.
+ ******************************************************************************/
+void LZW_ResetCtx( LZW_CTX    *spCtx )    /* IO: Compression context */
 {
-    /* Local variables.
-    */
-    code pi;
+    if(spCtx == NULL)
+        return;
+
+    memset(spCtx->nFHead, 0, sizeof(spCtx->nFHead));
+    spCtx->nFBase = 0;
+    spCtx->nStreamLen = 0;
+    spCtx->nStreamNext = 0;
+    spCtx->nStreamBad = FALSE;
+    if(spCtx->nCodec == CMP_FLZS && spCtx->nDict != 0)
+        CMPStreamDict(spCtx);
+}
 
-    pi = PTable[Prefix];
-    while(((short)pi) != -1)
+/******************************************************************************
+ * Function:    LZW_SetCodec
+ * Description: Select the codec CompressCtx writes with a context. A new
+ *              context writes LZW. Decompression reads any codec whatever
+ *              is set here, as the codec is held in the buffer header,
+ *              except that CMP_FLZS blocks are only read by a context set
+ *              to CMP_FLZS. A stream context holds the history of one
+ *              direction of one connection, so it either compresses or
+ *              decompresses, never both. Setting the codec restarts the
+ *              stream.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     R_OK     - Codec selected.
+ *              R_FAIL   - Unknown codec, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed.
+ ******************************************************************************/
+int LZW_SetCodec( LZW_CTX    *spCtx,     /* IO: Compression context */
+                  UINT       nCodec )    /* I: CMP_LZW, CMP_FLZ or CMP_FLZS */
+{
+    if(spCtx == NULL || nCodec > CMP_MAXCODEC)
     {
-        if(CTable[pi] == Car) return pi;
-        pi = NTable[pi];
+        Errno = E_BADPARM;
+        return(R_FAIL);
     }
+    spCtx->nCodec = nCodec;
+    LZW_ResetCtx(spCtx);
+    return(R_OK);
+}
 
-    /* No hit.
-    */
-    return(-1);
+/******************************************************************************
+ * Function:    CompressBestCodec
+ * Description: Choose the codec to use with a peer from the mask of codecs
+ *              it supports, (1 << codec) for each. The stream codec is
+ *              preferred, then the fastest codec both sides support,
+ *              falling back to LZW which every peer supports. Only callers
+ *              keeping a stream context per connection should offer
+ *              CMP_FLZS.
+ * Thread Safe: Yes.
+ * Returns:     Codec to use.
+ ******************************************************************************/
+UINT CompressBestCodec( UINT    nPeerCodecs )    /* I: Mask of peers codecs */
+{
+    if((nPeerCodecs & CMP_ALLCODECS) & (1 << CMP_FLZS))
+        return(CMP_FLZS);
+    if((nPeerCodecs & CMP_ALLCODECS) & (1 << CMP_FLZ))
+        return(CMP_FLZ);
+    return(CMP_LZW);
 }
 
-/* byte is added to table and becomes prefix */
-static int WAddPrefix(void)
+/******************************************************************************
+ * Function:    LZW_SetAdaptive
+ * Description: Turn on or off the adaptive policy of a context, which
+ *              stops trying to compress content that has not been
+ *              shrinking and tests it again now and then, see CMP_MISSLIMIT.
+ *              Each class of content set by LZW_SetClass is tracked on its
+ *              own. Setting the policy restarts it and the statistics.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     R_OK     - Policy set.
+ *              R_FAIL   - Bad parameter, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed.
+ ******************************************************************************/
+int LZW_SetAdaptive( LZW_CTX    *spCtx,      /* IO: Compression context */
+                     UINT       nAdaptive )  /* I: TRUE to skip, FALSE to always try */
 {
     /* Local variables.
     */
-    code pi;
+    UINT        nClass;
 
-    pi = PTable[Prefix];
-    PTable[Prefix] = Index;        /* Next entry */
-    NTable[Index] = pi;
-    CTable[Index++] = Prefix = Prefix0 = *sbyte;
-
-    /* Table full.
-    */
-    if(Index == LZSIZE)
+    if(spCtx == NULL)
     {
-        if(!WCode(CLEAR)) return 0; 
-        Index = START;
-        memset(PTable, -1, LZSIZE*sizeof(code));
-        bits = 8;
-        size = 256;
-    } else
-    if(Index > size)
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    spCtx->nAdaptive = nAdaptive;
+    memset(spCtx->sPolicy, 0, sizeof(spCtx->sPolicy));
+    for(nClass=0; nClass < CMP_MAXCLASS; nClass++)
+        spCtx->sPolicy[nClass].nBackoff = CMP_BACKOFFMIN;
+    memset(&spCtx->sStats, 0, sizeof(spCtx->sStats));
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    LZW_SetClass
+ * Description: Set the class of content the blocks to come belong to, such
+ *              as a service type, so that the adaptive policy learns about
+ *              each class separately. Classes fold onto CMP_MAXCLASS slots.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     R_OK     - Class set.
+ *              R_FAIL   - Bad parameter, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed.
+ ******************************************************************************/
+int LZW_SetClass( LZW_CTX    *spCtx,     /* IO: Compression context */
+                  UINT       nClass )    /* I: Class of content */
+{
+    if(spCtx == NULL)
     {
-        bits++;
-        size <<= 1;
+        Errno = E_BADPARM;
+        return(R_FAIL);
     }
+    spCtx->nClass = nClass % CMP_MAXCLASS;
+    return(R_OK);
+}
 
-    /* Finished, get out.
-    */
-    return(1);
+/******************************************************************************
+ * Function:    LZW_GetStats
+ * Description: Get the work a context has done and avoided since it was
+ *              created or LZW_SetAdaptive was last called. The time saved is
+ *              estimated from the time taken per byte by the blocks tried.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     Non.
+ ******************************************************************************/
+void LZW_GetStats( LZW_CTX    *spCtx,      /* I: Compression context */
+                   CMP_STATS  *spStats )   /* O: Statistics */
+{
+    *spStats = spCtx->sStats;
+    spStats->lSavedUs = spStats->lTriedBytes == 0 ? 0L :
+                (ULNG)((double)spStats->lSkipBytes * spStats->lTryUs /
+                       spStats->lTriedBytes);
+}
+
+/******************************************************************************
+ * Function:    LZW_SetParallel
+ * Description: Allow CompressCtx to cut buffers of CMP_PARMIN bytes or more
+ *              into blocks compressed in parallel by the worker pool, which
+ *              only peers offering CMP_PAR can read. Such buffers stand
+ *              outside of any stream the context carries. Without a pool
+ *              they are compressed as usual.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     R_OK     - Set.
+ *              R_FAIL   - Bad parameter, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed.
+ ******************************************************************************/
+int LZW_SetParallel( LZW_CTX    *spCtx,      /* IO: Compression context */
+                     UINT       nParallel )  /* I: TRUE to use the pool */
+{
+    if(spCtx == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    spCtx->nParallel = nParallel;
+    return(R_OK);
 }
 
-static int Expand(code val)
+/******************************************************************************
+ * Function:    LZW_StartPool
+ * Description: Set up the pool of worker threads which compresses and
+ *              expands the blocks of large buffers, one worker per online
+ *              processor if none are given. The workers start when first
+ *              needed, in the process which needs them, so a server may
+ *              set up the pool before it forks. Calling it again resizes
+ *              the pool.
+ * Thread Safe: Yes.
+ * Returns:     R_OK     - Pool set up.
+ *              R_FAIL   - No threads on this platform, see Errno.
+ * <Errno>      E_BADPARM- Pool not available.
+ ******************************************************************************/
+int LZW_StartPool( UINT    nWorkers )    /* I: Workers, 0 = one per CPU */
 {
+#if defined(CMP_THREADS)
     /* Local variables.
     */
-    code p,q,r;
+    long        lCpus;
 
-    if(val > Index)
-        return -2;
-    q = -1;
-    PTable[Index] = Prefix;
-    do {
+    if(nWorkers == 0)
+    {
+        lCpus = sysconf(_SC_NPROCESSORS_ONLN);
+        nWorkers = lCpus > 0 ? (UINT)lCpus : 1;
+    }
+    if(nWorkers > CMP_MAXWORKERS)
+        nWorkers = CMP_MAXWORKERS;
+
+    LZW_StopPool();
+    pthread_mutex_lock(&Cmp.sBatchLock);
+    if(Cmp.nForkSet == FALSE)
+    {
+        pthread_atfork(CMPPrepare, CMPParent, CMPChild);
+        Cmp.nForkSet = TRUE;
+    }
+    Cmp.nWorkers = nWorkers;
+    pthread_mutex_unlock(&Cmp.sBatchLock);
+    return(R_OK);
+#else
+    Errno = E_BADPARM;
+    return(R_FAIL);
+#endif
+}
+
+/******************************************************************************
+ * Function:    LZW_StopPool
+ * Description: Stop the worker threads and release their contexts, large
+ *              buffers are compressed serially from then on.
+ * Thread Safe: Yes.
+ * Returns:     Non.
+ ******************************************************************************/
+void LZW_StopPool( void )
+{
+#if defined(CMP_THREADS)
+    /* Local variables.
+    */
+    UINT        nWorker;
+
+    pthread_mutex_lock(&Cmp.sBatchLock);
+    if(Cmp.nRunning > 0)
+    {
+        pthread_mutex_lock(&Cmp.sLock);
+        Cmp.nStop = TRUE;
+        pthread_cond_broadcast(&Cmp.sWork);
+        pthread_mutex_unlock(&Cmp.sLock);
+        for(nWorker=0; nWorker < Cmp.nRunning; nWorker++)
+            pthread_join(Cmp.sThread[nWorker], NULL);
+    }
+    for(nWorker=0; nWorker < CMP_MAXWORKERS; nWorker++)
+    {
+        LZW_FreeCtx(Cmp.spCtx[nWorker]);
+        Cmp.spCtx[nWorker] = NULL;
+    }
+    Cmp.nRunning = 0;
+    Cmp.nWorkers = 0;
+    pthread_mutex_unlock(&Cmp.sBatchLock);
+#endif
+}
+
+/* Check of the content of a dictionary, so that peers holding different
+ * dictionaries under the same id notice rather than garble the data.
+*/
+static UINT CMPDictCheck(UCHAR *spData, UINT nLen)
+{
+    /* Local variables.
+    */
+    UINT        nHash = 2166136261U;
+
+    for(; nLen > 0; nLen--)
+        nHash = (nHash ^ *spData++) * 16777619U;
+    return((nHash ^ (nHash >> 16)) & 0xffff);
+}
+
+/* Make the scratch buffer of a context hold a dictionary followed by room
+ * for a message of len bytes. The dictionary is only copied in when it
+ * isnt already there.
+*/
+static int CMPDictBuf(LZW_CTX *spCtx, CMP_DICT *spDict, UINT nId, UINT len)
+{
+    /* Local variables.
+    */
+    UINT        nSize = spDict->nLen + len;
+    UCHAR       *spNew;
+
+    if(nSize > spCtx->nDictBufSize)
+    {
+        if((spNew=(UCHAR *)realloc(spCtx->spDictBuf, nSize)) == NULL)
+        {
+            Errno = E_NOMEM;
+            return(R_FAIL);
+        }
+        spCtx->spDictBuf = spNew;
+        spCtx->nDictBufSize = nSize;
+    }
+    if(spCtx->nDictBufId != nId || spCtx->nDictBufCheck != spDict->nCheck)
+    {
+        memcpy(spCtx->spDictBuf, spDict->spData, spDict->nLen);
+        spCtx->nDictBufId = nId;
+        spCtx->nDictBufCheck = spDict->nCheck;
+    }
+    return(R_OK);
+}
+
+/* Compress a message against the dictionary of a context. Returns the
+ * new buffer, the message itself if it wouldnt shrink, or NULL.
+*/
+static UCHAR *CMPDictCompress(LZW_CTX *spCtx, UCHAR *spInBuf, UINT *nLen)
+{
+    /* Local variables.
+    */
+    int         nSize;
+    UINT        nInLen = *nLen;
+    ULNG        lStartUs;
+    UCHAR       *spOut;
+    CMP_DICT    *spDict = spDicts[spCtx->nDict];
+    char        *szFunc = "CMPDictCompress";
+
+    if(spDict == NULL)
+        return(spInBuf);
+    if(CMPDictBuf(spCtx, spDict, spCtx->nDict, nInLen) == R_FAIL ||
+       (spOut=(UCHAR *)malloc(nInLen)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes", nInLen);
+        Errno = E_NOMEM;
+        return(NULL);
+    }
+
+    /* The message follows the dictionary and is chained from a base moved
+     * on past every call, as WFLZ does, only the output must beat the
+     * larger header too.
+    */
+    lStartUs = CMPGetTimeUs();
+    memcpy(spCtx->spDictBuf + spDict->nLen, spInBuf, nInLen);
+    if(spCtx->nFBase > ~(UINT)0 - (spDict->nLen + nInLen) - 2)
+    {
+        memset(spCtx->nFHead, 0, sizeof(spCtx->nFHead));
+        spCtx->nFBase = 0;
+    }
+    nSize = FLZEncode(spCtx, spCtx->spDictBuf, (int)spDict->nLen,
+                      (int)(spDict->nLen + nInLen), &spOut[CMP_DICTHDRLEN],
+                      (int)nInLen - CMP_DICTHDRLEN - 1, spDict);
+    spCtx->nFBase += spDict->nLen + nInLen + 1;
+    if(nSize <= 0)
+    {
+        CMPResult(spCtx, nInLen, nInLen, lStartUs);
+        free(spOut);
+        return(spInBuf);
+    }
+
+    spOut[0] = spOut[1] = CMP_MARKER;
+    spOut[2] = (UCHAR)(CMP_CODECFLAG | CMP_FLZD);
+    PutCharFromLong( &spOut[CMP_CODECHDRLEN-4], (ULNG)nInLen );
+    spOut[CMP_CODECHDRLEN] = (UCHAR)spCtx->nDict;
+    spOut[CMP_CODECHDRLEN+1] = (UCHAR)(spDict->nCheck >> 8);
+    spOut[CMP_CODECHDRLEN+2] = (UCHAR)(spDict->nCheck & 0xff);
+    CMPResult(spCtx, nInLen, nSize + CMP_DICTHDRLEN, lStartUs);
+    *nLen = nSize + CMP_DICTHDRLEN;
+    return(spOut);
+}
+
+/* Expand a CMP_FLZD buffer, which needs the dictionary it names loaded
+ * here with the same content. Returns the length expanded or below 0.
+*/
+static int CMPDictDecode(LZW_CTX *spCtx, UCHAR *spInBuf, UINT nInLen,
+                         UCHAR *spOutBuf, UINT nOutLen)
+{
+    /* Local variables.
+    */
+    int         nSize;
+    UINT        nId = spInBuf[CMP_CODECHDRLEN];
+    UINT        nCheck;
+    CMP_DICT    *spDict = spDicts[nId];
+    char        *szFunc = "CMPDictDecode";
+
+    nCheck = (spInBuf[CMP_CODECHDRLEN+1] << 8) | spInBuf[CMP_CODECHDRLEN+2];
+    if(spDict == NULL || spDict->nCheck != nCheck)
+    {
+        Lgr(LOG_WARNING, szFunc, "Dictionary (%d) not loaded or differs",
+            nId);
+        return(-3);
+    }
+    if(CMPDictBuf(spCtx, spDict, nId, nOutLen) == R_FAIL)
+        return(-1);
+
+    nSize = FLZDecode(&spInBuf[CMP_DICTHDRLEN], (int)(nInLen - CMP_DICTHDRLEN),
+                      spCtx->spDictBuf, (int)spDict->nLen,
+                      (int)(spDict->nLen + nOutLen));
+    if(nSize != (int)nOutLen)
+        return(-2);
+    memcpy(spOutBuf, spCtx->spDictBuf + spDict->nLen, nOutLen);
+    return(nSize);
+}
+
+/******************************************************************************
+ * Function:    LZW_LoadDict
+ * Description: Load a shared dictionary under an id from 1 to
+ *              CMP_MAXDICT-1, replacing any loaded under it. Only the last
+ *              CMP_MAXDICTLEN bytes of a longer sample are kept, so the
+ *              content expected most often belongs at the end. Both ends
+ *              of a connection must load the same content under the same
+ *              id, typically the service type, before either uses it.
+ * Thread Safe: No, load dictionaries at startup before contexts use them.
+ * Returns:     R_OK     - Dictionary loaded.
+ *              R_FAIL   - Bad parameter or memory exhaustion, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed.
+ *              E_NOMEM  - Memory exhaustion.
+ ******************************************************************************/
+int LZW_LoadDict( UINT     nId,        /* I: Dictionary id */
+                  UCHAR    *spData,    /* I: Dictionary content */
+                  UINT     nLen )      /* I: Length of content */
+{
+    /* Local variables.
+    */
+    UINT        nPos;
+    UINT        nHash;
+    CMP_DICT    *spDict;
+
+    if(nId == 0 || nId >= CMP_MAXDICT || spData == NULL ||
+       nLen < FLZ_MINMATCH)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    if(nLen > CMP_MAXDICTLEN)
+    {
+        spData += nLen - CMP_MAXDICTLEN;
+        nLen = CMP_MAXDICTLEN;
+    }
+
+    if((spDict=(CMP_DICT *)malloc(sizeof(CMP_DICT))) == NULL ||
+       (spDict->spData=(UCHAR *)malloc(nLen)) == NULL)
+    {
+        if(spDict != NULL)
+            free(spDict);
+        Errno = E_NOMEM;
+        return(R_FAIL);
+    }
+    memcpy(spDict->spData, spData, nLen);
+    spDict->nLen = nLen;
+    spDict->nCheck = CMPDictCheck(spData, nLen);
+
+    /* Chain every position once here rather than per message.
+    */
+    memset(spDict->nDHead, 0, sizeof(spDict->nDHead));
+    for(nPos=0; nPos + FLZ_MINMATCH <= nLen; nPos++)
+    {
+        nHash = FLZ_HASH(spDict->spData + nPos);
+        spDict->nDChain[nPos] = spDict->nDHead[nHash] == 0 ? 0 :
+                        (USHRT)(nPos - (spDict->nDHead[nHash] - 1));
+        spDict->nDHead[nHash] = nPos + 1;
+    }
+
+    LZW_FreeDict(nId);
+    spDicts[nId] = spDict;
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    LZW_LoadDictFile
+ * Description: Load a shared dictionary from a file, such as one written
+ *              by ux_test/cm_dict, see LZW_LoadDict.
+ * Thread Safe: No, load dictionaries at startup before contexts use them.
+ * Returns:     R_OK     - Dictionary loaded.
+ *              R_FAIL   - File unreadable, bad parameter or memory
+ *                         exhaustion, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed or file unreadable.
+ *              E_NOMEM  - Memory exhaustion.
+ ******************************************************************************/
+int LZW_LoadDictFile( UINT     nId,        /* I: Dictionary id */
+                      UCHAR    *szFile )   /* I: File holding the content */
+{
+    /* Local variables.
+    */
+    int         nReturn;
+    long        lLen;
+    UCHAR       *spData;
+    FILE        *fp;
+    char        *szFunc = "LZW_LoadDictFile";
+
+    if((fp=fopen((char *)szFile, "rb")) == NULL)
+    {
+        Lgr(LOG_WARNING, szFunc, "Couldnt open dictionary (%s)", szFile);
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    if(fseek(fp, 0L, SEEK_END) != 0 || (lLen=ftell(fp)) <= 0 ||
+       fseek(fp, 0L, SEEK_SET) != 0)
+    {
+        Lgr(LOG_WARNING, szFunc, "Empty dictionary (%s)", szFile);
+        fclose(fp);
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    if((spData=(UCHAR *)malloc(lLen)) == NULL)
+    {
+        fclose(fp);
+        Errno = E_NOMEM;
+        return(R_FAIL);
+    }
+    if(fread(spData, 1, (size_t)lLen, fp) != (size_t)lLen)
+    {
+        Lgr(LOG_WARNING, szFunc, "Couldnt read dictionary (%s)", szFile);
+        Errno = E_BADPARM;
+        nReturn = R_FAIL;
+    } else
+     {
+        nReturn = LZW_LoadDict(nId, spData, (UINT)lLen);
+    }
+    free(spData);
+    fclose(fp);
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    LZW_FreeDict
+ * Description: Unload the dictionary held under an id, if any.
+ * Thread Safe: No, no context may be using the dictionary.
+ * Returns:     Non.
+ ******************************************************************************/
+void LZW_FreeDict( UINT     nId )        /* I: Dictionary id */
+{
+    if(nId >= CMP_MAXDICT || spDicts[nId] == NULL)
+        return;
+    free(spDicts[nId]->spData);
+    free(spDicts[nId]);
+    spDicts[nId] = NULL;
+}
+
+/******************************************************************************
+ * Function:    LZW_DictCheck
+ * Description: Get the check of the dictionary held under an id, which a
+ *              peer compares with its own before both agree to use it.
+ * Thread Safe: Yes, once dictionaries are loaded.
+ * Returns:     R_OK     - Check stored in nCheck.
+ *              R_FAIL   - No dictionary under the id, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed.
+ ******************************************************************************/
+int LZW_DictCheck( UINT     nId,        /* I: Dictionary id */
+                   UINT     *nCheck )   /* O: Check of its content */
+{
+    if(nId == 0 || nId >= CMP_MAXDICT || spDicts[nId] == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    *nCheck = spDicts[nId]->nCheck;
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    LZW_SetDict
+ * Description: Select the dictionary CompressCtx matches messages against,
+ *              0 for none. Messages from CMP_DICTMINLEN bytes up to a
+ *              window long are written as CMP_FLZD, larger ones with the
+ *              codec of the context. A stream context instead starts its
+ *              history with the dictionary, so setting one restarts the
+ *              stream, and both ends must set the same one.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     R_OK     - Dictionary selected.
+ *              R_FAIL   - Dictionary not loaded, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed.
+ ******************************************************************************/
+int LZW_SetDict( LZW_CTX    *spCtx,     /* IO: Compression context */
+                 UINT       nId )       /* I: Dictionary id, 0 for none */
+{
+    if(spCtx == NULL || nId >= CMP_MAXDICT ||
+       (nId != 0 && spDicts[nId] == NULL))
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    spCtx->nDict = nId;
+    LZW_ResetCtx(spCtx);
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    CompressCtx
+ * Description: A generic function to compress a buffer of text using the
+ *              given context.
+ * Thread Safe: Yes, with a context per thread.
+ * Returns:     NULL - Memory problems.
+ *              Memory buffer containing compressed copy of input.
+ ******************************************************************************/
+UCHAR *CompressCtx( LZW_CTX  *spCtx,       /* IO: Compression context */
+                    UCHAR    *spInBuf,     /* I: Buffer to be compressed. */
+                    UINT     *nLen )       /* IO: Length of dec/compressed buffer. */
+{
+    /* Local variables.
+    */
+    int            nSize;
+    UINT        nHdrLen;
+    UINT        nInLen = *nLen;
+    UINT        nOutLen = nInLen+10;
+    UINT        nTry;
+    ULNG        lStartUs;
+    UCHAR        *spReturn = spInBuf;
+    UCHAR        *spOut;
+    char        *szFunc = "CompressCtx";
+
+    /* Should we bother..? An adaptive context skips content which has not
+     * been shrinking.
+    */
+    nTry = CMPTry(spCtx, spInBuf, nInLen);
+
+    /* A large buffer may be cut into blocks for the worker pool, which
+     * stand outside of any stream. Without a pool it carries on below.
+    */
+    if(spCtx->nParallel == TRUE && nInLen >= CMP_PARMIN && nTry == TRUE)
+    {
+        lStartUs = CMPGetTimeUs();
+        if((spOut=CMPParCompress(spCtx, spInBuf, nInLen, &nOutLen)) != NULL)
+        {
+            if(spOut == spInBuf)
+                nOutLen = nInLen;
+            CMPResult(spCtx, nInLen, nOutLen, lStartUs);
+            if(nLen != NULL) *nLen = nOutLen;
+            return(spOut);
+        }
+        nOutLen = nInLen+10;
+    }
+
+    /* A stream block is always written, however small, as it becomes
+     * part of the history the reader matches against. One the policy
+     * skips is stored as literals.
+    */
+    if(spCtx->nCodec == CMP_FLZS)
+    {
+        nOutLen = FLZS_MAXLEN(nInLen) + CMP_CODECHDRLEN;
+        if((spOut=(UCHAR *)malloc(nOutLen)) == NULL)
+        {
+            Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes", nOutLen);
+            Errno = E_NOMEM;
+            return(NULL);
+        }
+        lStartUs = CMPGetTimeUs();
+        if(nTry == TRUE)
+            nSize=WFLZS(spCtx, spInBuf, &spOut[CMP_CODECHDRLEN], nInLen);
+        else
+            nSize=FLZStore(spCtx, spInBuf, &spOut[CMP_CODECHDRLEN], nInLen);
+        if(nSize <= 0)
+        {
+            Lgr(LOG_DEBUG, szFunc, "Couldnt extend stream (%d)", nInLen);
+            free(spOut);
+            return(NULL);
+        }
+        spOut[0] = spOut[1] = CMP_MARKER;
+        spOut[2] = (UCHAR)(CMP_CODECFLAG | CMP_FLZS);
+        PutCharFromLong( &spOut[CMP_CODECHDRLEN-4], (ULNG)nInLen );
+        if(nTry == TRUE)
+            CMPResult(spCtx, nInLen, nSize + CMP_CODECHDRLEN, lStartUs);
+        if(nLen != NULL) *nLen = nSize + CMP_CODECHDRLEN;
+        return(spOut);
+    }
+
+    /* With a dictionary short messages are worth trying too, those up to
+     * a window long are matched against it.
+    */
+    if(spCtx->nDict != 0 && nInLen >= CMP_DICTMINLEN && nInLen < FLZ_WINDOW &&
+       nTry == TRUE)
+    {
+        return(CMPDictCompress(spCtx, spInBuf, nLen));
+    }
+
+    /* If the input buffer is smaller than a given threshold then dont
+     * waste CPU trying to compress it.
+    */
+    if(nInLen < MIN_COMPRESSLEN || nTry == FALSE)
+    {
+        return(spInBuf);
+    }
+
+    /* Allocate a buffer to hold the compressed data.
+    */
+    if((spOut=(UCHAR *)malloc(sizeof(USHRT) * nOutLen)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes", nOutLen);
+        Errno = E_NOMEM;
+        return(NULL);
+    }
+
+    /* Compress the buffer. LZW keeps its original header so that peers
+     * which know nothing of codecs can still read it.
+    */
+    lStartUs = CMPGetTimeUs();
+    if(spCtx->nCodec == CMP_LZW)
+    {
+        nHdrLen = CMP_HDRLEN;
+        nSize=WLZW(spCtx, spInBuf, (unsigned short *)&spOut[nHdrLen], nInLen,
+                   nOutLen-4);
+    } else
+     {
+        nHdrLen = CMP_CODECHDRLEN;
+        nSize=WFLZ(spCtx, spInBuf, &spOut[nHdrLen], nInLen, nInLen);
+    }
+
+    /* Could we compress it?
+    */
+    if(nSize > 0 && (UINT)nSize < nInLen)
+    {
+        /* OK, add in the compressed id-bytes, the codec if not LZW and the
+         * original buffer size.
+        */
+        spOut[0] = spOut[1] = CMP_MARKER;
+        if(nHdrLen == CMP_CODECHDRLEN)
+            spOut[2] = (UCHAR)(CMP_CODECFLAG | spCtx->nCodec);
+        PutCharFromLong( &spOut[nHdrLen-4], (ULNG)nInLen );
+        spReturn = spOut;
+        if(nLen != NULL) *nLen = nSize + nHdrLen;
+        CMPResult(spCtx, nInLen, nSize + nHdrLen, lStartUs);
+
+/* Debugging code.
+*/
+#if defined(UX_DEBUG)
+        printf("Compressed from (%d) to (%d) bytes\n", nInLen, nSize);
+#endif
+    } else
+     {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt compress data (%d)", nSize);
+        CMPResult(spCtx, nInLen, nInLen, lStartUs);
+        if(nLen != NULL) *nLen = nInLen;
+        free(spOut);
+    }
+
+    /* Return buffer or NULL to caller.
+    */
+    return(spReturn);
+}
+
+/* Examine the header of a buffer. Returns 1 with the codec, header length
+ * and expanded length if its compressed, 0 if its not and -1 if the header
+ * is damaged or names a codec this library doesnt have.
+*/
+static int CMPHeader(UCHAR *spInBuf, UINT nInLen, UINT *nCodec, UINT *nHdrLen,
+                     UINT *nOutLen)
+{
+    /* The first two bytes contain the value 0xff if its compressed.
+    */
+    if(nInLen < 2 || spInBuf[0] != CMP_MARKER || spInBuf[1] != CMP_MARKER)
+        return(0);
+
+    /* A codec byte may follow the marker, without one its LZW.
+    */
+    *nCodec = CMP_LZW;
+    *nHdrLen = CMP_HDRLEN;
+    if(nInLen >= CMP_CODECHDRLEN && (spInBuf[2] & CMP_CODECFLAG))
+    {
+        *nCodec = spInBuf[2] & ~CMP_CODECFLAG;
+        *nHdrLen = CMP_CODECHDRLEN;
+    }
+    if(nInLen < *nHdrLen ||
+       (*nCodec > CMP_MAXCODEC && *nCodec != CMP_PAR && *nCodec != CMP_FLZD))
+        return(-1);
+
+    /* Extract the expanded size from the buffer, a dictionary buffer names
+     * its dictionary after it.
+    */
+    *nOutLen = GetLongFromChar(&spInBuf[*nHdrLen-4]);
+    if(*nCodec == CMP_FLZD)
+        *nHdrLen = CMP_DICTHDRLEN;
+    if(nInLen < *nHdrLen)
+        return(-1);
+    return(1);
+}
+
+/******************************************************************************
+ * Function:    DecompressSize
+ * Description: Probe a buffer for the length it decompresses to, which is
+ *              the size of the buffer DecompressInto needs. Only the header
+ *              is read.
+ * Thread Safe: Yes.
+ * Returns:     R_OK   - Length stored in nOutLen.
+ *              R_FAIL - Damaged header or unknown codec, see Errno.
+ * <Errno>      E_BADPARM
+ ******************************************************************************/
+int DecompressSize( UCHAR    *spInBuf,       /* I: Buffer to be decompressed. */
+                    UINT     nInLen,         /* I: Length of buffer */
+                    UINT     *nOutLen )      /* O: Length decompressed */
+{
+    /* Local variables.
+    */
+    UINT        nCodec;
+    UINT        nHdrLen;
+
+    switch(CMPHeader(spInBuf, nInLen, &nCodec, &nHdrLen, nOutLen))
+    {
+        case 0:
+            *nOutLen = nInLen;
+            break;
+
+        case 1:
+            break;
+
+        default:
+            Errno = E_BADPARM;
+            return(R_FAIL);
+    }
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    DecompressInto
+ * Description: De-compress a buffer into one provided by the caller, such
+ *              as a pooled or arena buffer, allocating nothing but the
+ *              index of a CMP_PAR buffer or the dictionary space of the
+ *              context. The input is only read, at any
+ *              alignment, and a buffer which isnt compressed is copied as
+ *              is. The output is not terminated.
+ *              An output buffer too small is refused before anything is
+ *              read, leaving a stream context able to take the same block
+ *              again, size it with DecompressSize.
+ * Thread Safe: Yes, with a context per thread.
+ * Returns:     R_OK   - Decompressed length stored in nOutLen.
+ *              R_FAIL - Output too small or damaged data, see Errno.
+ * <Errno>      E_BADPARM
+ ******************************************************************************/
+int DecompressInto( LZW_CTX  *spCtx,         /* IO: Compression context */
+                    UCHAR    *spInBuf,       /* I: Buffer to be decompressed. */
+                    UINT     nInLen,         /* I: Length of buffer */
+                    UCHAR    *spOutBuf,      /* O: Decompressed data */
+                    UINT     nOutCap,        /* I: Size of spOutBuf */
+                    UINT     *nOutLen )      /* O: Length decompressed */
+{
+    /* Local variables.
+    */
+    int         nSize;
+    int         nHead;
+    UINT        nCodec = CMP_LZW;
+    UINT        nHdrLen = 0;
+    char        *szFunc = "DecompressInto";
+
+    /* Work out what is in the buffer before touching the output.
+    */
+    nHead = CMPHeader(spInBuf, nInLen, &nCodec, &nHdrLen, nOutLen);
+    if(nHead == 0)
+        *nOutLen = nInLen;
+    if(nHead < 0 || (nHead == 1 && nCodec == CMP_FLZS &&
+                     spCtx->nCodec != CMP_FLZS))
+    {
+        Lgr(LOG_WARNING, szFunc, "Unknown codec (%d) or short buffer (%d)",
+            nCodec, nInLen);
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    if(*nOutLen > nOutCap)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Output buffer (%d) too small for (%d) bytes",
+            nOutCap, *nOutLen);
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+
+    /* A buffer which isnt compressed is simply copied.
+    */
+    if(nHead == 0)
+    {
+        memcpy(spOutBuf, spInBuf, nInLen);
+        return(R_OK);
+    }
+
+    if(nCodec == CMP_LZW)
+    {
+        /* LZW always writes a first byte, and never compresses nothing.
+        */
+        nSize = *nOutLen == 0 ? -2 :
+                RLZW(spCtx, &spInBuf[nHdrLen], spOutBuf, nInLen-nHdrLen,
+                     *nOutLen);
+    } else
+    if(nCodec == CMP_PAR)
+    {
+        /* Blocks compressed in parallel, expanded in parallel too.
+        */
+        nSize = CMPParDecompress(spCtx, spInBuf, nInLen, spOutBuf,
+                                 *nOutLen) == R_OK ? 1 : -2;
+    } else
+    if(nCodec == CMP_FLZD)
+    {
+        /* Matched against a dictionary loaded at both ends.
+        */
+        nSize = CMPDictDecode(spCtx, spInBuf, nInLen, spOutBuf, *nOutLen);
+    } else
+    if(nCodec == CMP_FLZ)
+    {
+        /* The fast codec must produce exactly the recorded length.
+        */
+        nSize=RFLZ(&spInBuf[nHdrLen], spOutBuf, nInLen-nHdrLen, *nOutLen);
+        if(nSize >= 0 && (UINT)nSize != *nOutLen)
+            nSize = -2;
+    } else
+     {
+        /* A stream block may be empty, so only failure counts.
+        */
+        nSize=RFLZS(spCtx, &spInBuf[nHdrLen], spOutBuf, nInLen-nHdrLen,
+                    *nOutLen);
+        if(nSize == 0)
+            nSize = 1;
+    }
+    if(nSize <= 0)
+    {
+        Lgr(LOG_WARNING,szFunc, "Couldnt Decompress data (%d)",nSize);
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+
+    /* Finished, get out!
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    DecompressCtx
+ * Description: A generic function to de-compress a buffer to text using the
+ *              given context. A compressed buffer is expanded into a new
+ *              buffer, one which isnt is returned as is, and either is
+ *              terminated so it may be used as a string.
+ * Thread Safe: Yes, with a context per thread.
+ * Returns:     NULL - Memory problems.
+ *              Memory buffer containing decompressed copy of input.
+ ******************************************************************************/
+UCHAR *DecompressCtx( LZW_CTX  *spCtx,         /* IO: Compression context */
+                      UCHAR    *spInBuf,       /* I: Buffer to be decompressed. */
+                      UINT     *nCmpLen )      /* IO: Length of comp/dec buffer */
+{
+    /* Local variables.
+    */
+    int         nHead;
+    UINT        nCodec = CMP_LZW;
+    UINT        nHdrLen;
+    UINT        nOutLen;
+    UCHAR        *spTmp;
+    char        *szFunc = "DecompressCtx";
+
+    /* Is the input buffer in compressed format..?
+    */
+    if((nHead=CMPHeader(spInBuf, *nCmpLen, &nCodec, &nHdrLen, &nOutLen)) == 0)
+    {
+        /* The buffer is not compressed, terminate it in case its a character
+         * string. No need to update the callers lenght parameter as it
+         * has not changed.
+        */
+        spInBuf[*nCmpLen] = '\0';
+
+/* Debugging code.
+*/
+#if defined(UX_DEBUG)
+        printf("Buffer not compressed (%c, %x)\n", spInBuf[0], spInBuf[1]);
+#endif
+        return(spInBuf);
+    }
+    if(nHead < 0)
+    {
+        Lgr(LOG_WARNING, szFunc, "Unknown codec (%d) or short buffer (%d)",
+            nCodec, *nCmpLen);
+        Errno = E_BADPARM;
+        return(NULL);
+    }
+
+    /* Allocate a buffer to hold the de-compressed data.
+    */
+    if((spTmp=(UCHAR *)malloc(nOutLen+1)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes", nOutLen);
+        if(nCodec == CMP_FLZS)
+            spCtx->nStreamBad = TRUE;
+        Errno = E_NOMEM;
+        return(NULL);
+    }
+    if(DecompressInto(spCtx, spInBuf, *nCmpLen, spTmp, nOutLen,
+                      &nOutLen) == R_FAIL)
+    {
+        free(spTmp);
+        return(NULL);
+    }
+
+    /* Terminate string as this may just be a character string.
+    */
+    spTmp[nOutLen] = '\0';
+
+    /* Update the callers length parameter to indicate buffers new
+     * length.
+    */
+    *nCmpLen = nOutLen;
+    return(spTmp);
+}
+
+/******************************************************************************
+ * Function:    Compress
+ * Description: A generic function to compress a buffer of text with LZW,
+ *              which every peer can read. Uses a context shared by all
+ *              callers, threads must use CompressCtx.
+ * Thread Safe: No.
+ * Returns:     NULL - Memory problems.
+ *              Memory buffer containing compressed copy of input.
+ ******************************************************************************/
+UCHAR *Compress( UCHAR    *spInBuf,      /* I: Buffer to be compressed. */
+                 UINT     *nLen )        /* IO: Length of dec/compressed buffer. */
+{
+    return(CompressCodec(CMP_LZW, spInBuf, nLen));
+}
+
+/******************************************************************************
+ * Function:    Decompress
+ * Description: A generic function to de-compress a buffer to text. Uses a
+ *              context shared by all callers, threads must use DecompressCtx.
+ * Thread Safe: No.
+ * Returns:     NULL - Memory problems.
+ *              Memory buffer containing decompressed copy of input.
+ ******************************************************************************/
+UCHAR *Decompress( UCHAR    *spInBuf,         /* I: Buffer to be decompressed. */
+                   UINT     *nCmpLen )        /* IO: Length of comp/dec buffer */
+{
+    if(spDefCtx == NULL && (spDefCtx=LZW_CreateCtx()) == NULL)
+        return(NULL);
+    return(DecompressCtx(spDefCtx, spInBuf, nCmpLen));
+}
+
+/******************************************************************************
+ * Function:    CompressCodec
+ * Description: Compress a buffer with the given codec, typically the one
+ *              agreed with the peer it is going to. Uses the context shared
+ *              with Compress, threads must use CompressCtx. The stream
+ *              codec needs a context of its own so is refused.
+ * Thread Safe: No.
+ * Returns:     NULL - Memory problems or unknown codec.
+ *              Memory buffer containing compressed copy of input.
+ ******************************************************************************/
+UCHAR *CompressCodec( UINT     nCodec,       /* I: CMP_LZW or CMP_FLZ */
+                      UCHAR    *spInBuf,     /* I: Buffer to be compressed. */
+                      UINT     *nLen )       /* IO: Length of dec/compressed buffer. */
+{
+    if(nCodec == CMP_FLZS)
+    {
+        Errno = E_BADPARM;
+        return(NULL);
+    }
+    if(spDefCtx == NULL && (spDefCtx=LZW_CreateCtx()) == NULL)
+        return(NULL);
+    if(spDefCtx->nCodec != nCodec && LZW_SetCodec(spDefCtx, nCodec) == R_FAIL)
+        return(NULL);
+    return(CompressCtx(spDefCtx, spInBuf, nLen));
+}
+
+/* Write Next Code */
+static int WCode(LZW_CTX *spCtx, code wcode)
+{
+    /* Local variables.
+    */
+    int todo;
+
+    spCtx->pcode+=spCtx->bits;
+
+    /* Quickly check output buffer size for insufficient compression.
+    */
+    if((spCtx->pcode>>3) > spCtx->length)
+        return 0;
+
+    if((todo = spCtx->bits+spCtx->off-16)>=0)
+    {
+        *spCtx->scode++ |= wcode>>todo;
+        *spCtx->scode = wcode<<(16-todo);
+        spCtx->off = todo;
+    } else
+     {
+        *spCtx->scode |= wcode<<(-todo);
+        spCtx->off += spCtx->bits;
+    }
+
+    /* Finished, get out.
+    */
+    return(1);
+}
+
+/* Read Next Word. Codes are packed into big endian words, assembled here a
+ * byte at a time so that the input needs neither alignment nor byte
+ * swapping, and anything past the end of the input reads as zero.
+*/
+static code RWord(LZW_CTX *spCtx, byte *p)
+{
+    if(p+1 < spCtx->rend)
+        return((code)((p[0] << 8) | p[1]));
+    if(p < spCtx->rend)
+        return((code)(p[0] << 8));
+    return(0);
+}
+
+/* Read Next Code */
+static short RCode(LZW_CTX *spCtx)
+{
+    /* Local variables.
+    */
+    code rcode; /* 15 bits maximum, with LZSIZE=32768; never negative */
+    short todo;
+
+    if((todo = spCtx->bits+spCtx->off-16)>=0)
+    {
+        rcode = RWord(spCtx, spCtx->rcode)<<todo;
+        spCtx->rcode += 2;
+        rcode |= RWord(spCtx, spCtx->rcode)>>(16-todo);
+        spCtx->off = todo;
+    } else
+     {
+        rcode = RWord(spCtx, spCtx->rcode)>>(-todo);
+        spCtx->off += spCtx->bits;
+    }
+
+    rcode&=spCtx->size-1;
+    return((short)rcode);
+}
+
+/* Initialization (R/W) */
+static void InitTable(LZW_CTX *spCtx)
+{
+    spCtx->bits = 8;
+    spCtx->size = 256;
+    spCtx->pbyte = spCtx->pcode = spCtx->off = 0;
+
+    memset(spCtx->PTable, -1, LZSIZE*sizeof(code));
+    spCtx->Index = START;
+}
+
+/* Initialization for decompression */
+static void RInitTable(LZW_CTX *spCtx)
+{
+    /* Local variables.
+    */
+    int i;
+    byte *p;
+
+    InitTable(spCtx);
+    for(i = 0, p = spCtx->CTable; i < CLEAR; i++)
+        *p++ = i;
+}
+
+/* Lookup Table */
+static short LookUp(LZW_CTX *spCtx, byte Car)
+{
+    /* Local variables.
+    */
+    code pi;
+
+    pi = spCtx->PTable[spCtx->Prefix];
+    while(((short)pi) != -1)
+    {
+        if(spCtx->CTable[pi] == Car) return pi;
+        pi = spCtx->NTable[pi];
+    }
+
+    /* No hit.
+    */
+    return(-1);
+}
+
+/* byte is added to table and becomes prefix */
+static int WAddPrefix(LZW_CTX *spCtx)
+{
+    /* Local variables.
+    */
+    code pi;
+
+    pi = spCtx->PTable[spCtx->Prefix];
+    spCtx->PTable[spCtx->Prefix] = spCtx->Index;        /* Next entry */
+    spCtx->NTable[spCtx->Index] = pi;
+    spCtx->CTable[spCtx->Index++] = spCtx->Prefix = spCtx->Prefix0 =
+                                                                *spCtx->sbyte;
+
+    /* Table full.
+    */
+    if(spCtx->Index == LZSIZE)
+    {
+        if(!WCode(spCtx, CLEAR)) return 0; 
+        spCtx->Index = START;
+        memset(spCtx->PTable, -1, LZSIZE*sizeof(code));
+        spCtx->bits = 8;
+        spCtx->size = 256;
+    } else
+    if(spCtx->Index > spCtx->size)
+    {
+        spCtx->bits++;
+        spCtx->size <<= 1;
+    }
+
+    /* Finished, get out.
+    */
+    return(1);
+}
+
+static int Expand(LZW_CTX *spCtx, code val)
+{
+    /* Local variables.
+    */
+    code p,q,r;
+
+    if(val > spCtx->Index)
+        return -2;
+
+    /* The writer clears a full table, so only damaged data gets here.
+    */
+    if(spCtx->Index >= LZSIZE)
+        return -3;
+    q = -1;
+    spCtx->PTable[spCtx->Index] = spCtx->Prefix;
+    do {
         p = val;
 
-        /* Get previous
+        /* Get previous
+        */
+        while((p = spCtx->PTable[(r = p)]) != q);
+
+        *spCtx->sbyte++ = spCtx->CTable[r];
+
+        /* Done; skip useless stuff
+        */
+        if(++spCtx->pbyte >= spCtx->length)
+            return 0;
+
+        if(((short)q) == -1 && spCtx->new_entry)
+        {
+            if(spCtx->Index == LZSIZE) return -3;
+            spCtx->CTable[spCtx->Index++] = spCtx->CTable[r];
+            spCtx->new_entry = 0;
+        }
+        q = r;
+    } while(q != val);
+    spCtx->Prefix = val;
+
+    /* Finished, get out.
+    */
+    return(1);
+}
+
+static int check_repeat(LZW_CTX *spCtx, int len)
+{
+    /* Local variables.
+    */
+    int        n = 0;
+    char    *s;
+    char    *s0;
+
+    /* Current string.
+    */
+    s = spCtx->sbyte;
+
+    /* Reference string.
+    */
+    s0 = s - spCtx->code_len;
+
+    while(spCtx->code_len <= len && (n+1) < spCtx->size)
+    {
+        if(memcmp(s0, s, spCtx->code_len))
+            break;
+
+        /* Number of bytes left.
+        */
+        len -= spCtx->code_len;
+
+        /* Number of repeats.
+        */
+        n++;
+        s += spCtx->code_len;
+    }
+
+    /* Finished, get out!
+    */
+    return(n);
+}
+
+/******************************************************************************
+ * Function:    WLZW
+ * Description: Write or compress data in LZW format.
+ * Returns:     0  = Worthless CPU waste (No compression)
+ *              -1 = General error
+ *              -2 = Logical error
+ *              -3 = Expand error
+ *              >0 = OK/total length
+ ******************************************************************************/
+int WLZW( LZW_CTX    *spCtx,     /* IO: Compression context */
+          byte       *si,        /* I: Data for compression */
+          code       *so,        /* O: Compressed data */
+          int        len,        /* I: Length of data for compression */
+          int        maxlen )    /* I: Maximum length of compressed data */
+{
+    /* Local variables.
+    */
+    code    val;
+    int        Repeat;
+    int        nNdx;
+    unsigned char *pC, cTmp;
+
+    spCtx->scode = so;
+    *spCtx->scode = 0;
+    spCtx->sbyte = si;
+    spCtx->length = maxlen;
+    InitTable(spCtx);
+
+    spCtx->Prefix = spCtx->Prefix0 = *spCtx->sbyte;
+    spCtx->code_len = 0;
+    while(++spCtx->pbyte<len)
+    {
+        /* Length of current string.
+        */
+        spCtx->code_len++;
+
+        /* at least 2 bytes.
         */
-        while((p = PTable[(r = p)]) != q);
+        if(*(++spCtx->sbyte) == spCtx->Prefix0 && spCtx->code_len > 1)
+        {
+            /* Check for string repeat. If positive, we are going to write
+             * 3 codes.  Therefore, we need to filter small repeats.
+            */
+            Repeat = check_repeat(spCtx, len-spCtx->pbyte);
+
+            /* Could do better.
+             */
+            if(Repeat > 1)
+            {
+                /* At least 3 times (1+>2).
+                */
+                WCode(spCtx, REPEAT);
+                WCode(spCtx, Repeat);
+                if(!WCode(spCtx, spCtx->Prefix))
+                    return(0);
 
-        *sbyte++ = CTable[r];
+                /* Total length of repeat.
+                */
+                spCtx->pbyte += spCtx->code_len*Repeat;
+                if(spCtx->pbyte >= len)
+                    break;
 
-        /* Done; skip useless stuff
+                /* Position of next byte.
+                */
+                spCtx->sbyte += spCtx->code_len*Repeat;
+            }
+        }
+
+        /* Break in sequence.
         */
-        if(++pbyte >= length)
-            return 0;
+        if(((short)(val=LookUp(spCtx, *spCtx->sbyte)))==-1)
+        {
+            /* Write to buffer.
+            */
+            if(!WCode(spCtx, spCtx->Prefix))
+                return(0);
+
+            /* Car is new prefix.
+            */
+            if(!WAddPrefix(spCtx))
+                return(0);
+            spCtx->code_len = 0;
+        } else
+            spCtx->Prefix = val;
+    }
+
+    if(!WCode(spCtx, spCtx->Prefix))
+        return(0);
+
+    len = spCtx->pcode/sizeof(code)/8;
+    if(spCtx->pcode&(sizeof(code)*8-1))
+        len++;
+    len *= sizeof(code);
+
+    /* Portability issue, will change the code to be insensitive to 
+     * little/big endian eventually.
+    */
+    if(*pEndian == 0x00)
+    {
+        pC = (unsigned char *)so;
+        for(nNdx=0; nNdx < len; nNdx += 2, pC += 2)
+        {
+            cTmp = *pC;
+            *pC = *(pC+1);
+            *(pC+1) = cTmp;
+        }
+    }
+    return(len);
+}
+
+/* CLEAR Code Read */
+static int RClear(LZW_CTX *spCtx)
+{
+    spCtx->bits = 8;
+    spCtx->size = 256;
+    spCtx->Prefix = RCode(spCtx);
+    *spCtx->sbyte++ = spCtx->Prefix;
+    if(++spCtx->pbyte >= spCtx->length)
+        return(0);
+    spCtx->new_entry = 1;
+    spCtx->Index = START;
+    spCtx->bits++;
+    spCtx->size = 512;
+
+    /* Finished, get out!
+    */
+    return(1);
+}
+
+/******************************************************************************
+ * Function:    RLZW
+ * Description: Read or de-compress data from LZW format. The input is read
+ *              a byte at a time, so it may lie at any alignment, and it is
+ *              not altered.
+ * Returns:     0  = Worthless CPU waste (No compression)
+ *              -1 = General error
+ *              -2 = Logical error
+ *              -3 = Expand error
+ *              >0 = OK/total length
+ ******************************************************************************/
+int RLZW( LZW_CTX    *spCtx, /* IO: Compression context */
+          byte       *si,    /* I: Data to be decompressed, left untouched */
+          byte       *so,    /* O: Decompressed data */
+          int        silen,  /* I: Compressed length */
+          int        len )   /* I: Expected length of decompressed data. */
+{
+    /* Local variables.
+    */
+    code    val;
+    int        n;
 
-        if(((short)q) == -1 && new_entry)
+    spCtx->sbyte  = so;
+    spCtx->rcode  = si;
+    spCtx->rend   = si + silen;
+    spCtx->length = len;
+    RInitTable(spCtx);
+
+    RClear(spCtx);
+    for(;;)
+    {
+        val = RCode(spCtx);
+        if(val == CLEAR)
         {
-            if(Index == LZSIZE) return -3;
-            CTable[Index++] = CTable[r];
-            new_entry = 0;
+            if(!RClear(spCtx))
+                break;
+            continue;
         }
-        q = r;
-    } while(q != val);
-    Prefix = val;
 
-    /* Finished, get out.
+        if(val == REPEAT)
+        {
+            /* # of repeats.
+            */
+            len = RCode(spCtx);
+            val = RCode(spCtx);    /* code to expand */
+            do {
+                n = Expand(spCtx, val);
+            } while(--len && n > 0);
+        } else
+         {
+            n = Expand(spCtx, val);
+            if(spCtx->Index >= spCtx->size)
+            {
+                spCtx->bits++;
+                spCtx->size <<= 1;
+            }
+
+            /* Add new entry at next code.
+            */
+            spCtx->new_entry = 1;
+        }
+        if(n < 0)
+            return(n);
+        if(n == 0)
+            break;
+    } 
+
+    /* Finished, get out!
+    */
+    return(1);
+}
+
+/* Position at the head of a hash chain, -1 if empty or left by an
+ * earlier call.
+*/
+#define FLZ_HEAD(c, h) ((c)->nFHead[h] > (c)->nFBase ? \
+                        (int)((c)->nFHead[h] - (c)->nFBase - 1) : -1)
+
+/* Chain entry of a position, indexed by its position in the whole stream
+ * so that entries stay put when a stream slides its history down.
+*/
+#define FLZ_CHAIN(c, p) ((c)->nFChain[((c)->nFBase + (p)) & (FLZ_WINDOW-1)])
+
+/* Put the positions from up to before to on their hash chains, linking
+ * each to the previous head when that is within the window.
+*/
+static void FLZInsert(LZW_CTX *spCtx, byte *si, int from, int to, int len)
+{
+    /* Local variables.
+    */
+    int     ref;
+    UINT    h;
+
+    for(; from < to && from + FLZ_MINMATCH <= len; from++)
+    {
+        h = FLZ_HASH(si + from);
+        ref = FLZ_HEAD(spCtx, h);
+        FLZ_CHAIN(spCtx, from) =
+                (ref >= 0 && from - ref < FLZ_WINDOW) ? (USHRT)(from - ref) : 0;
+        spCtx->nFHead[h] = spCtx->nFBase + from + 1;
+    }
+}
+
+/* Write a length over 15 as a run of 255s and a remainder.
+*/
+static int FLZLength(byte **so, byte *soend, int n)
+{
+    for(; n >= 255; n -= 255)
+    {
+        if(*so >= soend) return 0;
+        *(*so)++ = 255;
+    }
+    if(*so >= soend) return 0;
+    *(*so)++ = (byte)n;
+    return(1);
+}
+
+/* Write one sequence, literals then a match. A zero match length writes
+ * the literals alone, which ends the stream.
+*/
+static int FLZSequence(byte **so, byte *soend, byte *lit, int litlen,
+                       int off, int matchlen)
+{
+    /* Local variables.
+    */
+    byte *token;
+    int  mlen = matchlen ? matchlen - FLZ_MINMATCH : 0;
+
+    if(*so >= soend) return 0;
+    token = (*so)++;
+    *token = (byte)(((litlen < 15 ? litlen : 15) << 4) | (mlen < 15 ? mlen : 15));
+    if(litlen >= 15 && !FLZLength(so, soend, litlen - 15))
+        return 0;
+    if(soend - *so < litlen) return 0;
+    if(litlen != 0)
+        memcpy(*so, lit, litlen);
+    *so += litlen;
+    if(matchlen == 0)
+        return(1);
+
+    if(soend - *so < 2) return 0;
+    *(*so)++ = (byte)(off & 0xff);
+    *(*so)++ = (byte)(off >> 8);
+    if(mlen >= 15 && !FLZLength(so, soend, mlen - 15))
+        return 0;
+    return(1);
+}
+
+/* Compress si from start to len, matching back into anything before start
+ * which is already on the hash chains. With a dictionary, si starts with
+ * its content, chained in the dictionary, and a walk which runs off the
+ * end of the chains of the message carries on along those.
+*/
+static int FLZEncode(LZW_CTX *spCtx, byte *si, int start, int len, byte *so,
+                     int maxlen, CMP_DICT *spDict)
+{
+    /* Local variables.
+    */
+    int     ip = start;
+    int     anchor = start;
+    int     ref;
+    int     indict;
+    UINT    h;
+    int     dist;
+    int     depth;
+    int     mlen;
+    int     bestlen;
+    int     bestoff;
+    byte    *op = so;
+    byte    *opend = so + maxlen;
+
+    while(ip + FLZ_MINMATCH <= len)
+    {
+        /* Put this position at the head of its chain, keeping the head it
+         * replaces as the first candidate.
+        */
+        h = FLZ_HASH(si + ip);
+        ref = FLZ_HEAD(spCtx, h);
+        FLZInsert(spCtx, si, ip, ip + 1, len);
+        indict = FALSE;
+        if(ref < 0 && spDict != NULL)
+        {
+            ref = (int)spDict->nDHead[h] - 1;
+            indict = TRUE;
+        }
+
+        /* Walk back along the chain for the longest match. A chain entry
+         * is only read for positions still held, so stale entries from an
+         * earlier call are never followed.
+        */
+        for(bestlen=0, bestoff=0, depth=0;
+            ref >= 0 && (dist = ip - ref) < FLZ_WINDOW && depth < FLZ_MAXCHAIN;
+            depth++)
+        {
+            if(si[ref] == si[ip] && si[ref+1] == si[ip+1] &&
+               si[ref+2] == si[ip+2] && si[ref+3] == si[ip+3] &&
+               (bestlen == 0 || si[ref+bestlen] == si[ip+bestlen]))
+            {
+                for(mlen=FLZ_MINMATCH;
+                    ip + mlen < len && si[ref + mlen] == si[ip + mlen]; mlen++);
+                if(mlen > bestlen)
+                {
+                    bestlen = mlen;
+                    bestoff = dist;
+                    if(ip + mlen == len || mlen >= FLZ_GOODMATCH)
+                        break;
+                }
+            }
+            if(indict == TRUE)
+            {
+                if(spDict->nDChain[ref] == 0)
+                    break;
+                ref -= spDict->nDChain[ref];
+            } else
+            if(FLZ_CHAIN(spCtx, ref) == 0)
+            {
+                if(spDict == NULL)
+                    break;
+                ref = (int)spDict->nDHead[h] - 1;
+                indict = TRUE;
+            } else
+             {
+                ref -= FLZ_CHAIN(spCtx, ref);
+            }
+        }
+
+        /* No match, step on further the longer the run of literals so
+         * that data which will not compress is crossed quickly.
+        */
+        if(bestlen == 0)
+        {
+            ip += 1 + ((ip - anchor) >> FLZ_SKIPSHIFT);
+            continue;
+        }
+
+        if(!FLZSequence(&op, opend, si + anchor, ip - anchor, bestoff, bestlen))
+            return(0);
+
+        /* Chain the positions covered by the match for later matches.
+        */
+        FLZInsert(spCtx, si, ip + 1, ip + bestlen, len);
+        ip += bestlen;
+        anchor = ip;
+    }
+
+    /* Remaining literals close the stream.
+    */
+    if(!FLZSequence(&op, opend, si + anchor, len - anchor, 0, 0))
+        return(0);
+    return((int)(op - so));
+}
+
+/* Decompress si into so from start, matches may reach back before start
+ * into data already held there.
+*/
+static int FLZDecode(byte *si, int silen, byte *so, int start, int len)
+{
+    /* Local variables.
+    */
+    int     ip = 0;
+    int     op = start;
+    int     n;
+    int     off;
+    int     token;
+
+    while(ip < silen)
+    {
+        /* Literals.
+        */
+        token = si[ip++];
+        if((n = token >> 4) == 15)
+        {
+            do {
+                if(ip >= silen) return(-1);
+                n += si[ip];
+            } while(si[ip++] == 255);
+        }
+        if(n > silen - ip || n > len - op) return(-1);
+        if(n != 0)
+            memcpy(so + op, si + ip, n);
+        ip += n;
+        op += n;
+
+        /* The final sequence has no match.
+        */
+        if(ip == silen)
+            break;
+
+        /* Match, copied a byte at a time as it may overlap itself.
+        */
+        if(silen - ip < 2) return(-1);
+        off = si[ip] | (si[ip+1] << 8);
+        ip += 2;
+        if((n = token & 0x0f) == 15)
+        {
+            do {
+                if(ip >= silen) return(-1);
+                n += si[ip];
+            } while(si[ip++] == 255);
+        }
+        n += FLZ_MINMATCH;
+        if(off == 0 || off > op || n > len - op) return(-1);
+        if(off >= n)
+        {
+            memcpy(so + op, so + op - off, n);
+            op += n;
+        } else
+         {
+            for(; n > 0; n--, op++)
+                so[op] = so[op - off];
+        }
+    }
+    return(op - start);
+}
+
+/* Chain heads count up with a stream, start them again if they would
+ * wrap, losing matches against the history but nothing else.
+*/
+static int FLZStreamBase(LZW_CTX *spCtx)
+{
+    if(spCtx->nFBase > ~(UINT)0 - spCtx->nStreamSize - 2)
+    {
+        memset(spCtx->nFHead, 0, sizeof(spCtx->nFHead));
+        spCtx->nFBase = 0;
+        spCtx->nStreamNext = spCtx->nStreamLen;
+    }
+    return(R_OK);
+}
+
+/* Make room for len more bytes after the history of a stream. The history
+ * slides down to its last window, which is all a match can reach, and the
+ * buffer grows if a block is bigger than the space left.
+*/
+static int FLZStreamRoom(LZW_CTX *spCtx, UINT len)
+{
+    /* Local variables.
+    */
+    UINT    nKeep;
+    UINT    nSize;
+    UCHAR   *spNew;
+
+    if(spCtx->nStreamLen + len <= spCtx->nStreamSize)
+        return(FLZStreamBase(spCtx));
+
+    /* Slide, moving the base on so that chained positions keep their
+     * place and those slid out read as stale.
+    */
+    nKeep = spCtx->nStreamLen < FLZ_WINDOW ? spCtx->nStreamLen : FLZ_WINDOW;
+    if(nKeep < spCtx->nStreamLen)
+    {
+        memmove(spCtx->spStream, spCtx->spStream + spCtx->nStreamLen - nKeep,
+                nKeep);
+        spCtx->nFBase += spCtx->nStreamLen - nKeep;
+        spCtx->nStreamNext -= spCtx->nStreamLen - nKeep;
+        spCtx->nStreamLen = nKeep;
+    }
+
+    if(nKeep + len > spCtx->nStreamSize)
+    {
+        nSize = nKeep + (len > FLZ_STREAMSIZE ? len : FLZ_STREAMSIZE);
+        if((spNew=(UCHAR *)realloc(spCtx->spStream, nSize)) == NULL)
+        {
+            Errno = E_NOMEM;
+            return(R_FAIL);
+        }
+        spCtx->spStream = spNew;
+        spCtx->nStreamSize = nSize;
+    }
+    return(FLZStreamBase(spCtx));
+}
+
+/******************************************************************************
+ * Function:    WFLZS
+ * Description: Write or compress a block continuing the stream of a
+ *              context. The block is appended to the history held in the
+ *              context and matched against it, so blocks too small to
+ *              compress alone still compress when they repeat earlier
+ *              ones. Every block is written, whether it shrinks or not, so
+ *              that the reader keeps the same history.
+ * Returns:     -1 = Memory exhaustion
+ *              >0 = OK/total length
+ ******************************************************************************/
+int WFLZS( LZW_CTX    *spCtx,     /* IO: Compression context */
+           byte       *si,        /* I: Data for compression */
+           byte       *so,        /* O: Compressed data, FLZS_MAXLEN(len) */
+           int        len )       /* I: Length of data for compression */
+{
+    /* Local variables.
+    */
+    int     start;
+    int     nSize;
+
+    if(FLZStreamRoom(spCtx, (UINT)len) == R_FAIL)
+        return(-1);
+
+    /* Append the block and chain the last positions of the history, which
+     * were too near its end to hash before.
+    */
+    start = (int)spCtx->nStreamLen;
+    if(len != 0)
+        memcpy(spCtx->spStream + start, si, len);
+    FLZInsert(spCtx, spCtx->spStream, (int)spCtx->nStreamNext, start,
+              start + len);
+
+    nSize = FLZEncode(spCtx, spCtx->spStream, start, start + len, so,
+                      FLZS_MAXLEN(len), NULL);
+    spCtx->nStreamLen += len;
+    spCtx->nStreamNext = spCtx->nStreamLen >= FLZ_MINMATCH ?
+                                     spCtx->nStreamLen - FLZ_MINMATCH + 1 : 0;
+    return(nSize);
+}
+
+/* Store a block in a stream as literals alone, for content not worth
+ * compressing. The block joins the history but is not chained, so later
+ * blocks cannot match it.
+*/
+static int FLZStore(LZW_CTX *spCtx, byte *si, byte *so, int len)
+{
+    /* Local variables.
+    */
+    byte    *op = so;
+
+    if(FLZStreamRoom(spCtx, (UINT)len) == R_FAIL ||
+       !FLZSequence(&op, so + FLZS_MAXLEN(len), si, len, 0, 0))
+        return(-1);
+    if(len != 0)
+        memcpy(spCtx->spStream + spCtx->nStreamLen, si, len);
+    spCtx->nStreamLen += len;
+    spCtx->nStreamNext = spCtx->nStreamLen >= FLZ_MINMATCH ?
+                                     spCtx->nStreamLen - FLZ_MINMATCH + 1 : 0;
+    return((int)(op - so));
+}
+
+/******************************************************************************
+ * Function:    RFLZS
+ * Description: Read or de-compress a block continuing the stream of a
+ *              context, appending it to the history held there. A block
+ *              which cannot be read leaves the stream unusable until
+ *              LZW_ResetCtx, as later blocks would refer to data missing
+ *              from the history.
+ * Returns:     -1 = Corrupt data, memory exhaustion or unusable stream
+ *              >=0 = OK/decompressed length
+ ******************************************************************************/
+int RFLZS( LZW_CTX    *spCtx,     /* IO: Compression context */
+           byte       *si,        /* I: Data to be decompressed */
+           byte       *so,        /* O: Decompressed data */
+           int        silen,      /* I: Compressed length */
+           int        len )       /* I: Expected length of decompressed data. */
+{
+    /* Local variables.
     */
-    return(1);
+    int     nSize;
+
+    if(spCtx->nStreamBad == TRUE || FLZStreamRoom(spCtx, (UINT)len) == R_FAIL)
+    {
+        spCtx->nStreamBad = TRUE;
+        return(-1);
+    }
+
+    nSize = FLZDecode(si, silen, spCtx->spStream, (int)spCtx->nStreamLen,
+                      (int)spCtx->nStreamLen + len);
+    if(nSize != len)
+    {
+        spCtx->nStreamBad = TRUE;
+        return(-1);
+    }
+    if(len != 0)
+        memcpy(so, spCtx->spStream + spCtx->nStreamLen, len);
+    spCtx->nStreamLen += len;
+    return(nSize);
 }
 
-int check_repeat(int len)
+/******************************************************************************
+ * Function:    WFLZ
+ * Description: Write or compress data in the fast format. The data becomes
+ *              a run of sequences, each a token byte holding the literal
+ *              count and match length, 4 bits each with longer values
+ *              continued in following bytes, the literals, then a 16 bit
+ *              offset back to the match. Matches are found on hash chains
+ *              of the positions in the last 64K.
+ * Returns:     0  = Output would exceed maxlen
+ *              >0 = OK/total length
+ ******************************************************************************/
+int WFLZ( LZW_CTX    *spCtx,     /* IO: Compression context */
+          byte       *si,        /* I: Data for compression */
+          byte       *so,        /* O: Compressed data */
+          int        len,        /* I: Length of data for compression */
+          int        maxlen )    /* I: Maximum length of compressed data */
 {
     /* Local variables.
     */
-    int        n = 0;
-    char    *s;
-    char    *s0;
+    int     nSize;
 
-    /* Current string.
+    /* Heads are stored offset by a base which moves on past every call,
+     * so the heads of earlier calls read as empty without clearing them.
     */
-    s = sbyte;
+    if(spCtx->nFBase > ~(UINT)0 - (UINT)len - 2)
+    {
+        memset(spCtx->nFHead, 0, sizeof(spCtx->nFHead));
+        spCtx->nFBase = 0;
+    }
 
-    /* Reference string.
+    nSize = FLZEncode(spCtx, si, 0, len, so, maxlen, NULL);
+    spCtx->nFBase += len + 1;
+    return(nSize);
+}
+
+/******************************************************************************
+ * Function:    RFLZ
+ * Description: Read or de-compress data from the fast format. Every length
+ *              and offset is checked against the buffers so that damaged
+ *              data cannot run outside them.
+ * Returns:     -1 = Corrupt data
+ *              >=0 = OK/decompressed length
+ ******************************************************************************/
+int RFLZ( byte       *si,    /* I: Data to be decompressed */
+          byte       *so,    /* O: Decompressed data */
+          int        silen,  /* I: Compressed length */
+          int        len )   /* I: Size of decompressed data buffer. */
+{
+    return(FLZDecode(si, silen, so, 0, len));
+}
+
+/* Split the previous row of a context into its fields at a separator.
+*/
+static int ROWSplit(ROW_CTX *spCtx, UCHAR cSep)
+{
+    /* Local variables.
     */
-    s0 = s - code_len;
+    UINT        nPos;
+    UINT        nFields = 1;
+    UINT        *nNew;
 
-    while(code_len <= len && (n+1) < size)
+    for(nPos=0; nPos < spCtx->nPrevLen; nPos++)
     {
-        if(memcmp(s0, s, code_len))
-            break;
-
-        /* Number of bytes left.
-        */
-        len -= code_len;
+        if(spCtx->spPrev[nPos] == cSep)
+            nFields++;
+    }
+    if(nFields > spCtx->nFieldSize)
+    {
+        if((nNew=(UINT *)realloc(spCtx->nField, nFields * sizeof(UINT)))
+                                                                    == NULL)
+        {
+            Errno = E_NOMEM;
+            return(R_FAIL);
+        }
+        spCtx->nField = nNew;
+        spCtx->nFieldSize = nFields;
+    }
 
-        /* Number of repeats.
-        */
-        n++;
-        s += code_len;
+    spCtx->nField[0] = 0;
+    spCtx->nFields = 1;
+    for(nPos=0; nPos < spCtx->nPrevLen; nPos++)
+    {
+        if(spCtx->spPrev[nPos] == cSep)
+            spCtx->nField[spCtx->nFields++] = nPos + 1;
     }
+    spCtx->cSep = cSep;
+    return(R_OK);
+}
 
-    /* Finished, get out!
+/* Keep a row as the one the next is coded against.
+*/
+static int ROWKeep(ROW_CTX *spCtx, UCHAR cSep, UCHAR *spRow, UINT nLen)
+{
+    /* Local variables.
     */
-    return(n);
+    UCHAR       *spNew;
+
+    if(nLen > spCtx->nPrevSize)
+    {
+        if((spNew=(UCHAR *)realloc(spCtx->spPrev, nLen)) == NULL)
+        {
+            Errno = E_NOMEM;
+            return(R_FAIL);
+        }
+        spCtx->spPrev = spNew;
+        spCtx->nPrevSize = nLen;
+    }
+    if(nLen != 0)
+        memcpy(spCtx->spPrev, spRow, nLen);
+    spCtx->nPrevLen = nLen;
+    return(ROWSplit(spCtx, cSep));
 }
 
-/******************************************************************************
- * Function:    WLZW
- * Description: Write or compress data in LZW format.
- * Returns:     0  = Worthless CPU waste (No compression)
- *              -1 = General error
- *              -2 = Logical error
- *              -3 = Expand error
- *              >0 = OK/total length
- ******************************************************************************/
-int WLZW( byte       *si,        /* I: Data for compression */
-          code       *so,        /* O: Compressed data */
-          int        len,        /* I: Length of data for compression */
-          int        maxlen )    /* I: Maximum length of compressed data */
+/* Length of a field of the previous row, less any separator after it.
+*/
+static UINT ROWFieldLen(ROW_CTX *spCtx, UINT nField)
+{
+    if(nField + 1 < spCtx->nFields)
+        return(spCtx->nField[nField+1] - 1 - spCtx->nField[nField]);
+    return(spCtx->nPrevLen - spCtx->nField[nField]);
+}
+
+/* Write an op with its count, and the bytes of a literal, provided they
+ * fit before soend. Returns the next output position or NULL.
+*/
+static UCHAR *ROWOp(UCHAR *so, UCHAR *soend, UINT nOp, UINT n, UCHAR *spLit)
 {
     /* Local variables.
     */
-    code    val;
-    int        Repeat;
+    UINT        nVal = n - 1;
 
-    if(nInit == 0)
+    if(so + 6 + (nOp == ROW_LITERAL ? n : 0) > soend)
+        return(NULL);
+    if(nVal < ROW_OPEXT)
+    {
+        *so++ = (UCHAR)(nOp | nVal);
+    } else
+     {
+        *so++ = (UCHAR)(nOp | ROW_OPEXT);
+        for(nVal -= ROW_OPEXT; nVal >= 0x80; nVal >>= 7)
+            *so++ = (UCHAR)((nVal & 0x7f) | 0x80);
+        *so++ = (UCHAR)nVal;
+    }
+    if(nOp == ROW_LITERAL)
     {
-        LZW_init();
-        nInit = 1;
+        memcpy(so, spLit, n);
+        so += n;
     }
+    return(so);
+}
 
-    scode = so;
-    *scode = 0;
-    sbyte = si;
-    length = maxlen;
-    InitTable();
+/* Read the count of an op. Returns the next input position or NULL if the
+ * count runs off the end.
+*/
+static UCHAR *ROWCount(UCHAR *si, UCHAR *siend, UINT *n)
+{
+    /* Local variables.
+    */
+    UINT        nVal = *si & ROW_OPEXT;
+    UINT        nShift;
 
-    Prefix = Prefix0 = *sbyte;
-    code_len = 0;
-    while(++pbyte<len)
+    si++;
+    if(nVal == ROW_OPEXT)
     {
-        /* Length of current string.
-        */
-        code_len++;
+        for(nShift=0; ; nShift += 7)
+        {
+            if(si >= siend || nShift > 28)
+                return(NULL);
+            nVal += (UINT)(*si & 0x7f) << nShift;
+            if((*si++ & 0x80) == 0)
+                break;
+        }
+    }
+    *n = nVal + 1;
+    return(si);
+}
 
-        /* at least 2 bytes.
+/* Code the fields of a row against the previous row. Returns the length
+ * of the ops or 0 if they wouldnt fit in nMax bytes.
+*/
+static UINT ROWEncode(ROW_CTX *spCtx, UCHAR cSep, UCHAR *si, UINT len,
+                      UCHAR *so, UINT nMax)
+{
+    /* Local variables.
+    */
+    UINT        nPos = 0;
+    UINT        nLit = 0;
+    UINT        nEnd;
+    UINT        nRun;
+    UINT        nField = 0;
+    UINT        nCopy = 0;
+    UINT        nFLen;
+    UCHAR       *spPrev;
+    UCHAR       *sp = so;
+    UCHAR       *soend = so + nMax;
+
+    while(nPos < len)
+    {
+        for(nEnd=nPos; nEnd < len && si[nEnd] != cSep; nEnd++);
+
+        /* A field the same as the one above, separator and all, joins a
+         * run of copied fields.
         */
-        if(*(++sbyte) == Prefix0 && code_len > 1)
+        if(nField < spCtx->nFields)
         {
-            /* Check for string repeat. If positive, we are going to write
-             * 3 codes.  Therefore, we need to filter small repeats.
-            */
-            Repeat = check_repeat(len-pbyte);
-
-            /* Could do better.
-             */
-            if(Repeat > 1)
+            spPrev = spCtx->spPrev + spCtx->nField[nField];
+            nFLen = ROWFieldLen(spCtx, nField);
+            if(nFLen == nEnd - nPos &&
+               (nField + 1 < spCtx->nFields) == (nEnd < len) &&
+               memcmp(spPrev, si + nPos, nFLen) == 0)
             {
-                /* At least 3 times (1+>2).
-                */
-                WCode(REPEAT);
-                WCode(Repeat);
-                if(!WCode(Prefix))
+                if(nPos > nLit &&
+                   (sp=ROWOp(sp, soend, ROW_LITERAL, nPos-nLit, si+nLit)) == NULL)
                     return(0);
-
-                /* Total length of repeat.
-                */
-                pbyte += code_len*Repeat;
-                if(pbyte >= len)
-                    break;
-
-                /* Position of next byte.
-                */
-                sbyte += code_len*Repeat;
+                nCopy++;
+                nField++;
+                nPos = nLit = (nEnd < len ? nEnd + 1 : nEnd);
+                continue;
             }
+        } else
+         {
+            spPrev = NULL;
+            nFLen = 0;
         }
+        if(nCopy > 0 && (sp=ROWOp(sp, soend, ROW_COPY, nCopy, NULL)) == NULL)
+            return(0);
+        nCopy = 0;
 
-        /* Break in sequence.
+        /* Otherwise take what it shares with the start of the field above,
+         * then runs of spaces, leaving the rest as literals.
         */
-        if(((short)(val=LookUp(*sbyte)))==-1)
+        for(nRun=0; nRun < nFLen && nPos + nRun < nEnd &&
+                    spPrev[nRun] == si[nPos+nRun]; nRun++);
+        if(nRun >= ROW_MINRUN)
         {
-            /* Write to buffer.
-            */
-            if(!WCode(Prefix))
+            if(nPos > nLit &&
+               (sp=ROWOp(sp, soend, ROW_LITERAL, nPos-nLit, si+nLit)) == NULL)
                 return(0);
-
-            /* Car is new prefix.
-            */
-            if(!WAddPrefix())
+            if((sp=ROWOp(sp, soend, ROW_PREFIX, nRun, NULL)) == NULL)
                 return(0);
-            code_len = 0;
-        } else
-            Prefix = val;
+            nPos = nLit = nPos + nRun;
+        }
+        while(nPos < nEnd)
+        {
+            for(nRun=0; nPos + nRun < nEnd && si[nPos+nRun] == ' '; nRun++);
+            if(nRun >= ROW_MINRUN)
+            {
+                if(nPos > nLit &&
+                   (sp=ROWOp(sp, soend, ROW_LITERAL, nPos-nLit, si+nLit))
+                                                                    == NULL)
+                    return(0);
+                if((sp=ROWOp(sp, soend, ROW_SPACES, nRun, NULL)) == NULL)
+                    return(0);
+                nPos = nLit = nPos + nRun;
+            } else
+             {
+                nPos += (nRun > 0 ? nRun : 1);
+            }
+        }
+        nField++;
+        nPos = (nEnd < len ? nEnd + 1 : nEnd);
     }
-
-    if(!WCode(Prefix))
+    if(nCopy > 0 && (sp=ROWOp(sp, soend, ROW_COPY, nCopy, NULL)) == NULL)
         return(0);
+    if(nPos > nLit &&
+       (sp=ROWOp(sp, soend, ROW_LITERAL, nPos-nLit, si+nLit)) == NULL)
+        return(0);
+    return((UINT)(sp - so));
+}
 
-    len = pcode/sizeof(code)/8;
-    if(pcode&(sizeof(code)*8-1))
-        len++;
-    len *= sizeof(code);
-
-    /* Portability issue, will change the code to be insensitive to 
-     * little/big endian eventually.
+/******************************************************************************
+ * Function:    ROW_CreateCtx
+ * Description: Create a row encoding context, which holds the previous row
+ *              sent or received in one direction of a connection. Both
+ *              ends start empty and must see the same rows in order.
+ * Thread Safe: Yes.
+ * Returns:     NOTNULL  - The new context.
+ *              NULL     - Memory exhaustion, see Errno.
+ * <Errno>      E_NOMEM  - Memory exhaustion.
+ ******************************************************************************/
+ROW_CTX *ROW_CreateCtx( void )
+{
+    /* Local variables.
     */
-    if(*pEndian == 0x00)
+    ROW_CTX     *spCtx;
+
+    if((spCtx=(ROW_CTX *)malloc(sizeof(ROW_CTX))) == NULL)
     {
-        pC = (unsigned char *)so;
-        for(nNdx=0; nNdx < len; nNdx += 2, pC += 2)
-        {
-            cTmp = *pC;
-            *pC = *(pC+1);
-            *(pC+1) = cTmp;
-        }
+        Errno = E_NOMEM;
+        return(NULL);
     }
-    return(len);
+    memset((UCHAR *)spCtx, '\0', sizeof(ROW_CTX));
+    return(spCtx);
 }
 
-/* CLEAR Code Read */
-static int RClear(void)
+/******************************************************************************
+ * Function:    ROW_FreeCtx
+ * Description: Release a row encoding context.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     Non.
+ ******************************************************************************/
+void ROW_FreeCtx( ROW_CTX    *spCtx )    /* I: Context to release */
 {
-    bits = 8;
-    size = 256;
-    Prefix = RCode();
-    *sbyte++ = Prefix;
-    if(++pbyte >= length)
-        return(0);
-    new_entry = 1;
-    Index = START;
-    bits++;
-    size = 512;
+    if(spCtx == NULL)
+        return;
+    if(spCtx->spPrev != NULL)
+        free(spCtx->spPrev);
+    if(spCtx->nField != NULL)
+        free(spCtx->nField);
+    free(spCtx);
+}
 
-    /* Finished, get out!
-    */
-    return(1);
+/******************************************************************************
+ * Function:    ROW_ResetCtx
+ * Description: Forget the previous row of a context, and any row lost,
+ *              as the other end must do at the same point.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     Non.
+ ******************************************************************************/
+void ROW_ResetCtx( ROW_CTX    *spCtx )    /* IO: Row encoding context */
+{
+    if(spCtx == NULL)
+        return;
+    spCtx->nPrevLen = 0;
+    spCtx->nFields = 0;
+    spCtx->nBad = FALSE;
 }
 
 /******************************************************************************
- * Function:    RLZW
- * Description: Read or de-compress data from LZW format.
- * Returns:     0  = Worthless CPU waste (No compression)
- *              -1 = General error
- *              -2 = Logical error
- *              -3 = Expand error
- *              >0 = OK/total length
+ * Function:    ROW_Encode
+ * Description: Encode a row against the previous row of a context, see
+ *              ROW_COPY, and keep it for the next. The output buffer must
+ *              hold ROW_MAXLEN(nLen) bytes. A row which wouldnt shrink is
+ *              written as one literal. If the row cannot be kept the
+ *              context is unusable until reset, as the other end would no
+ *              longer decode the same rows.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     R_OK     - Row encoded, its length in nOutLen.
+ *              R_FAIL   - Context unusable or memory exhaustion, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed or context unusable.
+ *              E_NOMEM  - Memory exhaustion.
  ******************************************************************************/
-int RLZW( code       *si,    /* I: Data to be decompressed */
-          byte       *so,    /* O: Decompressed data */
-          int        silen,  /* I: Compressed length */
-          int        len )   /* I: Expected length of decompressed data. */
+int ROW_Encode( ROW_CTX    *spCtx,     /* IO: Row encoding context */
+                UCHAR      cSep,       /* I: Field separator */
+                UCHAR      *spRow,     /* I: Row to encode */
+                UINT       nLen,       /* I: Length of row */
+                UCHAR      *spOutBuf,  /* O: Encoded row */
+                UINT       *nOutLen )  /* O: Length of encoded row */
 {
     /* Local variables.
     */
-    code    val;
-    int        n;
+    UINT        nSize = 0;
 
-    /* Portability issue, will change the code to be insensitive to 
-     * little/big endian eventually.
-    */
-    if(*pEndian == 0x00)
+    if(spCtx == NULL || spCtx->nBad == TRUE)
     {
-        pC = (unsigned char *)si;
-        for(nNdx=0; nNdx < silen; nNdx += 2, pC += 2)
-        {
-            cTmp = *pC;
-            *pC = *(pC+1);
-            *(pC+1) = cTmp;
-        }
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    if(spCtx->nFields > 0 && spCtx->cSep != cSep &&
+       ROWSplit(spCtx, cSep) == R_FAIL)
+    {
+        spCtx->nBad = TRUE;
+        return(R_FAIL);
     }
 
-    if(nInit == 0)
+    spOutBuf[0] = cSep;
+    PutCharFromLong( &spOutBuf[1], (ULNG)nLen );
+    if(nLen > 0 &&
+       (nSize=ROWEncode(spCtx, cSep, spRow, nLen, &spOutBuf[ROW_HDRLEN],
+                        nLen)) == 0)
     {
-        LZW_init();
-        nInit = 1;
+        nSize = (UINT)(ROWOp(&spOutBuf[ROW_HDRLEN], &spOutBuf[ROW_MAXLEN(nLen)],
+                             ROW_LITERAL, nLen, spRow) - &spOutBuf[ROW_HDRLEN]);
     }
+    if(ROWKeep(spCtx, cSep, spRow, nLen) == R_FAIL)
+    {
+        spCtx->nBad = TRUE;
+        return(R_FAIL);
+    }
+    *nOutLen = nSize + ROW_HDRLEN;
+    return(R_OK);
+}
 
-    sbyte  = so;
-    scode  = si;
-    length = len;
-    RInitTable();
+/******************************************************************************
+ * Function:    ROW_Size
+ * Description: Get the length of the row an encoded row rebuilds to.
+ * Thread Safe: Yes.
+ * Returns:     R_OK     - Length in nLen.
+ *              R_FAIL   - Not an encoded row, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed.
+ ******************************************************************************/
+int ROW_Size( UCHAR    *spInBuf,     /* I: Encoded row */
+              UINT     nInLen,       /* I: Length of encoded row */
+              UINT     *nLen )       /* O: Length of row */
+{
+    if(spInBuf == NULL || nInLen < ROW_HDRLEN)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    *nLen = (UINT)GetLongFromChar(&spInBuf[1]);
+    return(R_OK);
+}
 
-    RClear();
-    for(;;)
+/******************************************************************************
+ * Function:    ROW_Decode
+ * Description: Rebuild a row encoded by ROW_Encode, against the previous
+ *              row of a context, and keep it for the next. Every op is
+ *              checked against the buffers and the previous row so that
+ *              damaged data cannot run outside them, though after a bad
+ *              row the context is unusable until reset.
+ * Thread Safe: Yes, provided no other thread is using the context.
+ * Returns:     R_OK     - Row rebuilt, its length in nOutLen.
+ *              R_FAIL   - Corrupt data, buffer too small or context
+ *                         unusable, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed or corrupt data.
+ *              E_NOMEM  - Memory exhaustion.
+ ******************************************************************************/
+int ROW_Decode( ROW_CTX    *spCtx,     /* IO: Row encoding context */
+                UCHAR      *spInBuf,   /* I: Encoded row */
+                UINT       nInLen,     /* I: Length of encoded row */
+                UCHAR      *spOutBuf,  /* O: Row */
+                UINT       nOutSize,   /* I: Size of spOutBuf */
+                UINT       *nOutLen )  /* O: Length of row */
+{
+    /* Local variables.
+    */
+    UINT        nLen;
+    UINT        nPos = 0;
+    UINT        nSeps = 0;
+    UINT        nCnt;
+    UINT        nOp;
+    UINT        nFLen;
+    UINT        nNdx;
+    UCHAR       cSep;
+    UCHAR       *si = spInBuf + ROW_HDRLEN;
+    UCHAR       *siend = spInBuf + nInLen;
+
+    if(spCtx == NULL || spCtx->nBad == TRUE ||
+       ROW_Size(spInBuf, nInLen, &nLen) == R_FAIL || nLen > nOutSize)
     {
-        val = RCode();
-        if(val == CLEAR)
-        {
-            if(!RClear())
-                break;
-            continue;
-        }
+        Errno = E_BADPARM;
+        if(spCtx != NULL)
+            spCtx->nBad = TRUE;
+        return(R_FAIL);
+    }
+    cSep = spInBuf[0];
+    if(spCtx->nFields > 0 && spCtx->cSep != cSep &&
+       ROWSplit(spCtx, cSep) == R_FAIL)
+    {
+        spCtx->nBad = TRUE;
+        return(R_FAIL);
+    }
 
-        if(val == REPEAT)
+    /* The field an op refers to is the one being rebuilt, which is the
+     * count of separators so far.
+    */
+    while(si < siend)
+    {
+        nOp = *si & ROW_OPMASK;
+        if((si=ROWCount(si, siend, &nCnt)) == NULL ||
+           (nOp != ROW_COPY && nCnt > nLen - nPos))
+            break;
+        if(nOp == ROW_COPY)
         {
-            /* # of repeats.
+            /* Fields come with their separator, the last has none and
+             * ends the row.
             */
-            len = RCode();
-            val = RCode();    /* code to expand */
-            do {
-                n = Expand(val);
-            } while(--len && n > 0);
+            for(; nCnt > 0; nCnt--)
+            {
+                if(nSeps >= spCtx->nFields)
+                    break;
+                nFLen = ROWFieldLen(spCtx, nSeps);
+                if(nSeps + 1 < spCtx->nFields)
+                    nFLen++;
+                if(nFLen > nLen - nPos)
+                    break;
+                memcpy(&spOutBuf[nPos], spCtx->spPrev + spCtx->nField[nSeps],
+                       nFLen);
+                nPos += nFLen;
+                if(nSeps + 1 < spCtx->nFields)
+                    nSeps++;
+                else if(nCnt > 1)
+                    break;
+            }
+            if(nCnt > 0)
+                break;
         } else
-         {
-            n = Expand(val);
-            if(Index >= size)
+        if(nOp == ROW_PREFIX)
+        {
+            if(nSeps >= spCtx->nFields || nCnt > ROWFieldLen(spCtx, nSeps))
+                break;
+            memcpy(&spOutBuf[nPos], spCtx->spPrev + spCtx->nField[nSeps],
+                   nCnt);
+            nPos += nCnt;
+        } else
+        if(nOp == ROW_LITERAL)
+        {
+            if(nCnt > (UINT)(siend - si))
+                break;
+            for(nNdx=0; nNdx < nCnt; nNdx++)
             {
-                bits++;
-                size <<= 1;
+                if(si[nNdx] == cSep)
+                    nSeps++;
             }
-
-            /* Add new entry at next code.
-            */
-            new_entry = 1;
+            memcpy(&spOutBuf[nPos], si, nCnt);
+            si += nCnt;
+            nPos += nCnt;
+        } else
+         {
+            memset(&spOutBuf[nPos], ' ', nCnt);
+            nPos += nCnt;
         }
-        if(n < 0)
-            return(n);
-        if(n == 0)
-            break;
-    } 
+    }
+    if(si != siend || nPos != nLen)
+    {
+        Errno = E_BADPARM;
+        spCtx->nBad = TRUE;
+        return(R_FAIL);
+    }
 
-    /* Finished, get out!
-    */
-    return(1);
+    if(ROWKeep(spCtx, cSep, spOutBuf, nLen) == R_FAIL)
+    {
+        spCtx->nBad = TRUE;
+        return(R_FAIL);
+    }
+    *nOutLen = nLen;
+    return(R_OK);
 }
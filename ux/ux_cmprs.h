@@ -41,9 +41,279 @@
 typedef unsigned short code;
 typedef unsigned char byte;
 
+/* Size of the LZW tables.
+*/
+#define LZSIZE  4096    /* Should stay < 32768 */ 
+
+/* Compressed buffer header. A compressed buffer starts with two
+ * CMP_MARKER bytes. LZW buffers follow them with the original length, as
+ * they always have, other codecs put a codec byte with CMP_CODECFLAG set
+ * ahead of the length. No real length has that bit set in its top byte.
+*/
+#define CMP_MARKER      0xff
+#define CMP_CODECFLAG   0x80
+#define CMP_HDRLEN      6       /* Header of an LZW buffer */
+#define CMP_CODECHDRLEN 7       /* Header of a buffer with a codec byte */
+
+/* Codecs, and the mask of those this library can read and write, which
+ * peers exchange to agree on the codec they use. CMP_PAR is a container
+ * of blocks in one of the other codecs rather than a codec a context is
+ * set to, a peer offering it can be sent large buffers compressed in
+ * parallel, see LZW_SetParallel. CMP_ROWS is no codec either, a peer
+ * offering it can rebuild rows sent encoded by ROW_Encode.
+*/
+#define CMP_LZW         0       /* 12 bit LZW, best ratio, slow */
+#define CMP_FLZ         1       /* Byte aligned LZ77, fast */
+#define CMP_FLZS        2       /* CMP_FLZ continuing a per connection stream */
+#define CMP_MAXCODEC    CMP_FLZS
+#define CMP_PAR         3       /* Independent blocks, compressed in parallel */
+#define CMP_FLZD        4       /* CMP_FLZ matching a shared dictionary */
+#define CMP_ROWS        5       /* Rows coded against the row before */
+#define CMP_ALLCODECS   ((1 << CMP_LZW) | (1 << CMP_FLZ) | (1 << CMP_FLZS) | \
+                         (1 << CMP_PAR) | (1 << CMP_FLZD) | (1 << CMP_ROWS))
+
+/* Block parallel compression. A buffer of CMP_PARMIN bytes or more given to
+ * a parallel context is cut into CMP_PARBLOCK blocks which the worker pool
+ * compresses independently. The CMP_PAR buffer holds the usual header with
+ * the expanded length, the codec of the blocks, the block size, the block
+ * count, an index of the compressed length of each block and then the
+ * blocks, those which didnt shrink held as is with CMP_PARSTORED set in
+ * their length. With the index the reader can expand the blocks in
+ * parallel as well. Worker threads are POSIX threads, so the pool exists
+ * only where they do.
+*/
+#define CMP_PARMIN      (1024 * 1024)   /* Smaller buffers stay serial */
+#define CMP_PARBLOCK    (256 * 1024)    /* Bytes in each block */
+#define CMP_PARHDRLEN   (CMP_CODECHDRLEN + 9) /* Header ahead of the index */
+#define CMP_PARSTORED   0x80000000      /* Block held uncompressed */
+#define CMP_MAXWORKERS  64              /* Largest worker pool */
+
+#if defined(SOLARIS) || defined(LINUX)
+#define CMP_THREADS
+#endif
+
+/* Fast codec parameters. Offsets are 16 bit so the window is 64K.
+*/
+#define FLZ_HASHBITS    14      /* Bits of hash chain heads */
+#define FLZ_WINDOW      65536   /* Positions kept on the hash chains */
+#define FLZ_MINMATCH    4       /* Shortest match coded */
+#define FLZ_MAXCHAIN    4       /* Candidates tried for each position */
+#define FLZ_GOODMATCH   32      /* Match long enough to stop looking */
+#define FLZ_SKIPSHIFT   6       /* Literal run doubling the search step */
+#define FLZ_STREAMSIZE  (2 * FLZ_WINDOW) /* Stream history buffer growth */
+
+/* Shared dictionaries. A dictionary is a sample of the content expected,
+ * loaded at both ends under the same id, typically the service type, and
+ * matched against as though it came before every message, so that even
+ * short messages shrink. A CMP_FLZD buffer follows the codec header with
+ * the id and a 16 bit check of the dictionary content, a stream context
+ * given a dictionary starts its history with it instead. ux_test/cm_dict
+ * builds them from captured traffic.
+*/
+#define CMP_MAXDICT     256     /* Dictionary ids, 0 is none */
+#define CMP_MAXDICTLEN  (FLZ_WINDOW / 2) /* Largest dictionary */
+#define CMP_DICTHDRLEN  (CMP_CODECHDRLEN + 3) /* Header of a CMP_FLZD buffer */
+#define CMP_DICTMINLEN  16      /* Shortest message tried with a dictionary */
+
+/* Row encoding. Text result rows are padded with spaces to the width of
+ * each column, so much of a row is padding and much of the rest repeats
+ * the row before. ROW_Encode splits a row into fields at a separator and
+ * codes each against the same field of the previous row as ops, the top
+ * two bits of an op giving its kind and the rest a count less one, with
+ * ROW_OPEXT continuing the count 7 bits a byte in the bytes after. An
+ * encoded row starts with the separator and the length of the row, a
+ * row which wouldnt shrink is sent as a single literal.
+*/
+#define ROW_COPY        0x00    /* Whole fields as in the previous row */
+#define ROW_PREFIX      0x40    /* Bytes from the start of the field above */
+#define ROW_LITERAL     0x80    /* Bytes following the op */
+#define ROW_SPACES      0xc0    /* Run of spaces */
+#define ROW_OPMASK      0xc0    /* Kind of op */
+#define ROW_OPEXT       0x3f    /* Count continues in following bytes */
+#define ROW_MINRUN      3       /* Shortest prefix or run of spaces coded */
+#define ROW_HDRLEN      5       /* Separator and row length */
+#define ROW_MAXLEN(n)   ((n) + ROW_HDRLEN + 6) /* Largest encoded row */
+
+/* Largest output of WFLZS, a block of literals alone.
+*/
+#define FLZS_MAXLEN(n)  ((n) + (n) / 255 + 16)
+
+/* Adaptive policy. An adaptive context stops trying to compress a class of
+ * content once CMP_MISSLIMIT blocks in a row fail to save 1/CMP_MINGAIN of
+ * their size, passing blocks on as they are, and tests again after a
+ * backoff which doubles for as long as the content stays incompressible.
+ * A block whose sampled bytes collide less than 1 in CMP_RANDOMCOLL times
+ * looks random and counts as a failure without being tried.
+*/
+#define CMP_MAXCLASS    32      /* Content classes, others fold onto these */
+#define CMP_MISSLIMIT   3       /* Failures in a row before skipping */
+#define CMP_MINGAIN     32      /* A block must save 1/32 to count */
+#define CMP_BACKOFFMIN  8       /* Blocks skipped after the first failures */
+#define CMP_BACKOFFMAX  256     /* Most blocks skipped between tests */
+#define CMP_SAMPLECHUNK 64      /* Bytes in each chunk of the sample */
+#define CMP_SAMPLECHUNKS 8      /* Chunks sampled, spread over a block */
+#define CMP_RANDOMCOLL  128     /* Collision rate of random looking data */
+
+/* Policy state of one class of content in a context.
+*/
+typedef struct {
+    UINT            nMisses;               /* Failures in a row */
+    UINT            nSkip;                 /* Blocks to pass before testing */
+    UINT            nBackoff;              /* Blocks to skip after next fail */
+    UINT            nRatio;                /* Recent out/in in 1/256ths */
+} CMP_POLICY;
+
+/* Work done and avoided by a context, see LZW_GetStats.
+*/
+typedef struct {
+    ULNG            lBlocks;               /* Blocks offered */
+    ULNG            lBytesIn;              /* Bytes offered */
+    ULNG            lTried;                /* Blocks compression was tried on */
+    ULNG            lTriedBytes;           /* Bytes of the blocks tried */
+    ULNG            lBytesOut;             /* Output from the blocks tried */
+    ULNG            lShrunk;               /* Tried blocks which came out smaller */
+    ULNG            lSkipped;              /* Blocks the policy passed on as is */
+    ULNG            lSkipBytes;            /* Bytes of the blocks skipped */
+    ULNG            lTryUs;                /* Time spent compressing, uS */
+    ULNG            lSavedUs;              /* Estimated time skipping saved, uS */
+} CMP_STATS;
+
+/* A loaded dictionary, with the positions of its content already on hash
+ * chains so that each message need only chain its own.
+*/
+typedef struct {
+    UINT            nLen;                  /* Length of the content */
+    UINT            nCheck;                /* Check of the content */
+    UCHAR           *spData;               /* Content */
+    UINT            nDHead[1 << FLZ_HASHBITS]; /* Newest position+1 */
+    USHRT           nDChain[CMP_MAXDICTLEN]; /* Distance to previous position */
+} CMP_DICT;
+
+/* A compression context, all of the state of one compression or
+ * decompression including its tables. Each thread compressing at the
+ * same time as another needs a context of its own. With the stream codec
+ * the context also carries the history of one direction of a connection
+ * from block to block.
+*/
+typedef struct {
+    code            Prefix, Prefix0, Index;
+    int             code_len, new_entry;   /* For repeated strings */
+    int             bits, off, size;
+    code            *scode;
+    byte            *sbyte;
+    byte            *rcode, *rend;         /* Next and end of codes read */
+    unsigned int    pcode, pbyte, length;
+    code            PTable[LZSIZE];
+    code            NTable[LZSIZE];
+    byte            CTable[LZSIZE];
+    UINT            nCodec;                /* Codec CompressCtx writes */
+    UINT            nFBase;                /* Heads at or below are stale */
+    UINT            nFHead[1 << FLZ_HASHBITS]; /* Newest position+base+1 */
+    USHRT           nFChain[FLZ_WINDOW];   /* Distance to previous position */
+    UCHAR           *spStream;             /* Stream history, then new block */
+    UINT            nStreamLen;            /* Bytes of history held */
+    UINT            nStreamSize;           /* Size of spStream */
+    UINT            nStreamNext;           /* First position not yet chained */
+    UINT            nStreamBad;            /* Block lost, stream unusable */
+    UINT            nAdaptive;             /* Skip content which wont shrink */
+    UINT            nClass;                /* Class of the blocks to come */
+    CMP_POLICY      sPolicy[CMP_MAXCLASS]; /* Policy state of each class */
+    CMP_STATS       sStats;                /* Work done and avoided */
+    UINT            nParallel;             /* Large buffers go to the pool */
+    UINT            nDict;                 /* Dictionary id, 0 for none */
+    UCHAR           *spDictBuf;            /* Dictionary then message */
+    UINT            nDictBufSize;          /* Size of spDictBuf */
+    UINT            nDictBufId;            /* Dictionary held in spDictBuf */
+    UINT            nDictBufCheck;         /* and its check */
+} LZW_CTX;
+
+/* A row encoding context, the previous row of one direction of a
+ * connection split into its fields.
+*/
+typedef struct {
+    UCHAR           *spPrev;               /* Previous row */
+    UINT            nPrevLen;              /* Its length */
+    UINT            nPrevSize;             /* Size of spPrev */
+    UINT            *nField;               /* Start of each of its fields */
+    UINT            nFields;               /* Fields held in nField */
+    UINT            nFieldSize;            /* Size of nField */
+    UCHAR           cSep;                  /* Separator it was split at */
+    UINT            nBad;                  /* Row lost, context unusable */
+} ROW_CTX;
+
+/* Internal structures. A batch of blocks handed to the worker pool, and
+ * the pool itself.
+*/
+#if defined(UX_CMPRS_C)
+#define CMP_PARCOMPRESS   0
+#define CMP_PARDECOMPRESS 1
+
+typedef struct {
+    UINT            nOp;                   /* Compress or decompress */
+    UINT            nCodec;                /* Codec of the blocks */
+    UINT            nBlockSize;            /* Expanded bytes in each block */
+    UINT            nBlocks;               /* Blocks in the batch */
+    UINT            nNext;                 /* Next block to hand out */
+    UINT            nDone;                 /* Blocks finished */
+    UINT            nFail;                 /* A block couldnt be expanded */
+    UCHAR           *spRaw;                /* Expanded data */
+    UINT            nRawLen;               /* Length of expanded data */
+    UCHAR           *spPack;               /* Compressed blocks */
+    UINT            *nBlkOff;              /* Offset of each in spPack */
+    UINT            *nBlkLen;              /* Compressed length of each */
+} CMP_BATCH;
+
+#if defined(CMP_THREADS)
+typedef struct {
+    pthread_mutex_t sBatchLock;            /* One batch at a time */
+    pthread_mutex_t sLock;                 /* Guards the rest */
+    pthread_cond_t  sWork;                 /* Batch posted or pool stopping */
+    pthread_cond_t  sDone;                 /* Last block of a batch done */
+    UINT            nWorkers;              /* Workers wanted */
+    UINT            nRunning;              /* Workers started */
+    UINT            nForkSet;              /* Fork handlers registered */
+    UINT            nStop;                 /* Workers to exit */
+    CMP_BATCH       *spBatch;              /* Batch being worked on */
+    pthread_t       sThread[CMP_MAXWORKERS];
+    LZW_CTX         *spCtx[CMP_MAXWORKERS];/* Context of each worker */
+} CMP_GLOBALS;
+#endif
+#endif
+
 /* Define prototypes for functions globally available.
 */
-int WLZW( byte *, code *, int, int );
-int RLZW( code *, byte *, int, int );
+LZW_CTX *LZW_CreateCtx( void );
+void    LZW_FreeCtx( LZW_CTX * );
+void    LZW_ResetCtx( LZW_CTX * );
+int     LZW_SetCodec( LZW_CTX *, UINT );
+int     LZW_SetAdaptive( LZW_CTX *, UINT );
+int     LZW_SetClass( LZW_CTX *, UINT );
+void    LZW_GetStats( LZW_CTX *, CMP_STATS * );
+int     LZW_SetParallel( LZW_CTX *, UINT );
+int     LZW_StartPool( UINT );
+void    LZW_StopPool( void );
+int     LZW_LoadDict( UINT, UCHAR *, UINT );
+int     LZW_LoadDictFile( UINT, UCHAR * );
+void    LZW_FreeDict( UINT );
+int     LZW_DictCheck( UINT, UINT * );
+int     LZW_SetDict( LZW_CTX *, UINT );
+UINT    CompressBestCodec( UINT );
+UCHAR   *CompressCtx( LZW_CTX *, UCHAR *, UINT * );
+UCHAR   *DecompressCtx( LZW_CTX *, UCHAR *, UINT * );
+int     DecompressSize( UCHAR *, UINT, UINT * );
+int     DecompressInto( LZW_CTX *, UCHAR *, UINT, UCHAR *, UINT, UINT * );
+UCHAR   *CompressCodec( UINT, UCHAR *, UINT * );
+ROW_CTX *ROW_CreateCtx( void );
+void    ROW_FreeCtx( ROW_CTX * );
+void    ROW_ResetCtx( ROW_CTX * );
+int     ROW_Encode( ROW_CTX *, UCHAR, UCHAR *, UINT, UCHAR *, UINT * );
+int     ROW_Size( UCHAR *, UINT, UINT * );
+int     ROW_Decode( ROW_CTX *, UCHAR *, UINT, UCHAR *, UINT, UINT * );
+int     WLZW( LZW_CTX *, byte *, code *, int, int );
+int     RLZW( LZW_CTX *, byte *, byte *, int, int );
+int     WFLZ( LZW_CTX *, byte *, byte *, int, int );
+int     RFLZ( byte *, byte *, int, int );
+int     WFLZS( LZW_CTX *, byte *, byte *, int );
+int     RFLZS( LZW_CTX *, byte *, byte *, int, int );
 
 #endif    /* UX_CMPRS_H */
@@ -31,6 +31,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  ******************************************************************************/
 
+/* Linux extensions, ie. splice, are needed for relaying.
+*/
+#if defined(LINUX)
+#define     _GNU_SOURCE
+#endif
+
 /* Bring in system header files.
 */
 #include    <stdio.h>
@@ -338,8 +344,14 @@ int    _SL_AcceptClient( UINT          nServerSd,    /* I: Server Socket Id */
             spNetCon->nChanId = nChanId + 1;
             spNetCon->nStatus = SSL_UP;
             spNetCon->spXmitBuf = NULL;
+            spNetCon->spXmitFrame = NULL;
+            spNetCon->spFrameHead = NULL;
+            spNetCon->spFrameTail = NULL;
             spNetCon->nXmitLen = 0;
             spNetCon->nXmitPos = 0;
+            spNetCon->nRelayRd = -1;
+            spNetCon->nRelayWr = -1;
+            spNetCon->spRelayPeer = NULL;
 
             /* Set up KEEPALIVE, so the underlying keeps an eye on the net/
              * processes going up/down.
@@ -371,11 +383,11 @@ int    _SL_AcceptClient( UINT          nServerSd,    /* I: Server Socket Id */
 
             /* Place in NetCon list.
             */
-            if(AddItem(&Sl.spHead, &Sl.spTail, SORT_NONE,
-                       &spNetCon->nChanId,
-                       &spNetCon->lServerIPaddr,
-                       spNetCon->szServerName,
-                       spNetCon) == R_OK)
+            if(AddItemWithHandle(&Sl.spHead, &Sl.spTail, SORT_NONE,
+                                 &spNetCon->nChanId,
+                                 &spNetCon->lServerIPaddr,
+                                 spNetCon->szServerName,
+                                 spNetCon, &spNetCon->spHandle) == R_OK)
             {
                 /* Finally, call the users control callback to let him
                  * know about the new connection.
@@ -467,18 +479,17 @@ int    _SL_Close( SL_NETCONS    *spNetCon,        /* I: Connection to sever */
         spNetCon->spRecvBuf = NULL;
     }
 
-    /* Free up transmit buffer, not needed.
+    /* Free up transmit buffer and any queued shared frames, not needed.
     */
-    if(spNetCon->spXmitBuf != NULL)
-    {
-        free(spNetCon->spXmitBuf);
-        spNetCon->spXmitBuf = NULL;
-    }
+    _SL_FreeXmit(spNetCon, TRUE);
+
+    /* A relayed channel takes its peer down with it.
+    */
+    _SL_RelayBreak(spNetCon);
 
     /* Free up control record, no longer needed.
     */
-    if(DelItem(&Sl.spHead,&Sl.spTail,spNetCon,NULL,NULL,NULL)
-                                                    == R_FAIL)
+    if(DelItemByHandle(&Sl.spHead, &Sl.spTail, spNetCon->spHandle) == R_FAIL)
     {
         Lgr(LOG_WARNING, szFunc,
             "Couldnt delete server entry (%d, %d, %s)",
@@ -652,6 +663,11 @@ int    _SL_ConnectToServer( SL_NETCONS        *spNetCon )
             "Couldnt disable LINGER on socket (%d)", spNetCon->nSd);
     }
 
+    /* Mark connection as up, before the callback so that the user can
+     * use it straight away, as with accepted connections.
+    */
+    spNetCon->nStatus = SSL_UP;
+
     /* Finally, call the users control callback to let him
      * know about the new connection.
     */
@@ -659,10 +675,6 @@ int    _SL_ConnectToServer( SL_NETCONS        *spNetCon )
                              _SL_GetPortNo(spNetCon), spNetCon->lServerIPaddr,
                              spNetCon->nOurPortNo);
 
-    /* Mark connection as up.
-    */
-    spNetCon->nStatus = SSL_UP;
-
     /* Finished, success, get out!!
     */
     return( R_OK );
@@ -882,6 +894,11 @@ int    _SL_ProcessRecvBuf( SL_NETCONS        *spNetCon )
             {
                 /* Execute the callback function with the obtained data.
                 */
+                if(Sl.fpCapture != NULL)
+                {
+                    _SL_Capture(spNetCon->nChanId, SLCAP_RECV, spTmp+5,
+                                nTmpLen);
+                }
                 if(spNetCon->nDataCallback != NULL)
                 {
                     spNetCon->nDataCallback(spNetCon->nChanId,spTmp+5,nTmpLen);
@@ -897,14 +914,19 @@ int    _SL_ProcessRecvBuf( SL_NETCONS        *spNetCon )
                 */
                 spNetCon->nRecvLen -= ((spTmp+nTmpLen+8) - spNetCon->spRecvBuf);
                 if(spNetCon->nRecvLen > 0)
-                    memcpy(spNetCon->spRecvBuf, spTmp+nTmpLen+8,
-                           spNetCon->nRecvLen);
+                    memmove(spNetCon->spRecvBuf, spTmp+nTmpLen+8,
+                            spNetCon->nRecvLen);
             }
         } while(nTmpLen > 0);
     } else
      {
         /* Execute the callback function with all the data in the buffer.
         */
+        if(Sl.fpCapture != NULL && spNetCon->nRecvLen > 0)
+        {
+            _SL_Capture(spNetCon->nChanId, SLCAP_RECV, spNetCon->spRecvBuf,
+                        spNetCon->nRecvLen);
+        }
         if(spNetCon->nDataCallback != NULL)
         {
             spNetCon->nDataCallback(spNetCon->nChanId, spNetCon->spRecvBuf,
@@ -923,6 +945,411 @@ int    _SL_ProcessRecvBuf( SL_NETCONS        *spNetCon )
     return( nReturn );
 }
 
+/******************************************************************************
+ * Function:    _SL_LoadFrame
+ * Description: If a connection's transmit buffer is free and there are
+ *              shared frames queued for it, then dequeue the next frame and
+ *              make it the current transmit buffer. The frame is not copied,
+ *              the transmit buffer points directly into it, skipping the
+ *              framing characters if the connection is in raw mode.
+ * Thread Safe: No, forces SL thread entry only.
+ * Returns:     Non.
+ ******************************************************************************/
+void    _SL_LoadFrame( SL_NETCONS    *spNetCon )    /* IO: Connection to load */
+{
+    /* Local variables.
+    */
+    LINKLIST    *spNext;
+    SL_FRAME    *spFrame;
+    char        *szFunc = "_SL_LoadFrame";
+
+    SL_THREAD_ONLY;
+
+    /* Nothing to do if a buffer is already in transmission or there are
+     * no frames waiting.
+    */
+    if(spNetCon->spXmitBuf != NULL || spNetCon->spFrameHead == NULL)
+        return;
+
+    /* Take the frame at the head of the queue, the queue reference now
+     * belongs to the transmit buffer.
+    */
+    spFrame = (SL_FRAME *)StartItem(spNetCon->spFrameHead, &spNext);
+    if(DelItem(&spNetCon->spFrameHead, &spNetCon->spFrameTail, spFrame,
+               NULL, NULL, NULL) == R_FAIL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt dequeue frame on channel (%d)",
+            spNetCon->nChanId);
+        return;
+    }
+
+    /* Setup the transmit buffer to point into the shared frame.
+    */
+    spNetCon->spXmitFrame = spFrame;
+    spNetCon->nXmitPos = 0;
+    if(spNetCon->nRawMode == FALSE)
+    {
+        spNetCon->spXmitBuf = spFrame->spFrame;
+        spNetCon->nXmitLen = spFrame->nDataLen + 8;
+    } else
+     {
+        spNetCon->spXmitBuf = spFrame->spFrame + 5;
+        spNetCon->nXmitLen = spFrame->nDataLen;
+    }
+
+    /* Finished, get out!!
+    */
+    return;
+}
+
+/******************************************************************************
+ * Function:    _SL_FreeXmit
+ * Description: Free the current transmit buffer of a connection. If the
+ *              buffer belongs to a shared frame, then the reference is
+ *              released rather than the memory being freed. Optionally, all
+ *              frames still queued on the connection are released as well.
+ * Thread Safe: No, forces SL thread entry only.
+ * Returns:     Non.
+ ******************************************************************************/
+void    _SL_FreeXmit( SL_NETCONS    *spNetCon,       /* IO: Connection to free */
+                      UINT          nFlushQueue )    /* I: Release queue also? */
+{
+    SL_THREAD_ONLY;
+
+    /* Free up the current transmit buffer.
+    */
+    if(spNetCon->spXmitBuf != NULL)
+    {
+        if(spNetCon->spXmitFrame != NULL)
+        {
+            SL_ReleaseFrame(spNetCon->spXmitFrame);
+        } else
+         {
+            free(spNetCon->spXmitBuf);
+        }
+        spNetCon->spXmitBuf = NULL;
+        spNetCon->spXmitFrame = NULL;
+    }
+
+    /* Release all references held by the queue if requested.
+    */
+    if(nFlushQueue == TRUE && spNetCon->spFrameHead != NULL)
+    {
+        /* Frames are shared, so each is released rather than freed.
+        */
+        DelListWithFree(&spNetCon->spFrameHead, &spNetCon->spFrameTail,
+                        (void (*)(void *))SL_ReleaseFrame);
+    }
+
+    /* Finished, get out!!
+    */
+    return;
+}
+
+/******************************************************************************
+ * Function:    _SL_Capture
+ * Description: Write a timestamped frame record to the traffic capture
+ *              file. Only the user data is recorded, the framing can be
+ *              regenerated on replay. Failure to write disables capture
+ *              rather than disturbing the traffic.
+ * Thread Safe: No, forces SL thread entry only.
+ * Returns:     Non.
+ ******************************************************************************/
+void    _SL_Capture( UINT    nChanId,     /* I: Channel frame belongs to */
+                     UCHAR   cDir,        /* I: Direction, SLCAP_RECV/SEND */
+                     UCHAR   *szData,     /* I: Frame data */
+                     UINT    nDataLen )   /* I: Length of frame data */
+{
+    /* Local variables.
+    */
+    UCHAR           szHdr[SLCAP_RECHDRLEN];
+    char            *szFunc = "_SL_Capture";
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    struct timeval  sTv;
+#endif
+#if defined(_WIN32)
+    struct timeb    sTp;
+#endif
+
+    SL_THREAD_ONLY;
+
+    /* Build up record header, time first.
+    */
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    gettimeofday(&sTv, NULL);
+    PutCharFromLong(&szHdr[0], (ULNG)sTv.tv_sec);
+    PutCharFromLong(&szHdr[4], (ULNG)sTv.tv_usec);
+#endif
+#if defined(_WIN32)
+    ftime(&sTp);
+    PutCharFromLong(&szHdr[0], (ULNG)sTp.time);
+    PutCharFromLong(&szHdr[4], (ULNG)sTp.millitm * 1000L);
+#endif
+    PutCharFromLong(&szHdr[8], (ULNG)nChanId);
+    szHdr[12] = cDir;
+    PutCharFromLong(&szHdr[13], (ULNG)nDataLen);
+
+    /* Write out header and data, buffered by stdio.
+    */
+    if(fwrite(szHdr, SLCAP_RECHDRLEN, 1, Sl.fpCapture) != 1 ||
+       (nDataLen > 0 && fwrite(szData, nDataLen, 1, Sl.fpCapture) != 1))
+    {
+        Lgr(LOG_WARNING, szFunc, "Capture write failed, capture stopped");
+        SL_CaptureStop();
+    }
+
+    /* Finished, get out!!
+    */
+    return;
+}
+
+/******************************************************************************
+ * Function:    _SL_RelayFlush
+ * Description: Move relayed data held in a channel's relay pipe out onto its
+ *              socket with splice(), so it never enters user space. Data is
+ *              only moved once any normal SL transmit data has gone, keeping
+ *              the byte stream in order.
+ * Thread Safe: No, forces SL thread entry only.
+ * Returns:     R_OK     - Flushed as much as the socket would take.
+ *              R_FAIL   - Socket failed, see Errno.
+ * <Errno>      E_BADSOCKET - Internal failure on socket, terminal.
+ ******************************************************************************/
+int    _SL_RelayFlush( SL_NETCONS    *spNetCon )    /* IO: Channel to flush */
+{
+    /* Local variables.
+    */
+    int             nReturn = R_OK;
+#if defined(LINUX)
+    ssize_t         nRet;
+#endif
+    char            *szFunc = "_SL_RelayFlush";
+
+    SL_THREAD_ONLY;
+
+#if defined(LINUX)
+    while(spNetCon->nRelayPend > 0 && spNetCon->spXmitBuf == NULL &&
+          spNetCon->spFrameHead == NULL)
+    {
+        nRet = splice(spNetCon->nRelayRd, NULL, spNetCon->nSd, NULL,
+                      spNetCon->nRelayPend, SPLICE_F_MOVE|SPLICE_F_NONBLOCK);
+        if(nRet > 0)
+        {
+            spNetCon->nRelayPend -= (UINT)nRet;
+            spNetCon->lRelayOut += (ULNG)nRet;
+        } else
+        if(nRet < 0 && (errno == EWOULDBLOCK || errno == EINTR))
+        {
+            break;
+        } else
+         {
+            Lgr(LOG_DEBUG, szFunc, "Relay splice to channel (%d) failed (%d)",
+                spNetCon->nChanId, errno);
+            Errno = E_BADSOCKET;
+            nReturn = R_FAIL;
+            break;
+        }
+    }
+#endif
+
+    /* Finished, get out!!
+    */
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    _SL_RelayRecv
+ * Description: Move data waiting on a relayed channel's socket into the
+ *              relay pipe of its peer and on out of the peer's socket. Reading
+ *              stops when the peer cannot take any more, the unsent data
+ *              staying in the pipe until the peer drains it.
+ * Thread Safe: No, forces SL thread entry only.
+ * Returns:     R_OK     - Data relayed.
+ *              R_FAIL   - Channel closed or failed, see Errno.
+ * <Errno>      E_NOSERVICE - Remote end closed or failed.
+ ******************************************************************************/
+int    _SL_RelayRecv( SL_NETCONS    *spNetCon )    /* IO: Channel with data */
+{
+    /* Local variables.
+    */
+    int             nReturn = R_OK;
+#if defined(LINUX)
+    ssize_t         nRet;
+    SL_NETCONS      *spPeer = spNetCon->spRelayPeer;
+#endif
+
+    SL_THREAD_ONLY;
+
+#if defined(LINUX)
+    while(spPeer != NULL)
+    {
+        nRet = splice(spNetCon->nSd, NULL, spPeer->nRelayWr, NULL,
+                      DEF_RELAYCHUNK, SPLICE_F_MOVE|SPLICE_F_NONBLOCK);
+
+        /* Remote end closed or socket failed?
+        */
+        if(nRet == 0 ||
+           (nRet < 0 && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            Errno = E_NOSERVICE;
+            nReturn = R_FAIL;
+            break;
+        }
+        if(nRet < 0)
+            break;
+
+        /* Account and push straight on to the peer. If the peer fails, it
+         * is closed, which in turn closes us.
+        */
+        spPeer->nRelayPend += (UINT)nRet;
+        spNetCon->lRelayIn += (ULNG)nRet;
+        if(_SL_RelayFlush(spPeer) == R_FAIL)
+        {
+            spPeer->nRelayPend = 0;
+            spPeer->nClose = TRUE;
+            break;
+        }
+
+        /* Peer is backed up, leave the rest in the socket.
+        */
+        if(spPeer->nRelayPend > 0)
+            break;
+    }
+#endif
+
+    /* Finished, get out!!
+    */
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    _SL_RelayBreak
+ * Description: Unbind a relayed channel from its peer and release its relay
+ *              pipe. The peer is marked for closure, so closure or failure of
+ *              either side takes down the other, but only once the peer has
+ *              sent any relayed data still held for it.
+ * Thread Safe: No, forces SL thread entry only.
+ * Returns:     Non.
+ ******************************************************************************/
+void    _SL_RelayBreak( SL_NETCONS    *spNetCon )    /* IO: Channel to unbind */
+{
+    SL_THREAD_ONLY;
+
+    /* Release peer.
+    */
+    if(spNetCon->spRelayPeer != NULL)
+    {
+        spNetCon->spRelayPeer->spRelayPeer = NULL;
+        spNetCon->spRelayPeer->nClose = TRUE;
+        spNetCon->spRelayPeer = NULL;
+    }
+
+    /* Release pipe, anything still in it is lost with the channel.
+    */
+    if(spNetCon->nRelayWr >= 0)
+    {
+        close(spNetCon->nRelayRd);
+        close(spNetCon->nRelayWr);
+        spNetCon->nRelayRd = -1;
+        spNetCon->nRelayWr = -1;
+    }
+    spNetCon->nRelayPend = 0;
+
+    /* Finished, get out!!
+    */
+    return;
+}
+
+/******************************************************************************
+ * Function:    _SL_GetTimeUs
+ * Description: Get the current time in microseconds. Only differences
+ *              between two readings are meaningful, the value wraps.
+ * Thread Safe: Yes.
+ * Returns:     Current time in uS.
+ ******************************************************************************/
+ULNG    _SL_GetTimeUs( void )
+{
+    /* Local variables.
+    */
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    struct timeval  sTv;
+
+    gettimeofday(&sTv, NULL);
+    return((ULNG)sTv.tv_sec * 1000000L + (ULNG)sTv.tv_usec);
+#endif
+#if defined(_WIN32)
+    struct timeb    sTp;
+
+    ftime(&sTp);
+    return((ULNG)sTp.time * 1000000L + (ULNG)sTp.millitm * 1000L);
+#endif
+}
+
+/******************************************************************************
+ * Function:    _SL_SpinWait
+ * Description: Low latency mode. Busy poll the given read set with zero
+ *              timeout selects for up to the current spin budget, avoiding
+ *              the wakeup latency of a blocking select if data arrives within
+ *              the budget. The budget adapts to the arrival rate, doubling
+ *              (up to the configured maximum) when a spin finds data and
+ *              halving (down to DEF_SPINMIN) when it doesnt, so idle links
+ *              stop burning CPU while busy request/response links spin.
+ * Thread Safe: No, forces SL Thread only.
+ * Returns:     >0      - Number of descriptors ready, read set updated.
+ *              0       - Nothing arrived within budget, read set unchanged.
+ *              <0      - Select failure.
+ ******************************************************************************/
+int    _SL_SpinWait( fd_set    *spReadList )    /* IO: Descriptors to poll */
+{
+    /* Local variables.
+    */
+    int             nStatus;
+    ULNG            lStartUs;
+    ULNG            lElapsedUs;
+    fd_set          SpinList;
+    struct timeval  sTimeDelay;
+
+    SL_THREAD_ONLY;
+
+    /* Poll until something arrives or the budget is spent.
+    */
+    lStartUs = _SL_GetTimeUs();
+    do {
+        memcpy((UCHAR *)&SpinList, (UCHAR *)spReadList, sizeof(fd_set));
+        sTimeDelay.tv_sec = 0;
+        sTimeDelay.tv_usec = 0;
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+        nStatus=select(getdtablesize(), &SpinList, NULL, NULL, &sTimeDelay);
+#endif
+#if defined(_WIN32)
+        nStatus=select(MAX_WIN_RLIMIT, &SpinList, NULL, NULL, &sTimeDelay);
+#endif
+        lElapsedUs = _SL_GetTimeUs() - lStartUs;
+    } while(nStatus == 0 && lElapsedUs < Sl.sSpin.lSpinBudget);
+
+    /* Account for the CPU spent and adapt the budget.
+    */
+    Sl.sSpin.lSpinCount++;
+    Sl.sSpin.lSpinUs += lElapsedUs;
+    if(nStatus > 0)
+    {
+        memcpy((UCHAR *)spReadList, (UCHAR *)&SpinList, sizeof(fd_set));
+        Sl.sSpin.lSpinHits++;
+        Sl.sSpin.lSavedUs += Sl.sSpin.lWakeupUs;
+        Sl.sSpin.lSpinBudget *= 2;
+        if(Sl.sSpin.lSpinBudget > Sl.lSpinMax)
+            Sl.sSpin.lSpinBudget = Sl.lSpinMax;
+    } else
+     {
+        Sl.sSpin.lSpinBudget /= 2;
+        if(Sl.sSpin.lSpinBudget < DEF_SPINMIN)
+            Sl.sSpin.lSpinBudget = DEF_SPINMIN;
+    }
+
+    /* Return select status to caller.
+    */
+    return(nStatus);
+}
+
 /******************************************************************************
  * Function:    _SL_ProcessWaitingPorts
  * Description:    
@@ -938,10 +1365,15 @@ int _SL_ProcessWaitingPorts( ULNG    nHibernationPeriod )    /* I: Select sleep*
     */
     int             nReturn = R_FAIL;
     int             nStatus;
+    UINT            nRelayWait = FALSE;
     ULNG            lCurrTimeMs;
+    ULNG            lElapsedUs;
+    ULNG            lStartUs;
+    ULNG            lWaitUs;
     fd_set          ReadList;
     fd_set          WriteList;
     fd_set          ExceptList;
+    fd_set          RelayList;
     LINKLIST        *spNext;
     SL_NETCONS      *spNetCon;
     struct timeb    sTp;
@@ -951,6 +1383,7 @@ int _SL_ProcessWaitingPorts( ULNG    nHibernationPeriod )    /* I: Select sleep*
 #if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
     pid_t           nPid;
     SL_NETCONS      *spNewClnt;
+    UCHAR           szCapFile[MAX_PATHLEN+1];
 #endif
 
     SL_THREAD_ONLY;
@@ -960,6 +1393,7 @@ int _SL_ProcessWaitingPorts( ULNG    nHibernationPeriod )    /* I: Select sleep*
     FD_ZERO(&ReadList);
     FD_ZERO(&WriteList);
     FD_ZERO(&ExceptList);
+    FD_ZERO(&RelayList);
 
     /* Get current time to validate comms down timers.
     */
@@ -1004,36 +1438,97 @@ int _SL_ProcessWaitingPorts( ULNG    nHibernationPeriod )    /* I: Select sleep*
         }
 
         /* Active connections? Need to know if they are ready to accept
-         * data or have data awaiting.
+         * data or have data awaiting. A relayed channel isnt read while its
+         * peer is still backed up.
         */
         if(spNetCon->nStatus == SSL_UP)
         {
-            FD_SET(spNetCon->nSd, &ReadList);
+            if(spNetCon->spRelayPeer == NULL ||
+               spNetCon->spRelayPeer->nRelayPend == 0)
+            {
+                FD_SET(spNetCon->nSd, &ReadList);
+            }
             FD_SET(spNetCon->nSd, &WriteList);
         }
 
         /* If there is data which is awaiting xmission, then try to send it.
         */
-        if(spNetCon->nStatus == SSL_UP && spNetCon->spXmitBuf != NULL)
+        if(spNetCon->nStatus == SSL_UP &&
+           (spNetCon->spXmitBuf != NULL || spNetCon->spFrameHead != NULL))
         {
             SL_SendData(spNetCon->nChanId, NULL, 0);
         }
+
+        /* Relayed data held for this channel? Send it, and if the socket
+         * wont take it all, wait for it to become writeable and hold off
+         * reading from the source, the pipe acting as back pressure.
+        */
+        if(spNetCon->nStatus == SSL_UP && spNetCon->nRelayPend > 0)
+        {
+            if(_SL_RelayFlush(spNetCon) == R_FAIL)
+            {
+                spNetCon->nRelayPend = 0;
+                spNetCon->nClose = TRUE;
+            } else
+            if(spNetCon->nRelayPend > 0)
+            {
+                FD_SET(spNetCon->nSd, &RelayList);
+                nRelayWait = TRUE;
+                if(spNetCon->spRelayPeer != NULL)
+                    FD_CLR(spNetCon->spRelayPeer->nSd, &ReadList);
+            } else
+            if(spNetCon->spRelayPeer != NULL &&
+               spNetCon->spRelayPeer->nStatus == SSL_UP)
+            {
+                FD_SET(spNetCon->spRelayPeer->nSd, &ReadList);
+            }
+        }
+    }
+
+    /* In low latency mode, spin on the ports for a while before committing
+     * to a blocking select, it is only worth it if we would block.
+    */
+    nStatus = 0;
+    if(Sl.nLowLatency == TRUE && nHibernationPeriod > 0)
+    {
+        if((nStatus = _SL_SpinWait(&ReadList)) > 0)
+            FD_ZERO(&RelayList);
     }
 
     /* Issue select on ports of interest, should return immediately or after
      * the programmed delay, thereby not blocking action for too long.
     */
-    sTimeDelay.tv_sec = nHibernationPeriod/1000;
-    nHibernationPeriod -= sTimeDelay.tv_sec * 1000;
-    sTimeDelay.tv_usec = (nHibernationPeriod * 1000L);
+    if(nStatus == 0)
+    {
+        lWaitUs = nHibernationPeriod * 1000L;
+        sTimeDelay.tv_sec = nHibernationPeriod/1000;
+        nHibernationPeriod -= sTimeDelay.tv_sec * 1000;
+        sTimeDelay.tv_usec = (nHibernationPeriod * 1000L);
+        lStartUs = (Sl.nLowLatency == TRUE ? _SL_GetTimeUs() : 0L);
 
 #if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
-    nStatus=select(getdtablesize(), &ReadList, NULL, NULL, &sTimeDelay);
+        nStatus=select(getdtablesize(), &ReadList,
+                       (nRelayWait == TRUE ? &RelayList : NULL), NULL,
+                       &sTimeDelay);
 #endif
 #if defined(_WIN32)
-    nStatus=select(MAX_WIN_RLIMIT, &ReadList, NULL, NULL, &sTimeDelay);
+        nStatus=select(MAX_WIN_RLIMIT, &ReadList, NULL, NULL, &sTimeDelay);
 #endif
 
+        /* A timed out wait tells us how late the kernel wakes us, which is
+         * the latency a successful spin saves. Keep a running average.
+        */
+        if(Sl.nLowLatency == TRUE && nStatus == 0 && lWaitUs > 0)
+        {
+            lElapsedUs = _SL_GetTimeUs() - lStartUs;
+            if(lElapsedUs > lWaitUs)
+            {
+                Sl.sSpin.lWakeupUs = ((Sl.sSpin.lWakeupUs * 7) +
+                                      (lElapsedUs - lWaitUs)) / 8;
+            }
+        }
+    }
+
     if(nStatus > 0)
     {
         /* Go through lists and process any pending server connections, data
@@ -1069,7 +1564,13 @@ int _SL_ProcessWaitingPorts( ULNG    nHibernationPeriod )    /* I: Select sleep*
                         if(_SL_AcceptClient(spNetCon->nSd, spNetCon, &spNewClnt)
                                                                      == R_OK)
                         {
-                            /* Fork child to handle new connection.
+                            /* Flush any captured traffic so the child doesnt
+                             * inherit and duplicate it.
+                            */
+                            if(Sl.fpCapture != NULL)
+                                fflush(Sl.fpCapture);
+
+                            /* Fork child to handle new connection.
                             */
                             if((nPid=fork()) < 0)
                             {
@@ -1081,6 +1582,14 @@ int _SL_ProcessWaitingPorts( ULNG    nHibernationPeriod )    /* I: Select sleep*
                             */
                             if(nPid == 0)
                             {
+                                /* Children capture to their own file.
+                                */
+                                if(Sl.fpCapture != NULL)
+                                {
+                                    sprintf(szCapFile, "%.*s.%d", MAX_PATHLEN-12,
+                                            Sl.szCapFile, (int)getpid());
+                                    SL_CaptureStart(szCapFile);
+                                }
                                 _SL_Close(spNetCon, FALSE);
                             } else
                             /* If we are the parent then close the accepted
@@ -1106,6 +1615,13 @@ int _SL_ProcessWaitingPorts( ULNG    nHibernationPeriod )    /* I: Select sleep*
                     */
                     _SL_AcceptClient(spNetCon->nSd, spNetCon, NULL);
 #endif
+                } else
+                /* Relayed channels bypass the receive buffer altogether.
+                */
+                if(spNetCon->spRelayPeer != NULL)
+                {
+                    if(_SL_RelayRecv(spNetCon) == R_FAIL)
+                        FD_SET(spNetCon->nSd, &ExceptList);
                 } else
                  {
                     if(_SL_ReceiveFromSocket(spNetCon) == R_OK)
@@ -1129,6 +1645,15 @@ int _SL_ProcessWaitingPorts( ULNG    nHibernationPeriod )    /* I: Select sleep*
                 }
             }
 
+            /* Relay channel now writeable? Send on the held data.
+            */
+            if(nRelayWait == TRUE && FD_ISSET(spNetCon->nSd, &RelayList) &&
+               _SL_RelayFlush(spNetCon) == R_FAIL)
+            {
+                spNetCon->nRelayPend = 0;
+                spNetCon->nClose = TRUE;
+            }
+
             /* Any exceptions occurred on a socket?
             */
             if(FD_ISSET(spNetCon->nSd, &ExceptList))
@@ -1146,6 +1671,7 @@ int _SL_ProcessWaitingPorts( ULNG    nHibernationPeriod )    /* I: Select sleep*
                      * down and it will eventually be rebuilt.
                     */
                     spNetCon->nStatus = SSL_DOWN;
+                    _SL_RelayBreak(spNetCon);
                     spNetCon->nCntrlCallback(SLC_LINKDOWN, spNetCon->nChanId,
                                              _SL_GetPortNo(spNetCon),
                                              spNetCon->lServerIPaddr);
@@ -1155,7 +1681,8 @@ int _SL_ProcessWaitingPorts( ULNG    nHibernationPeriod )    /* I: Select sleep*
             /* This Channel marked for closure? Close it only if all data
              * for transmission has been sent.
             */
-            if(spNetCon->nClose == TRUE && spNetCon->spXmitBuf == NULL)
+            if(spNetCon->nClose == TRUE && spNetCon->spXmitBuf == NULL &&
+               spNetCon->spFrameHead == NULL && spNetCon->nRelayPend == 0)
             {
                 _SL_Close(spNetCon, TRUE);
             }
@@ -1207,7 +1734,7 @@ ULNG _SL_ProcessCallbacks( void )
     */
     ULNG            nReturn = DEF_MAXBLOCKPERIOD;
     ULNG            lCurrTimeMs;
-    LINKLIST        *spNext;
+    UINT            nNdx;
     SL_CALLIST      *spCB;
     struct timeb    sTp;
 
@@ -1218,19 +1745,25 @@ ULNG _SL_ProcessCallbacks( void )
     ftime(&sTp);
     lCurrTimeMs = (sTp.time * 1000L) + (ULNG)sTp.millitm;
 
-    /* Go through callback list and invoke callback function if timer has
-     * expired.
+    /* Go through callback vector and invoke callback function if timer has
+     * expired. A callback may add a timer itself, which can move the
+     * vector, so it is walked by index and the entry re-fetched after each
+     * invocation.
     */
-    for(spCB=(SL_CALLIST *)StartItem(Sl.spCBHead, &spNext); spCB != NULL;
-        spCB=(SL_CALLIST *)NextItem(&spNext))
+    for(nNdx=0; nNdx < Sl.sTimers.nCount; nNdx++)
     {
+        spCB = SL_CBVEC_At(&Sl.sTimers, nNdx);
+
         /* If the callback is active, and its timer has expired, execute
          * the callback.
         */
         if( spCB->nStatus == TCB_UP && spCB->lTimeExpire <= lCurrTimeMs )
         {
             if( spCB->nCallback != NULL )
+            {
                 spCB->nCallback(spCB->lCBData);
+                spCB = SL_CBVEC_At(&Sl.sTimers, nNdx);
+            }
 
             /* Update counter according to options flag.
             */
@@ -1310,7 +1843,9 @@ UCHAR *SL_HostIPtoString( ULNG    lIPaddr )    /* I: IP address to convert */
 /******************************************************************************
  * Function:    SL_GetIPaddr
  * Description: Get the Internet address of the local machine or a named
- *              machine.
+ *              machine. Successful lookups are cached for DEF_DNSCACHETTL
+ *              mS so that repeated connects to the same host do not each
+ *              wait on the resolver.
  * Thread Safe: No, API only allows one thread at a time.
  * Returns:     R_OK   - IP address obtained.
  *              R_FAIL - IP address not obtained.
@@ -1321,6 +1856,7 @@ int    SL_GetIPaddr( UCHAR       *szHost,        /* I: Hostname string */
     /* Local variables.
     */
     int             nReturn = R_FAIL;
+    UINT            nLen;
     char            szHostName[MAX_MACHINENAME+1];
     struct hostent  *spHostEnt;
 
@@ -1338,6 +1874,21 @@ int    SL_GetIPaddr( UCHAR       *szHost,        /* I: Hostname string */
         strcpy(szHostName, szHost);
     }
 
+    /* Try the cache first, it is created on first use.
+    */
+    if(Sl.spDnsCache == NULL)
+    {
+        Sl.spDnsCache = UC_Create(DEF_DNSCACHESIZE, 0, DEF_DNSCACHETTL, 1,
+                                  NULL, 0);
+    }
+    nLen = sizeof(ULNG);
+    if(Sl.spDnsCache != NULL &&
+       UC_Get(Sl.spDnsCache, (UCHAR *)szHostName, strlen(szHostName),
+              (void *)lIPaddr, &nLen) == R_OK)
+    {
+        SL_SINGLE_THREAD_EXIT( R_OK );
+    }
+
     if( (spHostEnt=gethostbyname( szHostName )) != NULL )
     {
         if( spHostEnt->h_addrtype == AF_INET )
@@ -1348,6 +1899,12 @@ int    SL_GetIPaddr( UCHAR       *szHost,        /* I: Hostname string */
             memcpy((UCHAR *)lIPaddr, spHostEnt->h_addr, 4);
             *lIPaddr = ntohl(*lIPaddr);
             nReturn = R_OK;
+
+            if(Sl.spDnsCache != NULL)
+            {
+                UC_Put(Sl.spDnsCache, (UCHAR *)szHostName, strlen(szHostName),
+                       (void *)lIPaddr, sizeof(ULNG), 0);
+            }
         }
     }
     
@@ -1425,8 +1982,14 @@ int    SL_Init( UINT        nSockKeepAlive,    /* I: Socket keep alive time peri
     */
     Sl.spHead = NULL;
     Sl.spTail = NULL;
-    Sl.spCBHead = NULL;
-    Sl.spCBTail = NULL;
+    SL_CBVEC_Init(&Sl.sTimers);
+    Sl.spDnsCache = NULL;
+    Sl.nLowLatency = FALSE;
+    Sl.fpCapture = NULL;
+    Sl.lSpinMax = DEF_SPINMAX;
+    memset((UCHAR *)&Sl.sSpin, '\0', sizeof(SL_SPINSTATS));
+    Sl.sSpin.lSpinBudget = DEF_SPINMAX;
+    Sl.sSpin.lWakeupUs = DEF_WAKEUPUS;
 
     /* Finished, get out!!
     */
@@ -1459,14 +2022,23 @@ int    SL_Exit( UCHAR        *szErrMsg )        /* O: Error message buffer */
     {
         if(spNetCon->spRecvBuf != NULL)
             free(spNetCon->spRecvBuf);
-        if(spNetCon->spXmitBuf != NULL)
-            free(spNetCon->spXmitBuf);
+        _SL_FreeXmit(spNetCon, TRUE);
+        _SL_RelayBreak(spNetCon);
     }
 
+    /* Close any active traffic capture.
+    */
+    SL_CaptureStop();
+
     /* Free up linked list memory.
     */
     if(Sl.spHead != NULL) DelList(&Sl.spHead, &Sl.spTail);
-    if(Sl.spCBHead != NULL) DelList(&Sl.spCBHead, &Sl.spCBTail);
+    SL_CBVEC_Free(&Sl.sTimers);
+    if(Sl.spDnsCache != NULL)
+    {
+        UC_Destroy(Sl.spDnsCache);
+        Sl.spDnsCache = NULL;
+    }
 
     /* Free up any character buffers...
     */
@@ -1653,8 +2225,13 @@ int SL_AddServer( UINT    nPortNo,                      /* I: Port to listen on
         spNetCon->nStatus = SSL_LISTENING;
         spNetCon->nForkForAccept = nForkForAccept;
         spNetCon->spXmitBuf = NULL;
+        spNetCon->spXmitFrame = NULL;
+        spNetCon->spFrameHead = NULL;
+        spNetCon->spFrameTail = NULL;
         spNetCon->nXmitLen = 0;
         spNetCon->nXmitPos = 0;
+        spNetCon->nRelayRd = -1;
+        spNetCon->nRelayWr = -1;
 
         /* Build up Server address info, so it can be publicised by bind to
          * the big wide world.
@@ -1688,9 +2265,10 @@ int SL_AddServer( UINT    nPortNo,                      /* I: Port to listen on
          {
             /* OK, almost there, now will it stick onto the lists!!?
             */
-            if(AddItem(&Sl.spHead, &Sl.spTail, SORT_NONE, &spNetCon->nChanId,
-                       &spNetCon->lServerIPaddr, spNetCon->szServerName,
-                       spNetCon) == R_OK)
+            if(AddItemWithHandle(&Sl.spHead, &Sl.spTail, SORT_NONE,
+                                 &spNetCon->nChanId, &spNetCon->lServerIPaddr,
+                                 spNetCon->szServerName, spNetCon,
+                                 &spNetCon->spHandle) == R_OK)
             {
                 nReturn = R_OK;
             } else
@@ -1795,14 +2373,21 @@ int SL_AddClient( UINT    nServerPortNo,                /* I: Server port to tal
             spNetCon->nChanId = nChanId + 1;
             spNetCon->lDownTimer = 0L;
             spNetCon->spXmitBuf = NULL;
+            spNetCon->spXmitFrame = NULL;
+            spNetCon->spFrameHead = NULL;
+            spNetCon->spFrameTail = NULL;
             spNetCon->nXmitLen = 0;
             spNetCon->nXmitPos = 0;
+            spNetCon->nRelayRd = -1;
+            spNetCon->nRelayWr = -1;
+            spNetCon->spRelayPeer = NULL;
 
             /* OK, almost there, now will it stick onto the lists!!?
             */
-            if(AddItem(&Sl.spHead, &Sl.spTail, SORT_NONE, &spNetCon->nChanId,
-                       &spNetCon->lServerIPaddr, spNetCon->szServerName,
-                       spNetCon) == R_OK)
+            if(AddItemWithHandle(&Sl.spHead, &Sl.spTail, SORT_NONE,
+                                 &spNetCon->nChanId, &spNetCon->lServerIPaddr,
+                                 spNetCon->szServerName, spNetCon,
+                                 &spNetCon->spHandle) == R_OK)
             {
                 nReturn = spNetCon->nChanId;
             } else
@@ -1829,7 +2414,7 @@ int SL_AddClient( UINT    nServerPortNo,                /* I: Server port to tal
  *              Each callback can pass a predefined variable/pointer, so
  *              multiple instances of the same callback can exist, each
  *              referring to the same function, but passing different values
- *              to it. The callbacks are maintained in a dynamic link list.
+ *              to it. The callbacks are maintained in a contiguous vector.
  * Thread Safe: No, API Function, only allows single thread at a time.
  * Returns:     R_OK     - Callback added successfully.
  *              R_FAIL   - Failure, see Errno.
@@ -1844,61 +2429,40 @@ int SL_AddTimerCB( ULNG    lTimePeriod,        /* I: Time between callbacks */
     */
     int             nReturn = R_FAIL;
     ULNG            lCurrTimeMs;
+    UINT            nNdx;
     char            *szFunc = "SL_AddTimerCB";
-    SL_CALLIST      *spCB;
-    LINKLIST        *spNext;
+    SL_CALLIST      *spCB = NULL;
+    SL_CALLIST      sNew;
     struct timeb    sTp;
 
     SL_SINGLE_THREAD_ONLY;
 
-    /* Go through callback list to locate an existing entry. Existing entries
-     * may occur as the application is just updating the configuration of
-     * the given callback.
+    /* Go through callback vector to locate an existing entry. Existing
+     * entries may occur as the application is just updating the
+     * configuration of the given callback.
     */
-    for(spCB=(SL_CALLIST *)StartItem(Sl.spCBHead, &spNext); spCB != NULL;
-        spCB=(SL_CALLIST *)NextItem(&spNext))
+    for(nNdx=0; nNdx < Sl.sTimers.nCount; nNdx++)
     {
         /* If the callback is the same... and the data back is the same, then
          * we are updating an existing record.
         */
+        spCB = SL_CBVEC_At(&Sl.sTimers, nNdx);
         if( spCB->nCallback ==  nCallback && spCB->lCBData == lCBData )
             break;
+        spCB = NULL;
     }
 
-    /* Does a current entry exist? If not, allocate and add to linked list.
+    /* Does a current entry exist? If not, add a washed record to the
+     * vector.
     */
     if( spCB == NULL )
     {
-        /* Create record.
-        */
-        if((spCB = (SL_CALLIST *)malloc(sizeof(SL_CALLIST))) == NULL)
+        memset((UCHAR *)&sNew, '\0', sizeof(SL_CALLIST));
+        sNew.nCallback = nCallback;
+        if((spCB = SL_CBVEC_Push(&Sl.sTimers, sNew)) == NULL)
         {
-            Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes",
-                sizeof(SL_CALLIST));
-            Errno = E_NOMEM;
-        } else
-         {
-            /* Wash the new memory, just in case.
-            */
-            memset((UCHAR *)spCB, '\0', sizeof(SL_CALLIST));
-        }
-
-        /* Add to callback list.
-        */
-        if(AddItem(&Sl.spCBHead, &Sl.spCBTail, SORT_NONE, NULL, NULL, NULL,
-                   spCB) == R_FAIL)
-        {
-            /* Dont modify Errno as AddItem has already set it for the
-             * correct error condition.
-            */
-            free(spCB);
-            spCB = NULL;
-        } else
-         {
-            /* Store the callback address, no need to accomplish in an update
-             * scenario.
-            */
-            spCB->nCallback    = nCallback;
+            Lgr(LOG_DEBUG, szFunc, "Couldnt grow timer vector to (%d) entries",
+                Sl.sTimers.nCount + 1);
         }
     }
 
@@ -2072,7 +2636,9 @@ int    SL_Close( UINT    nChanId )    /* I: Channel Id to close */
 /******************************************************************************
  * Function:    SL_SendData
  * Description: Transmit a packet of data to a given destination identified
- *              by it channel Id.
+ *              by it channel Id. With no data, flush the buffer pending
+ *              and any shared frames queued behind it, giving E_BUSY until
+ *              all of them have gone.
  * Thread Safe: No, API function, only allows one thread at a time.
  * Returns:     R_OK     - Data sent successfully.
  *              R_FAIL   - Couldnt send data, see Errno.
@@ -2114,6 +2680,12 @@ int SL_SendData( UINT    nChanId,      /* I: Channel Id to send data on */
         SL_SINGLE_THREAD_EXIT(nReturn);
     }
 
+    /* If the transmit buffer is free and shared frames are queued, then the
+     * next frame becomes the transmit buffer, keeping frames in order ahead
+     * of any new data.
+    */
+    _SL_LoadFrame(spNetCon);
+
     /* If the caller has passed no data in then he is wanting to flush any
      * existing buffer out and get a result from it. If there is no data
      * pending for transmission then exit with OK.
@@ -2181,13 +2753,22 @@ int SL_SendData( UINT    nChanId,      /* I: Channel Id to send data on */
              {
                 memcpy((UCHAR *)spNetCon->spXmitBuf, (UCHAR *)szData, nDataLen);
             }
+
+            /* Record the frame if traffic is being captured.
+            */
+            if(Sl.fpCapture != NULL)
+            {
+                _SL_Capture(nChanId, SLCAP_SEND, szData, nDataLen);
+            }
         }
     }
 
-    /* If we've got info to xmit, then transmit it.
+    /* If we've got info to xmit, then transmit it, carrying on with any
+     * shared frames queued behind it until the port is busy or fails.
     */
-    if(spNetCon->spXmitBuf != NULL)
+    for(nReturn=R_OK; nReturn == R_OK && spNetCon->spXmitBuf != NULL; )
     {
+        nReturn = R_FAIL;
         switch(spNetCon->nStatus)
         {
             case SSL_UP:
@@ -2236,10 +2817,12 @@ int SL_SendData( UINT    nChanId,      /* I: Channel Id to send data on */
                     */
                     if(spNetCon->nXmitPos == spNetCon->nXmitLen)
                     {
-                        /* No further need for dynamic buffer.
+                        /* No further need for dynamic buffer or our
+                         * reference to a shared frame, the next frame
+                         * queued takes its place.
                         */
-                        free(spNetCon->spXmitBuf);
-                        spNetCon->spXmitBuf = NULL;
+                        _SL_FreeXmit(spNetCon, FALSE);
+                        _SL_LoadFrame(spNetCon);
                     }
                     nReturn = R_OK;
                 }
@@ -2253,9 +2836,6 @@ int SL_SendData( UINT    nChanId,      /* I: Channel Id to send data on */
                 Errno = E_BADSOCKET;
                 break;
         }
-    } else
-     {
-        nReturn = R_OK;
     }
 
     /* If a failure occurs due to the send-buffer becoming full, tell
@@ -2323,6 +2903,525 @@ int SL_BlockSendData( UINT    nChanId,    /* I: Channel Id to send data on */
     SL_SINGLE_THREAD_EXIT(nReturn);
 }
 
+/******************************************************************************
+ * Function:    SL_CreateFrame
+ * Description: Build an immutable, shareable transmit frame from a block of
+ *              data. The data is framed and CRC'd once, the resulting frame
+ *              can then be queued on any number of channels via SL_SendFrame
+ *              without further copying. The frame is returned holding one
+ *              reference on behalf of the caller, which must be released with
+ *              SL_ReleaseFrame once the caller has finished queuing it.
+ * Thread Safe: No, API function, only allows one thread at a time.
+ * Returns:     Non-NULL - Pointer to new frame.
+ *              NULL     - Couldnt create frame, see Errno.
+ * <Errno>      E_NOMEM  - Memory exhaustion.
+ ******************************************************************************/
+SL_FRAME *SL_CreateFrame( UCHAR    *szData,     /* I: Data to be framed */
+                          UINT     nDataLen )   /* I: Length of data */
+{
+    /* Local variables.
+    */
+    UINT        nDataCRC;
+    SL_FRAME    *spFrame;
+    char        *szFunc = "SL_CreateFrame";
+
+    SL_SINGLE_THREAD_ONLY;
+
+    /* Allocate the control record and the frame buffer in one block, the
+     * frame data immediately following the control record.
+    */
+    if((spFrame=(SL_FRAME *)malloc(sizeof(SL_FRAME)+nDataLen+8)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes",
+            sizeof(SL_FRAME)+nDataLen+8);
+        Errno = E_NOMEM;
+        SL_SINGLE_THREAD_EXIT(NULL);
+    }
+    spFrame->nRefCnt = 1;
+    spFrame->nDataLen = nDataLen;
+    spFrame->spFrame = (UCHAR *)(spFrame + 1);
+
+    /* Format the data in format:
+     * <SYN><SYN><STX><LEN_LSB><LEN_MSB><..DATA..><ETX><CRC_LSB><CRC_MSB>
+     * Raw mode channels transmit the data portion only.
+    */
+    memcpy((UCHAR *)spFrame->spFrame+5, (UCHAR *)szData, nDataLen);
+    spFrame->spFrame[0] = A_SYN;
+    spFrame->spFrame[1] = A_SYN;
+    spFrame->spFrame[2] = A_STX;
+    PutCharFromInt(&spFrame->spFrame[3], nDataLen);
+    spFrame->spFrame[nDataLen+5] = A_ETX;
+    nDataCRC = _SL_CalcCRC(szData, nDataLen);
+    PutCharFromInt(&spFrame->spFrame[nDataLen+6], nDataCRC);
+
+    /* Return new frame to caller.
+    */
+    SL_SINGLE_THREAD_EXIT(spFrame);
+}
+
+/******************************************************************************
+ * Function:    SL_ReleaseFrame
+ * Description: Release a reference to a shared frame. When the last
+ *              reference is released the frame memory is returned to the
+ *              system pool.
+ * Thread Safe: No, API function, only allows one thread at a time.
+ * Returns:     Non.
+ ******************************************************************************/
+void    SL_ReleaseFrame( SL_FRAME    *spFrame )    /* I: Frame to release */
+{
+    SL_SINGLE_THREAD_ONLY;
+
+    /* Drop the reference, free on last.
+    */
+    if(spFrame != NULL && --spFrame->nRefCnt == 0)
+    {
+        free(spFrame);
+    }
+
+    /* Finished, get out!!
+    */
+    return;
+}
+
+/******************************************************************************
+ * Function:    SL_SendFrame
+ * Description: Queue a shared frame for transmission on a given channel. The
+ *              channel takes its own reference to the frame, released once
+ *              the frame has been transmitted or the channel closes, so the
+ *              caller remains responsible for its own reference.
+ * Thread Safe: No, API function, only allows one thread at a time.
+ * Returns:     R_OK     - Frame sent or queued successfully.
+ *              R_FAIL   - Couldnt send frame, see Errno.
+ * <Errno>      E_INVCHANID - Invalid channel Id.
+ *              E_NOMEM     - Memory exhaustion.
+ *              E_BADSOCKET - Internal failure on socket, terminal.
+ *              E_NOSERVICE - No remote connection established yet.
+ ******************************************************************************/
+int SL_SendFrame( UINT        nChanId,    /* I: Channel Id to send frame on */
+                  SL_FRAME    *spFrame )  /* I: Frame to be sent */
+{
+    /* Local variables.
+    */
+    int            nReturn = R_FAIL;
+    char        *szFunc = "SL_SendFrame";
+    LINKLIST    *spNext;
+    SL_NETCONS    *spNetCon;
+
+    SL_SINGLE_THREAD_ONLY;
+
+    /* Scan list to see if an entry exists for requested channel.
+    */
+    for(spNetCon=(SL_NETCONS *)StartItem(Sl.spHead, &spNext);
+        spNetCon != NULL && spNetCon->nChanId != nChanId;
+        spNetCon=(SL_NETCONS *)NextItem(&spNext));
+
+    /* If the channel is invalid, get out.
+    */
+    if(spNetCon == NULL)
+    {
+        Errno = E_INVCHANID;
+        SL_SINGLE_THREAD_EXIT(nReturn);
+    }
+
+    /* Queue the frame on the channel, the queue holds a reference.
+    */
+    if(AddItem(&spNetCon->spFrameHead, &spNetCon->spFrameTail, SORT_NONE,
+               NULL, NULL, NULL, spFrame) == R_FAIL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt queue frame on channel (%d)",
+            nChanId);
+        Errno = E_NOMEM;
+        SL_SINGLE_THREAD_EXIT(nReturn);
+    }
+    spFrame->nRefCnt++;
+
+    /* Record the frame if traffic is being captured.
+    */
+    if(Sl.fpCapture != NULL)
+    {
+        _SL_Capture(nChanId, SLCAP_SEND, spFrame->spFrame+5, spFrame->nDataLen);
+    }
+
+    /* Try and get the data moving. A busy port is not a failure, the
+     * frame will be flushed out in the background.
+    */
+    if((nReturn=SL_SendData(nChanId, NULL, 0)) == R_FAIL && Errno == E_BUSY)
+    {
+        nReturn = R_OK;
+    }
+
+    /* Return result code to caller.
+    */
+    SL_SINGLE_THREAD_EXIT(nReturn);
+}
+
+/******************************************************************************
+ * Function:    SL_BroadcastData
+ * Description: Transmit a packet of data to a list of channels. The data is
+ *              framed once into a shared frame which is queued on every
+ *              channel and freed when the last channel has transmitted it.
+ * Thread Safe: No, API function, only allows one thread at a time.
+ * Returns:     R_OK     - Data sent/queued on some/all channels.
+ *              R_FAIL   - Couldnt send to any channel, see Errno.
+ * <Errno>      E_NOMEM     - Memory exhaustion.
+ *              E_INVCHANID - Invalid channel Id.
+ *              E_BADSOCKET - Internal failure on socket, terminal.
+ *              E_NOSERVICE - No remote connection established yet.
+ ******************************************************************************/
+int SL_BroadcastData( UINT    *nChanIds,    /* I: Array of channel Id's */
+                      UINT    nChanCnt,     /* I: Number of channel Id's */
+                      UCHAR   *szData,      /* I: Data to be sent */
+                      UINT    nDataLen )    /* I: Length of data */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    int         nReturn = R_FAIL;
+    SL_FRAME    *spFrame;
+
+    SL_SINGLE_THREAD_ONLY;
+
+    /* Frame the data once.
+    */
+    if((spFrame=SL_CreateFrame(szData, nDataLen)) == NULL)
+    {
+        SL_SINGLE_THREAD_EXIT(nReturn);
+    }
+
+    /* Queue the shared frame on each channel.
+    */
+    for(nNdx=0; nNdx < nChanCnt; nNdx++)
+    {
+        if(SL_SendFrame(nChanIds[nNdx], spFrame) == R_OK)
+            nReturn = R_OK;
+    }
+
+    /* Release our reference, the channels hold their own.
+    */
+    SL_ReleaseFrame(spFrame);
+
+    /* Return result code to caller.
+    */
+    SL_SINGLE_THREAD_EXIT(nReturn);
+}
+
+/******************************************************************************
+ * Function:    SL_CaptureStart
+ * Description: Start capturing all traffic, sent and received, on all
+ *              channels to a binary capture file for later replay. Any
+ *              previous capture is closed first. Children forked to accept
+ *              connections capture to the same name suffixed by their pid.
+ * Thread Safe: No, API function, only allows one thread at a time.
+ * Returns:     R_OK     - Capture started.
+ *              R_FAIL   - Couldnt create capture file, see Errno.
+ * <Errno>      E_BADPARM - Capture file couldnt be created.
+ ******************************************************************************/
+int SL_CaptureStart( UCHAR    *szCapFile )    /* I: Name of capture file */
+{
+    /* Local variables.
+    */
+    UCHAR       szHdr[SLCAP_HDRLEN];
+    char        *szFunc = "SL_CaptureStart";
+
+    SL_SINGLE_THREAD_ONLY;
+
+    /* Close down any existing capture.
+    */
+    SL_CaptureStop();
+
+    /* Create the file and write the header.
+    */
+    memset(szHdr, '\0', SLCAP_HDRLEN);
+    memcpy(szHdr, SLCAP_MAGIC, strlen(SLCAP_MAGIC));
+    szHdr[strlen(SLCAP_MAGIC)] = SLCAP_VERSION;
+    strncpy(Sl.szCapFile, szCapFile, MAX_PATHLEN);
+    Sl.szCapFile[MAX_PATHLEN] = '\0';
+    if((Sl.fpCapture=fopen(szCapFile, "wb")) == NULL ||
+       fwrite(szHdr, SLCAP_HDRLEN, 1, Sl.fpCapture) != 1)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt create capture file (%s)", szCapFile);
+        if(Sl.fpCapture != NULL)
+        {
+            fclose(Sl.fpCapture);
+            Sl.fpCapture = NULL;
+        }
+        Errno = E_BADPARM;
+        SL_SINGLE_THREAD_EXIT(R_FAIL);
+    }
+
+    /* Finished, get out!!
+    */
+    SL_SINGLE_THREAD_EXIT(R_OK);
+}
+
+/******************************************************************************
+ * Function:    SL_CaptureStop
+ * Description: Stop capturing traffic, flushing and closing the capture
+ *              file.
+ * Thread Safe: No, API function, only allows one thread at a time.
+ * Returns:     R_OK     - Capture stopped or wasnt running.
+ ******************************************************************************/
+int SL_CaptureStop( void )
+{
+    SL_SINGLE_THREAD_ONLY;
+
+    /* Close the file if open.
+    */
+    if(Sl.fpCapture != NULL)
+    {
+        fclose(Sl.fpCapture);
+        Sl.fpCapture = NULL;
+    }
+
+    /* Finished, get out!!
+    */
+    SL_SINGLE_THREAD_EXIT(R_OK);
+}
+
+/******************************************************************************
+ * Function:    SL_LowLatency
+ * Description: Enable or disable the low latency spin-then-block mode. When
+ *              enabled, a poll which would otherwise block in select first
+ *              busy polls the sockets for up to lSpinMax microseconds, the
+ *              actual budget adapting to the rate at which data arrives.
+ *              Costs CPU, so only of benefit to latency sensitive request/
+ *              response traffic.
+ * Thread Safe: No, API function, only allows one thread at a time.
+ * Returns:     R_OK     - Mode changed.
+ *              R_FAIL   - Bad parameters, see Errno.
+ * <Errno>      E_BADPARM - Spin maximum of zero given when enabling.
+ ******************************************************************************/
+int SL_LowLatency( UINT    nEnable,       /* I: Enable (TRUE) or disable */
+                   ULNG    lSpinMax )     /* I: Max spin period in uS */
+{
+    SL_SINGLE_THREAD_ONLY;
+
+    /* A zero budget makes no sense when turning the mode on.
+    */
+    if(nEnable == TRUE && lSpinMax == 0)
+    {
+        Errno = E_BADPARM;
+        SL_SINGLE_THREAD_EXIT(R_FAIL);
+    }
+
+    /* Store the new settings, the adaptive budget starts at the maximum.
+    */
+    Sl.nLowLatency = nEnable;
+    if(nEnable == TRUE)
+    {
+        Sl.lSpinMax = lSpinMax;
+        Sl.sSpin.lSpinBudget = lSpinMax;
+    }
+
+    /* Finished, get out!!
+    */
+    SL_SINGLE_THREAD_EXIT(R_OK);
+}
+
+/******************************************************************************
+ * Function:    SL_GetSpinStats
+ * Description: Return the low latency mode statistics, ie. the CPU time spent
+ *              spinning against the estimated latency saved.
+ * Thread Safe: No, API function, only allows one thread at a time.
+ * Returns:     Non.
+ ******************************************************************************/
+void    SL_GetSpinStats( SL_SPINSTATS    *spStats )    /* O: Statistics */
+{
+    SL_SINGLE_THREAD_ONLY;
+
+    /* Copy out the current figures.
+    */
+    memcpy((UCHAR *)spStats, (UCHAR *)&Sl.sSpin, sizeof(SL_SPINSTATS));
+
+    /* Finished, get out!!
+    */
+    return;
+}
+
+/******************************************************************************
+ * Function:    SL_Relay
+ * Description: Bind two connected channels together so that all data
+ *              arriving on one is sent out of the other, as is, in both
+ *              directions. Data is moved with splice() through a pipe per
+ *              direction and never enters user space, nor reaches the data
+ *              callbacks or any capture. Any part packet already received is
+ *              forwarded first. Closure or failure of either channel closes
+ *              the other once data held for it has been sent, the control
+ *              callbacks being invoked as normal.
+ * Thread Safe: No, API function, only allows one thread at a time.
+ * Returns:     R_OK     - Channels bound.
+ *              R_FAIL   - Couldnt bind, see Errno.
+ * <Errno>      E_INVCHANID - Invalid channel Id.
+ *              E_NOSERVICE - A channel isnt connected.
+ *              E_EXISTS    - A channel is already relayed.
+ *              E_BUSY      - Transmit data pending, retry later.
+ *              E_NOSOCKET  - Couldnt allocate relay pipes.
+ *              E_BADPARM   - Relaying not supported on this platform.
+ ******************************************************************************/
+int SL_Relay( UINT    nChanA,    /* I: First channel to bind */
+              UINT    nChanB )   /* I: Channel to bind it to */
+{
+    /* Local variables.
+    */
+    UINT            nNdx;
+    UINT            nRawMode;
+    int             nRet;
+    int             nPipes[2][2];
+    LINKLIST        *spNext;
+    SL_NETCONS      *spNetCon;
+    SL_NETCONS      *spChan[2];
+    char            *szFunc = "SL_Relay";
+
+    SL_SINGLE_THREAD_ONLY;
+
+    /* Locate both channels.
+    */
+    spChan[0] = spChan[1] = NULL;
+    for(spNetCon=(SL_NETCONS *)StartItem(Sl.spHead, &spNext); spNetCon != NULL;
+        spNetCon=(SL_NETCONS *)NextItem(&spNext))
+    {
+        if(spNetCon->nChanId == nChanA) spChan[0] = spNetCon;
+        if(spNetCon->nChanId == nChanB) spChan[1] = spNetCon;
+    }
+    if(spChan[0] == NULL || spChan[1] == NULL || nChanA == nChanB)
+    {
+        Errno = E_INVCHANID;
+        SL_SINGLE_THREAD_EXIT(R_FAIL);
+    }
+
+    /* Both must be live, unbound connections. Any part packet received
+     * will be sent raw, which needs an idle transmit side.
+    */
+    for(nNdx=0; nNdx < 2; nNdx++)
+    {
+        if(spChan[nNdx]->nStatus != SSL_UP || spChan[nNdx]->nClose == TRUE)
+        {
+            Errno = E_NOSERVICE;
+            SL_SINGLE_THREAD_EXIT(R_FAIL);
+        }
+        if(spChan[nNdx]->spRelayPeer != NULL)
+        {
+            Errno = E_EXISTS;
+            SL_SINGLE_THREAD_EXIT(R_FAIL);
+        }
+        if(spChan[1-nNdx]->nRecvLen > 0 &&
+           (spChan[nNdx]->spXmitBuf != NULL ||
+            spChan[nNdx]->spFrameHead != NULL))
+        {
+            Errno = E_BUSY;
+            SL_SINGLE_THREAD_EXIT(R_FAIL);
+        }
+    }
+
+#if defined(LINUX)
+    /* Create a relay pipe for each direction.
+    */
+    if(pipe(nPipes[0]) < 0)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt create relay pipe (%d)", errno);
+        Errno = E_NOSOCKET;
+        SL_SINGLE_THREAD_EXIT(R_FAIL);
+    }
+    if(pipe(nPipes[1]) < 0)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt create relay pipe (%d)", errno);
+        close(nPipes[0][0]);
+        close(nPipes[0][1]);
+        Errno = E_NOSOCKET;
+        SL_SINGLE_THREAD_EXIT(R_FAIL);
+    }
+
+    /* Bind.
+    */
+    for(nNdx=0; nNdx < 2; nNdx++)
+    {
+        spChan[nNdx]->nRelayRd = nPipes[nNdx][0];
+        spChan[nNdx]->nRelayWr = nPipes[nNdx][1];
+        spChan[nNdx]->nRelayPend = 0;
+        spChan[nNdx]->lRelayIn = 0L;
+        spChan[nNdx]->lRelayOut = 0L;
+        spChan[nNdx]->spRelayPeer = spChan[1-nNdx];
+    }
+
+    /* Forward anything already received but not yet a whole packet.
+    */
+    for(nNdx=0; nNdx < 2; nNdx++)
+    {
+        if(spChan[nNdx]->nRecvLen > 0)
+        {
+            nRawMode = spChan[1-nNdx]->nRawMode;
+            spChan[1-nNdx]->nRawMode = TRUE;
+            nRet = SL_SendData(spChan[1-nNdx]->nChanId, spChan[nNdx]->spRecvBuf,
+                               spChan[nNdx]->nRecvLen);
+            spChan[1-nNdx]->nRawMode = nRawMode;
+            if(nRet == R_OK)
+            {
+                spChan[nNdx]->lRelayIn += spChan[nNdx]->nRecvLen;
+                spChan[1-nNdx]->lRelayOut += spChan[nNdx]->nRecvLen;
+            } else
+             {
+                Lgr(LOG_DEBUG, szFunc,
+                    "Couldnt forward (%d) bytes from channel (%d)",
+                    spChan[nNdx]->nRecvLen, spChan[nNdx]->nChanId);
+            }
+            spChan[nNdx]->nRecvLen = 0;
+        }
+    }
+
+    /* Finished, get out!!
+    */
+    SL_SINGLE_THREAD_EXIT(R_OK);
+#else
+    Lgr(LOG_DEBUG, szFunc, "Relaying not supported on this platform");
+    Errno = E_BADPARM;
+    SL_SINGLE_THREAD_EXIT(R_FAIL);
+#endif
+}
+
+/******************************************************************************
+ * Function:    SL_GetRelayStats
+ * Description: Get the byte counters of a relayed channel. The counters
+ *              remain readable after the relay has broken, until the channel
+ *              itself is closed.
+ * Thread Safe: No, API function, only allows one thread at a time.
+ * Returns:     R_OK     - Statistics returned.
+ *              R_FAIL   - Illegal channel Id, see Errno.
+ * <Errno>      E_INVCHANID - Invalid channel Id.
+ ******************************************************************************/
+int SL_GetRelayStats( UINT             nChanId,    /* I: Channel to query */
+                      SL_RELAYSTATS    *spStats )  /* O: Statistics */
+{
+    /* Local variables.
+    */
+    LINKLIST        *spNext;
+    SL_NETCONS      *spNetCon;
+
+    SL_SINGLE_THREAD_ONLY;
+
+    /* Locate channel.
+    */
+    for(spNetCon=(SL_NETCONS *)StartItem(Sl.spHead, &spNext);
+        spNetCon != NULL && spNetCon->nChanId != nChanId;
+        spNetCon=(SL_NETCONS *)NextItem(&spNext));
+    if(spNetCon == NULL)
+    {
+        Errno = E_INVCHANID;
+        SL_SINGLE_THREAD_EXIT(R_FAIL);
+    }
+
+    /* Copy out the current figures.
+    */
+    spStats->nPeerChanId = (spNetCon->spRelayPeer == NULL ? 0 :
+                                               spNetCon->spRelayPeer->nChanId);
+    spStats->nPending = spNetCon->nRelayPend;
+    spStats->lBytesIn = spNetCon->lRelayIn;
+    spStats->lBytesOut = spNetCon->lRelayOut;
+
+    /* Finished, get out!!
+    */
+    SL_SINGLE_THREAD_EXIT(R_OK);
+}
+
 /******************************************************************************
  * Function:    SL_Poll
  * Description: Function for programs which cant afford UX taking control of
@@ -37,6 +37,7 @@
 #define    UX_COMMS_H
 
 #define    SL_SINGLE_THREAD_ONLY
+#define    SL_SINGLE_THREAD_EXIT(r)    return(r)
 #define    SL_THREAD_ONLY
 
 
@@ -96,6 +97,12 @@
 #define    DEF_MAXBLOCKPERIOD    10000   /* Default max select sleep period in mS */
 #define    DEF_CONWAITPER        50      /* Default wait period for reconnect */
 #define    DEF_CONFAILPER        30000   /* Default wait period for a fail */
+#define    DEF_SPINMAX           200     /* Default max low latency spin in uS */
+#define    DEF_SPINMIN           10      /* Floor of adaptive spin budget in uS */
+#define    DEF_WAKEUPUS          50      /* Initial wakeup latency estimate in uS */
+#define    DEF_RELAYCHUNK        65536   /* Max bytes moved by one relay splice */
+#define    DEF_DNSCACHESIZE      256     /* Hostnames held by SL_GetIPaddr */
+#define    DEF_DNSCACHETTL       60000   /* Life of a cached hostname in mS */
 
 /* Communications framing characters.
 */
@@ -103,6 +110,17 @@
 #define    A_ETX                 0x03    /* End of Text */
 #define    A_SYN                 0x22    /* Synchronise */
 
+/* Traffic capture file format. A file header of SLCAP_MAGIC, a version
+ * byte and padding to SLCAP_HDRLEN, followed by one record per frame:
+ * <SECS 4><USECS 4><CHANID 4><DIR 1><LEN 4><..DATA..>, integers MSB first.
+*/
+#define    SLCAP_MAGIC           "SLCAP" /* Identifies a capture file */
+#define    SLCAP_VERSION         1       /* Capture format version */
+#define    SLCAP_HDRLEN          8       /* Size of file header */
+#define    SLCAP_RECHDRLEN       17      /* Size of record header */
+#define    SLCAP_RECV            'R'     /* Frame received on channel */
+#define    SLCAP_SEND            'S'     /* Frame sent on channel */
+
 /* Timer callback option flags. 
 */
 #define    TCB_OFF               0       /* Disable callback */
@@ -161,10 +179,26 @@ typedef struct {
     ULNG    lCBData;                     /* Callback specific data */
 } SL_CALLIST;
 
+/* Timer callbacks are scanned on every poll, so they are held by value in a
+ * contiguous vector rather than a linked list.
+*/
+UX_VECTOR(SL_CBVEC, SL_CALLIST)
+
+/* A structure to define a shared, immutable transmit frame. The frame is
+ * built (framed and CRC'd) once and can then be queued on any number of
+ * channels, each queue holding a reference. The frame is freed when the
+ * last reference is released, ie. the last channel has transmitted it.
+*/
+typedef struct {
+    UINT    nRefCnt;                     /* Number of outstanding references */
+    UINT    nDataLen;                    /* Length of user data within frame */
+    UCHAR   *spFrame;                    /* <SYN><SYN><STX><LEN><DATA><ETX><CRC> */
+} SL_FRAME;
+
 /* A structure to define and maintain a connection, either server of client
  * with its opposite on another process.
 */
-typedef struct {
+typedef struct _SL_NETCONS {
     UINT    nChanId;                     /* Internal channel Id associated with link */
     UINT    nClose;                      /* Flag for sync socket closure */
     UINT    nForkForAccept;              /* Fork a child prior to every accept on srv port */
@@ -182,20 +216,57 @@ typedef struct {
     UCHAR   cCorS;                       /* (C) or (S)erver */
     UCHAR   *spRecvBuf;                  /* Flat, dynamic expand/shrink receive buffer */
     UCHAR   *spXmitBuf;                  /* Singular xmit buffer, to contain 1 packet */
+    SL_FRAME *spXmitFrame;               /* Shared frame owning spXmitBuf, if any */
+    LINKLIST *spFrameHead;               /* Head of queue of shared frames to xmit */
+    LINKLIST *spFrameTail;               /* Tail ... */
+    int     nRelayRd;                    /* Read end of relay pipe into this channel */
+    int     nRelayWr;                    /* Write end ..., -1 = not relaying */
+    UINT    nRelayPend;                  /* Bytes in relay pipe awaiting xmit */
+    ULNG    lRelayIn;                    /* Bytes relayed from this channel to peer */
+    ULNG    lRelayOut;                   /* Bytes relayed to this channel from peer */
+    struct _SL_NETCONS *spRelayPeer;     /* Channel bound to this one by SL_Relay */
+    LISTHANDLE spHandle;                 /* Element in channel list, for removal */
     UCHAR   szServerName[MAX_SERVERNAME+1];/* Name of server */
     void    (*nDataCallback)();          /* Function to call with data */
     void    (*nCntrlCallback)(int, ...); /* Function to call with out-of-band info */
 } SL_NETCONS;
 
+/* Byte counters of a relayed channel, as returned by SL_GetRelayStats.
+*/
+typedef struct {
+    UINT    nPeerChanId;                 /* Channel relayed to, 0 = relay broken */
+    UINT    nPending;                    /* Bytes held for xmit on this channel */
+    ULNG    lBytesIn;                    /* Bytes read here and relayed to peer */
+    ULNG    lBytesOut;                   /* Bytes from peer written out here */
+} SL_RELAYSTATS;
+
+/* Statistics for the low latency spin-then-block mode. The wakeup latency
+ * is measured from the overshoot of timed out blocking waits, the latency
+ * saved is that figure multiplied by the number of spins which found data.
+*/
+typedef struct {
+    ULNG    lSpinBudget;                 /* Current adaptive spin budget, uS */
+    ULNG    lSpinCount;                  /* Number of spin periods executed */
+    ULNG    lSpinHits;                   /* Spin periods which found data */
+    ULNG    lSpinUs;                     /* Total CPU time spent spinning, uS */
+    ULNG    lWakeupUs;                   /* Measured blocking wakeup latency, uS */
+    ULNG    lSavedUs;                    /* Estimated total latency saved, uS */
+} SL_SPINSTATS;
+
 /* Global variables for the Comms module.
 */
 typedef struct {
     LINKLIST    *spHead;                 /* Head of LinkedList containing connections */
     LINKLIST    *spTail;                 /* Tail ... */
-    LINKLIST    *spCBHead;               /* Head of LinkedList containing timer callbacks */
-    LINKLIST    *spCBTail;               /* Tail ... */
+    SL_CBVEC    sTimers;                 /* Vector of timer callbacks */
+    UX_CACHE    *spDnsCache;             /* Hostname to IP address cache */
     UINT        nCloseDown;              /* Shutdown in progress flag */
     UINT        nSockKeepAlive;          /* Time to keep socket alive */
+    UINT        nLowLatency;             /* Spin prior to blocking in select */
+    ULNG        lSpinMax;                /* Upper limit of spin budget, uS */
+    SL_SPINSTATS sSpin;                  /* Low latency mode statistics */
+    FILE        *fpCapture;              /* Traffic capture file, NULL = off */
+    UCHAR       szCapFile[MAX_PATHLEN+1];/* Name of capture file */
 } SL_GLOBALS;
 
 /* Prototypes for functions internal to SocketLib module.
@@ -209,6 +280,16 @@ int     _SL_Close( SL_NETCONS *, UINT );
 int     _SL_ConnectToServer( SL_NETCONS * );
 int     _SL_ReceiveFromSocket( SL_NETCONS * );
 int     _SL_ProcessRecvBuf( SL_NETCONS * );
+void    _SL_LoadFrame( SL_NETCONS * );
+void    _SL_FreeXmit( SL_NETCONS *, UINT );
+int     _SL_RelayFlush( SL_NETCONS * );
+int     _SL_RelayRecv( SL_NETCONS * );
+void    _SL_RelayBreak( SL_NETCONS * );
+void    _SL_Capture( UINT, UCHAR, UCHAR *, UINT );
+ULNG    _SL_GetTimeUs( void );
+#if defined(UX_COMMS_C)
+int     _SL_SpinWait( fd_set * );
+#endif
 int     _SL_ProcessWaitingPorts( ULNG );
 ULNG    _SL_ProcessCallbacks( void );
 
@@ -230,6 +311,16 @@ int     SL_DelClient( UINT );
 int     SL_Close( UINT );
 int     SL_SendData( UINT, UCHAR *, UINT );
 int     SL_BlockSendData( UINT, UCHAR *, UINT );
+SL_FRAME *SL_CreateFrame( UCHAR *, UINT );
+void    SL_ReleaseFrame( SL_FRAME * );
+int     SL_SendFrame( UINT, SL_FRAME * );
+int     SL_BroadcastData( UINT *, UINT, UCHAR *, UINT );
+int     SL_CaptureStart( UCHAR * );
+int     SL_CaptureStop( void );
+int     SL_LowLatency( UINT, ULNG );
+void    SL_GetSpinStats( SL_SPINSTATS * );
+int     SL_Relay( UINT, UINT );
+int     SL_GetRelayStats( UINT, SL_RELAYSTATS * );
 int     SL_Poll( ULNG );
 int     SL_Kernel( void );
 
@@ -45,6 +45,14 @@
 #define    SORT_LONG_DOWN   4        /* Linklist sorted decrementally on long */
 #define    SORT_CHAR_UP     5        /* Linklist sorted on alpha string */
 #define    SORT_CHAR_DOWN   6        /* Linklist sorted in reverseo on alpha string*/
+#define    SORT_MASK        0x00ff   /* Sort mode bits of a list mode */
+#define    LST_SKIPLIST     0x0100   /* Index a sorted list with a skip list */
+#define    LST_HASH_NKEY    0x0200   /* Index list with a hash on nKey */
+#define    LST_HASH_LKEY    0x0400   /* Index list with a hash on lKey */
+#define    LST_HASH_SZKEY   0x0800   /* Index list with a hash on szKey */
+#define    LST_INDEXMASK    0x0f00   /* All index bits of a list mode */
+#define    LLA_SLAB         0        /* List elements allocated from slabs */
+#define    LLA_MALLOC       1        /* List elements and keys malloc'd */
 
 /* Logger definitions. Define's mode and level logger operates at.
 */
@@ -76,13 +84,50 @@
 /* Define prototypes for functions globally available.
 */
 int        AddItem(LINKLIST **, LINKLIST **, int, UINT *, ULNG *, UCHAR *, void *);
+int        AddItemWithHandle( LINKLIST **, LINKLIST **, int, UINT *, ULNG *,
+                              UCHAR *, void *, LISTHANDLE * );
+int        AddItems( LINKLIST **, LINKLIST **, int, UINT *, ULNG *, UCHAR **,
+                     void **, UINT );
 int        DelItem( LINKLIST **, LINKLIST **, void *, UINT *, ULNG *, UCHAR * );
+int        DelItemByHandle( LINKLIST **, LINKLIST **, LISTHANDLE );
 void      *FindItem( LINKLIST *, UINT *, ULNG *, UCHAR * );
 void      *StartItem( LINKLIST *, LINKLIST ** );
 void      *NextItem( LINKLIST ** );
+LISTHANDLE CurrentHandle( LINKLIST *, LINKLIST * );
 int        MergeLists( LINKLIST **, LINKLIST **, LINKLIST *, LINKLIST *, int );
 int        DelList( LINKLIST **, LINKLIST ** );
+int        DelListWithFree( LINKLIST **, LINKLIST **, void (*)(void *) );
 int        SizeList( LINKLIST *, UINT * );
+int        SetListAlloc( UINT );
+int        GetListAllocStats( LISTALLOCSTATS * );
+#if defined(UX_LINKEDLIST_C)
+int        _LL_Compare( int, LINKLIST *, LINKLIST * );
+LINKLIST **_LL_SkipLink( LISTCTL *, LINKLIST **, LINKLIST *, UINT );
+UINT       _LL_RandomLevel( LISTCTL * );
+LINKLIST  *_LL_SkipSeek( LINKLIST **, LINKLIST * );
+void       _LL_SkipUnlink( LINKLIST **, LINKLIST * );
+ULNG       _LL_KeyPrefix( UCHAR * );
+int        _LL_IsSorted( LINKLIST *, int );
+void       _LL_SkipRebuild( LINKLIST * );
+UINT       _LL_HashKey( UINT, LINKLIST * );
+int        _LL_HashSame( UINT, LINKLIST *, LINKLIST * );
+LISTSLOT  *_LL_HashSlot( LISTHASH *, UINT, LINKLIST * );
+void       _LL_HashAdd( LISTCTL *, LINKLIST *, LINKLIST * );
+void       _LL_HashDel( LISTCTL *, LINKLIST * );
+LINKLIST **_LL_HashFind( LISTCTL *, UINT *, ULNG *, UCHAR * );
+void       _LL_FreeCtl( LISTCTL * );
+void       _LL_DropSkip( LINKLIST * );
+void       _LL_DropIndex( LINKLIST * );
+int        _LL_Insert( LINKLIST **, LINKLIST **, int, LINKLIST * );
+void       _LL_Unlink( LINKLIST **, LINKLIST **, LINKLIST * );
+void       _LL_Lock( void );
+void       _LL_Unlock( void );
+int        _LL_AddSlab( UINT );
+void       _LL_Reserve( ULNG );
+LINKLIST  *_LL_NewNode( void );
+LINKLIST  *_LL_MakeNode( UINT *, ULNG *, UCHAR *, void * );
+void       _LL_FreeNode( LINKLIST * );
+#endif
 int        PutCharFromLong( UCHAR *, ULNG );
 int        PutCharFromInt( UCHAR *, UINT );
 ULNG       GetLongFromChar( UCHAR * );
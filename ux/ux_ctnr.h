@@ -0,0 +1,470 @@
+/******************************************************************************
+ * Product:       #     # #     #         #         ###   ######
+ *                #     #  #   #          #          #    #     #
+ *                #     #   # #           #          #    #     #
+ *                #     #    #            #          #    ######
+ *                #     #   # #           #          #    #     #
+ *                #     #  #   #          #          #    #     #
+ *                 #####  #     # ####### #######   ###   ######
+ *
+ * File:          ux_ctnr.h
+ * Description:   Type specialised containers, generated by macro for a given
+ *                element and key type so that elements are held by value in
+ *                contiguous storage and comparisons compile inline. A
+ *                vector, an intrusive list, a hash map and a min heap.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1994-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    UX_CTNR_H
+#define    UX_CTNR_H
+
+/* Generated functions allocate with realloc and move elements with
+ * memmove, so bring in their declarations for every module which expands
+ * a container.
+*/
+#include    <stdlib.h>
+#include    <string.h>
+
+/* Generated functions are inlined where the compiler allows, and being
+ * static, each module only carries the ones it uses.
+*/
+#if defined(__GNUC__)
+#define    UX_CTNR_FN       static __inline__
+#else
+#define    UX_CTNR_FN       static
+#endif
+
+/* Sizing of the containers.
+*/
+#define    UX_CTNR_INIT     8        /* Initial slots of a vector/heap/map */
+
+/* Helpers for hash map keys.
+*/
+#define    UX_HASH_UINT(k)  (((UINT)(k) * 2654435761U) ^ \
+                             (((UINT)(k) * 2654435761U) >> 16))
+#define    UX_HASH_ULNG(k)  UX_HASH_UINT((UINT)(k) ^ \
+                                  (UINT)(((ULNG)(k) >> 16) >> 16))
+#define    UX_EQ(a, b)      ((a) == (b))
+#define    UX_LESS(a, b)    (*(a) < *(b))
+
+/******************************************************************************
+ * Vector.  UX_VECTOR(NAME, TYPE)
+ *
+ * A contiguous, growable array of TYPE.
+ *   void  NAME_Init(NAME *)                 - Initialise an empty vector.
+ *   int   NAME_Reserve(NAME *, UINT)        - Ensure room for n elements.
+ *   TYPE *NAME_Push(NAME *, TYPE)           - Append, NULL on E_NOMEM.
+ *   TYPE *NAME_At(NAME *, UINT)             - Element n, NULL if out of range.
+ *   void  NAME_Remove(NAME *, UINT)         - Remove n, keeping order.
+ *   void  NAME_RemoveFast(NAME *, UINT)     - Remove n, last takes its place.
+ *   void  NAME_Free(NAME *)                 - Release storage.
+ * Pointers into a vector are invalidated by Push/Reserve, index instead
+ * wherever the vector may grow.
+ ******************************************************************************/
+#define UX_VECTOR(NAME, TYPE)                                                  \
+typedef struct {                                                               \
+    UINT        nCount;                 /* Elements in use */                  \
+    UINT        nSize;                  /* Elements allocated */               \
+    TYPE        *spItem;                /* Storage */                          \
+} NAME;                                                                        \
+                                                                               \
+UX_CTNR_FN void NAME##_Init( NAME *spVec )                                     \
+{                                                                              \
+    spVec->nCount = spVec->nSize = 0;                                          \
+    spVec->spItem = NULL;                                                      \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN int NAME##_Reserve( NAME *spVec, UINT nSize )                       \
+{                                                                              \
+    TYPE        *spNew;                                                        \
+                                                                               \
+    if(nSize <= spVec->nSize)                                                  \
+        return(R_OK);                                                          \
+    if((spNew=(TYPE *)realloc(spVec->spItem, sizeof(TYPE) * nSize)) == NULL)   \
+    {                                                                          \
+        Errno = E_NOMEM;                                                       \
+        return(R_FAIL);                                                        \
+    }                                                                          \
+    spVec->spItem = spNew;                                                     \
+    spVec->nSize = nSize;                                                      \
+    return(R_OK);                                                              \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN TYPE *NAME##_Push( NAME *spVec, TYPE sItem )                        \
+{                                                                              \
+    if(spVec->nCount == spVec->nSize &&                                        \
+       NAME##_Reserve(spVec, spVec->nSize ? spVec->nSize * 2 : UX_CTNR_INIT)   \
+                                                                   == R_FAIL)  \
+        return(NULL);                                                          \
+    spVec->spItem[spVec->nCount] = sItem;                                      \
+    return(&spVec->spItem[spVec->nCount++]);                                   \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN TYPE *NAME##_At( NAME *spVec, UINT nNdx )                           \
+{                                                                              \
+    return(nNdx < spVec->nCount ? &spVec->spItem[nNdx] : NULL);                \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN void NAME##_Remove( NAME *spVec, UINT nNdx )                        \
+{                                                                              \
+    if(nNdx >= spVec->nCount)                                                  \
+        return;                                                                \
+    memmove(&spVec->spItem[nNdx], &spVec->spItem[nNdx+1],                      \
+            sizeof(TYPE) * (spVec->nCount - nNdx - 1));                        \
+    spVec->nCount--;                                                           \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN void NAME##_RemoveFast( NAME *spVec, UINT nNdx )                    \
+{                                                                              \
+    if(nNdx >= spVec->nCount)                                                  \
+        return;                                                                \
+    spVec->spItem[nNdx] = spVec->spItem[--spVec->nCount];                      \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN void NAME##_Free( NAME *spVec )                                     \
+{                                                                              \
+    if(spVec->spItem != NULL)                                                  \
+        free(spVec->spItem);                                                   \
+    NAME##_Init(spVec);                                                        \
+}
+
+/******************************************************************************
+ * Intrusive list.  UX_ILIST(NAME, TYPE, LINK)
+ *
+ * A doubly linked list threaded through a UX_ILINK(TYPE) member named LINK
+ * within TYPE, so membership costs no allocation. An element may be on
+ * one list per link member.
+ *   void  NAME_Init(NAME *)                 - Initialise an empty list.
+ *   void  NAME_PushBack(NAME *, TYPE *)     - Link at tail.
+ *   void  NAME_PushFront(NAME *, TYPE *)    - Link at head.
+ *   void  NAME_Remove(NAME *, TYPE *)       - Unlink, O(1).
+ *   TYPE *NAME_First(NAME *)                - Head, NULL if empty.
+ *   TYPE *NAME_Next(TYPE *)                 - Follower, NULL at tail.
+ * Take the follower before removing an element whilst iterating.
+ ******************************************************************************/
+#define UX_ILINK(TYPE)                                                         \
+struct {                                                                       \
+    TYPE        *spNext;                                                       \
+    TYPE        *spPrev;                                                       \
+}
+
+#define UX_ILIST(NAME, TYPE, LINK)                                             \
+typedef struct {                                                               \
+    UINT        nCount;                 /* Elements linked */                  \
+    TYPE        *spHead;                /* First element */                    \
+    TYPE        *spTail;                /* Last element */                     \
+} NAME;                                                                        \
+                                                                               \
+UX_CTNR_FN void NAME##_Init( NAME *spList )                                    \
+{                                                                              \
+    spList->nCount = 0;                                                        \
+    spList->spHead = spList->spTail = NULL;                                    \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN void NAME##_PushBack( NAME *spList, TYPE *spItem )                  \
+{                                                                              \
+    spItem->LINK.spNext = NULL;                                                \
+    if((spItem->LINK.spPrev = spList->spTail) == NULL)                         \
+        spList->spHead = spItem;                                               \
+    else                                                                       \
+        spList->spTail->LINK.spNext = spItem;                                  \
+    spList->spTail = spItem;                                                   \
+    spList->nCount++;                                                          \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN void NAME##_PushFront( NAME *spList, TYPE *spItem )                 \
+{                                                                              \
+    spItem->LINK.spPrev = NULL;                                                \
+    if((spItem->LINK.spNext = spList->spHead) == NULL)                         \
+        spList->spTail = spItem;                                               \
+    else                                                                       \
+        spList->spHead->LINK.spPrev = spItem;                                  \
+    spList->spHead = spItem;                                                   \
+    spList->nCount++;                                                          \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN void NAME##_Remove( NAME *spList, TYPE *spItem )                    \
+{                                                                              \
+    if(spItem->LINK.spPrev == NULL)                                            \
+        spList->spHead = spItem->LINK.spNext;                                  \
+    else                                                                       \
+        spItem->LINK.spPrev->LINK.spNext = spItem->LINK.spNext;                \
+    if(spItem->LINK.spNext == NULL)                                            \
+        spList->spTail = spItem->LINK.spPrev;                                  \
+    else                                                                       \
+        spItem->LINK.spNext->LINK.spPrev = spItem->LINK.spPrev;                \
+    spItem->LINK.spNext = spItem->LINK.spPrev = NULL;                          \
+    spList->nCount--;                                                          \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN TYPE *NAME##_First( NAME *spList )                                  \
+{                                                                              \
+    return(spList->spHead);                                                    \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN TYPE *NAME##_Next( TYPE *spItem )                                   \
+{                                                                              \
+    return(spItem->LINK.spNext);                                               \
+}
+
+/******************************************************************************
+ * Hash map.  UX_HASHMAP(NAME, KTYPE, VTYPE, HASHFN, EQFN)
+ *
+ * An open addressed map from KTYPE to VTYPE, both held by value in one
+ * table. HASHFN(key) gives a UINT hash, EQFN(a, b) is non zero for equal
+ * keys. Kept at most half full, removal shifts entries back rather than
+ * leaving tombstones.
+ *   void   NAME_Init(NAME *)                - Initialise an empty map.
+ *   VTYPE *NAME_Get(NAME *, KTYPE)          - Value of key, NULL if absent.
+ *   VTYPE *NAME_Put(NAME *, KTYPE, VTYPE)   - Add or replace, NULL on E_NOMEM.
+ *   int    NAME_Del(NAME *, KTYPE)          - Remove, R_FAIL if absent.
+ *   NAME_ENTRY *NAME_Next(NAME *, UINT *)   - Iterate, start at 0, NULL at end.
+ *   void   NAME_Free(NAME *)                - Release storage.
+ * Pointers into a map are invalidated by Put and Del.
+ ******************************************************************************/
+#define UX_HASHMAP(NAME, KTYPE, VTYPE, HASHFN, EQFN)                           \
+typedef struct {                                                               \
+    UINT        nUsed;                  /* Slot occupied */                    \
+    KTYPE       sKey;                                                          \
+    VTYPE       sVal;                                                          \
+} NAME##_ENTRY;                                                                \
+                                                                               \
+typedef struct {                                                               \
+    UINT        nCount;                 /* Entries held */                     \
+    UINT        nSize;                  /* Slots, power of 2 */                \
+    NAME##_ENTRY *spSlot;               /* Table */                            \
+} NAME;                                                                        \
+                                                                               \
+UX_CTNR_FN void NAME##_Init( NAME *spMap )                                     \
+{                                                                              \
+    spMap->nCount = spMap->nSize = 0;                                          \
+    spMap->spSlot = NULL;                                                      \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN NAME##_ENTRY *NAME##_Slot( NAME *spMap, KTYPE sKey )                \
+{                                                                              \
+    UINT        nMask = spMap->nSize - 1;                                      \
+    UINT        nNdx;                                                          \
+                                                                               \
+    for(nNdx=(UINT)(HASHFN(sKey)) & nMask;                                     \
+        spMap->spSlot[nNdx].nUsed && !(EQFN(spMap->spSlot[nNdx].sKey, sKey));  \
+        nNdx=(nNdx + 1) & nMask);                                              \
+    return(&spMap->spSlot[nNdx]);                                              \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN VTYPE *NAME##_Get( NAME *spMap, KTYPE sKey )                        \
+{                                                                              \
+    NAME##_ENTRY *spEnt;                                                       \
+                                                                               \
+    if(spMap->nCount == 0)                                                     \
+        return(NULL);                                                          \
+    spEnt = NAME##_Slot(spMap, sKey);                                          \
+    return(spEnt->nUsed ? &spEnt->sVal : NULL);                                \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN VTYPE *NAME##_Put( NAME *spMap, KTYPE sKey, VTYPE sVal )            \
+{                                                                              \
+    UINT        nNdx;                                                          \
+    NAME        sNew;                                                          \
+    NAME##_ENTRY *spEnt;                                                       \
+                                                                               \
+    if((spMap->nCount + 1) * 2 > spMap->nSize)                                 \
+    {                                                                          \
+        sNew.nCount = spMap->nCount;                                           \
+        sNew.nSize = (spMap->nSize ? spMap->nSize * 2 : UX_CTNR_INIT);         \
+        if((sNew.spSlot=(NAME##_ENTRY *)calloc(sNew.nSize,                     \
+                                        sizeof(NAME##_ENTRY))) == NULL)        \
+        {                                                                      \
+            Errno = E_NOMEM;                                                   \
+            return(NULL);                                                      \
+        }                                                                      \
+        for(nNdx=0; nNdx < spMap->nSize; nNdx++)                               \
+        {                                                                      \
+            if(spMap->spSlot[nNdx].nUsed)                                      \
+                *NAME##_Slot(&sNew, spMap->spSlot[nNdx].sKey) =                \
+                                                     spMap->spSlot[nNdx];      \
+        }                                                                      \
+        if(spMap->spSlot != NULL)                                              \
+            free(spMap->spSlot);                                               \
+        *spMap = sNew;                                                         \
+    }                                                                          \
+    if((spEnt=NAME##_Slot(spMap, sKey))->nUsed == 0)                           \
+    {                                                                          \
+        spEnt->nUsed = 1;                                                      \
+        spEnt->sKey = sKey;                                                    \
+        spMap->nCount++;                                                       \
+    }                                                                          \
+    spEnt->sVal = sVal;                                                        \
+    return(&spEnt->sVal);                                                      \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN int NAME##_Del( NAME *spMap, KTYPE sKey )                           \
+{                                                                              \
+    UINT        nMask = spMap->nSize - 1;                                      \
+    UINT        nHole;                                                         \
+    UINT        nNdx;                                                          \
+    UINT        nHome;                                                         \
+    NAME##_ENTRY *spEnt;                                                       \
+                                                                               \
+    if(spMap->nCount == 0 || (spEnt=NAME##_Slot(spMap, sKey))->nUsed == 0)     \
+    {                                                                          \
+        Errno = E_NODATA;                                                      \
+        return(R_FAIL);                                                        \
+    }                                                                          \
+                                                                               \
+    /* Empty the slot, then move back any following entry which could no    \
+     * longer be reached past the hole.                                      \
+    */                                                                         \
+    nHole = (UINT)(spEnt - spMap->spSlot);                                     \
+    spEnt->nUsed = 0;                                                          \
+    spMap->nCount--;                                                           \
+    for(nNdx=(nHole + 1) & nMask; spMap->spSlot[nNdx].nUsed;                   \
+        nNdx=(nNdx + 1) & nMask)                                               \
+    {                                                                          \
+        nHome = (UINT)(HASHFN(spMap->spSlot[nNdx].sKey)) & nMask;              \
+        if(nHole <= nNdx ? (nHole < nHome && nHome <= nNdx) :                  \
+                           (nHole < nHome || nHome <= nNdx))                   \
+            continue;                                                          \
+        spMap->spSlot[nHole] = spMap->spSlot[nNdx];                            \
+        spMap->spSlot[nNdx].nUsed = 0;                                         \
+        nHole = nNdx;                                                          \
+    }                                                                          \
+    return(R_OK);                                                              \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN NAME##_ENTRY *NAME##_Next( NAME *spMap, UINT *nIter )               \
+{                                                                              \
+    for(; *nIter < spMap->nSize; (*nIter)++)                                   \
+    {                                                                          \
+        if(spMap->spSlot[*nIter].nUsed)                                        \
+            return(&spMap->spSlot[(*nIter)++]);                                \
+    }                                                                          \
+    return(NULL);                                                              \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN void NAME##_Free( NAME *spMap )                                     \
+{                                                                              \
+    if(spMap->spSlot != NULL)                                                  \
+        free(spMap->spSlot);                                                   \
+    NAME##_Init(spMap);                                                        \
+}
+
+/******************************************************************************
+ * Min heap.  UX_HEAP(NAME, TYPE, LESSFN)
+ *
+ * A binary heap of TYPE in a contiguous array, LESSFN(&a, &b) being non
+ * zero when a must come out before b.
+ *   void  NAME_Init(NAME *)                 - Initialise an empty heap.
+ *   int   NAME_Push(NAME *, TYPE)           - Add, R_FAIL on E_NOMEM.
+ *   TYPE *NAME_Top(NAME *)                  - Least element, NULL if empty.
+ *   int   NAME_Pop(NAME *, TYPE *)          - Remove least, R_FAIL if empty.
+ *   void  NAME_Free(NAME *)                 - Release storage.
+ ******************************************************************************/
+#define UX_HEAP(NAME, TYPE, LESSFN)                                            \
+typedef struct {                                                               \
+    UINT        nCount;                 /* Elements held */                    \
+    UINT        nSize;                  /* Elements allocated */               \
+    TYPE        *spItem;                /* Storage, heap ordered */            \
+} NAME;                                                                        \
+                                                                               \
+UX_CTNR_FN void NAME##_Init( NAME *spHeap )                                    \
+{                                                                              \
+    spHeap->nCount = spHeap->nSize = 0;                                        \
+    spHeap->spItem = NULL;                                                     \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN int NAME##_Push( NAME *spHeap, TYPE sItem )                         \
+{                                                                              \
+    UINT        nNdx;                                                          \
+    UINT        nSize;                                                         \
+    TYPE        *spNew;                                                        \
+                                                                               \
+    if(spHeap->nCount == spHeap->nSize)                                        \
+    {                                                                          \
+        nSize = (spHeap->nSize ? spHeap->nSize * 2 : UX_CTNR_INIT);            \
+        if((spNew=(TYPE *)realloc(spHeap->spItem, sizeof(TYPE) * nSize))       \
+                                                                     == NULL)  \
+        {                                                                      \
+            Errno = E_NOMEM;                                                   \
+            return(R_FAIL);                                                    \
+        }                                                                      \
+        spHeap->spItem = spNew;                                                \
+        spHeap->nSize = nSize;                                                 \
+    }                                                                          \
+                                                                               \
+    /* Sift up.                                                              \
+    */                                                                         \
+    for(nNdx=spHeap->nCount++;                                                 \
+        nNdx > 0 && LESSFN(&sItem, &spHeap->spItem[(nNdx-1)/2]);               \
+        nNdx=(nNdx-1)/2)                                                       \
+    {                                                                          \
+        spHeap->spItem[nNdx] = spHeap->spItem[(nNdx-1)/2];                     \
+    }                                                                          \
+    spHeap->spItem[nNdx] = sItem;                                              \
+    return(R_OK);                                                              \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN TYPE *NAME##_Top( NAME *spHeap )                                    \
+{                                                                              \
+    return(spHeap->nCount ? &spHeap->spItem[0] : NULL);                        \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN int NAME##_Pop( NAME *spHeap, TYPE *spItem )                        \
+{                                                                              \
+    UINT        nNdx;                                                          \
+    UINT        nChild;                                                        \
+    TYPE        sLast;                                                         \
+                                                                               \
+    if(spHeap->nCount == 0)                                                    \
+    {                                                                          \
+        Errno = E_NODATA;                                                      \
+        return(R_FAIL);                                                        \
+    }                                                                          \
+    if(spItem != NULL)                                                         \
+        *spItem = spHeap->spItem[0];                                           \
+    sLast = spHeap->spItem[--spHeap->nCount];                                  \
+                                                                               \
+    /* Sift the last element down from the root.                             \
+    */                                                                         \
+    for(nNdx=0; (nChild=nNdx*2+1) < spHeap->nCount; nNdx=nChild)               \
+    {                                                                          \
+        if(nChild+1 < spHeap->nCount &&                                        \
+           LESSFN(&spHeap->spItem[nChild+1], &spHeap->spItem[nChild]))         \
+            nChild++;                                                          \
+        if(!(LESSFN(&spHeap->spItem[nChild], &sLast)))                         \
+            break;                                                             \
+        spHeap->spItem[nNdx] = spHeap->spItem[nChild];                         \
+    }                                                                          \
+    spHeap->spItem[nNdx] = sLast;                                              \
+    return(R_OK);                                                              \
+}                                                                              \
+                                                                               \
+UX_CTNR_FN void NAME##_Free( NAME *spHeap )                                    \
+{                                                                              \
+    if(spHeap->spItem != NULL)                                                 \
+        free(spHeap->spItem);                                                  \
+    NAME##_Init(spHeap);                                                       \
+}
+
+#endif    /* UX_CTNR_H */
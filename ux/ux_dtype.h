@@ -129,16 +129,115 @@ typedef    unsigned short   USHRT;
 /* Own internal link list handling. Simple progressive link list, with the
  * header containing the key elements. In this case, one of each type is
  * given, thereby allowing searches without knowing the structure of
- * the underlying code.
+ * the underlying code. String keys shorter than LL_INLINEKEY are held in
+ * the element itself.
 */
+#define    LL_INLINEKEY     24
+
 typedef struct linklist {
     UINT            nKey;
     ULNG            lKey;
     UCHAR           *szKey;
+    ULNG            lPrefix;            /* Leading bytes of szKey, for sorts */
     void            *spData;
     struct linklist *spNext;
+    union {
+        struct linklist *spPrev;        /* Previous element */
+        struct listctl  *spCtl;         /* List control, indexed head */
+        ULNG            lCount;         /* Count, unindexed head, LL_CNT */
+    } uBack;
+    struct linklist **spSkip;           /* Skip index links, level 1 upwards */
+    UCHAR           szInline[LL_INLINEKEY];/* Short szKey held in element */
 } LINKLIST;
 
+/* The head element has no element before it, so carries the count of an
+ * unindexed list in place of that link, or the control block of an
+ * indexed one. The count is kept odd so it is never taken for a control
+ * block, which is always aligned.
+*/
+#define    LL_CNT(n)        (((ULNG)(n) << 1) | 1L)
+#define    LL_ISCNT(spH)    (((spH)->uBack.lCount & 1L) != 0)
+#define    LL_CTL(spH)      (LL_ISCNT(spH) ? NULL : (spH)->uBack.spCtl)
+#define    LL_COUNT(spH)    (LL_ISCNT(spH) ? (UINT)((spH)->uBack.lCount >> 1) \
+                                           : (spH)->uBack.spCtl->nCount)
+
+/* Opaque reference to a list element, see AddItemWithHandle.
+*/
+typedef void *LISTHANDLE;
+
+/* Levels of a skip list index, ample for 4^16 elements.
+*/
+#define    LL_MAXLEVEL      16
+
+/* Hash index on one of the element keys. Open addressed, a slot per key
+ * holding the first and last elements in list order with that key and a
+ * count of the elements sharing it, so a deletion hands the slot on to the
+ * next. An element without a string key matches any string in a DelItem
+ * scan, so adding one retires the string key table. Should a table be
+ * retired or not grow, searches on that key revert to scanning the list.
+*/
+#define    LL_HASHTYPES     3
+#define    LL_HASHINIT      16
+
+typedef struct {
+    struct linklist *spNode;            /* First element with the key */
+    struct linklist *spLast;            /* Last element with the key */
+    UINT            nDup;               /* Elements with the key */
+} LISTSLOT;
+
+typedef struct {
+    UINT            nSize;              /* Slots in table, power of 2 */
+    UINT            nUsed;              /* Slots occupied */
+    UINT            nScan;              /* Non zero, table incomplete, scan */
+    LISTSLOT        *spSlot;            /* Table of keys */
+} LISTHASH;
+
+/* Control block of an indexed list, holding its count and indexes. It
+ * is handed on when the head changes and exists only whilst the list
+ * does, staying with the list should its indexes be dropped.
+*/
+typedef struct listctl {
+    UINT            nCount;             /* Elements in list */
+    int             nMode;              /* Sort mode the list is kept in */
+    int             nFlags;             /* Indexes maintained, LST_... */
+    UINT            nLevel;             /* Highest skip level in use */
+    ULNG            lSeed;              /* Skip level generator state */
+    struct linklist *spSkip[LL_MAXLEVEL];/* Skip index heads, level 1 upwards */
+    LISTHASH        sHash[LL_HASHTYPES];/* Hash indexes on nKey, lKey, szKey */
+} LISTCTL;
+
+/* Element allocator. Elements are carved from slabs and recycled through a
+ * free list rather than returned to the system, saving a malloc/free pair
+ * per addition and deletion and keeping the heap unfragmented. Slabs hold
+ * LL_SLABNODES elements, or as many as a bulk addition is short of. The
+ * free list is shared by all lists, so is taken under a spin lock.
+*/
+#define    LL_SLABNODES     256
+
+typedef struct llslab {
+    struct llslab   *spNext;            /* Next slab obtained */
+    UINT            nNodes;             /* Elements in slab */
+    LINKLIST        sNode[1];           /* Elements carved from slab */
+} LL_SLAB;
+
+typedef struct {
+    UINT            nMode;              /* LLA_SLAB or LLA_MALLOC */
+    ULNG            lAllocs;            /* Elements handed out */
+    ULNG            lFrees;             /* Elements handed back */
+    ULNG            lInUse;             /* Elements currently in lists */
+    ULNG            lFree;              /* Elements on the free list */
+    ULNG            lSlabs;             /* Slabs obtained from system */
+    ULNG            lKeysInline;        /* String keys held in element */
+    ULNG            lKeysAlloc;         /* String keys needing allocation */
+} LISTALLOCSTATS;
+
+typedef struct {
+    LL_SLAB         *spSlab;            /* Slabs obtained */
+    LINKLIST        *spFree;            /* Free elements, chained on spNext */
+    LISTALLOCSTATS  sStats;             /* Mode and counters */
+    UINT            nLock;              /* Spinlock over the allocator */
+} LL_GLOBALS;
+
 /* Need a reference to the external errorno which the UX library procedures make
  * use of.
 extern int        errno;
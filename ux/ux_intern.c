@@ -0,0 +1,380 @@
+/******************************************************************************
+ * Product:       #     # #     #         #         ###   ######
+ *                #     #  #   #          #          #    #     #
+ *                #     #   # #           #          #    #     #
+ *                #     #    #            #          #    ######
+ *                #     #   # #           #          #    #     #
+ *                #     #  #   #          #          #    #     #
+ *                 #####  #     # ####### #######   ###   ######
+ *
+ * File:          ux_intern.c
+ * Description:   A global table of interned names. Each distinct name is
+ *                hashed and copied once and given a small id, stable for the
+ *                life of the process, so that command, service and key
+ *                names can be compared by id rather than character by
+ *                character.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1994-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Bring in system header files.
+*/
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <ctype.h>
+#include    <stdarg.h>
+#include    <sys/types.h>
+#include    <errno.h>
+#include    <sys/timeb.h>
+#include    <sys/stat.h>
+#include    <fcntl.h>
+
+#if defined(SUNOS) || defined(SOLARIS) || defined(LINUX)
+#include    <sys/socket.h>
+#include    <sys/time.h>
+#include    <string.h>
+#endif
+
+#if defined(SOLARIS)
+#include    <sys/file.h>
+#endif
+
+#if defined(LINUX)
+#include    <term.h>
+#endif
+
+#if !defined(_WIN32)
+#include    <unistd.h>
+#include    <sched.h>
+#endif
+
+#if defined(_WIN32)
+#include    <winsock.h>
+#include    <time.h>
+#endif
+
+#if defined(SUNOS) || defined(SOLARIS)
+#include    <netinet/in.h>
+#include    <sys/wait.h>
+#endif
+
+/* Indicate that we are a C module for any header specifics.
+*/
+#define        UX_INTERN_C
+
+/* Bring in specific header files.
+*/
+#include    "ux.h"
+
+
+/* Local module variables.
+*/
+static SI_GLOBALS    Si;
+
+/******************************************************************************
+ * Internal Library functions.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Function:    _SI_Lock
+ * Description: Take the table lock, spinning briefly then yielding whilst
+ *              another thread holds it. Without the GNU atomic builtins the
+ *              table is only safe within a single thread.
+ * Returns:     Non.
+ ******************************************************************************/
+void _SI_Lock( void )
+{
+#if defined(__GNUC__)
+    /* Local variables.
+    */
+    UINT        nSpin = 0;
+
+    while(__atomic_exchange_n(&Si.nLock, 1, __ATOMIC_ACQUIRE) != 0)
+    {
+        while(__atomic_load_n(&Si.nLock, __ATOMIC_RELAXED) != 0)
+        {
+#if !defined(_WIN32)
+            if(++nSpin > 100)
+                sched_yield();
+#endif
+        }
+    }
+#endif
+}
+
+/******************************************************************************
+ * Function:    _SI_Unlock
+ * Description: Release the table lock.
+ * Returns:     Non.
+ ******************************************************************************/
+void _SI_Unlock( void )
+{
+#if defined(__GNUC__)
+    __atomic_store_n(&Si.nLock, 0, __ATOMIC_RELEASE);
+#endif
+}
+
+/******************************************************************************
+ * Function:    _SI_Hash
+ * Description: FNV-1a hash of a name, folding to upper case first if asked
+ *              so that a folded lookup hashes the same as its stored form.
+ * Returns:     Hash value.
+ ******************************************************************************/
+UINT _SI_Hash( UCHAR    *szName,    /* I: Name to hash */
+               UINT     nFold )     /* I: Fold to upper case */
+{
+    /* Local variables.
+    */
+    UINT        nHash = 2166136261U;
+
+    for(; *szName != '\0'; szName++)
+    {
+        nHash ^= (nFold ? (UINT)toupper(*szName) : (UINT)*szName);
+        nHash *= 16777619U;
+    }
+    return(nHash);
+}
+
+/******************************************************************************
+ * Function:    _SI_Find
+ * Description: Probe the slots for a name. The table lock must be held and
+ *              the slot array must exist.
+ * Returns:     Index of the slot holding the name's id, or of the empty
+ *              slot where it would go.
+ ******************************************************************************/
+UINT _SI_Find( UCHAR    *szName,    /* I: Name to look for */
+               UINT     nHash,      /* I: Hash of name */
+               UINT     nFold )     /* I: Fold to upper case */
+{
+    /* Local variables.
+    */
+    UINT        nIdx;
+    UCHAR       *szCur;
+    UCHAR       *szCmp;
+
+    for(nIdx=nHash & (Si.nSlots-1); Si.npSlot[nIdx] != 0;
+        nIdx=(nIdx+1) & (Si.nSlots-1))
+    {
+        if(Si.spName[Si.npSlot[nIdx]-1].nHash != nHash)
+            continue;
+
+        /* Stored names are already folded when they were folded on entry,
+         * so only the callers side needs folding here.
+        */
+        for(szCur=Si.spName[Si.npSlot[nIdx]-1].szName, szCmp=szName;
+            *szCur != '\0' &&
+            *szCur == (nFold ? (UCHAR)toupper(*szCmp) : *szCmp);
+            szCur++, szCmp++);
+        if(*szCur == '\0' && *szCmp == '\0')
+            break;
+    }
+    return(nIdx);
+}
+
+/******************************************************************************
+ * Function:    _SI_Grow
+ * Description: Make room for one more name, enlarging the name array when
+ *              full and doubling and rehashing the slots when they pass
+ *              three quarters full. The table lock must be held.
+ * Returns:     R_OK     - Room available.
+ *              R_FAIL   - Memory exhaustion.
+ ******************************************************************************/
+int _SI_Grow( void )
+{
+    /* Local variables.
+    */
+    UINT        nIdx;
+    UINT        nId;
+    UINT        nSlots;
+    UINT        *npSlot;
+    SI_ENTRY    *spName;
+
+    if(Si.spArena == NULL && (Si.spArena=UA_Create(SI_BLOCKSIZE)) == NULL)
+        return(R_FAIL);
+
+    if(Si.nNames == Si.nMaxNames)
+    {
+        nIdx = (Si.nMaxNames == 0 ? SI_NAMEINIT : Si.nMaxNames * 2);
+        if((spName=(SI_ENTRY *)realloc(Si.spName, nIdx*sizeof(SI_ENTRY)))
+                                                                        == NULL)
+            return(R_FAIL);
+        Si.spName = spName;
+        Si.nMaxNames = nIdx;
+    }
+
+    if((Si.nNames+1)*4 > Si.nSlots*3)
+    {
+        nSlots = (Si.nSlots == 0 ? SI_HASHINIT : Si.nSlots * 2);
+        if((npSlot=(UINT *)calloc(nSlots, sizeof(UINT))) == NULL)
+            return(R_FAIL);
+
+        /* Reinsert every id by its stored hash, ids are never duplicated
+         * so the first empty slot on the probe is the right one.
+        */
+        for(nId=1; nId <= Si.nNames; nId++)
+        {
+            for(nIdx=Si.spName[nId-1].nHash & (nSlots-1); npSlot[nIdx] != 0;
+                nIdx=(nIdx+1) & (nSlots-1));
+            npSlot[nIdx] = nId;
+        }
+        if(Si.npSlot != NULL) free(Si.npSlot);
+        Si.npSlot = npSlot;
+        Si.nSlots = nSlots;
+    }
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Externally accessible Library functions.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Function:    SI_Intern
+ * Description: Map a name to its id. With SI_CREATE an unknown name is
+ *              copied into the table and given the next id, without it an
+ *              unknown name is simply reported, so that names arriving in
+ *              requests can be looked up without growing the table. With
+ *              SI_NOCASE the name is folded to upper case, and so matches
+ *              a name registered in any case under SI_NOCASE.
+ * Thread Safe: Yes.
+ * Returns:     > 0      - Id of the name.
+ *              0        - Not known or failure, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed.
+ *              E_NODATA - Name not known and SI_CREATE not given.
+ *              E_NOMEM  - Memory exhaustion.
+ ******************************************************************************/
+UINT SI_Intern( UCHAR    *szName,    /* I: Name to intern */
+                UINT     nFlags )    /* I: SI_CREATE and/or SI_NOCASE */
+{
+    /* Local variables.
+    */
+    UINT        nFold = (nFlags & SI_NOCASE) ? 1 : 0;
+    UINT        nHash;
+    UINT        nId = 0;
+    UCHAR       *szCopy;
+    UCHAR       *szCur;
+
+    if(szName == NULL)
+    {
+        Errno = E_BADPARM;
+        return(0);
+    }
+    nHash = _SI_Hash(szName, nFold);
+
+    _SI_Lock();
+    if(Si.nSlots != 0)
+        nId = Si.npSlot[_SI_Find(szName, nHash, nFold)];
+
+    if(nId == 0)
+    {
+        if((nFlags & SI_CREATE) == 0)
+        {
+            Errno = E_NODATA;
+        } else
+        if(_SI_Grow() == R_FAIL ||
+           (szCopy=UA_StrDup(Si.spArena, szName)) == NULL)
+        {
+            Errno = E_NOMEM;
+        } else
+         {
+            /* Keep the folded form so that the stored hash holds for it.
+            */
+            if(nFold)
+                for(szCur=szCopy; *szCur != '\0'; szCur++)
+                    *szCur = (UCHAR)toupper(*szCur);
+
+            nId = ++Si.nNames;
+            Si.spName[nId-1].szName = szCopy;
+            Si.spName[nId-1].nHash = nHash;
+            Si.npSlot[_SI_Find(szCopy, nHash, 0)] = nId;
+        }
+    }
+    _SI_Unlock();
+
+    /* Return the id, 0 if unknown or not added.
+    */
+    return(nId);
+}
+
+/******************************************************************************
+ * Function:    SI_Name
+ * Description: Get the canonical text of an interned name. The text stays
+ *              at the same address until SI_Exit, so callers may keep the
+ *              pointer and compare it directly.
+ * Thread Safe: Yes.
+ * Returns:     NOTNULL  - Name for the id.
+ *              NULL     - Unknown id, see Errno.
+ * <Errno>      E_BADPARM- Bad parameter passed.
+ ******************************************************************************/
+UCHAR *SI_Name( UINT    nId )    /* I: Id of name */
+{
+    /* Local variables.
+    */
+    UCHAR       *szName = NULL;
+
+    _SI_Lock();
+    if(nId == 0 || nId > Si.nNames)
+    {
+        Errno = E_BADPARM;
+    } else
+     {
+        szName = Si.spName[nId-1].szName;
+    }
+    _SI_Unlock();
+
+    /* Return the name, NULL if id unknown.
+    */
+    return(szName);
+}
+
+/******************************************************************************
+ * Function:    SI_Count
+ * Description: Get the number of names held, which is also the highest id
+ *              given out.
+ * Thread Safe: Yes.
+ * Returns:     Number of names interned.
+ ******************************************************************************/
+UINT SI_Count( void )
+{
+    /* Local variables.
+    */
+    UINT        nCount;
+
+    _SI_Lock();
+    nCount = Si.nNames;
+    _SI_Unlock();
+    return(nCount);
+}
+
+/******************************************************************************
+ * Function:    SI_Exit
+ * Description: Release the table. Every id and name pointer given out
+ *              beforehand becomes invalid, so only call this at shutdown.
+ * Thread Safe: No, no other thread may be using the table.
+ * Returns:     Non.
+ ******************************************************************************/
+void SI_Exit( void )
+{
+    if(Si.spArena != NULL) UA_Destroy(Si.spArena);
+    if(Si.spName != NULL) free(Si.spName);
+    if(Si.npSlot != NULL) free(Si.npSlot);
+    memset((UCHAR *)&Si, '\0', sizeof(SI_GLOBALS));
+}
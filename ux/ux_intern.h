@@ -0,0 +1,89 @@
+/******************************************************************************
+ * Product:       #     # #     #         #         ###   ######
+ *                #     #  #   #          #          #    #     #
+ *                #     #   # #           #          #    #     #
+ *                #     #    #            #          #    ######
+ *                #     #   # #           #          #    #     #
+ *                #     #  #   #          #          #    #     #
+ *                 #####  #     # ####### #######   ###   ######
+ *
+ * File:          ux_intern.h
+ * Description:   Header file for the string interning table, which maps
+ *                names to stable small ids so that hot paths compare ids.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1994-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    UX_INTERN_H
+#define    UX_INTERN_H
+
+/* Table sizes.
+*/
+#define    SI_HASHINIT       64        /* Initial hash slots, power of 2 */
+#define    SI_NAMEINIT       32        /* Initial name slots */
+#define    SI_BLOCKSIZE      4096      /* Arena block for name storage */
+
+/* Flags for SI_Intern.
+*/
+#define    SI_CREATE         0x01      /* Add the name if not yet known */
+#define    SI_NOCASE         0x02      /* Fold to upper case before lookup */
+
+/* An interned name, indexed by its id less one.
+*/
+typedef struct {
+    UCHAR           *szName;           /* Canonical copy of the name */
+    UINT            nHash;             /* Hash of the name */
+} SI_ENTRY;
+
+/* Global variables of the interning table, internal to the module.
+*/
+#if defined(UX_INTERN_C)
+typedef struct {
+    UINT            *npSlot;           /* Open addressed slots of ids */
+    UINT            nSlots;            /* Number of slots, power of 2 */
+    SI_ENTRY        *spName;           /* Names in id order */
+    UINT            nNames;            /* Names held */
+    UINT            nMaxNames;         /* Size of name array */
+    UX_ARENA        *spArena;          /* Storage for the name text */
+    UINT            nLock;             /* Spinlock over the whole table */
+} SI_GLOBALS;
+#endif
+
+/* Prototypes for internal functions.
+*/
+#if defined(UX_INTERN_C)
+void        _SI_Lock( void );
+void        _SI_Unlock( void );
+UINT        _SI_Hash( UCHAR *, UINT );
+UINT        _SI_Find( UCHAR *, UINT, UINT );
+int         _SI_Grow( void );
+#endif
+
+/* Prototypes for API functions.
+*/
+UINT        SI_Intern( UCHAR *, UINT );
+UCHAR       *SI_Name( UINT );
+UINT        SI_Count( void );
+void        SI_Exit( void );
+
+#endif    /* UX_INTERN_H */
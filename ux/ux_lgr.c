@@ -9,7 +9,8 @@
  *
  * File:          ux_lgr.c
  * Description:   General purpose standalone (programmable) logging
- *                utilities.
+ *                utilities. Lines can be handed to a writer thread through
+ *                a ring per thread rather than written by the caller.
  *
  * Version:       %I%
  * Dated:         %D%
@@ -55,6 +56,16 @@
 #include    <sys/file.h>
 #endif
 
+#if defined(SOLARIS) || defined(LINUX)
+#include    <pthread.h>
+#include    <signal.h>
+#include    <sys/uio.h>
+#endif
+
+#if !defined(_WIN32)
+#include    <unistd.h>
+#endif
+
 #if defined(LINUX)
 #include    <term.h>
 #endif
@@ -62,6 +73,7 @@
 #if defined(_WIN32)
 #include    <winsock.h>
 #include    <time.h>
+#include    <io.h>
 #endif
 
 #if defined(SUNOS) || defined(SOLARIS)
@@ -77,9 +89,580 @@
 */
 #include    "ux.h"
 
+/* Memory ordering of the ring counters, as in ux_queue. A counter is
+ * published with release once the bytes it covers are in place, and read
+ * with acquire.
+*/
+#if defined(__GNUC__)
+#define    LGR_LOAD(p)       __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define    LGR_STORE(p, v)   __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#define    LGR_LOAD(p)       (*(p))
+#define    LGR_STORE(p, v)   (*(p) = (v))
+#endif
+
+/* Logger globals, starting out logging messages and above to stdout.
+*/
+#if defined(LGR_THREADS)
+static LGR_GLOBALS Lg = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                          PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                          LGM_STDOUT, LOG_MESSAGE, NULL, 0, -1 };
+#else
+static LGR_GLOBALS Lg = { LGM_STDOUT, LOG_MESSAGE, NULL, 0, -1 };
+#endif
+
+/******************************************************************************
+ * Function:    _LGR_Stamp
+ * Description: Get the timestamp of a log line, formatting it afresh only
+ *              when the second has changed.
+ * Thread Safe: No, each thread must use its own LGR_TIME.
+ * Returns:     Formatted timestamp.
+ ******************************************************************************/
+UCHAR *_LGR_Stamp( LGR_TIME    *spTime )    /* IO: Timestamp cache */
+{
+    /* Local variables.
+    */
+    struct tm    sTime;
+    time_t       nTime;
+
+    time(&nTime);
+    if(nTime != spTime->nTime || spTime->szTime[0] == '\0')
+    {
+#if defined(SOLARIS) || defined(LINUX)
+        localtime_r(&nTime, &sTime);
+#else
+        memcpy(&sTime, localtime(&nTime), sizeof(struct tm));
+#endif
+        sprintf(spTime->szTime, "%02d/%02d/%02d %02d:%02d:%02d", sTime.tm_mday,
+                sTime.tm_mon+1, sTime.tm_year, sTime.tm_hour, sTime.tm_min,
+                sTime.tm_sec);
+        spTime->nTime = nTime;
+    }
+    return(spTime->szTime);
+}
+
+/******************************************************************************
+ * Function:    _LGR_Check
+ * Description: Make sure the log file is open, opening it when configured
+ *              and, at most once a second, checking that it hasnt been
+ *              moved or removed, as when logs are rotated, in which case
+ *              the file is opened again.
+ * Thread Safe: No, call holding the logger lock where there are threads.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LGR_Check( void )
+{
+    /* Local variables.
+    */
+    int          nFd;
+    time_t       nTime;
+    struct stat  sFile;
+    struct stat  sOpen;
+
+    if(Lg.szLogFile == NULL)
+        return;
+    if(Lg.nFd >= 0 && Lg.nFdGen == Lg.nFileGen)
+    {
+        time(&nTime);
+        if(nTime == Lg.nChecked)
+            return;
+        Lg.nChecked = nTime;
+        if(stat(Lg.szLogFile, &sFile) == 0 && fstat(Lg.nFd, &sOpen) == 0 &&
+           sFile.st_dev == sOpen.st_dev && sFile.st_ino == sOpen.st_ino)
+            return;
+    }
+
+    /* A file which cant be opened again after rotation keeps the old one,
+     * a newly configured file replaces it regardless.
+    */
+    nFd = open(Lg.szLogFile, O_WRONLY | O_APPEND | O_CREAT, 0666);
+    if(nFd >= 0 || Lg.nFdGen != Lg.nFileGen)
+    {
+        if(Lg.nFd >= 0)
+            close(Lg.nFd);
+        Lg.nFd = nFd;
+        Lg.nFdGen = Lg.nFileGen;
+    }
+#if !defined(_WIN32)
+    if(nFd >= 0)
+        fcntl(nFd, F_SETFD, FD_CLOEXEC);
+#endif
+}
+
+/******************************************************************************
+ * Function:    _LGR_Write
+ * Description: Write lines straight to the log file, if it is open.
+ * Thread Safe: Yes, lines are appended whole.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LGR_Write( UCHAR    *spBuf,     /* I: Lines to write */
+                 UINT     nLen )      /* I: Bytes of lines */
+{
+    /* Local variables.
+    */
+    int         nDone;
+
+    while(nLen > 0 && Lg.nFd >= 0)
+    {
+        if((nDone=write(Lg.nFd, spBuf, nLen)) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return;
+        }
+        spBuf += nDone;
+        nLen -= (UINT)nDone;
+    }
+}
+
+#if defined(LGR_THREADS)
+/******************************************************************************
+ * Function:    _LGR_WriteV
+ * Description: Write a batch of ring pieces to the log file with as few
+ *              system calls as possible. On an error the batch is dropped.
+ * Thread Safe: No, writer only.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LGR_WriteV( struct iovec    *spIov,   /* IO: Pieces to write */
+                  UINT            nIov )    /* I: Number of pieces */
+{
+    /* Local variables.
+    */
+    ssize_t     nDone;
+
+    while(nIov > 0)
+    {
+        if((nDone=writev(Lg.nFd, spIov, (int)nIov)) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return;
+        }
+        while(nIov > 0 && (size_t)nDone >= spIov->iov_len)
+        {
+            nDone -= spIov->iov_len;
+            spIov++;
+            nIov--;
+        }
+        if(nIov > 0)
+        {
+            spIov->iov_base = (char *)spIov->iov_base + nDone;
+            spIov->iov_len -= nDone;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function:    _LGR_Ring
+ * Description: Get the ring of the calling thread, creating it and adding
+ *              it to those of the writer on first use.
+ * Thread Safe: Yes.
+ * Returns:     NOTNULL  - Ring of the calling thread.
+ *              NULL     - Memory exhausted.
+ ******************************************************************************/
+LGR_RING *_LGR_Ring( void )
+{
+    /* Local variables.
+    */
+    void        *spBase;
+    LGR_RING    *spRing;
+
+    if((spRing=(LGR_RING *)pthread_getspecific(Lg.sKey)) != NULL)
+        return(spRing);
+
+    /* The ring and its buffer are one allocation, the counters starting
+     * on a cache line boundary.
+    */
+    if((spBase=malloc(sizeof(LGR_RING) + LGR_CACHELINE + Lg.nRingSize)) == NULL)
+        return(NULL);
+    spRing = (LGR_RING *)(((ULNG)spBase + LGR_CACHELINE - 1) &
+                                                  ~(ULNG)(LGR_CACHELINE - 1));
+    memset((UCHAR *)spRing, '\0', sizeof(LGR_RING));
+    spRing->spBase = spBase;
+    spRing->nSize = Lg.nRingSize;
+    spRing->spBuf = (UCHAR *)spRing + sizeof(LGR_RING);
+    if(pthread_setspecific(Lg.sKey, spRing) != 0)
+    {
+        free(spBase);
+        return(NULL);
+    }
+
+    /* Only the writer takes rings off the list, so it can walk the list
+     * without the lock whilst rings are added at the head.
+    */
+    pthread_mutex_lock(&Lg.sLock);
+    spRing->spNext = Lg.spRings;
+    LGR_STORE(&Lg.spRings, spRing);
+    pthread_mutex_unlock(&Lg.sLock);
+    return(spRing);
+}
+
+/******************************************************************************
+ * Function:    _LGR_Put
+ * Description: Add a line to the ring of the calling thread. When the ring
+ *              is full a line below LOG_ALERT is dropped and counted under
+ *              the LGR_DROP policy, otherwise the thread waits for the
+ *              writer to make room. The writer is woken early for alerts
+ *              and when the ring passes half full.
+ * Thread Safe: Yes, on the ring of the calling thread.
+ * Returns:     R_OK     - Line added, or dropped.
+ *              R_FAIL   - Line wont fit or the writer is stopping, the
+ *                         caller must write it.
+ ******************************************************************************/
+int _LGR_Put( LGR_RING    *spRing,     /* IO: Ring of calling thread */
+              int         nLevel,      /* I: Level of line */
+              UCHAR       *spLine,     /* I: Line */
+              UINT        nLen )       /* I: Length of line */
+{
+    /* Local variables.
+    */
+    ULNG        lHead = spRing->lHead;
+    ULNG        lUsed;
+    UINT        nPos;
+    UINT        nFirst;
+    UINT        nStopped;
+
+    if(nLen > spRing->nSize)
+        return(R_FAIL);
+    while(nLen > spRing->nSize - (lUsed=lHead - LGR_LOAD(&spRing->lTail)))
+    {
+        LGR_STORE(&Lg.nKick, TRUE);
+        if(Lg.nPolicy == LGR_DROP && nLevel < LOG_ALERT)
+        {
+            LGR_STORE(&spRing->lDropped, spRing->lDropped + 1);
+            pthread_cond_signal(&Lg.sWork);
+            return(R_OK);
+        }
+        pthread_mutex_lock(&Lg.sLock);
+        Lg.nWaiting++;
+        pthread_cond_signal(&Lg.sWork);
+        if(Lg.nRunning == TRUE && Lg.nStop == FALSE &&
+           nLen > spRing->nSize - (lHead - LGR_LOAD(&spRing->lTail)))
+            pthread_cond_wait(&Lg.sSpace, &Lg.sLock);
+        Lg.nWaiting--;
+        nStopped = (Lg.nRunning == FALSE || Lg.nStop == TRUE);
+        pthread_mutex_unlock(&Lg.sLock);
+        if(nStopped == TRUE)
+            return(R_FAIL);
+    }
+
+    /* Copy the line in, wrapping at the end of the ring, then publish it.
+    */
+    nPos = (UINT)(lHead & (spRing->nSize - 1));
+    nFirst = spRing->nSize - nPos < nLen ? spRing->nSize - nPos : nLen;
+    memcpy(&spRing->spBuf[nPos], spLine, nFirst);
+    memcpy(spRing->spBuf, &spLine[nFirst], nLen - nFirst);
+    LGR_STORE(&spRing->lHead, lHead + nLen);
+
+    /* The writer wakes by itself every LGR_FLUSHMS, a wakeup lost because
+     * the lock isnt held only delays the line until then.
+    */
+    if(nLevel >= LOG_ALERT ||
+       (lUsed < spRing->nSize / 2 && lUsed + nLen >= spRing->nSize / 2))
+    {
+        LGR_STORE(&Lg.nKick, TRUE);
+        pthread_cond_signal(&Lg.sWork);
+    }
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    _LGR_Drain
+ * Description: Write out everything in every ring, gathering the rings
+ *              into as few writes as possible, and log the number of
+ *              lines any ring has dropped.
+ * Thread Safe: No, writer only, or once the writer has stopped.
+ * Returns:     Bytes written.
+ ******************************************************************************/
+ULNG _LGR_Drain( void )
+{
+    /* Local variables.
+    */
+    UINT        nIov = 0;
+    UINT        nRings = 0;
+    UINT        nNdx;
+    UINT        nPos;
+    UINT        nLen;
+    ULNG        lBytes = 0;
+    ULNG        lTail;
+    ULNG        lDropped;
+    ULNG        lHead[LGR_MAXIOV];
+    LGR_RING    *spRing[LGR_MAXIOV];
+    LGR_RING    *spNext;
+    struct iovec sIov[LGR_MAXIOV];
+    UCHAR       szLine[LGR_MAXPREFIX];
+
+    for(spNext=LGR_LOAD(&Lg.spRings); spNext != NULL; spNext=spNext->spNext)
+    {
+        lDropped = LGR_LOAD(&spNext->lDropped);
+        if(lDropped != spNext->lReported)
+        {
+            nLen = (UINT)sprintf(szLine, "[%d %s %s] (%lu) lines dropped, "
+                                 "log ring full\n", LOG_WARNING,
+                                 _LGR_Stamp(&Lg.sWrTime), "Lgr",
+                                 lDropped - spNext->lReported);
+            _LGR_Write(szLine, nLen);
+            spNext->lReported = lDropped;
+        }
+
+        /* Whats in the ring is one piece, or two where it wraps.
+        */
+        lTail = spNext->lTail;
+        if((lHead[nRings]=LGR_LOAD(&spNext->lHead)) == lTail)
+            continue;
+        nPos = (UINT)(lTail & (spNext->nSize - 1));
+        nLen = (UINT)(lHead[nRings] - lTail);
+        sIov[nIov].iov_base = (char *)&spNext->spBuf[nPos];
+        sIov[nIov].iov_len = spNext->nSize - nPos < nLen ? spNext->nSize - nPos
+                                                         : nLen;
+        if(sIov[nIov++].iov_len < nLen)
+        {
+            sIov[nIov].iov_base = (char *)spNext->spBuf;
+            sIov[nIov].iov_len = nLen - sIov[nIov-1].iov_len;
+            nIov++;
+        }
+        spRing[nRings++] = spNext;
+        lBytes += nLen;
+
+        /* Write the batch once it is full or the last ring is in it, then
+         * hand the space back to the owning threads. A ring adds one or two
+         * pieces, so there are never more rings in a batch than pieces.
+        */
+        if(nIov > LGR_MAXIOV - 2 || spNext->spNext == NULL)
+        {
+            _LGR_WriteV(sIov, nIov);
+            for(nNdx=0; nNdx < nRings; nNdx++)
+                LGR_STORE(&spRing[nNdx]->lTail, lHead[nNdx]);
+            nIov = nRings = 0;
+        }
+    }
+    if(nIov > 0)
+    {
+        _LGR_WriteV(sIov, nIov);
+        for(nNdx=0; nNdx < nRings; nNdx++)
+            LGR_STORE(&spRing[nNdx]->lTail, lHead[nNdx]);
+    }
+    return(lBytes);
+}
+
+/******************************************************************************
+ * Function:    _LGR_Sweep
+ * Description: Release the rings of threads which have exited once they
+ *              have been written out.
+ * Thread Safe: No, writer only, holding the logger lock.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LGR_Sweep( void )
+{
+    /* Local variables.
+    */
+    LGR_RING    **spPrev;
+    LGR_RING    *spRing;
+
+    for(spPrev=&Lg.spRings; (spRing=*spPrev) != NULL; )
+    {
+        if(LGR_LOAD(&spRing->nClosed) == TRUE &&
+           LGR_LOAD(&spRing->lHead) == spRing->lTail &&
+           LGR_LOAD(&spRing->lDropped) == spRing->lReported)
+        {
+            *spPrev = spRing->spNext;
+            free(spRing->spBase);
+        } else
+         {
+            spPrev = &spRing->spNext;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function:    _LGR_Writer
+ * Description: The writer thread, writing out the rings every LGR_FLUSHMS
+ *              or sooner when woken, until asked to stop.
+ * Thread Safe: Yes.
+ * Returns:     NULL.
+ ******************************************************************************/
+void *_LGR_Writer( void    *pArg )    /* I: Unused */
+{
+    /* Local variables.
+    */
+    struct timeval  sNow;
+    struct timespec sWake;
+
+    pthread_mutex_lock(&Lg.sLock);
+    while(Lg.nStop == FALSE)
+    {
+        _LGR_Check();
+        pthread_mutex_unlock(&Lg.sLock);
+        _LGR_Drain();
+        pthread_mutex_lock(&Lg.sLock);
+        _LGR_Sweep();
+
+        /* Let flushes and threads waiting for room know.
+        */
+        Lg.lPasses++;
+        pthread_cond_broadcast(&Lg.sDone);
+        if(Lg.nWaiting > 0)
+            pthread_cond_broadcast(&Lg.sSpace);
+
+        if(LGR_LOAD(&Lg.nKick) == FALSE && Lg.nStop == FALSE)
+        {
+            gettimeofday(&sNow, NULL);
+            sWake.tv_sec = sNow.tv_sec +
+                              (sNow.tv_usec + LGR_FLUSHMS * 1000L) / 1000000L;
+            sWake.tv_nsec = (sNow.tv_usec + LGR_FLUSHMS * 1000L) % 1000000L *
+                                                                         1000L;
+            pthread_cond_timedwait(&Lg.sWork, &Lg.sLock, &sWake);
+        }
+        LGR_STORE(&Lg.nKick, FALSE);
+    }
+    pthread_mutex_unlock(&Lg.sLock);
+
+    /* Write out whatever came in whilst stopping.
+    */
+    _LGR_Drain();
+    return(NULL);
+}
+
+/******************************************************************************
+ * Function:    _LGR_Up
+ * Description: Start the writer in this process if it isnt running. It is
+ *              started on first use, so a server which forks gets a writer
+ *              in each process which logs. The writer blocks all signals,
+ *              leaving them to the threads of the program.
+ * Thread Safe: Yes.
+ * Returns:     R_OK     - Writer running.
+ *              R_FAIL   - Couldnt start it, asynchronous mode turned off.
+ ******************************************************************************/
+int _LGR_Up( void )
+{
+    /* Local variables.
+    */
+    int         nReturn = R_OK;
+    sigset_t    sAll;
+    sigset_t    sOld;
+
+    pthread_mutex_lock(&Lg.sLock);
+    if(Lg.nAsync == FALSE)
+    {
+        nReturn = R_FAIL;
+    } else
+    if(Lg.nRunning == FALSE)
+    {
+        Lg.nStop = FALSE;
+        sigfillset(&sAll);
+        pthread_sigmask(SIG_SETMASK, &sAll, &sOld);
+        if(pthread_create(&Lg.sThread, NULL, _LGR_Writer, NULL) == 0)
+        {
+            LGR_STORE(&Lg.nRunning, TRUE);
+        } else
+         {
+            LGR_STORE(&Lg.nAsync, FALSE);
+            nReturn = R_FAIL;
+        }
+        pthread_sigmask(SIG_SETMASK, &sOld, NULL);
+    }
+    pthread_mutex_unlock(&Lg.sLock);
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    _LGR_Setup
+ * Description: Create the key of the thread rings and register the fork
+ *              and exit handlers, once. Fork handlers are needed as soon as
+ *              the lock is used, so this is done on configuration too.
+ * Thread Safe: No, call holding the logger lock.
+ * Returns:     R_OK     - Set up.
+ *              R_FAIL   - Couldnt create the key.
+ ******************************************************************************/
+int _LGR_Setup( void )
+{
+    if(Lg.nSetup == FALSE)
+    {
+        if(pthread_key_create(&Lg.sKey, _LGR_Closed) != 0)
+            return(R_FAIL);
+        pthread_atfork(_LGR_Prepare, _LGR_Parent, _LGR_Child);
+        atexit(LgrStop);
+        Lg.nSetup = TRUE;
+    }
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    _LGR_Closed
+ * Description: Thread exit handler, marking the ring of the thread for the
+ *              writer to release.
+ * Thread Safe: Yes.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LGR_Closed( void    *spArg )    /* I: Ring of exiting thread */
+{
+    LGR_STORE(&((LGR_RING *)spArg)->nClosed, TRUE);
+}
+
+/******************************************************************************
+ * Function:    _LGR_Prepare
+ * Description: Fork handler, holding the logger lock across the fork so
+ *              the child gets the rings and file in a consistent state.
+ * Thread Safe: Yes.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LGR_Prepare( void )
+{
+    pthread_mutex_lock(&Lg.sLock);
+}
+
+/******************************************************************************
+ * Function:    _LGR_Parent
+ * Description: Fork handler, the parent carries on as it was.
+ * Thread Safe: Yes.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LGR_Parent( void )
+{
+    pthread_mutex_unlock(&Lg.sLock);
+}
+
+/******************************************************************************
+ * Function:    _LGR_Child
+ * Description: Fork handler. The child has no writer and only the forking
+ *              thread, so the lock and conditions start afresh, lines still
+ *              in the rings are left to the parent to write, and the rings
+ *              of the other threads are released by the writer of the child
+ *              once it starts.
+ * Thread Safe: Yes.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LGR_Child( void )
+{
+    /* Local variables.
+    */
+    LGR_RING    *spOwn = (LGR_RING *)pthread_getspecific(Lg.sKey);
+    LGR_RING    *spRing;
+
+    pthread_mutex_init(&Lg.sLock, NULL);
+    pthread_cond_init(&Lg.sWork, NULL);
+    pthread_cond_init(&Lg.sSpace, NULL);
+    pthread_cond_init(&Lg.sDone, NULL);
+    Lg.nRunning = FALSE;
+    Lg.nStop = FALSE;
+    Lg.nKick = FALSE;
+    Lg.nWaiting = 0;
+    for(spRing=Lg.spRings; spRing != NULL; spRing=spRing->spNext)
+    {
+        spRing->lTail = spRing->lHead;
+        spRing->lReported = spRing->lDropped;
+        if(spRing != spOwn)
+            spRing->nClosed = TRUE;
+    }
+}
+#endif
+
 /******************************************************************************
  * Function:    Lgr
  * Description: A function to log a message to a flatfile, database or both.
+ *              The flatfile is held open. Once LgrStart has been called,
+ *              lines for it go through a ring of the calling thread to a
+ *              writer thread rather than being written by the caller.
  * Returns:     Non.
  ******************************************************************************/
 void Lgr( int        nLevel,        /* I: Level of error message/or command */
@@ -90,23 +673,27 @@ void Lgr( int        nLevel,        /* I: Level of error message/or command */
 #ifdef    SL_MONITOR
     static UCHAR    nAlert = FALSE;
 #endif
-    static UINT        nLogMode = LGM_STDOUT;
-    static int        nErrLevel = LOG_MESSAGE;
-    static UCHAR    *szLogFile = NULL;
 
     /* Local variables.
     */
     va_list        pArgs;
-    struct tm    sTime;
-    time_t        nTime;
-    UCHAR        szBuf[MAX_VARARGBUF];
-    UCHAR        *szFormat;
-    UCHAR        *szFuncName;
+    UINT           nLen;
+    UINT           nMsgLen = 0;
+    UINT           nLogMode;
+    int            nErrLevel;
+    UCHAR          *szLogFile;
+    UCHAR          szLine[LGR_MAXPREFIX + MAX_VARARGBUF + 1];
+    UCHAR          *szBuf = "";
+    UCHAR          *szFormat;
+    UCHAR          *szFuncName;
+    UCHAR          *szTime = "";
+    LGR_TIME       *spTime = &Lg.sTime;
+#if defined(LGR_THREADS)
+    LGR_RING       *spRing = NULL;
+#endif
 #ifdef    SL_MONITOR
     UCHAR        szMonBuf[MAX_ERRMSG];
 #endif
-    UCHAR        szTime[50];
-    FILE        *fp;
 
     /* Start variable argument passing.
     */
@@ -123,6 +710,22 @@ void Lgr( int        nLevel,        /* I: Level of error message/or command */
         nErrLevel   = va_arg(pArgs, UINT);
         szLogFile   = va_arg(pArgs, UCHAR *);
 
+        /* Lines already queued go to the file they were logged for, the
+         * new file is opened when next written to.
+        */
+        LgrFlush();
+#if defined(LGR_THREADS)
+        pthread_mutex_lock(&Lg.sLock);
+#endif
+        Lg.nLogMode  = nLogMode;
+        Lg.nErrLevel = nErrLevel;
+        Lg.szLogFile = szLogFile;
+        Lg.nFileGen++;
+#if defined(LGR_THREADS)
+        _LGR_Setup();
+        pthread_mutex_unlock(&Lg.sLock);
+#endif
+
         /* Tidy up for exit and return to caller.
         */
         va_end(pArgs);
@@ -131,7 +734,8 @@ void Lgr( int        nLevel,        /* I: Level of error message/or command */
 
     /* If the logger is switched off, just exit.
     */
-    if((nErrLevel == LOG_OFF || nLogMode == LGM_OFF) && nLevel != LOG_DIRECT)
+    if((Lg.nErrLevel == LOG_OFF || Lg.nLogMode == LGM_OFF) &&
+        nLevel != LOG_DIRECT)
     {
         /* Tidy up for exit and return to caller.
         */
@@ -145,7 +749,7 @@ void Lgr( int        nLevel,        /* I: Level of error message/or command */
 #if defined(UX_DEBUG)
     if(TRUE)
 #else
-    if(nLevel >= nErrLevel)
+    if(nLevel >= Lg.nErrLevel)
 #endif
     {
         /* Extract varargs off stack. Caller should have called with the
@@ -154,22 +758,37 @@ void Lgr( int        nLevel,        /* I: Level of error message/or command */
         szFuncName  = va_arg(pArgs, UCHAR *);
         szFormat    = va_arg(pArgs, UCHAR *);
 
-        /* Build up full message for logging.
+#if defined(LGR_THREADS)
+        /* In asynchronous mode, lines for the flatfile go to the ring of
+         * this thread, starting the writer if this process has none yet.
         */
-        vsprintf(szBuf, szFormat, pArgs);
+        if(LGR_LOAD(&Lg.nAsync) == TRUE && Lg.szLogFile != NULL &&
+           (Lg.nLogMode == LGM_ALL || Lg.nLogMode == LGM_FLATFILE) &&
+           nLevel != LOG_DIRECT &&
+           (LGR_LOAD(&Lg.nRunning) == TRUE || _LGR_Up() == R_OK) &&
+           (spRing=_LGR_Ring()) != NULL)
+        {
+            spTime = &spRing->sTime;
+        }
+#endif
 
-        /* Get current time to stamp message with. This is only used for non-
-         * database log messages.
+        /* Build up the full line for logging, stamped with the current
+         * time, which is only formatted once a second. Without a ring the
+         * line is built and written holding the lock, as the timestamp
+         * and file are shared.
         */
-        time(&nTime);
-#if defined(SOLARIS)
-        localtime_r(&nTime, &sTime);
-#else
-        memcpy(&sTime, localtime(&nTime), sizeof(struct tm));
+#if defined(LGR_THREADS)
+        if(spRing == NULL)
+            pthread_mutex_lock(&Lg.sLock);
 #endif
-        sprintf(szTime, "%02d/%02d/%02d %02d:%02d:%02d", sTime.tm_mday,
-                sTime.tm_mon+1, sTime.tm_year, sTime.tm_hour, sTime.tm_min,
-                sTime.tm_sec);
+        szTime = _LGR_Stamp(spTime);
+        nLen = (UINT)sprintf(szLine, "[%d %s %.*s] ", nLevel, szTime,
+                             LGR_MAXPREFIX - 48, szFuncName);
+        szBuf = &szLine[nLen];
+        vsprintf(szBuf, szFormat, pArgs);
+        nMsgLen = strlen(szBuf);
+        nLen += nMsgLen;
+        szLine[nLen++] = '\n';
 
         /* Log according to programmed mode.
          *   LGM_OFF     - No logging.
@@ -178,44 +797,67 @@ void Lgr( int        nLevel,        /* I: Level of error message/or command */
          *   LGM_DB      - Log to Database.
          *   LGM_ALL     - Log to all output destinations.
         */
-        if(nLogMode == LGM_STDOUT || nLevel == LOG_DIRECT)
+        if(Lg.nLogMode == LGM_STDOUT || nLevel == LOG_DIRECT)
         {
             /* Print to stdout as requested.
             */
-            printf("[%d %s %s] %s\n", nLevel, szTime, szFuncName,szBuf);
+            fwrite(szLine, 1, nLen, stdout);
             fflush(stdout);
         }
-        if((nLogMode == LGM_ALL || nLogMode == LGM_FLATFILE) &&
+        if((Lg.nLogMode == LGM_ALL || Lg.nLogMode == LGM_FLATFILE) &&
             nLevel != LOG_DIRECT)
         {
             /* Only log to flatfile if a program name exists.
             */
-            if(szLogFile != NULL)
+            if(Lg.szLogFile != NULL)
             {
-                /* Build up the name of file to open.
+#if defined(LGR_THREADS)
+                /* A line which cant be queued is written here. Whilst the
+                 * writer runs, only it changes the open file.
+                */
+                if(spRing == NULL)
+                {
+                    if(Lg.nRunning == FALSE || Lg.nFd < 0)
+                        _LGR_Check();
+                    _LGR_Write(szLine, nLen);
+                } else
+                if(_LGR_Put(spRing, nLevel, szLine, nLen) == R_FAIL)
+                {
+                    pthread_mutex_lock(&Lg.sLock);
+                    if(Lg.nRunning == FALSE || Lg.nFd < 0)
+                        _LGR_Check();
+                    _LGR_Write(szLine, nLen);
+                    pthread_mutex_unlock(&Lg.sLock);
+                } else
+                /* A fatal error usually ends the program, so see it
+                 * written before returning.
                 */
-                if((fp=fopen(szLogFile, "a")) != NULL)
+                if(nLevel >= LOG_FATAL)
                 {
-                    /* Place string in buffer.
-                    */
-                    fprintf(fp, "[%d %s %s] %s\n", nLevel, szTime,
-                            szFuncName, szBuf);
-
-                    /* Close file when finished, in case a crash occurs,
-                     * sys-op wants to see last message.
-                    */
-                    fclose(fp);
+                    LgrFlush();
                 }
+#else
+                /* Written straight to the file, which isnt buffered, so
+                 * the sys-op sees the last message if a crash occurs.
+                */
+                _LGR_Check();
+                _LGR_Write(szLine, nLen);
+#endif
             }
         }
-        if((nLogMode == LGM_ALL || nLogMode == LGM_DB) && nLevel != LOG_DIRECT)
+        if((Lg.nLogMode == LGM_ALL || Lg.nLogMode == LGM_DB) &&
+            nLevel != LOG_DIRECT)
         {
             /* Call the database to log the message.
             */
         }
+#if defined(LGR_THREADS)
+        if(spRing == NULL)
+            pthread_mutex_unlock(&Lg.sLock);
+#endif
     }
 
-/* If monitor processing is enabled, then dispatch all log messages to 
+/* If monitor processing is enabled, then dispatch all log messages to
  * monitor processes.
 */
 #ifdef    SL_MONITOR
@@ -225,7 +867,7 @@ void Lgr( int        nLevel,        /* I: Level of error message/or command */
     if(nAlert == TRUE && nLevel >= LOG_MESSAGE)
     {
         sprintf(szMonBuf, "%c", MON_MSG_CANALERT);
-        SL_MonitorBroadcast(szMonBuf, strlen(szMonBuf));
+        ML_Broadcast(szMonBuf, strlen(szMonBuf));
         nAlert = FALSE;
     }
 
@@ -235,14 +877,14 @@ void Lgr( int        nLevel,        /* I: Level of error message/or command */
     if(nLevel >= LOG_ALERT)
     {
         sprintf(szMonBuf, "%c", MON_MSG_ALERT);
-        SL_MonitorBroadcast(szMonBuf, strlen(szMonBuf));
+        ML_Broadcast(szMonBuf, strlen(szMonBuf));
         nAlert = TRUE;
     }
 
     /* Build up error message and transmit seperately.
     */
-    sprintf(szMonBuf, "%c%s %s", MON_MSG_ERRMSG, szTime, szBuf);
-    SL_MonitorBroadcast(szMonBuf, strlen(szMonBuf));
+    sprintf(szMonBuf, "%c%s %.*s", MON_MSG_ERRMSG, szTime, (int)nMsgLen, szBuf);
+    ML_Broadcast(szMonBuf, strlen(szMonBuf));
 #endif
 
     /* Stop vararg processing... ie tidy up stack.
@@ -253,3 +895,122 @@ void Lgr( int        nLevel,        /* I: Level of error message/or command */
     */
     return;
 }
+
+/******************************************************************************
+ * Function:    LgrStart
+ * Description: Log asynchronously. Each thread formats its lines into a
+ *              ring of its own, without locking, and a writer thread
+ *              gathers them from all the rings into batched writes to the
+ *              log file every LGR_FLUSHMS, or sooner when a ring passes
+ *              half full or an alert is logged. When a ring is full, lines
+ *              below LOG_ALERT are dropped and the number dropped logged
+ *              under LGR_DROP, the thread waits for room under LGR_BLOCK.
+ *              Only flatfile logging is affected. Rings made before a call
+ *              keep their size. The writer is started in each process on
+ *              its first line and is stopped at exit.
+ * Thread Safe: Yes.
+ * Returns:     R_OK     - Asynchronous logging on.
+ *              R_FAIL   - Failure, see Errno.
+ * <Errno>      E_BADPARM- Bad size or policy, or no threads on this platform.
+ *              E_NOMEM  - Couldnt create the thread key.
+ ******************************************************************************/
+int LgrStart( UINT    nRingSize,      /* I: Bytes in each ring, 0 = default */
+              UINT    nPolicy )       /* I: LGR_DROP or LGR_BLOCK */
+{
+#if defined(LGR_THREADS)
+    /* Local variables.
+    */
+    UINT        nSize;
+
+    if(nRingSize == 0)
+        nRingSize = LGR_RINGSIZE;
+    if(nRingSize > LGR_MAXRING || (nPolicy != LGR_DROP && nPolicy != LGR_BLOCK))
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    for(nSize=LGR_MINRING; nSize < nRingSize; nSize <<= 1);
+
+    pthread_mutex_lock(&Lg.sLock);
+    if(_LGR_Setup() == R_FAIL)
+    {
+        pthread_mutex_unlock(&Lg.sLock);
+        Errno = E_NOMEM;
+        return(R_FAIL);
+    }
+    Lg.nRingSize = nSize;
+    Lg.nPolicy = nPolicy;
+    LGR_STORE(&Lg.nAsync, TRUE);
+    pthread_mutex_unlock(&Lg.sLock);
+    return(R_OK);
+#else
+    Errno = E_BADPARM;
+    return(R_FAIL);
+#endif
+}
+
+/******************************************************************************
+ * Function:    LgrStop
+ * Description: Stop logging asynchronously, writing out all the rings and
+ *              stopping the writer. Lines are written by the caller again
+ *              from then on.
+ * Thread Safe: Yes, though lines logged by other threads whilst stopping
+ *              may be lost.
+ * Returns:     Non.
+ ******************************************************************************/
+void LgrStop( void )
+{
+#if defined(LGR_THREADS)
+    /* Local variables.
+    */
+    UINT        nJoin;
+
+    pthread_mutex_lock(&Lg.sLock);
+    LGR_STORE(&Lg.nAsync, FALSE);
+    if((nJoin=Lg.nRunning) == TRUE)
+    {
+        Lg.nStop = TRUE;
+        pthread_cond_signal(&Lg.sWork);
+        pthread_cond_broadcast(&Lg.sSpace);
+    }
+    pthread_mutex_unlock(&Lg.sLock);
+    if(nJoin == TRUE)
+        pthread_join(Lg.sThread, NULL);
+
+    pthread_mutex_lock(&Lg.sLock);
+    LGR_STORE(&Lg.nRunning, FALSE);
+    Lg.nStop = FALSE;
+    _LGR_Drain();
+    _LGR_Sweep();
+    pthread_mutex_unlock(&Lg.sLock);
+#endif
+}
+
+/******************************************************************************
+ * Function:    LgrFlush
+ * Description: Wait until every line logged before the call, by any
+ *              thread, has been written to the log file.
+ * Thread Safe: Yes.
+ * Returns:     Non.
+ ******************************************************************************/
+void LgrFlush( void )
+{
+#if defined(LGR_THREADS)
+    /* Local variables.
+    */
+    ULNG        lPasses;
+
+    /* The pass under way may have passed the ring of the caller already,
+     * the one after it wont have.
+    */
+    pthread_mutex_lock(&Lg.sLock);
+    lPasses = Lg.lPasses + 2;
+    while(Lg.nRunning == TRUE && Lg.nStop == FALSE && Lg.lPasses < lPasses)
+    {
+        LGR_STORE(&Lg.nKick, TRUE);
+        pthread_cond_signal(&Lg.sWork);
+        pthread_cond_wait(&Lg.sDone, &Lg.sLock);
+    }
+    pthread_mutex_unlock(&Lg.sLock);
+#endif
+}
@@ -0,0 +1,146 @@
+/******************************************************************************
+ * Product:       #     # #     #         #         ###   ######
+ *                #     #  #   #          #          #    #     #
+ *                #     #   # #           #          #    #     #
+ *                #     #    #            #          #    ######
+ *                #     #   # #           #          #    #     #
+ *                #     #  #   #          #          #    #     #
+ *                 #####  #     # ####### #######   ###   ######
+ *
+ * File:          ux_lgr.h
+ * Description:   Header file for the logger, and the per thread rings and
+ *                writer thread of its asynchronous mode.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1994-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    UX_LGR_H
+#define    UX_LGR_H
+
+/* Asynchronous logging parameters and policies. A ring holds whole log
+ * lines, so it must have room for the longest message and its prefix.
+*/
+#define    LGR_RINGSIZE      262144    /* Default bytes in a thread ring */
+#define    LGR_MINRING       32768     /* Smallest ring */
+#define    LGR_MAXRING       67108864  /* Largest ring */
+#define    LGR_MAXPREFIX     160       /* Longest "[level time function] " */
+#define    LGR_FLUSHMS       100       /* Longest a record waits to be written */
+#define    LGR_MAXIOV        64        /* Ring pieces in one write */
+#define    LGR_CACHELINE     64        /* Padding between ring counters */
+#define    LGR_DROP          0         /* Full ring, drop records below alerts */
+#define    LGR_BLOCK         1         /* Full ring, wait for room */
+
+#if defined(SOLARIS) || defined(LINUX)
+#define    LGR_THREADS
+#endif
+
+#if defined(UX_LOGGER_C)
+/* Timestamp of log lines, formatted once a second.
+*/
+typedef struct {
+    time_t      nTime;                 /* Second formatted */
+    UCHAR       szTime[50];            /* Formatted timestamp */
+} LGR_TIME;
+
+/* A thread ring, a byte ring of finished log lines written by the thread
+ * which owns it and read by the writer thread. Each side only writes its
+ * own counter, and the two sit on separate cache lines.
+*/
+typedef struct lgrring {
+    ULNG        lHead;                 /* Bytes added, owning thread */
+    UCHAR       cPad1[LGR_CACHELINE - sizeof(ULNG)];
+    ULNG        lTail;                 /* Bytes written out, writer */
+    UCHAR       cPad2[LGR_CACHELINE - sizeof(ULNG)];
+    ULNG        lDropped;              /* Records dropped, owning thread */
+    ULNG        lReported;             /* Drops logged, writer */
+    UINT        nClosed;               /* Owning thread has exited */
+    UINT        nSize;                 /* Bytes in ring, a power of 2 */
+    LGR_TIME    sTime;                 /* Timestamp of owning thread */
+    UCHAR       *spBuf;                /* Ring of log lines */
+    struct lgrring *spNext;            /* Next ring of the writer */
+    void        *spBase;               /* Allocation holding this ring */
+} LGR_RING;
+
+/* Logger globals, the configuration given with LOG_CONFIG, the log file
+ * held open and the state of asynchronous mode.
+*/
+typedef struct {
+#if defined(LGR_THREADS)
+    pthread_mutex_t sLock;             /* Guards the writer and file */
+    pthread_cond_t  sWork;             /* Writer wanted */
+    pthread_cond_t  sSpace;            /* Writer made room */
+    pthread_cond_t  sDone;             /* Writer finished a pass */
+#endif
+    UINT        nLogMode;              /* LGM_ mode */
+    int         nErrLevel;             /* Lowest level logged */
+    UCHAR       *szLogFile;            /* Log file, callers buffer */
+    UINT        nFileGen;              /* Bumped by each LOG_CONFIG */
+    int         nFd;                   /* Log file held open, or -1 */
+    UINT        nFdGen;                /* nFileGen it was opened for */
+    time_t      nChecked;              /* Last check it wasnt rotated */
+    LGR_TIME    sTime;                 /* Timestamp when not asynchronous */
+#if defined(LGR_THREADS)
+    UINT        nAsync;                /* Asynchronous mode on */
+    UINT        nPolicy;               /* LGR_DROP or LGR_BLOCK */
+    UINT        nRingSize;             /* Bytes in new rings */
+    UINT        nSetup;                /* Key and fork handlers made */
+    UINT        nRunning;              /* Writer running in this process */
+    UINT        nStop;                 /* Writer to exit */
+    UINT        nKick;                 /* Writer to start a pass now */
+    UINT        nWaiting;              /* Threads waiting for room */
+    ULNG        lPasses;               /* Passes completed by writer */
+    LGR_TIME    sWrTime;               /* Timestamp of writer */
+    LGR_RING    *spRings;              /* Rings of all threads */
+    pthread_key_t sKey;                /* Ring of this thread */
+    pthread_t   sThread;               /* Writer */
+#endif
+} LGR_GLOBALS;
+
+/* Prototypes for internal functions.
+*/
+UCHAR       *_LGR_Stamp( LGR_TIME * );
+void        _LGR_Check( void );
+void        _LGR_Write( UCHAR *, UINT );
+#if defined(LGR_THREADS)
+void        _LGR_WriteV( struct iovec *, UINT );
+LGR_RING    *_LGR_Ring( void );
+int         _LGR_Put( LGR_RING *, int, UCHAR *, UINT );
+ULNG        _LGR_Drain( void );
+void        _LGR_Sweep( void );
+void        *_LGR_Writer( void * );
+int         _LGR_Up( void );
+int         _LGR_Setup( void );
+void        _LGR_Closed( void * );
+void        _LGR_Prepare( void );
+void        _LGR_Parent( void );
+void        _LGR_Child( void );
+#endif
+#endif
+
+/* Prototypes for API functions.
+*/
+int         LgrStart( UINT, UINT );
+void        LgrStop( void );
+void        LgrFlush( void );
+
+#endif    /* UX_LGR_H */
@@ -58,6 +58,10 @@
 #include    <term.h>
 #endif
 
+#if !defined(_WIN32)
+#include    <sched.h>
+#endif
+
 #if defined(_WIN32)
 #include    <winsock.h>
 #include    <time.h>
@@ -68,19 +72,1152 @@
 #include    <sys/wait.h>
 #endif
 
-/* Indicate that we are a C module for any header specifics.
-*/
-#define        UX_LINKEDLIST_C
+/* Indicate that we are a C module for any header specifics.
+*/
+#define        UX_LINKEDLIST_C
+
+/* Bring in specific header files.
+*/
+#include    "ux.h"
+
+/* Element allocator state.
+*/
+static LL_GLOBALS    Ll;
+
+/******************************************************************************
+ * Function:    _LL_Compare
+ * Description: Compare two list elements according to a sort mode. String
+ *              keys are compared on their cached prefixes first, only going
+ *              to strcmp for keys which share a full prefix.
+ * Returns:     <0        - A sorts before B.
+ *              0         - A and B sort equally.
+ *              >0        - A sorts after B.
+ ******************************************************************************/
+int _LL_Compare( int         nSort,     /* I: Sort mode */
+                 LINKLIST    *spA,      /* I: First element */
+                 LINKLIST    *spB )     /* I: Second element */
+{
+    /* Local variables.
+    */
+    int         nCmp;
+
+    switch(nSort)
+    {
+        case SORT_INT_UP:
+            return(spA->nKey < spB->nKey ? -1 : spA->nKey > spB->nKey);
+
+        case SORT_INT_DOWN:
+            return(spA->nKey > spB->nKey ? -1 : spA->nKey < spB->nKey);
+
+        case SORT_LONG_UP:
+            return(spA->lKey < spB->lKey ? -1 : spA->lKey > spB->lKey);
+
+        case SORT_LONG_DOWN:
+            return(spA->lKey > spB->lKey ? -1 : spA->lKey < spB->lKey);
+
+        case SORT_CHAR_UP:
+        case SORT_CHAR_DOWN:
+            /* Prefixes differ, or are equal and hold the whole key?
+            */
+            if(spA->lPrefix != spB->lPrefix)
+            {
+                nCmp = (spA->lPrefix < spB->lPrefix ? -1 : 1);
+            } else
+            if((spA->lPrefix & 0xff) == 0)
+            {
+                nCmp = 0;
+            } else
+             {
+                nCmp = strcmp(spA->szKey + sizeof(ULNG),
+                              spB->szKey + sizeof(ULNG));
+                nCmp = (nCmp < 0 ? -1 : nCmp > 0);
+            }
+            return(nSort == SORT_CHAR_UP ? nCmp : -nCmp);
+
+        default:
+            return(0);
+    }
+}
+
+/******************************************************************************
+ * Function:    _LL_SkipLink
+ * Description: Get the address of the forward link of an element at a given
+ *              level of a list. Level 0 is the list itself. A NULL element
+ *              denotes the head of the list.
+ * Returns:     Address of forward link.
+ ******************************************************************************/
+LINKLIST **_LL_SkipLink( LISTCTL     *spCtl,     /* I: List control */
+                         LINKLIST    **spHead,   /* I: Pointer to head of list */
+                         LINKLIST    *spNode,    /* I: Element, NULL = head */
+                         UINT        nLevel )    /* I: Level of link */
+{
+    if(nLevel == 0)
+        return(spNode == NULL ? spHead : &spNode->spNext);
+    return(spNode == NULL ? &spCtl->spSkip[nLevel-1] :
+                            &spNode->spSkip[nLevel-1]);
+}
+
+/******************************************************************************
+ * Function:    _LL_RandomLevel
+ * Description: Pick the number of skip index levels for a new element, each
+ *              level being a quarter as likely as the one below.
+ * Returns:     Number of levels above the list itself.
+ ******************************************************************************/
+UINT _LL_RandomLevel( LISTCTL    *spCtl )    /* IO: List control */
+{
+    /* Local variables.
+    */
+    UINT        nLevel = 0;
+    ULNG        lRand;
+
+    /* Xorshift, cheap and good enough to balance the index.
+    */
+    lRand = spCtl->lSeed;
+    lRand ^= lRand << 13;
+    lRand ^= lRand >> 17;
+    lRand ^= lRand << 5;
+    spCtl->lSeed = lRand;
+
+    while(nLevel < LL_MAXLEVEL-1 && (lRand & 3) == 0)
+    {
+        nLevel++;
+        lRand >>= 2;
+    }
+    return(nLevel);
+}
+
+/******************************************************************************
+ * Function:    _LL_SkipSeek
+ * Description: Search the skip index of a list for the first element which
+ *              does not sort before a probe element.
+ * Returns:     Element preceding it in the list, NULL if it is the head.
+ ******************************************************************************/
+LINKLIST *_LL_SkipSeek( LINKLIST    **spHead,    /* I: Pointer to head of list */
+                        LINKLIST    *spProbe )   /* I: Element to seek */
+{
+    /* Local variables.
+    */
+    int         nLevel;
+    LISTCTL     *spCtl = (*spHead)->uBack.spCtl;
+    LINKLIST    *spCur = NULL;
+    LINKLIST    *spFwd;
+
+    /* Descend the levels, moving along each whilst before the probe.
+    */
+    for(nLevel=spCtl->nLevel; nLevel >= 0; nLevel--)
+    {
+        while((spFwd= *_LL_SkipLink(spCtl, spHead, spCur, nLevel)) != NULL &&
+              _LL_Compare(spCtl->nMode, spFwd, spProbe) < 0)
+        {
+            spCur = spFwd;
+        }
+    }
+    return(spCur);
+}
+
+/******************************************************************************
+ * Function:    _LL_SkipUnlink
+ * Description: Remove an element from the skip index levels of a list, the
+ *              caller unlinking it from the list itself.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_SkipUnlink( LINKLIST    **spHead,    /* IO: Pointer to head of list */
+                     LINKLIST    *spNode )    /* IO: Element to remove */
+{
+    /* Local variables.
+    */
+    UINT        nLevel;
+    LISTCTL     *spCtl = (*spHead)->uBack.spCtl;
+    LINKLIST    *spCur = NULL;
+    LINKLIST    *spEqual;
+    LINKLIST    *spFwd;
+    LINKLIST    **spLink;
+
+    if(spNode->spSkip == NULL)
+        return;
+
+    /* Seek the element on each level, from the top. Equal keys are walked
+     * ahead of the search, which only moves on to the element if it is on
+     * the level, so as not to overshoot it on the levels below.
+    */
+    for(nLevel=spCtl->nLevel; nLevel >= 1; nLevel--)
+    {
+        while((spFwd= *_LL_SkipLink(spCtl, spHead, spCur, nLevel)) != NULL &&
+              spFwd != spNode && _LL_Compare(spCtl->nMode, spFwd, spNode) < 0)
+        {
+            spCur = spFwd;
+        }
+
+        for(spEqual=spCur;
+            (spFwd= *(spLink=_LL_SkipLink(spCtl, spHead, spEqual, nLevel)))
+                                                                   != NULL &&
+            spFwd != spNode && _LL_Compare(spCtl->nMode, spFwd, spNode) == 0;
+            spEqual=spFwd);
+        if(spFwd == spNode)
+        {
+            *spLink = spNode->spSkip[nLevel-1];
+            spCur = spEqual;
+        }
+    }
+
+    /* Drop levels no longer in use.
+    */
+    while(spCtl->nLevel > 0 && spCtl->spSkip[spCtl->nLevel-1] == NULL)
+        spCtl->nLevel--;
+
+    /* Release the elements links.
+    */
+    free(spNode->spSkip);
+    spNode->spSkip = NULL;
+}
+
+/******************************************************************************
+ * Function:    _LL_KeyPrefix
+ * Description: Pack the leading bytes of a string key into a ULNG, most
+ *              significant first and zero filled, so that prefixes compare
+ *              as integers in the same order as the strings.
+ * Returns:     Prefix.
+ ******************************************************************************/
+ULNG _LL_KeyPrefix( UCHAR    *szKey )    /* I: String key, may be NULL */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    ULNG        lPrefix;
+
+    for(lPrefix=0L, nNdx=0; nNdx < sizeof(ULNG); nNdx++)
+    {
+        lPrefix = (lPrefix << 8) |
+                  (szKey != NULL && *szKey != '\0' ? *szKey++ : 0);
+    }
+    return(lPrefix);
+}
+
+/******************************************************************************
+ * Function:    _LL_IsSorted
+ * Description: Check that a list is in the order of a sort mode.
+ * Returns:     TRUE      - Sorted, or empty.
+ *              FALSE     - Out of order.
+ ******************************************************************************/
+int _LL_IsSorted( LINKLIST    *spHead,    /* I: Head of list */
+                  int         nSort )     /* I: Sort mode */
+{
+    /* Local variables.
+    */
+    LINKLIST    *spCur;
+
+    for(spCur=spHead; spCur != NULL && spCur->spNext != NULL;
+        spCur=spCur->spNext)
+    {
+        if(_LL_Compare(nSort, spCur, spCur->spNext) > 0)
+            return(FALSE);
+    }
+    return(TRUE);
+}
+
+/******************************************************************************
+ * Function:    _LL_SkipRebuild
+ * Description: Build the skip index of a list afresh in one pass, used once
+ *              a merge has relinked the list wholesale. An element whose
+ *              links cannot be allocated sits on the list alone.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_SkipRebuild( LINKLIST    *spHead )    /* IO: Head of list */
+{
+    /* Local variables.
+    */
+    UINT        nLevel;
+    UINT        nNewLevel;
+    LISTCTL     *spCtl = spHead->uBack.spCtl;
+    LINKLIST    *spCur;
+    LINKLIST    *spLast[LL_MAXLEVEL];
+
+    spCtl->nLevel = 0;
+    for(nLevel=0; nLevel < LL_MAXLEVEL; nLevel++)
+    {
+        spCtl->spSkip[nLevel] = NULL;
+        spLast[nLevel] = NULL;
+    }
+
+    for(spCur=spHead; spCur != NULL; spCur=spCur->spNext)
+    {
+        if(spCur->spSkip != NULL)
+            free(spCur->spSkip);
+        spCur->spSkip = NULL;
+
+        if((nNewLevel=_LL_RandomLevel(spCtl)) > 0 &&
+           (spCur->spSkip=(LINKLIST **)malloc(sizeof(LINKLIST *)*nNewLevel))
+                                                                      == NULL)
+        {
+            nNewLevel = 0;
+        }
+
+        /* Append to each level it is on.
+        */
+        for(nLevel=0; nLevel < nNewLevel; nLevel++)
+        {
+            if(spLast[nLevel] == NULL)
+                spCtl->spSkip[nLevel] = spCur;
+            else
+                spLast[nLevel]->spSkip[nLevel] = spCur;
+            spLast[nLevel] = spCur;
+            spCur->spSkip[nLevel] = NULL;
+        }
+        if(nNewLevel > spCtl->nLevel)
+            spCtl->nLevel = nNewLevel;
+    }
+}
+
+/******************************************************************************
+ * Function:    _LL_HashKey
+ * Description: Calculate the hash of one of the keys of an element.
+ * Returns:     Hash value.
+ ******************************************************************************/
+UINT _LL_HashKey( UINT        nType,     /* I: Key, 0 = nKey, 1 = lKey, 2 = szKey */
+                  LINKLIST    *spNode )  /* I: Element */
+{
+    /* Local variables.
+    */
+    UINT        nHash;
+    ULNG        lKey;
+    UCHAR       *spKey;
+
+    switch(nType)
+    {
+        case 0:
+            nHash = spNode->nKey * 2654435761U;
+            break;
+
+        case 1:
+            lKey = spNode->lKey;
+            nHash = (UINT)(lKey ^ ((lKey >> 16) >> 16)) * 2654435761U;
+            break;
+
+        default:
+            /* FNV-1a.
+            */
+            for(nHash=2166136261U, spKey=spNode->szKey; *spKey != '\0'; spKey++)
+            {
+                nHash = (nHash ^ *spKey) * 16777619U;
+            }
+            break;
+    }
+    return(nHash ^ (nHash >> 16));
+}
+
+/******************************************************************************
+ * Function:    _LL_HashSame
+ * Description: Compare one of the keys of two elements.
+ * Returns:     TRUE      - Keys are equal.
+ *              FALSE     - Keys differ.
+ ******************************************************************************/
+int _LL_HashSame( UINT        nType,     /* I: Key, 0 = nKey, 1 = lKey, 2 = szKey */
+                  LINKLIST    *spA,      /* I: First element */
+                  LINKLIST    *spB )     /* I: Second element */
+{
+    switch(nType)
+    {
+        case 0:
+            return(spA->nKey == spB->nKey);
+
+        case 1:
+            return(spA->lKey == spB->lKey);
+
+        default:
+            return(spA->szKey != NULL && spB->szKey != NULL &&
+                   strcmp(spA->szKey, spB->szKey) == 0);
+    }
+}
+
+/******************************************************************************
+ * Function:    _LL_HashSlot
+ * Description: Locate the slot of a hash table holding the key of a probe,
+ *              or the empty slot where it would go.
+ * Returns:     Address of slot.
+ ******************************************************************************/
+LISTSLOT *_LL_HashSlot( LISTHASH    *spHash,    /* I: Hash table */
+                        UINT        nType,      /* I: Key hashed on */
+                        LINKLIST    *spProbe )  /* I: Element to locate */
+{
+    /* Local variables.
+    */
+    UINT        nMask = spHash->nSize - 1;
+    UINT        nNdx;
+
+    /* Linear probe, the table is never more than half full.
+    */
+    for(nNdx=_LL_HashKey(nType, spProbe) & nMask;
+        spHash->spSlot[nNdx].spNode != NULL &&
+        _LL_HashSame(nType, spHash->spSlot[nNdx].spNode, spProbe) == FALSE;
+        nNdx=(nNdx + 1) & nMask);
+    return(&spHash->spSlot[nNdx]);
+}
+
+/******************************************************************************
+ * Function:    _LL_HashAdd
+ * Description: Add an element, once linked into its list, to the hash
+ *              indexes of the list, growing tables as needed. A key already
+ *              present is counted, and the slot takes the new element if it
+ *              now comes first or last in the list. An element without a
+ *              string key, or a table which cannot grow, retires the table
+ *              and searches on its key scan instead.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_HashAdd( LISTCTL     *spCtl,    /* IO: List control */
+                  LINKLIST    *spHead,   /* I: Head of list */
+                  LINKLIST    *spNode )  /* I: Element added */
+{
+    /* Local variables.
+    */
+    UINT        nType;
+    UINT        nNdx;
+    LISTHASH    *spHash;
+    LISTHASH    sNew;
+    LISTSLOT    *spSlot;
+    LINKLIST    *spCur;
+
+    for(nType=0; nType < LL_HASHTYPES; nType++)
+    {
+        spHash = &spCtl->sHash[nType];
+        if((spCtl->nFlags & (LST_HASH_NKEY << nType)) == 0 ||
+           spHash->nScan != 0)
+            continue;
+
+        /* An element without a string key matches any string in a DelItem
+         * scan, which the table cannot answer for.
+        */
+        if(nType == 2 && spNode->szKey == NULL)
+        {
+            spHash->nScan = 1;
+        } else
+
+        /* Keep the table at most half full.
+        */
+        if((spHash->nUsed + 1) * 2 > spHash->nSize)
+        {
+            sNew.nSize = (spHash->nSize == 0 ? LL_HASHINIT : spHash->nSize * 2);
+            sNew.nUsed = spHash->nUsed;
+            sNew.nScan = 0;
+            if((sNew.spSlot=(LISTSLOT *)calloc(sNew.nSize, sizeof(LISTSLOT)))
+                                                                      == NULL)
+            {
+                spHash->nScan = 1;
+            } else
+             {
+                for(nNdx=0; nNdx < spHash->nSize; nNdx++)
+                {
+                    if(spHash->spSlot[nNdx].spNode != NULL)
+                        *_LL_HashSlot(&sNew, nType, spHash->spSlot[nNdx].spNode)
+                                                        = spHash->spSlot[nNdx];
+                }
+                if(spHash->spSlot != NULL)
+                    free(spHash->spSlot);
+                *spHash = sNew;
+            }
+        }
+
+        /* Retired tables are of no further use.
+        */
+        if(spHash->nScan != 0)
+        {
+            if(spHash->spSlot != NULL)
+                free(spHash->spSlot);
+            spHash->spSlot = NULL;
+            spHash->nSize = spHash->nUsed = 0;
+            continue;
+        }
+
+        /* A new key takes an empty slot. For a duplicate, look back from
+         * the new element for the last or first with the key, or the head,
+         * to learn whether it now ends or starts the run. An addition at the
+         * tail, or next to its equals, is settled at once.
+        */
+        if((spSlot=_LL_HashSlot(spHash, nType, spNode))->spNode == NULL)
+        {
+            spSlot->spNode = spNode;
+            spSlot->spLast = spNode;
+            spSlot->nDup = 1;
+            spHash->nUsed++;
+        } else
+         {
+            spSlot->nDup++;
+            if(spNode->spNext == NULL)
+            {
+                spCur = spSlot->spLast;
+            } else
+             {
+                for(spCur=spNode; spCur != spSlot->spLast &&
+                    spCur != spSlot->spNode && spCur != spHead;
+                    spCur=spCur->uBack.spPrev);
+            }
+            if(spCur == spSlot->spLast)
+                spSlot->spLast = spNode;
+            else
+            if(spCur != spSlot->spNode)
+                spSlot->spNode = spNode;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function:    _LL_HashDel
+ * Description: Remove an element, before it is unlinked from its list, from
+ *              the hash indexes of the list. A slot still holding other
+ *              elements with the key passes from this one to the next or
+ *              previous of them in the list, otherwise it is emptied and the
+ *              probe sequence behind it closed up.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_HashDel( LISTCTL     *spCtl,    /* IO: List control */
+                  LINKLIST    *spNode )  /* I: Element being removed */
+{
+    /* Local variables.
+    */
+    UINT        nType;
+    UINT        nMask;
+    UINT        nHole;
+    UINT        nNdx;
+    UINT        nHome;
+    LISTHASH    *spHash;
+    LISTSLOT    *spSlot;
+    LINKLIST    *spCur;
+
+    for(nType=0; nType < LL_HASHTYPES; nType++)
+    {
+        spHash = &spCtl->sHash[nType];
+        if(spHash->nSize == 0 || (nType == 2 && spNode->szKey == NULL) ||
+           (spSlot=_LL_HashSlot(spHash, nType, spNode))->spNode == NULL)
+            continue;
+
+        /* Others with the key remain, the slot need only move on if it
+         * holds this one. The last has others before it, so never heads
+         * the list.
+        */
+        if(--spSlot->nDup != 0)
+        {
+            if(spSlot->spNode == spNode)
+            {
+                for(spCur=spNode->spNext;
+                    _LL_HashSame(nType, spCur, spNode) == FALSE;
+                    spCur=spCur->spNext);
+                spSlot->spNode = spCur;
+            } else
+            if(spSlot->spLast == spNode)
+            {
+                for(spCur=spNode->uBack.spPrev;
+                    _LL_HashSame(nType, spCur, spNode) == FALSE;
+                    spCur=spCur->uBack.spPrev);
+                spSlot->spLast = spCur;
+            }
+            continue;
+        }
+
+        /* Empty the slot, then move back any following element which can no
+         * longer be reached past the hole.
+        */
+        nMask = spHash->nSize - 1;
+        nHole = (UINT)(spSlot - spHash->spSlot);
+        spHash->spSlot[nHole].spNode = NULL;
+        spHash->nUsed--;
+        for(nNdx=(nHole + 1) & nMask; spHash->spSlot[nNdx].spNode != NULL;
+            nNdx=(nNdx + 1) & nMask)
+        {
+            nHome = _LL_HashKey(nType, spHash->spSlot[nNdx].spNode) & nMask;
+            if(nHole <= nNdx ? (nHole < nHome && nHome <= nNdx) :
+                               (nHole < nHome || nHome <= nNdx))
+                continue;
+            spHash->spSlot[nHole] = spHash->spSlot[nNdx];
+            spHash->spSlot[nNdx].spNode = NULL;
+            nHole = nNdx;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function:    _LL_HashFind
+ * Description: Look up an element through a hash index. Only possible when
+ *              a single key is given and that key is indexed.
+ * Returns:     NOTNULL   - Address holding the first element in the list
+ *                          with the key, or NULL when there is none.
+ *              NULL      - Index cannot answer, list must be scanned.
+ ******************************************************************************/
+LINKLIST **_LL_HashFind( LISTCTL     *spCtl,    /* I: List control */
+                         UINT        *nKey,     /* I: Integer based search key */
+                         ULNG        *lKey,     /* I: Long based search key */
+                         UCHAR       *szKey )   /* I: String based search key */
+{
+    /* Local variables.
+    */
+    static LINKLIST *spNone = NULL;
+    UINT        nType;
+    LISTHASH    *spHash;
+    LINKLIST    sProbe;
+
+    /* Which key, if only one?
+    */
+    if(nKey != NULL && lKey == NULL && szKey == NULL)
+        nType = 0;
+    else if(nKey == NULL && lKey != NULL && szKey == NULL)
+        nType = 1;
+    else if(nKey == NULL && lKey == NULL && szKey != NULL)
+        nType = 2;
+    else
+        return(NULL);
+
+    spHash = &spCtl->sHash[nType];
+    if((spCtl->nFlags & (LST_HASH_NKEY << nType)) == 0 || spHash->nScan != 0)
+        return(NULL);
+
+    /* Probe.
+    */
+    if(spHash->nSize == 0)
+        return(&spNone);
+    sProbe.nKey  = (nKey == NULL ? 0 : *nKey);
+    sProbe.lKey  = (lKey == NULL ? 0L : *lKey);
+    sProbe.szKey = szKey;
+    return(&_LL_HashSlot(spHash, nType, &sProbe)->spNode);
+}
+
+/******************************************************************************
+ * Function:    _LL_FreeCtl
+ * Description: Release a list control block and its hash tables.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_FreeCtl( LISTCTL    *spCtl )    /* I: List control */
+{
+    /* Local variables.
+    */
+    UINT        nType;
+
+    for(nType=0; nType < LL_HASHTYPES; nType++)
+    {
+        if(spCtl->sHash[nType].spSlot != NULL)
+            free(spCtl->sHash[nType].spSlot);
+    }
+    free(spCtl);
+}
+
+/******************************************************************************
+ * Function:    _LL_DropSkip
+ * Description: Remove the skip list index from a list, used when an addition
+ *              no longer keeps the list in index order. Any hash index
+ *              remains.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_DropSkip( LINKLIST    *spHead )    /* IO: Head of list */
+{
+    /* Local variables.
+    */
+    LISTCTL     *spCtl = spHead->uBack.spCtl;
+    LINKLIST    *spCur;
+
+    for(spCur=spHead; spCur != NULL; spCur=spCur->spNext)
+    {
+        if(spCur->spSkip != NULL)
+            free(spCur->spSkip);
+        spCur->spSkip = NULL;
+    }
+    spCtl->nFlags &= ~LST_SKIPLIST;
+    spCtl->nLevel = 0;
+    memset((UCHAR *)spCtl->spSkip, '\0', sizeof(spCtl->spSkip));
+}
+
+/******************************************************************************
+ * Function:    _LL_DropIndex
+ * Description: Remove all indexes from an indexed list, reverting it to a
+ *              plain list whose control block only keeps its count.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_DropIndex( LINKLIST    *spHead )    /* IO: Head of list */
+{
+    /* Local variables.
+    */
+    UINT        nType;
+    LISTCTL     *spCtl = spHead->uBack.spCtl;
+
+    if((spCtl->nFlags & LST_SKIPLIST) != 0)
+        _LL_DropSkip(spHead);
+    for(nType=0; nType < LL_HASHTYPES; nType++)
+    {
+        if(spCtl->sHash[nType].spSlot != NULL)
+            free(spCtl->sHash[nType].spSlot);
+        memset((UCHAR *)&spCtl->sHash[nType], '\0', sizeof(LISTHASH));
+    }
+    spCtl->nFlags = 0;
+}
+
+/******************************************************************************
+ * Function:    _LL_Insert
+ * Description: Link a new element into a list according to the mode. Sorted
+ *              lists with an index are inserted into by a skip list search,
+ *              others by scanning. Elements are placed after any which sort
+ *              equally, keeping the order of addition. The first element of
+ *              an indexed list brings its control block and indexes into
+ *              being, an unindexed list only keeps a count in its head.
+ * Returns:     R_OK      - Element linked in.
+ *              R_FAIL    - Memory exhaustion creating the control block,
+ *                          list untouched.
+ ******************************************************************************/
+int _LL_Insert( LINKLIST    **spHead,    /* IO: Pointer to head of list */
+                LINKLIST    **spTail,    /* IO: Pointer to tail of list */
+                int         nMode,       /* I: Mode of addition to link */
+                LINKLIST    *spNew )     /* IO: Element to insert */
+{
+    /* Local variables.
+    */
+    int         nSort = nMode & SORT_MASK;
+    int         nFlags;
+    int         nLevel;
+    UINT        nNewLevel;
+    LISTCTL     *spCtl;
+    LINKLIST    *spCur;
+    LINKLIST    *spPrev;
+    LINKLIST    *spFwd;
+    LINKLIST    **spLink;
+    LINKLIST    *spUpdate[LL_MAXLEVEL];
+
+    /* First element, create the control block if indexes are asked for,
+     * an index cannot be built on a list which already exists. Skip lists
+     * only index sorted lists.
+    */
+    if(*spHead == NULL)
+    {
+        if((nFlags=(nMode & LST_INDEXMASK)) != 0 && nSort == SORT_NONE)
+            nFlags &= ~LST_SKIPLIST;
+        if(nFlags == 0)
+        {
+            spNew->uBack.lCount = LL_CNT(1);
+        } else
+         {
+            if((spCtl=(LISTCTL *)malloc(sizeof(LISTCTL))) == NULL)
+                return(R_FAIL);
+            memset((UCHAR *)spCtl, '\0', sizeof(LISTCTL));
+            spCtl->nCount = 1;
+            spCtl->nMode = nSort;
+            spCtl->nFlags = nFlags;
+            spCtl->lSeed = ((ULNG)spNew >> 4) | 1L;
+            spNew->uBack.spCtl = spCtl;
+            _LL_HashAdd(spCtl, spNew, spNew);
+        }
+        *spHead = spNew;
+        *spTail = spNew;
+        spNew->spNext = NULL;
+        return(R_OK);
+    }
+
+    /* An addition out of sort order invalidates the skip list.
+    */
+    if((spCtl=LL_CTL(*spHead)) != NULL &&
+       (spCtl->nFlags & LST_SKIPLIST) != 0 && spCtl->nMode != nSort)
+    {
+        _LL_DropSkip(*spHead);
+    }
+
+    /* Indexed, seek insertion point on each level.
+    */
+    if(spCtl != NULL && (spCtl->nFlags & LST_SKIPLIST) != 0)
+    {
+        for(spCur=NULL, nLevel=spCtl->nLevel; nLevel >= 0; nLevel--)
+        {
+            while((spFwd= *_LL_SkipLink(spCtl, spHead, spCur, nLevel)) != NULL
+                  && _LL_Compare(nSort, spNew, spFwd) >= 0)
+            {
+                spCur = spFwd;
+            }
+            spUpdate[nLevel] = spCur;
+        }
+
+        /* Give the element its levels, if the links cant be allocated it
+         * simply sits on the list alone.
+        */
+        if((nNewLevel=_LL_RandomLevel(spCtl)) > 0 &&
+           (spNew->spSkip=(LINKLIST **)malloc(sizeof(LINKLIST *)*nNewLevel))
+                                                                      == NULL)
+        {
+            nNewLevel = 0;
+        }
+        for(; spCtl->nLevel < nNewLevel; spCtl->nLevel++)
+            spUpdate[spCtl->nLevel+1] = NULL;
+
+        /* Link in, bottom up.
+        */
+        for(nLevel=0; nLevel <= (int)nNewLevel; nLevel++)
+        {
+            spLink = _LL_SkipLink(spCtl, spHead, spUpdate[nLevel], nLevel);
+            *_LL_SkipLink(spCtl, spHead, spNew, nLevel) = *spLink;
+            *spLink = spNew;
+        }
+
+        /* The control block follows the head.
+        */
+        if(spUpdate[0] == NULL)
+            spNew->uBack.spCtl = spCtl;
+        else
+            spNew->uBack.spPrev = spUpdate[0];
+        if(spNew->spNext == NULL)
+            *spTail = spNew;
+        else
+            spNew->spNext->uBack.spPrev = spNew;
+    } else
+     {
+        /* If were sorting the list as we go along, then we need to scan it
+         * and find the required location, otherwise it goes on the tail.
+        */
+        spPrev = *spTail;
+        spCur  = NULL;
+        if(nSort != SORT_NONE)
+        {
+            for(spPrev=NULL, spCur= *spHead; spCur != NULL; 
+                spPrev=spCur, spCur=spCur->spNext)
+            {
+                if(_LL_Compare(nSort, spNew, spCur) < 0)
+                    break;
+            }
+        }
+
+        /* Insert at very beginning of list? The count or control block
+         * follows the head.
+        */
+        if(spPrev == NULL)
+        {
+            spNew->spNext = *spHead;
+            spNew->uBack = (*spHead)->uBack;
+            (*spHead)->uBack.spPrev = spNew;
+            *spHead = spNew;
+        } else
+
+        /* Insert in the middle of the list?
+        */
+        if(spCur != NULL)
+        {
+            spNew->spNext  = spCur;
+            spNew->uBack.spPrev = spPrev;
+            spPrev->spNext = spNew;
+            spCur->uBack.spPrev = spNew;
+        } else
+
+        /* Add to tail of list by making tail point to new item, then 
+         * new item becomes the tail.
+        */
+         {
+            (*spTail)->spNext = spNew;
+            spNew->uBack.spPrev = *spTail;
+            *spTail           = spNew;
+            spNew->spNext     = NULL;
+        }
+    }
+    /* Count the addition, in the head of an unindexed list.
+    */
+    if(spCtl == NULL)
+    {
+        (*spHead)->uBack.lCount = LL_CNT(LL_COUNT(*spHead) + 1);
+        return(R_OK);
+    }
+    spCtl->nCount++;
+
+    /* The hash indexes order duplicates by position, so go in once linked.
+    */
+    if(spCtl->nFlags != 0)
+        _LL_HashAdd(spCtl, *spHead, spNew);
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    _LL_Unlink
+ * Description: Remove an element from a list and its indexes and release
+ *              it. The element links both ways, so no search is needed.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_Unlink( LINKLIST    **spHead,    /* IO: Pointer to head of list */
+                 LINKLIST    **spTail,    /* IO: Pointer to tail of list */
+                 LINKLIST    *spCur )     /* I: Element to remove */
+{
+    /* Local variables.
+    */
+    UINT        nCount = LL_COUNT(*spHead) - 1;
+    LISTCTL     *spCtl = LL_CTL(*spHead);
+
+    /* Take it out of any index first.
+    */
+    if(spCtl != NULL && spCtl->nFlags != 0)
+    {
+        if((spCtl->nFlags & LST_SKIPLIST) != 0)
+            _LL_SkipUnlink(spHead, spCur);
+        _LL_HashDel(spCtl, spCur);
+    }
+
+    /* Item at beginning of list?
+    */
+    if(spCur == *spHead)
+    {
+        /* Point head at next in list. If next is NULL, then list empty,
+         * so update Tail. The count or control block moves to the new head
+         * or goes with the list.
+        */
+        if((*spHead = spCur->spNext) == NULL)
+        {
+            *spTail = NULL;
+            if(spCtl != NULL)
+                _LL_FreeCtl(spCtl);
+        } else
+         {
+            (*spHead)->uBack = spCur->uBack;
+        }
+    } else
+     {
+        if((spCur->uBack.spPrev->spNext = spCur->spNext) == NULL)
+            *spTail = spCur->uBack.spPrev;
+        else
+            spCur->spNext->uBack.spPrev = spCur->uBack.spPrev;
+    }
+
+    /* Count the removal, in the head of an unindexed list.
+    */
+    if(*spHead != NULL)
+    {
+        if(spCtl == NULL)
+            (*spHead)->uBack.lCount = LL_CNT(nCount);
+        else
+            spCtl->nCount = nCount;
+    }
+
+    /* Free memory used by removed element.
+    */
+    _LL_FreeNode(spCur);
+}
+
+/******************************************************************************
+ * Function:    _LL_Lock
+ * Description: Take the allocator lock, spinning briefly then yielding
+ *              whilst another thread holds it, so that lists in different
+ *              threads may share the free list. Without the GNU atomic
+ *              builtins the allocator is only safe within a single thread.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_Lock( void )
+{
+#if defined(__GNUC__)
+    /* Local variables.
+    */
+    UINT        nSpin = 0;
+
+    while(__atomic_exchange_n(&Ll.nLock, 1, __ATOMIC_ACQUIRE) != 0)
+    {
+        while(__atomic_load_n(&Ll.nLock, __ATOMIC_RELAXED) != 0)
+        {
+#if !defined(_WIN32)
+            if(++nSpin > 100)
+                sched_yield();
+#endif
+        }
+    }
+#endif
+}
+
+/******************************************************************************
+ * Function:    _LL_Unlock
+ * Description: Release the allocator lock.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_Unlock( void )
+{
+#if defined(__GNUC__)
+    __atomic_store_n(&Ll.nLock, 0, __ATOMIC_RELEASE);
+#endif
+}
+
+/******************************************************************************
+ * Function:    _LL_AddSlab
+ * Description: Obtain a slab of the given number of elements from the system
+ *              and put them all on the free list. Called holding the
+ *              allocator lock.
+ * Returns:     R_OK      - Slab added.
+ *              R_FAIL    - Memory exhaustion.
+ ******************************************************************************/
+int _LL_AddSlab( UINT    nNodes )    /* I: Elements in slab */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    LL_SLAB     *spSlab;
+
+    if((spSlab=(LL_SLAB *)malloc(sizeof(LL_SLAB) +
+                                 sizeof(LINKLIST) * (nNodes - 1))) == NULL)
+        return(R_FAIL);
+    spSlab->spNext = Ll.spSlab;
+    spSlab->nNodes = nNodes;
+    Ll.spSlab = spSlab;
+    for(nNdx=0; nNdx < nNodes; nNdx++)
+    {
+        spSlab->sNode[nNdx].spNext = (nNdx+1 < nNodes ?
+                                     &spSlab->sNode[nNdx+1] : Ll.spFree);
+    }
+    Ll.spFree = &spSlab->sNode[0];
+    Ll.sStats.lFree += nNodes;
+    Ll.sStats.lSlabs++;
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    _LL_Reserve
+ * Description: Ensure the free list holds at least the given number of
+ *              elements, making up any shortfall with a single slab. No
+ *              effect in LLA_MALLOC mode, and a failure simply leaves
+ *              _LL_NewNode to try again element by element.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_Reserve( ULNG    lNodes )    /* I: Elements about to be needed */
+{
+    _LL_Lock();
+    if(Ll.sStats.nMode == LLA_SLAB && Ll.sStats.lFree < lNodes)
+    {
+        lNodes -= Ll.sStats.lFree;
+        _LL_AddSlab(lNodes < LL_SLABNODES ? LL_SLABNODES : (UINT)lNodes);
+    }
+    _LL_Unlock();
+}
+
+/******************************************************************************
+ * Function:    _LL_NewNode
+ * Description: Obtain a cleared list element, from the free list if possible,
+ *              else from a newly obtained slab, or singly from the system
+ *              when in LLA_MALLOC mode.
+ * Returns:     NOTNULL   - Element.
+ *              NULL      - Memory exhaustion.
+ ******************************************************************************/
+LINKLIST *_LL_NewNode( void )
+{
+    /* Local variables.
+    */
+    LINKLIST    *spNode = NULL;
+
+    _LL_Lock();
+    if(Ll.sStats.nMode == LLA_MALLOC)
+    {
+        spNode = (LINKLIST *)malloc(sizeof(LINKLIST));
+    } else
+
+    /* Free list exhausted, carve up a new slab.
+    */
+    if(Ll.spFree != NULL || _LL_AddSlab(LL_SLABNODES) == R_OK)
+    {
+        spNode = Ll.spFree;
+        Ll.spFree = spNode->spNext;
+        Ll.sStats.lFree--;
+    }
+    if(spNode != NULL)
+    {
+        Ll.sStats.lAllocs++;
+        Ll.sStats.lInUse++;
+    }
+    _LL_Unlock();
+
+    if(spNode != NULL)
+        memset((UCHAR *)spNode, '\0', sizeof(LINKLIST));
+    return(spNode);
+}
+
+/******************************************************************************
+ * Function:    _LL_FreeNode
+ * Description: Hand back a list element, and any string key held outside of
+ *              it, to where it was obtained from.
+ * Returns:     Non.
+ ******************************************************************************/
+void _LL_FreeNode( LINKLIST    *spNode )    /* I: Element to release */
+{
+    if(spNode->szKey != NULL && spNode->szKey != spNode->szInline)
+        free(spNode->szKey);
+
+    _LL_Lock();
+    if(Ll.sStats.nMode == LLA_MALLOC)
+    {
+        free(spNode);
+    } else
+     {
+        spNode->spNext = Ll.spFree;
+        Ll.spFree = spNode;
+        Ll.sStats.lFree++;
+    }
+    Ll.sStats.lFrees++;
+    Ll.sStats.lInUse--;
+    _LL_Unlock();
+}
+
+/******************************************************************************
+ * Function:    _LL_MakeNode
+ * Description: Obtain a list element and populate it with the keys and the
+ *              data it is to carry, ready for linking in.
+ * Returns:     NOTNULL   - Element.
+ *              NULL      - Failure, see Errno.
+ * <Errno>      E_NOMEM   - Memory exhaustion.
+ ******************************************************************************/
+LINKLIST *_LL_MakeNode( UINT        *nKey,       /* I: Integer based search key */
+                        ULNG        *lKey,       /* I: Long based search key */
+                        UCHAR       *szKey,      /* I: String based search key */
+                        void        *spData )    /* I: Address of carried data */
+{
+    /* Local variables.
+    */
+    char        *szFunc = "_LL_MakeNode";
+    UINT        nKeyLen;
+    LINKLIST    *pTmpLRec;
 
-/* Bring in specific header files.
-*/
-#include    "ux.h"
+    /* Obtain a linklist control block. This will be tagged on to the end
+     * of the list... eventually!
+    */
+    if( (pTmpLRec=_LL_NewNode()) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes",
+            sizeof(LINKLIST));
+        Errno = E_NOMEM;
+        return(NULL);
+    }
+
+    /* If a text based search key provided, store it in the element if it
+     * fits and slabs are in use, else allocate space in which to dup it.
+    */
+    if(szKey != NULL)
+    {
+        if((nKeyLen=strlen(szKey)) < LL_INLINEKEY &&
+           Ll.sStats.nMode == LLA_SLAB)
+        {
+            pTmpLRec->szKey = pTmpLRec->szInline;
+        } else
+        if( (pTmpLRec->szKey=(UCHAR *)malloc(nKeyLen+1)) == NULL)
+        {
+            Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes",
+                nKeyLen+1);
+            _LL_FreeNode(pTmpLRec);
+            Errno = E_NOMEM;
+            return(NULL);
+        }
+        _LL_Lock();
+        if(pTmpLRec->szKey == pTmpLRec->szInline)
+            Ll.sStats.lKeysInline++;
+        else
+            Ll.sStats.lKeysAlloc++;
+        _LL_Unlock();
+        strcpy(pTmpLRec->szKey, szKey);
+    }
+    pTmpLRec->lPrefix = _LL_KeyPrefix(pTmpLRec->szKey);
+    
+    /* Populate linklist.
+    */
+    pTmpLRec->nKey   = (nKey == NULL ? 0  : *nKey);
+    pTmpLRec->lKey   = (lKey == NULL ? 0L : *lKey);
+    pTmpLRec->spData = spData;
+    return(pTmpLRec);
+}
 
 /******************************************************************************
  * Function:    AddItem
- * Description: A simplistic mechanism to compose a linked list. The link
- *              is only singly linked, and items are only added to the tail
- *              of the list.
+ * Description: A simplistic mechanism to compose a linked list. Elements
+ *              link both ways, and items are added to the tail of the
+ *              list unless a sort mode is given. Adding LST_SKIPLIST to the
+ *              sort mode when the list is created indexes it with a skip
+ *              list, making sorted additions O(log n) rather than O(n).
+ *              LST_HASH_NKEY, LST_HASH_LKEY and LST_HASH_SZKEY likewise
+ *              hash index the list on that key for FindItem.
  * Returns:     R_OK      - Item added successfully.
  *              R_FAIL    - Failure in addition, see Errno.
  * <Errno>      E_NOMEM   - Memory exhaustion.
@@ -95,14 +1232,34 @@ int AddItem( LINKLIST    **spHead,    /* IO: Pointer to head of list */
              ULNG        *lKey,       /* I: Long based search key */
              UCHAR       *szKey,      /* I: String based search key */
              void        *spData )    /* I: Address of carried data */
+{
+    return(AddItemWithHandle(spHead, spTail, nMode, nKey, lKey, szKey, spData,
+                             NULL));
+}
+
+/******************************************************************************
+ * Function:    AddItemWithHandle
+ * Description: As AddItem, also returning a handle to the new element with
+ *              which DelItemByHandle can remove it without a search. The
+ *              handle is valid until the element is deleted.
+ * Returns:     R_OK      - Item added successfully.
+ *              R_FAIL    - Failure in addition, see Errno.
+ * <Errno>      E_NOMEM   - Memory exhaustion.
+ *              E_NODATA  - No data to carry.
+ ******************************************************************************/
+int AddItemWithHandle( LINKLIST    **spHead,    /* IO: Pointer to head of list */
+                       LINKLIST    **spTail,    /* IO: Pointer to tail of list */
+                       int         nMode,       /* I: Mode of addition to link */
+                       UINT        *nKey,       /* I: Integer based search key */
+                       ULNG        *lKey,       /* I: Long based search key */
+                       UCHAR       *szKey,      /* I: String based search key */
+                       void        *spData,     /* I: Address of carried data */
+                       LISTHANDLE  *spHandle )  /* O: Element handle, or NULL */
 {
     /* Local variables.
     */
-    char        *szFunc = "AddItem";
+    char        *szFunc = "AddItemWithHandle";
     LINKLIST    *pTmpLRec;
-    LINKLIST    *pTailRec;
-    LINKLIST    *spCur;
-    LINKLIST    *spPrev;
 
     /* Quick check, no point adding to list if there is no data.
     */
@@ -112,120 +1269,108 @@ int AddItem( LINKLIST    **spHead,    /* IO: Pointer to head of list */
         return(R_FAIL);
     }
 
-    /* Allocate enough memory for a linklist control block. This will be
-     * tagged on to the end of the list... eventually!
+    /* Obtain a populated linklist control block, Errno already set if
+     * not.
     */
-    if( (pTmpLRec=(LINKLIST *)malloc(sizeof(LINKLIST))) == NULL)
+    if( (pTmpLRec=_LL_MakeNode(nKey, lKey, szKey, spData)) == NULL)
+        return(R_FAIL);
+
+    /* Right, we have a record, link it in where it belongs.
+    */
+    if(_LL_Insert(spHead, spTail, nMode, pTmpLRec) == R_FAIL)
     {
         Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes",
-            sizeof(LINKLIST));
+            sizeof(LISTCTL));
+        _LL_FreeNode(pTmpLRec);
         Errno = E_NOMEM;
         return(R_FAIL);
     }
-    memset((UCHAR *)pTmpLRec, '\0', sizeof(LINKLIST));
+    if(spHandle != NULL)
+        *spHandle = (LISTHANDLE)pTmpLRec;
 
-    /* If a text based search key provided, need to allocate space in which
-     * to store it. If allocation succeeds, dup key.
+    /* Return success or fail...?
     */
-    if(szKey != NULL)
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    AddItems
+ * Description: Add an array of items to a list in one call, as AddItem would
+ *              add each in turn. The elements for all of them are obtained
+ *              up front, as a single slab where the free list is short, and
+ *              either every item is added or none is. Key arrays may be
+ *              NULL where that key is not used.
+ * Returns:     R_OK      - Items added successfully.
+ *              R_FAIL    - Failure in addition, nothing added, see Errno.
+ * <Errno>      E_NOMEM   - Memory exhaustion.
+ *              E_NODATA  - No data to carry in an item.
+ ******************************************************************************/
+int AddItems( LINKLIST    **spHead,    /* IO: Pointer to head of list */
+              LINKLIST    **spTail,    /* IO: Pointer to tail of list */
+              int         nMode,       /* I: Mode of addition to link */
+              UINT        *nKeys,      /* I: Integer keys, or NULL */
+              ULNG        *lKeys,      /* I: Long keys, or NULL */
+              UCHAR       **szKeys,    /* I: String keys, or NULL */
+              void        **spData,    /* I: Addresses of carried data */
+              UINT        nItems )     /* I: Number of items */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    LINKLIST    *spFirst = NULL;
+    LINKLIST    *spLast = NULL;
+    LINKLIST    *spNode;
+    LINKLIST    *spNext;
+
+    for(nNdx=0; nNdx < nItems; nNdx++)
     {
-        if( (pTmpLRec->szKey=(UCHAR *)malloc(strlen(szKey)+1)) == NULL)
+        if(spData == NULL || spData[nNdx] == NULL)
         {
-            Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes",
-                strlen(szKey)+1);
-            free(pTmpLRec);
-            Errno = E_NOMEM;
+            Errno = E_NODATA;
             return(R_FAIL);
-        } else
-         {
-            strcpy(pTmpLRec->szKey, szKey);
         }
     }
-    
-    /* Populate linklist.
-    */
-    pTmpLRec->nKey   = (nKey == NULL ? 0  : *nKey);
-    pTmpLRec->lKey   = (lKey == NULL ? 0L : *lKey);
-    pTmpLRec->spData = spData;
 
-    /* Right, we have a record, so where do we add it.
+    /* Make all the elements first, chained in order, so that a failure
+     * leaves the list untouched.
     */
-    if(*spHead == NULL)
+    _LL_Reserve(nItems);
+    for(nNdx=0; nNdx < nItems; nNdx++)
     {
-        /* Both pointers look at new element.
-        */
-        *spHead = pTmpLRec;
-        *spTail = pTmpLRec;
-        pTmpLRec->spNext = NULL;
-    } else
-     {
-        /* If were sorting the list as we go along, then we need to scan it and
-         * find the required location.
-        */
-        if(nMode != SORT_NONE)
+        if((spNode=_LL_MakeNode(nKeys == NULL ? NULL : &nKeys[nNdx],
+                                lKeys == NULL ? NULL : &lKeys[nNdx],
+                                szKeys == NULL ? NULL : szKeys[nNdx],
+                                spData[nNdx])) == NULL)
         {
-            for(spPrev=NULL, spCur= *spHead; spCur != NULL; 
-                spPrev=spCur, spCur=spCur->spNext)
+            for(; spFirst != NULL; spFirst=spNext)
             {
-                if(nMode == SORT_INT_UP    && pTmpLRec->nKey < spCur->nKey)
-                    break;
-                else
-                if(nMode == SORT_INT_DOWN  && pTmpLRec->nKey > spCur->nKey)
-                    break;
-                else
-                if(nMode == SORT_LONG_UP   && pTmpLRec->lKey < spCur->lKey)
-                    break;
-                else
-                if(nMode == SORT_LONG_DOWN && pTmpLRec->lKey > spCur->lKey)
-                    break;
+                spNext = spFirst->spNext;
+                _LL_FreeNode(spFirst);
             }
+            return(R_FAIL);
+        }
+        if(spLast == NULL)
+            spFirst = spNode;
+        else
+            spLast->spNext = spNode;
+        spLast = spNode;
+    }
 
-            /* Error condition, should not occur?
-            */
-            if(spPrev == NULL && spCur == NULL)
-            {
-                if(pTmpLRec->szKey != NULL)
-                    free(pTmpLRec->szKey);
-                free(pTmpLRec);
-                return(R_FAIL);
-            } else
-
-            /* Insert at very beginning of list?
-            */
-            if(spPrev == NULL && spCur != NULL)
-            {
-                pTmpLRec->spNext = *spHead;
-                *spHead = pTmpLRec;
-            } else
-
-            /* Insert in the middle of the list?
-            */
-            if(spPrev != NULL && spCur != NULL)
+    /* Now link each in where it belongs. Only the first element of an
+     * empty list can fail to go in, when nothing has been added.
+    */
+    for(spNode=spFirst; spNode != NULL; spNode=spNext)
+    {
+        spNext = spNode->spNext;
+        if(_LL_Insert(spHead, spTail, nMode, spNode) == R_FAIL)
+        {
+            for(; spNode != NULL; spNode=spNext)
             {
-                pTmpLRec->spNext = spPrev->spNext;
-                spPrev->spNext   = pTmpLRec;
-            } else
-
-            /* Insert at the end of the list!
-            */
-             {
-                /* Add to tail of list by making tail point to new item, then 
-                 * new item becomes the tail.
-                */
-                pTailRec         = *spTail;
-                pTailRec->spNext = pTmpLRec;
-                *spTail          = pTmpLRec;
-                pTmpLRec->spNext = NULL;
+                spNext = spNode->spNext;
+                _LL_FreeNode(spNode);
             }
-        } else
-         {
-            /* Add to tail of list by making tail point to new item, then 
-             * new item becomes the tail.
-            */
-            pTailRec         = *spTail;
-            pTailRec->spNext = pTmpLRec;
-            *spTail          = pTmpLRec;
-            pTmpLRec->spNext = NULL;
+            Errno = E_NOMEM;
+            return(R_FAIL);
         }
     }
 
@@ -239,6 +1384,8 @@ int AddItem( LINKLIST    **spHead,    /* IO: Pointer to head of list */
  * Description: Delete an element from a given linked list. The underlying
  *              carried data is not freed, it is assumed that the caller
  *              will free that, as it was the caller that allocated it.
+ *              A single hash indexed key locates the element directly. An
+ *              element without a string key matches any string key given.
  * Returns:     R_OK      - Item deleted successfully.
  *              R_FAIL    - Failure in deletion, see Errno.
  * <Errno>      E_BADHEAD - Head pointer is bad.
@@ -256,8 +1403,11 @@ int DelItem( LINKLIST    **spHead,   /* IO: Pointer to head of list */
     /* Local variables.
     */
     int         nResult = R_FAIL;
+    LISTCTL     *spCtl;
+    LINKLIST    **spSlot;
     LINKLIST    *spCur;
     LINKLIST    *spPrev;
+    LINKLIST    sProbe;
 
     /* Check input values. Is head valid?
     */
@@ -283,11 +1433,34 @@ int DelItem( LINKLIST    **spHead,   /* IO: Pointer to head of list */
         return(nResult);
     }
 
-    /* Locate item by scanning the list. This may get updated in years to
-     * come to be a hash/btree lookup/delete.... dream on!!
+    /* A hash index on the only key given finds the element directly.
+    */
+    if((spCtl=LL_CTL(*spHead)) != NULL && spKey == NULL &&
+       (spSlot=_LL_HashFind(spCtl, nKey, lKey, szKey)) != NULL)
+    {
+        spCur = *spSlot;
+    } else
+
+    /* An indexed list searched on its sort key alone can be seeked.
+    */
+    if(spCtl != NULL &&
+       (spCtl->nFlags & LST_SKIPLIST) != 0 && spKey == NULL && szKey == NULL &&
+       (((spCtl->nMode == SORT_INT_UP || spCtl->nMode == SORT_INT_DOWN) &&
+         nKey != NULL && lKey == NULL) ||
+        ((spCtl->nMode == SORT_LONG_UP || spCtl->nMode == SORT_LONG_DOWN) &&
+         lKey != NULL && nKey == NULL)))
+    {
+        sProbe.nKey = (nKey == NULL ? 0  : *nKey);
+        sProbe.lKey = (lKey == NULL ? 0L : *lKey);
+        spPrev = _LL_SkipSeek(spHead, &sProbe);
+        spCur  = (spPrev == NULL ? *spHead : spPrev->spNext);
+        if(spCur != NULL && _LL_Compare(spCtl->nMode, spCur, &sProbe) != 0)
+            spCur = NULL;
+    } else
+
+    /* Locate item by scanning the list.
     */
-    for(spPrev=NULL, spCur= *spHead; spCur != NULL; 
-        spPrev=spCur, spCur=spCur->spNext)
+    for(spCur= *spHead; spCur != NULL; spCur=spCur->spNext)
     {
         /* See if we have a match!
         */
@@ -308,26 +1481,7 @@ int DelItem( LINKLIST    **spHead,   /* IO: Pointer to head of list */
     */
     if(spCur != NULL)
     {
-        /* Item at beginning of list?
-        */
-        if(spPrev == NULL)
-        {
-            /* Point head at next in list. If next is NULL, then list empty,
-             * so update Tail.
-            */
-            if((*spHead = spCur->spNext) == NULL)
-                *spTail = NULL;
-        } else
-         {
-            if((spPrev->spNext = spCur->spNext) == NULL)
-                *spTail = spPrev;
-        }
-
-        /* Free memory used by removed element.
-        */
-        if(spCur->szKey != NULL)
-            free(spCur->szKey);
-        free(spCur);
+        _LL_Unlink(spHead, spTail, spCur);
         nResult = R_OK;
     }
 
@@ -336,9 +1490,52 @@ int DelItem( LINKLIST    **spHead,   /* IO: Pointer to head of list */
     return(nResult);
 }
 
+/******************************************************************************
+ * Function:    DelItemByHandle
+ * Description: Delete the element a handle refers to, in O(1) as no search
+ *              is needed. As with DelItem, the carried data is not freed. The
+ *              handle must belong to the given list and not be deleted
+ *              already. Deleting the element most recently returned by
+ *              StartItem/NextItem does not disturb the iteration.
+ * Returns:     R_OK      - Item deleted successfully.
+ *              R_FAIL    - Failure in deletion, see Errno.
+ * <Errno>      E_BADHEAD - Head pointer is bad.
+ *              E_BADTAIL - Tail pointer is bad.
+ *              E_BADPARM - No handle given.
+ ******************************************************************************/
+int DelItemByHandle( LINKLIST    **spHead,     /* IO: Pointer to head of list */
+                     LINKLIST    **spTail,     /* IO: Pointer to tail of list */
+                     LISTHANDLE  spHandle )    /* I: Handle of element */
+{
+    /* Check input values.
+    */
+    if(*spHead == NULL)
+    {
+        Errno = E_BADHEAD;
+        return(R_FAIL);
+    }
+    if(*spTail == NULL)
+    {
+        Errno = E_BADTAIL;
+        return(R_FAIL);
+    }
+    if(spHandle == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+
+    /* The element knows its neighbours, unlink directly.
+    */
+    _LL_Unlink(spHead, spTail, (LINKLIST *)spHandle);
+    return(R_OK);
+}
+
 /******************************************************************************
  * Function:    FindItem
- * Description: Find an element in a given linked list.
+ * Description: Find an element in a given linked list. A search on a single
+ *              hash indexed key is O(1). An element without a string key is
+ *              never found by a string key.
  * Returns:     NOTNULL    - Item found, address returned.
  *              NULL       - Item not found, see Errno.
  * <Errno>      E_BADHEAD - Head pointer is bad.
@@ -353,7 +1550,36 @@ void *FindItem( LINKLIST    *spHead,    /* I: Pointer to head of list */
     /* Local variables.
     */
     UCHAR        *spResult = NULL;
+    LISTCTL     *spCtl = (spHead == NULL ? NULL : LL_CTL(spHead));
+    LINKLIST    **spSlot;
     LINKLIST    *spCur;
+    LINKLIST    *spPrev;
+    LINKLIST    sProbe;
+
+    /* A hash index on the key searched gives a direct answer.
+    */
+    if(spCtl != NULL &&
+       (spSlot=_LL_HashFind(spCtl, nKey, lKey, szKey)) != NULL)
+    {
+        spCur = *spSlot;
+    } else
+
+    /* An indexed list searched on its sort key alone can be seeked, equal
+     * keys are adjacent so the first found is the first in the list.
+    */
+    if(spCtl != NULL && (spCtl->nFlags & LST_SKIPLIST) != 0 && szKey == NULL &&
+       (((spCtl->nMode == SORT_INT_UP || spCtl->nMode == SORT_INT_DOWN) &&
+         nKey != NULL && lKey == NULL) ||
+        ((spCtl->nMode == SORT_LONG_UP || spCtl->nMode == SORT_LONG_DOWN) &&
+         lKey != NULL && nKey == NULL)))
+    {
+        sProbe.nKey = (nKey == NULL ? 0  : *nKey);
+        sProbe.lKey = (lKey == NULL ? 0L : *lKey);
+        spPrev = _LL_SkipSeek(&spHead, &sProbe);
+        spCur  = (spPrev == NULL ? spHead : spPrev->spNext);
+        if(spCur != NULL && _LL_Compare(spCtl->nMode, spCur, &sProbe) != 0)
+            spCur = NULL;
+    } else
 
     /* Quite simple at the momoko, just loop through the list and see if an
      * entry exists. Eventually, (he hopes) this could be enhanced to inc
@@ -367,7 +1593,8 @@ void *FindItem( LINKLIST    *spHead,    /* I: Pointer to head of list */
         if(lKey != NULL && spCur->lKey == *lKey)
             break;
 
-        if(szKey != NULL && strcmp(szKey, spCur->szKey) == 0)
+        if(szKey != NULL && spCur->szKey != NULL &&
+           strcmp(szKey, spCur->szKey) == 0)
             break;
     }
 
@@ -447,10 +1674,32 @@ void *NextItem( LINKLIST    **spNext )    /* O: Pointer to next item in list */
     return(spResult);
 }
 
+/******************************************************************************
+ * Function:    CurrentHandle
+ * Description: Obtain the handle of the element most recently returned by
+ *              StartItem/NextItem, so that it can be deleted with
+ *              DelItemByHandle without ending the iteration. Must be called
+ *              before the element is deleted.
+ * Returns:     NOTNULL    - Handle of current element.
+ *              NULL       - Empty list.
+ ******************************************************************************/
+LISTHANDLE CurrentHandle( LINKLIST    *spTail,    /* I: Pointer to tail of list */
+                          LINKLIST    *spNext )   /* I: Iteration position */
+{
+    /* The iteration holds the element after the current one, or nothing
+     * when the current one is the tail.
+    */
+    return((LISTHANDLE)(spNext == NULL ? spTail : spNext->uBack.spPrev));
+}
+
 /******************************************************************************
  * Function:    MergeLists
  * Description: Merge two list together. The Source list is merged into the
- *              target list. Lists are re-sorted if required.
+ *              target list. Lists are re-sorted if required. When both are
+ *              already in the sort order they are merged in a single pass,
+ *              O(n+m), and any skip list index rebuilt; otherwise each
+ *              element is inserted, through the skip list index of the
+ *              target if it has one.
  * Returns:     R_OK      - Item added successfully.
  *              R_FAIL    - Failure in addition, see Errno.
  * <Errno>      E_NOMEM   - Memory exhaustion.
@@ -466,99 +1715,119 @@ int MergeLists( LINKLIST    **spDstHead,   /* IO: Pointer to head of dest list *
 {
     /* Local variables.
     */
+    int         nSort = nMode & SORT_MASK;
+    int         nSrc;
+    UINT        nCount;
+    UINT        nType;
+    LISTCTL     *spCtl;
     LINKLIST    *spNext;
     LINKLIST    *spSrc;
-    LINKLIST    *pTailRec;
-    LINKLIST    *spCur;
-    LINKLIST    *spPrev;
+    LINKLIST    *spDst;
+    LINKLIST    *spHead;
+    LINKLIST    *spTail;
 
-    /* Go through each record in the source list and add onto the destination
-     * list.
+    /* Nothing to merge?
     */
-    if((spSrc = spSrcHead) != NULL)
-        spNext = spSrcHead->spNext;
-    else
-        spNext = NULL;
-    
-    /* Loop through the entire source list and merge into the destination list.
+    if(spSrcHead == NULL)
+        return(R_OK);
+
+    /* The source list ceases to exist, so does its index. Its control block
+     * goes once the first element has moved, a failure until then leaving
+     * the source list whole. The first element of an empty destination goes
+     * in alone so that the count or control block and any index are created.
     */
-    while(spSrc != NULL)
+    if((spCtl=LL_CTL(spSrcHead)) != NULL)
+        _LL_DropIndex(spSrcHead);
+    if(*spDstHead == NULL)
     {
-        /* Right, we have a record, so where do we add it.
-        */
-        if(*spDstHead == NULL)
+        spNext = spSrcHead->spNext;
+        if(_LL_Insert(spDstHead, spDstTail, nMode, spSrcHead) == R_FAIL)
         {
-            /* Both pointers look at new element.
-            */
-            *spDstHead = spSrc;
-            *spDstTail = spSrc;
-            spSrc->spNext = NULL;
-        } else
-         {
-            /* If were sorting the list as we go along, then we need to scan it
-             * and find the required location.
-            */
-            if(nMode != SORT_NONE)
-            {
-                for(spPrev=NULL, spCur= *spDstHead; spCur != NULL; 
-                    spPrev=spCur, spCur=spCur->spNext)
-                {
-                    if(nMode == SORT_INT_UP    && spSrc->nKey < spCur->nKey)
-                        break;
-                    else
-                    if(nMode == SORT_INT_DOWN  && spSrc->nKey > spCur->nKey)
-                        break;
-                    else
-                    if(nMode == SORT_LONG_UP   && spSrc->lKey < spCur->lKey)
-                        break;
-                    else
-                    if(nMode == SORT_LONG_DOWN && spSrc->lKey > spCur->lKey)
-                        break;
-                }
+            Errno = E_NOMEM;
+            return(R_FAIL);
+        }
+        spSrcHead = spNext;
+    }
+    if(spCtl != NULL)
+        _LL_FreeCtl(spCtl);
+    spCtl = LL_CTL(*spDstHead);
+    nCount = LL_COUNT(*spDstHead);
 
-                /* Insert at very beginning of list?
-                */
-                if(spPrev == NULL && spCur != NULL)
-                {
-                    spSrc->spNext = *spDstHead;
-                    *spDstHead = spSrc;
-                } else
+    /* Both lists in order, merge them side by side.
+    */
+    if(nSort != SORT_NONE && spSrcHead != NULL &&
+       _LL_IsSorted(spSrcHead, nSort) && _LL_IsSorted(*spDstHead, nSort))
+    {
+        if(spCtl != NULL &&
+           (spCtl->nFlags & LST_SKIPLIST) != 0 && spCtl->nMode != nSort)
+        {
+            _LL_DropSkip(*spDstHead);
+        }
 
-                /* Insert in the middle of the list?
-                */
-                if(spPrev != NULL && spCur != NULL)
-                {
-                    spSrc->spNext  = spPrev->spNext;
-                    spPrev->spNext = spSrc;
-                } else
+        /* The hash indexes are filled afresh as the merged list is built,
+         * each element going in after all those already indexed.
+        */
+        for(nType=0; spCtl != NULL && nType < LL_HASHTYPES; nType++)
+        {
+            if(spCtl->sHash[nType].spSlot != NULL)
+                memset((UCHAR *)spCtl->sHash[nType].spSlot, '\0',
+                       sizeof(LISTSLOT) * spCtl->sHash[nType].nSize);
+            spCtl->sHash[nType].nUsed = 0;
+        }
 
-                /* Insert at the end of the list!
-                */
-                {
-                    /* Add to tail of list by making tail point to new item,
-                     * then new item becomes the tail.
-                    */
-                    pTailRec         = *spDstTail;
-                    pTailRec->spNext = spSrc;
-                    *spDstTail       = spSrc;
-                    spSrc->spNext = NULL;
-                }
+        /* Take the lower of the two heads each step, destination first on
+         * equal keys as an insertion would.
+        */
+        for(spHead=spTail=NULL, spDst= *spDstHead, spSrc=spSrcHead;
+            spDst != NULL || spSrc != NULL; spTail=spNext)
+        {
+            nSrc = (spSrc != NULL &&
+                    (spDst == NULL || _LL_Compare(nSort, spSrc, spDst) < 0));
+            if(nSrc == FALSE)
+            {
+                spNext = spDst;
+                spDst = spDst->spNext;
             } else
              {
-                /* Add to tail of list by making tail point to new item, then 
-                 * new item becomes the tail.
-                */
-                pTailRec         = *spDstTail;
-                pTailRec->spNext = spSrc;
-                *spDstTail       = spSrc;
-                spSrc->spNext    = NULL;
+                spNext = spSrc;
+                spSrc = spSrc->spNext;
+                nCount++;
             }
+            spNext->uBack.spPrev = spTail;
+            spNext->spNext = NULL;
+            if(spTail == NULL)
+                spHead = spNext;
+            else
+                spTail->spNext = spNext;
+            if(spCtl != NULL && spCtl->nFlags != 0)
+                _LL_HashAdd(spCtl, spHead, spNext);
         }
 
-        /* Move to next element.
+        /* The count or control block goes to the new head, and the skip
+         * index is rebuilt to take in the new elements.
         */
-        if((spSrc = spNext) != NULL)
-            spNext = spSrc->spNext;
+        *spDstHead = spHead;
+        *spDstTail = spTail;
+        if(spCtl == NULL)
+        {
+            spHead->uBack.lCount = LL_CNT(nCount);
+        } else
+         {
+            spHead->uBack.spCtl = spCtl;
+            spCtl->nCount = nCount;
+            if((spCtl->nFlags & LST_SKIPLIST) != 0)
+                _LL_SkipRebuild(spHead);
+        }
+    } else
+
+    /* Loop through the rest of the source list and merge into the
+     * destination list, which is indexed if it has one. The destination
+     * exists, so an insertion cannot fail.
+    */
+    for(spSrc=spSrcHead; spSrc != NULL; spSrc=spNext)
+    {
+        spNext = spSrc->spNext;
+        _LL_Insert(spDstHead, spDstTail, nMode, spSrc);
     }
 
     /* Return success or fail...?
@@ -577,6 +1846,24 @@ int MergeLists( LINKLIST    **spDstHead,   /* IO: Pointer to head of dest list *
  ******************************************************************************/
 int DelList( LINKLIST    **spHead,     /* IO: Pointer to head of list */
              LINKLIST    **spTail )    /* IO: Pointer to tail of list */
+{
+    return(DelListWithFree(spHead, spTail, free));
+}
+
+/******************************************************************************
+ * Function:    DelListWithFree
+ * Description: Delete an entire list, handing each carried data item to the
+ *              given destructor, so that it can go back to wherever it was
+ *              obtained from. A NULL destructor leaves the data with the
+ *              caller.
+ * Returns:     R_OK      - List deleted successfully.
+ *              R_FAIL    - Failed to delete list, see Errno.
+ * <Errno>      E_BADHEAD - Head pointer is bad.
+ *              E_BADTAIL - Tail pointer is bad.
+ ******************************************************************************/
+int DelListWithFree( LINKLIST    **spHead,      /* IO: Pointer to head of list */
+                     LINKLIST    **spTail,      /* IO: Pointer to tail of list */
+                     void        (*fFree)(void *) ) /* I: Data destructor */
 {
     /* Local variables.
     */
@@ -599,24 +1886,29 @@ int DelList( LINKLIST    **spHead,     /* IO: Pointer to head of list */
         return(R_FAIL);
     }
 
+    /* Release any control block and index.
+    */
+    if(LL_ISCNT(*spHead) == FALSE)
+        _LL_FreeCtl((*spHead)->uBack.spCtl);
+
     /* Quite simple, breeze through list, deleting everything.
     */
     for(spTmp= *spHead; spTmp != NULL; spTmp=spNext)
     {
-        /* Free any memory allocated for text search buffer.
+        /* Free any index links.
         */
-        if(spTmp->szKey != NULL)
-            free(spTmp->szKey);
+        if(spTmp->spSkip != NULL)
+            free(spTmp->spSkip);
 
-        /* Free any memory allocated for data record.
+        /* Hand back the data record.
         */
-        if(spTmp->spData != NULL)
-            free(spTmp->spData);
+        if(spTmp->spData != NULL && fFree != NULL)
+            fFree(spTmp->spData);
 
         /* Get next element then release element memory.
         */
         spNext=spTmp->spNext;
-        free(spTmp);
+        _LL_FreeNode(spTmp);
     }
 
     /* Tidy up callers pointers.
@@ -630,8 +1922,8 @@ int DelList( LINKLIST    **spHead,     /* IO: Pointer to head of list */
 
 /******************************************************************************
  * Function:    SizeList
- * Description: Find the total number of elements in a given list by scanning
- *              it.
+ * Description: Find the total number of elements in a given list, which the
+ *              head of the list keeps count of.
  * Returns:     R_OK      - List size calculated.
  *              R_FAIL    - Failed to calculate list size, see Errno.
  * <Errno>      E_BADHEAD - Head pointer is bad.
@@ -639,10 +1931,6 @@ int DelList( LINKLIST    **spHead,     /* IO: Pointer to head of list */
 int SizeList( LINKLIST    *spHead,       /* I: Pointer to head of list */
               UINT        *nCnt )        /* O: Count of elements in list */
 {
-    /* Local variables.
-    */
-    LINKLIST    *spTmp;
-
     /* Check input values. Is head valid?
     */
     if(spHead == NULL)
@@ -650,12 +1938,79 @@ int SizeList( LINKLIST    *spHead,       /* I: Pointer to head of list */
         Errno = E_BADHEAD;
         return(R_FAIL);
     }
+    *nCnt = LL_COUNT(spHead);
 
-    /* Quite simple, breeze through list, counting.
+    /* Got here, perhaps everything worked...!
     */
-    for(*nCnt=0,spTmp=spHead; spTmp != NULL; *nCnt += 1, spTmp=spTmp->spNext);
+    return(R_OK);
+}
 
-    /* Got here, perhaps everything worked...!
+/******************************************************************************
+ * Function:    SetListAlloc
+ * Description: Select how list elements are allocated, LLA_SLAB (default)
+ *              with short keys held inline, or LLA_MALLOC where elements and
+ *              keys are each allocated from the system. Only possible whilst
+ *              no elements are in use, at which point any slabs held are
+ *              returned to the system, so calling with the current mode
+ *              trims the allocator.
+ * Thread Safe: Yes.
+ * Returns:     R_OK      - Mode set.
+ *              R_FAIL    - Mode not set, see Errno.
+ * <Errno>      E_BADPARM - Unknown mode.
+ *              E_BUSY    - List elements still in use.
+ ******************************************************************************/
+int SetListAlloc( UINT    nMode )    /* I: LLA_SLAB or LLA_MALLOC */
+{
+    /* Local variables.
+    */
+    LL_SLAB     *spSlab;
+
+    if(nMode != LLA_SLAB && nMode != LLA_MALLOC)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    _LL_Lock();
+    if(Ll.sStats.lInUse != 0)
+    {
+        _LL_Unlock();
+        Errno = E_BUSY;
+        return(R_FAIL);
+    }
+
+    /* Nothing in use, so every slab is wholly free.
     */
+    while((spSlab=Ll.spSlab) != NULL)
+    {
+        Ll.spSlab = spSlab->spNext;
+        free(spSlab);
+    }
+    Ll.spFree = NULL;
+    Ll.sStats.lFree = 0;
+    Ll.sStats.lSlabs = 0;
+    Ll.sStats.nMode = nMode;
+    _LL_Unlock();
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    GetListAllocStats
+ * Description: Obtain the allocation mode and counters of the list element
+ *              allocator.
+ * Thread Safe: Yes.
+ * Returns:     R_OK      - Statistics returned.
+ *              R_FAIL    - Bad parameter, see Errno.
+ * <Errno>      E_BADPARM - No buffer given.
+ ******************************************************************************/
+int GetListAllocStats( LISTALLOCSTATS    *spStats )    /* O: Statistics */
+{
+    if(spStats == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    _LL_Lock();
+    *spStats = Ll.sStats;
+    _LL_Unlock();
     return(R_OK);
 }
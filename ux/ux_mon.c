@@ -142,6 +142,7 @@ UINT _ML_InterpretHTMLRequest( ML_MONLIST    *spMon,        /* I: Monitor Desc *
     */
     UINT            nPos = 0;
     UINT            nTokType;
+    UINT            nCmdId;
     UCHAR           *spTmpTok = NULL;
     UCHAR           szTmpBuf[MAX_TMPBUFLEN+1];
     LINKLIST        *spNext = NULL;
@@ -163,15 +164,21 @@ UINT _ML_InterpretHTMLRequest( ML_MONLIST    *spMon,        /* I: Monitor Desc *
     */
     nTokType = ParseForToken(szData, &nPos, spTmpTok);
 
-    /* Get the first token from the HTML buffer and check to see if its
-     * within the recognised command set.
+    /* Look the token up once in the intern table, every registered command
+     * is in there so a token that is not cannot match any of them.
     */
-    for(spMC=(ML_COMMANDLIST *)StartItem(spMon->spMCHead, &spNext);
+    nCmdId = SI_Intern(spTmpTok, SI_NOCASE);
+    free(spTmpTok);
+
+    /* Check to see if the token is within the recognised command set.
+    */
+    for(spMC=(nCmdId == 0 ? NULL :
+                     (ML_COMMANDLIST *)StartItem(spMon->spMCHead, &spNext));
         spMC != NULL; spMC=(ML_COMMANDLIST *)NextItem(&spNext))
     {
         /* Match?
         */
-        if(StrCaseCmp(spMC->szCommand, spTmpTok) == 0)
+        if(spMC->nCmdId == nCmdId)
         {
             /* Send positive header to browser client.
             */
@@ -506,8 +513,9 @@ void _ML_MonitorCntrl( int    nType,    /* I: Type of callback */
 
             /* Tag onto end of existing list.
             */
-            if(AddItem(&spMon->spConHead,&spMon->spConTail,SORT_NONE,&nChanId,
-                       NULL, NULL, spCon) == R_FAIL)
+            if(AddItem(&spMon->spConHead, &spMon->spConTail,
+                       SORT_NONE|LST_HASH_NKEY, &nChanId, NULL, NULL, spCon)
+                                                                    == R_FAIL)
             {
                 /* Dont modify Errno as AddItem has already set it for the
                  * correct error condition.
@@ -751,8 +759,8 @@ int ML_Init( UINT     nMonPort,              /* I: Port that monitor service is
 
     /* Success so far... so tag record onto end of our monitor list.
     */
-    if(AddItem(&Ml.spMonHead, &Ml.spMonTail, SORT_NONE, &spMon->nMonPort, NULL,
-               NULL, spMon) == R_FAIL)
+    if(AddItem(&Ml.spMonHead, &Ml.spMonTail, SORT_NONE|LST_HASH_NKEY,
+               &spMon->nMonPort, NULL, NULL, spMon) == R_FAIL)
     {
         /* Get rid of comms server.
         */
@@ -985,15 +993,24 @@ int    ML_AddMonCommand( UINT        nMonPort,          /* I: Service Mon Port *
                 return(R_FAIL);
             }
 
-            /* Store command and callback in new memory.
+            /* Store command and callback in new memory, interning the
+             * command so that requests can be matched against it by id.
             */
             strcpy(spMC->szCommand, szCommand);
             spMC->nCallback = nCallback;
+            if((spMC->nCmdId = SI_Intern(szCommand, SI_CREATE|SI_NOCASE)) == 0)
+            {
+                Lgr(LOG_DEBUG, szFunc, "Couldnt intern command (%s)",
+                    szCommand);
+                free(spMC->szCommand);
+                free(spMC);
+                return(R_FAIL);
+            }
         }
 
         /* Add to Monitor Command list.
         */
-        if(AddItem(&spMon->spMCHead, &spMon->spMCTail, SORT_NONE, NULL, NULL,
+        if(AddItem(&spMon->spMCHead, &spMon->spMCTail, SORT_NONE|LST_HASH_SZKEY, NULL, NULL,
                    spMC->szCommand, spMC) == R_FAIL)
         {
             /* Dont modify Errno as AddItem has already set it for the
@@ -1060,7 +1077,8 @@ int    ML_DelMonCommand( UINT        nMonPort,       /* I: Service Mon Port */
 
 /******************************************************************************
  * Function:    ML_Broadcast
- * Description: Broadcast a message to all listening monitor processes.
+ * Description: Broadcast a message to all listening monitor processes. The
+ *              message is framed once and shared by all client channels.
  * Returns:     R_OK     - Data sent to some/all successfully.
  *              R_FAIL   - Couldnt send to any, see Errno.
  * <Errno>        
@@ -1070,24 +1088,65 @@ int ML_Broadcast( UCHAR   *szData,     /* I: Data to be sent */
 {
     /* Local variables.
     */
-    int            nReturn = R_FAIL;
+    UINT        nChanCnt = 0;
+    UINT        *nChanIds;
+    int         nReturn = R_FAIL;
+    char        *szFunc = "ML_Broadcast";
     LINKLIST    *spNext;
+    LINKLIST    *spConNext;
+    ML_MONLIST  *spMon;
+    ML_CONLIST  *spCon;
+
+    /* If nDataLen is 0, then the data is in a null terminated string,
+     * so work out its length.
+    */
+    if(nDataLen == 0)
+        nDataLen = strlen(szData);
 
-    /* Scan list to find monitor clients.
-    for(spNetCon=(ML_NETCONS *)StartItem(Ml.spHead, &spNext); spNetCon != NULL;
-        spNetCon=(ML_NETCONS *)NextItem(&spNext))
+    /* Count the monitor clients across all services.
+    */
+    for(spMon=(ML_MONLIST *)StartItem(Ml.spMonHead, &spNext); spMon != NULL;
+        spMon=(ML_MONLIST *)NextItem(&spNext))
     {
+        for(spCon=(ML_CONLIST *)StartItem(spMon->spConHead, &spConNext);
+            spCon != NULL; spCon=(ML_CONLIST *)NextItem(&spConNext))
+        {
+            nChanCnt++;
+        }
+    }
+
+    /* No one listening, nothing to do.
+    */
+    if(nChanCnt == 0)
+    {
+        Errno = E_NOSERVICE;
+        return(nReturn);
+    }
+
+    /* Build up the list of channels to fan the data out to.
     */
-        /* A monitor port is identified by the original server port being
-         * equal to that stored within the control record.
-        if(spNetCon->cCorS == STP_SERVER && spNetCon->nServerPortNo != 0 &&
-           spNetCon->nOurPortNo == Ml.nMonPort)
+    if((nChanIds=(UINT *)malloc(sizeof(UINT) * nChanCnt)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes",
+            sizeof(UINT) * nChanCnt);
+        Errno = E_NOMEM;
+        return(nReturn);
+    }
+    for(nChanCnt=0, spMon=(ML_MONLIST *)StartItem(Ml.spMonHead, &spNext);
+        spMon != NULL; spMon=(ML_MONLIST *)NextItem(&spNext))
+    {
+        for(spCon=(ML_CONLIST *)StartItem(spMon->spConHead, &spConNext);
+            spCon != NULL; spCon=(ML_CONLIST *)NextItem(&spConNext))
         {
-            if(SL_BlockSendData(spNetCon->nChanId, szData, nDataLen) == R_OK)
-                nReturn = R_OK;
+            nChanIds[nChanCnt++] = spCon->nChanId;
         }
     }
-        */
+
+    /* Send the data as one shared frame to all clients, the comms layer
+     * queues it on each channel and frees it once all have sent.
+    */
+    nReturn = SL_BroadcastData(nChanIds, nChanCnt, szData, nDataLen);
+    free(nChanIds);
 
     /* Finished, get out.
     */
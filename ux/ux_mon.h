@@ -79,6 +79,7 @@ typedef struct {
 */
 typedef struct {
     UCHAR       *szCommand;            /* Command in ascii text format */
+    UINT        nCmdId;                /* Interned id of command, any case */
     int         (*nCallback)();        /* Function to call when text recognised */
 } ML_COMMANDLIST;
 
@@ -0,0 +1,654 @@
+/******************************************************************************
+ * Product:       #     # #     #         #         ###   ######
+ *                #     #  #   #          #          #    #     #
+ *                #     #   # #           #          #    #     #
+ *                #     #    #            #          #    ######
+ *                #     #   # #           #          #    #     #
+ *                #     #  #   #          #          #    #     #
+ *                 #####  #     # ####### #######   ###   ######
+ *
+ * File:          ux_queue.c
+ * Description:   A bounded, lock free, multi producer single consumer queue
+ *                of pointers. Producers claim ring positions with a compare
+ *                and swap, the consumer needs no atomic read-modify-write at
+ *                all. Items can be queued and taken in batches, and the
+ *                consumer can block on a wakeup descriptor (eventfd on
+ *                Linux) which producers only signal whilst it is waiting.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1994-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Bring in system header files.
+*/
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <ctype.h>
+#include    <stdarg.h>
+#include    <sys/types.h>
+#include    <errno.h>
+#include    <sys/timeb.h>
+#include    <sys/stat.h>
+#include    <fcntl.h>
+
+#if defined(SUNOS) || defined(SOLARIS) || defined(LINUX)
+#include    <sys/socket.h>
+#include    <sys/time.h>
+#include    <string.h>
+#endif
+
+#if defined(SOLARIS)
+#include    <sys/file.h>
+#endif
+
+#if defined(LINUX)
+#include    <term.h>
+#include    <sys/eventfd.h>
+#endif
+
+#if !defined(_WIN32)
+#include    <unistd.h>
+#endif
+
+#if defined(_WIN32)
+#include    <winsock.h>
+#include    <time.h>
+#endif
+
+#if defined(SUNOS) || defined(SOLARIS)
+#include    <netinet/in.h>
+#include    <sys/wait.h>
+#endif
+
+/* Indicate that we are a C module for any header specifics.
+*/
+#define        UX_QUEUE_C
+
+/* Bring in specific header files.
+*/
+#include    "ux.h"
+
+/* Memory ordering. Slot sequences are published with release and read with
+ * acquire, which carries the item between threads. Without the GNU atomic
+ * builtins the queue is only safe within a single thread.
+*/
+#if defined(__GNUC__)
+#define    MQ_LOAD(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define    MQ_PEEK(p)        __atomic_load_n((p), __ATOMIC_RELAXED)
+#define    MQ_STORE(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define    MQ_CLAIM(p, e, v) __atomic_compare_exchange_n((p), (e), (v), 1, \
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#define    MQ_FENCE()        __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define    MQ_LOAD(p)        (*(p))
+#define    MQ_PEEK(p)        (*(p))
+#define    MQ_STORE(p, v)    (*(p) = (v))
+#define    MQ_CLAIM(p, e, v) (*(p) == *(e) ? (*(p) = (v), 1) : (*(e) = *(p), 0))
+#define    MQ_FENCE()
+#endif
+
+/* Is the item at the head of the queue published? Consumer only.
+*/
+#define    MQ_READY(q)       (MQ_LOAD(&(q)->spSlot[(q)->lHead & (q)->lMask].lSeq) \
+                                                         == (q)->lHead + 1)
+
+/******************************************************************************
+ * Function:    _MQ_GetTimeMs
+ * Description: Get the current time in milliseconds, for wait timeouts.
+ * Thread Safe: Yes.
+ * Returns:     Time in mS.
+ ******************************************************************************/
+ULNG _MQ_GetTimeMs( void )
+{
+    /* Local variables.
+    */
+#if defined(_WIN32)
+    struct timeb    sTp;
+
+    ftime(&sTp);
+    return((ULNG)sTp.time * 1000L + (ULNG)sTp.millitm);
+#else
+    struct timeval  sTv;
+
+    gettimeofday(&sTv, NULL);
+    return((ULNG)sTv.tv_sec * 1000L + (ULNG)sTv.tv_usec / 1000L);
+#endif
+}
+
+/******************************************************************************
+ * Function:    _MQ_Wake
+ * Description: Signal the wakeup descriptor of a queue. A signal which
+ *              cannot be written because one is already pending is not
+ *              needed, so errors are ignored.
+ * Thread Safe: Yes, called by producers.
+ * Returns:     Non.
+ ******************************************************************************/
+void _MQ_Wake( MQ_QUEUE    *spQueue )      /* I: Queue to wake */
+{
+    /* Local variables.
+    */
+#if defined(LINUX)
+    unsigned long long  llOne = 1;
+#else
+    UCHAR               cOne = 1;
+#endif
+
+#if defined(LINUX)
+    if(write(spQueue->nWakeFd[1], &llOne, sizeof(llOne)) < 0)
+        return;
+#elif !defined(_WIN32)
+    if(write(spQueue->nWakeFd[1], &cOne, 1) < 0)
+        return;
+#endif
+}
+
+/******************************************************************************
+ * Function:    _MQ_Drain
+ * Description: Clear down all pending signals on the wakeup descriptor of a
+ *              queue.
+ * Thread Safe: No, consumer only.
+ * Returns:     Non.
+ ******************************************************************************/
+void _MQ_Drain( MQ_QUEUE    *spQueue )     /* I: Queue to drain */
+{
+    /* Local variables.
+    */
+    UCHAR       szBuf[64];
+
+#if !defined(_WIN32)
+    while(read(spQueue->nWakeFd[0], szBuf, sizeof(szBuf)) > 0);
+#endif
+}
+
+/******************************************************************************
+ * Function:    MQ_Create
+ * Description: Create a queue able to hold the given number of items,
+ *              rounded up to a power of 2. With MQ_WAKEUP, a wakeup
+ *              descriptor is created so that the consumer can block in
+ *              MQ_Wait.
+ * Thread Safe: Yes.
+ * Returns:     NOTNULL  - The new queue.
+ *              NULL     - Failure, see Errno.
+ * <Errno>      E_BADPARM- Bad size, or wakeup unavailable on this platform.
+ *              E_NOMEM  - Memory or descriptor exhaustion.
+ ******************************************************************************/
+MQ_QUEUE *MQ_Create( UINT    nSize,           /* I: Items queue must hold */
+                     UINT    nFlags )         /* I: MQ_WAKEUP or 0 */
+{
+    /* Local variables.
+    */
+    ULNG        lSlots;
+    ULNG        lNdx;
+    void        *spBase;
+    MQ_QUEUE    *spQueue;
+    char        *szFunc = "MQ_Create";
+
+    /* Size must be sensible, and never big enough to make the sequence
+     * arithmetic ambiguous.
+    */
+    if(nSize == 0 || nSize > 0x40000000)
+    {
+        Errno = E_BADPARM;
+        return(NULL);
+    }
+#if defined(_WIN32)
+    if(nFlags & MQ_WAKEUP)
+    {
+        Errno = E_BADPARM;
+        return(NULL);
+    }
+#endif
+    for(lSlots=2; lSlots < nSize; lSlots <<= 1);
+
+    /* Allocate the control block on a cache line boundary, so that the
+     * padding keeps the head and tail apart.
+    */
+    if((spBase=malloc(sizeof(MQ_QUEUE) + MQ_CACHELINE)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes",
+            sizeof(MQ_QUEUE) + MQ_CACHELINE);
+        Errno = E_NOMEM;
+        return(NULL);
+    }
+    spQueue = (MQ_QUEUE *)(((ULNG)spBase + MQ_CACHELINE - 1) &
+                                                  ~(ULNG)(MQ_CACHELINE - 1));
+    memset((UCHAR *)spQueue, '\0', sizeof(MQ_QUEUE));
+    spQueue->spBase = spBase;
+    spQueue->lMask = lSlots - 1;
+    spQueue->nFlags = nFlags;
+    spQueue->nWakeFd[0] = spQueue->nWakeFd[1] = -1;
+
+    if((spQueue->spSlot=(MQ_SLOT *)malloc(sizeof(MQ_SLOT) * lSlots)) == NULL)
+    {
+        Lgr(LOG_DEBUG, szFunc, "Couldnt malloc (%d) bytes",
+            sizeof(MQ_SLOT) * lSlots);
+        free(spBase);
+        Errno = E_NOMEM;
+        return(NULL);
+    }
+
+    /* Each slot starts free for the first position which maps to it.
+    */
+    for(lNdx=0; lNdx < lSlots; lNdx++)
+    {
+        spQueue->spSlot[lNdx].lSeq = lNdx;
+        spQueue->spSlot[lNdx].spItem = NULL;
+    }
+
+    /* Create the wakeup descriptor if required.
+    */
+    if(nFlags & MQ_WAKEUP)
+    {
+#if defined(LINUX)
+        spQueue->nWakeFd[0] = spQueue->nWakeFd[1] =
+                                        eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(spQueue->nWakeFd[0] < 0)
+#elif !defined(_WIN32)
+        if(pipe(spQueue->nWakeFd) < 0 ||
+           fcntl(spQueue->nWakeFd[0], F_SETFL, O_NONBLOCK) < 0 ||
+           fcntl(spQueue->nWakeFd[1], F_SETFL, O_NONBLOCK) < 0)
+#endif
+        {
+            Lgr(LOG_DEBUG, szFunc, "Couldnt create wakeup descriptor (%d)",
+                errno);
+            spQueue->nFlags &= ~MQ_WAKEUP;
+            MQ_Destroy(spQueue);
+            Errno = E_NOMEM;
+            return(NULL);
+        }
+    }
+
+    /* Return the new queue to caller.
+    */
+    return(spQueue);
+}
+
+/******************************************************************************
+ * Function:    MQ_Destroy
+ * Description: Release a queue and its wakeup descriptor. Items still
+ *              queued belong to the caller, drain them with MQ_Pop first.
+ * Thread Safe: No, no other thread may be using the queue.
+ * Returns:     R_OK     - Queue released.
+ *              R_FAIL   - Failure, see Errno.
+ * <Errno>      E_BADPARM- Bad queue passed.
+ ******************************************************************************/
+int MQ_Destroy( MQ_QUEUE    *spQueue )     /* I: Queue to release */
+{
+    if(spQueue == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+
+#if !defined(_WIN32)
+    if(spQueue->nWakeFd[0] >= 0)
+        close(spQueue->nWakeFd[0]);
+    if(spQueue->nWakeFd[1] >= 0 && spQueue->nWakeFd[1] != spQueue->nWakeFd[0])
+        close(spQueue->nWakeFd[1]);
+#endif
+    if(spQueue->spSlot != NULL)
+        free(spQueue->spSlot);
+    free(spQueue->spBase);
+
+    /* Return result code to caller.
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    MQ_Push
+ * Description: Add an item to the tail of a queue. The consumer is woken
+ *              if it is waiting.
+ * Thread Safe: Yes, any number of producers.
+ * Returns:     R_OK     - Item queued.
+ *              R_FAIL   - Failure, see Errno.
+ * <Errno>      E_BADPARM- Bad queue or NULL item passed.
+ *              E_BUSY   - Queue is full, retry later.
+ ******************************************************************************/
+int MQ_Push( MQ_QUEUE    *spQueue,         /* I: Queue to add to */
+             void        *spItem )         /* I: Item to add */
+{
+    /* Local variables.
+    */
+    long        lDiff;
+    ULNG        lPos;
+    MQ_SLOT     *spSlot;
+
+    if(spQueue == NULL || spItem == NULL)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+
+    /* Claim the tail position. A slot whose sequence equals the position
+     * is free, one behind means the consumer has yet to take the item
+     * from the previous lap so the queue is full, ahead means another
+     * producer claimed the position first.
+    */
+    lPos = MQ_PEEK(&spQueue->lTail);
+    for(;;)
+    {
+        spSlot = &spQueue->spSlot[lPos & spQueue->lMask];
+        lDiff = (long)(MQ_LOAD(&spSlot->lSeq) - lPos);
+        if(lDiff == 0)
+        {
+            if(MQ_CLAIM(&spQueue->lTail, &lPos, lPos + 1))
+                break;
+        } else
+
+        if(lDiff < 0)
+        {
+            Errno = E_BUSY;
+            return(R_FAIL);
+        } else
+         {
+            lPos = MQ_PEEK(&spQueue->lTail);
+        }
+    }
+
+    /* Fill and publish the slot.
+    */
+    spSlot->spItem = spItem;
+    MQ_STORE(&spSlot->lSeq, lPos + 1);
+
+    /* The fence orders the publish before reading the consumer flag, MQ_Wait
+     * orders its flag before looking for items, so one side always sees
+     * the other.
+    */
+    if(spQueue->nFlags & MQ_WAKEUP)
+    {
+        MQ_FENCE();
+        if(MQ_PEEK(&spQueue->nWaiting))
+            _MQ_Wake(spQueue);
+    }
+
+    /* Return result code to caller.
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    MQ_PushBatch
+ * Description: Add as many of the given items as there is room for to the
+ *              tail of a queue, claiming all their positions with a single
+ *              compare and swap. The items are contiguous and in order
+ *              within the queue.
+ * Thread Safe: Yes, any number of producers.
+ * Returns:     Number of items queued, 0 on failure, see Errno.
+ * <Errno>      E_BADPARM- Bad queue or NULL item passed.
+ *              E_BUSY   - Queue is full, retry later.
+ ******************************************************************************/
+UINT MQ_PushBatch( MQ_QUEUE    *spQueue,   /* I: Queue to add to */
+                   void        **spItems,  /* I: Items to add */
+                   UINT        nCount )    /* I: Number of items */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    UINT        nTake;
+    ULNG        lFree;
+    ULNG        lHead;
+    ULNG        lPos;
+
+    if(spQueue == NULL || spItems == NULL)
+    {
+        Errno = E_BADPARM;
+        return(0);
+    }
+    for(nNdx=0; nNdx < nCount; nNdx++)
+    {
+        if(spItems[nNdx] == NULL)
+        {
+            Errno = E_BADPARM;
+            return(0);
+        }
+    }
+
+    /* Work out the room from the consumer position. The consumer frees a
+     * slot before moving its head past it, so every position short of a
+     * lap beyond the head is free. MQ_Push goes by the slot instead, so
+     * the tail can already be more than a lap beyond the head.
+    */
+    lPos = MQ_PEEK(&spQueue->lTail);
+    for(;;)
+    {
+        /* A stale tail may already have been overtaken by the consumer.
+        */
+        lHead = MQ_LOAD(&spQueue->lHead);
+        if((long)(lPos - lHead) < 0)
+        {
+            lPos = MQ_PEEK(&spQueue->lTail);
+            continue;
+        }
+        lFree = (lPos - lHead > spQueue->lMask ? 0 :
+                                          spQueue->lMask + 1 - (lPos - lHead));
+        if((nTake = (lFree < nCount ? (UINT)lFree : nCount)) == 0)
+        {
+            Errno = (nCount == 0 ? E_BADPARM : E_BUSY);
+            return(0);
+        }
+        if(MQ_CLAIM(&spQueue->lTail, &lPos, lPos + nTake))
+            break;
+    }
+
+    /* Fill and publish each slot in turn, the consumer takes them in
+     * order so the early ones become visible straight away.
+    */
+    for(nNdx=0; nNdx < nTake; nNdx++, lPos++)
+    {
+        spQueue->spSlot[lPos & spQueue->lMask].spItem = spItems[nNdx];
+        MQ_STORE(&spQueue->spSlot[lPos & spQueue->lMask].lSeq, lPos + 1);
+    }
+
+    if(spQueue->nFlags & MQ_WAKEUP)
+    {
+        MQ_FENCE();
+        if(MQ_PEEK(&spQueue->nWaiting))
+            _MQ_Wake(spQueue);
+    }
+
+    /* Return number queued to caller.
+    */
+    return(nTake);
+}
+
+/******************************************************************************
+ * Function:    MQ_Pop
+ * Description: Take the item at the head of a queue.
+ * Thread Safe: No, single consumer only.
+ * Returns:     NOTNULL  - The item.
+ *              NULL     - Queue empty or failure, see Errno.
+ * <Errno>      E_BADPARM- Bad queue passed.
+ *              E_NODATA - Queue is empty.
+ ******************************************************************************/
+void *MQ_Pop( MQ_QUEUE    *spQueue )       /* I: Queue to take from */
+{
+    /* Local variables.
+    */
+    ULNG        lPos;
+    void        *spItem;
+    MQ_SLOT     *spSlot;
+
+    if(spQueue == NULL)
+    {
+        Errno = E_BADPARM;
+        return(NULL);
+    }
+
+    lPos = spQueue->lHead;
+    spSlot = &spQueue->spSlot[lPos & spQueue->lMask];
+    if(MQ_LOAD(&spSlot->lSeq) != lPos + 1)
+    {
+        Errno = E_NODATA;
+        return(NULL);
+    }
+
+    /* Take the item, then hand the slot on to the position a lap ahead
+     * before moving the head past it.
+    */
+    spItem = spSlot->spItem;
+    MQ_STORE(&spSlot->lSeq, lPos + spQueue->lMask + 1);
+    MQ_STORE(&spQueue->lHead, lPos + 1);
+
+    /* Return item to caller.
+    */
+    return(spItem);
+}
+
+/******************************************************************************
+ * Function:    MQ_PopBatch
+ * Description: Take up to the given number of items from the head of a
+ *              queue, moving the head once for the whole batch.
+ * Thread Safe: No, single consumer only.
+ * Returns:     Number of items taken, 0 if empty or failure, see Errno.
+ * <Errno>      E_BADPARM- Bad queue or buffer passed.
+ *              E_NODATA - Queue is empty.
+ ******************************************************************************/
+UINT MQ_PopBatch( MQ_QUEUE    *spQueue,    /* I: Queue to take from */
+                  void        **spItems,   /* O: Items taken */
+                  UINT        nMax )       /* I: Size of spItems */
+{
+    /* Local variables.
+    */
+    UINT        nCount;
+    ULNG        lPos;
+    MQ_SLOT     *spSlot;
+
+    if(spQueue == NULL || spItems == NULL)
+    {
+        Errno = E_BADPARM;
+        return(0);
+    }
+
+    for(nCount=0, lPos=spQueue->lHead; nCount < nMax; nCount++, lPos++)
+    {
+        spSlot = &spQueue->spSlot[lPos & spQueue->lMask];
+        if(MQ_LOAD(&spSlot->lSeq) != lPos + 1)
+            break;
+        spItems[nCount] = spSlot->spItem;
+        MQ_STORE(&spSlot->lSeq, lPos + spQueue->lMask + 1);
+    }
+
+    if(nCount == 0)
+    {
+        Errno = E_NODATA;
+    } else
+     {
+        MQ_STORE(&spQueue->lHead, lPos);
+    }
+
+    /* Return number taken to caller.
+    */
+    return(nCount);
+}
+
+/******************************************************************************
+ * Function:    MQ_Count
+ * Description: Number of positions claimed on a queue and not yet taken.
+ *              Only a snapshot whilst producers are active.
+ * Thread Safe: Yes.
+ * Returns:     Number of items.
+ ******************************************************************************/
+UINT MQ_Count( MQ_QUEUE    *spQueue )      /* I: Queue to examine */
+{
+    /* Local variables.
+    */
+    ULNG        lHead;
+    ULNG        lTail;
+
+    if(spQueue == NULL)
+        return(0);
+
+    lHead = MQ_LOAD(&spQueue->lHead);
+    lTail = MQ_LOAD(&spQueue->lTail);
+    return((long)(lTail - lHead) > 0 ? (UINT)(lTail - lHead) : 0);
+}
+
+/******************************************************************************
+ * Function:    MQ_Wait
+ * Description: Block the consumer until an item is ready at the head of a
+ *              queue or the timeout expires. Producers only signal the
+ *              wakeup descriptor whilst the consumer is waiting here, so
+ *              the fast path costs them no system call.
+ * Thread Safe: No, single consumer only.
+ * Returns:     R_OK     - An item is ready.
+ *              R_FAIL   - Timed out or failure, see Errno.
+ * <Errno>      E_BADPARM- Bad queue passed, or created without MQ_WAKEUP.
+ *              E_NODATA - Timed out with the queue empty.
+ ******************************************************************************/
+int MQ_Wait( MQ_QUEUE    *spQueue,         /* I: Queue to wait on */
+             ULNG        lTimeout )        /* I: Timeout in mS or MQ_FOREVER */
+{
+    /* Local variables.
+    */
+    int             nReturn;
+    ULNG            lStart;
+    ULNG            lElapsed;
+    fd_set          sRead;
+    struct timeval  sTimeout;
+
+    if(spQueue == NULL || spQueue->nWakeFd[0] < 0)
+    {
+        Errno = E_BADPARM;
+        return(R_FAIL);
+    }
+    if(MQ_READY(spQueue))
+        return(R_OK);
+
+    /* Announce the wait before the final look for items, see MQ_Push.
+    */
+    MQ_STORE(&spQueue->nWaiting, TRUE);
+    MQ_FENCE();
+
+    /* Work out what is left of the timeout on every pass, as select may be
+     * interrupted or woken without an item and need not update the timeout.
+    */
+    lStart = _MQ_GetTimeMs();
+    while(! MQ_READY(spQueue))
+    {
+        if(lTimeout != MQ_FOREVER)
+        {
+            if((lElapsed = _MQ_GetTimeMs() - lStart) >= lTimeout)
+                break;
+            sTimeout.tv_sec = (lTimeout - lElapsed) / 1000;
+            sTimeout.tv_usec = ((lTimeout - lElapsed) % 1000) * 1000;
+        }
+        FD_ZERO(&sRead);
+        FD_SET(spQueue->nWakeFd[0], &sRead);
+        nReturn = select(spQueue->nWakeFd[0] + 1, &sRead, NULL, NULL,
+                         lTimeout == MQ_FOREVER ? NULL : &sTimeout);
+        if(nReturn < 0 && errno == EINTR)
+            continue;
+        if(nReturn <= 0)
+            break;
+        _MQ_Drain(spQueue);
+    }
+    MQ_STORE(&spQueue->nWaiting, FALSE);
+
+    if(! MQ_READY(spQueue))
+    {
+        Errno = E_NODATA;
+        return(R_FAIL);
+    }
+
+    /* Return result code to caller.
+    */
+    return(R_OK);
+}
@@ -0,0 +1,88 @@
+/******************************************************************************
+ * Product:       #     # #     #         #         ###   ######
+ *                #     #  #   #          #          #    #     #
+ *                #     #   # #           #          #    #     #
+ *                #     #    #            #          #    ######
+ *                #     #   # #           #          #    #     #
+ *                #     #  #   #          #          #    #     #
+ *                 #####  #     # ####### #######   ###   ######
+ *
+ * File:          ux_queue.h
+ * Description:   Header file for the bounded lock free message queue, many
+ *                producers handing items to a single consumer.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1994-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    UX_QUEUE_H
+#define    UX_QUEUE_H
+
+/* Queue options and limits.
+*/
+#define    MQ_WAKEUP         0x01      /* Create a wakeup fd for MQ_Wait */
+#define    MQ_FOREVER        0xffffffffUL /* MQ_Wait without a timeout */
+#define    MQ_CACHELINE      64        /* Padding between shared counters */
+
+/* A queue slot. The sequence number tells producers and the consumer
+ * whose turn it is: equal to the position when free for that position,
+ * one more once the item is published.
+*/
+typedef struct {
+    ULNG        lSeq;                  /* Slot sequence */
+    void        *spItem;               /* Item carried */
+} MQ_SLOT;
+
+/* A queue. Producers only write lTail and the consumer only writes lHead,
+ * so each sits on its own cache line, followed by the read mostly fields.
+*/
+typedef struct {
+    ULNG        lTail;                 /* Next position to claim, producers */
+    UCHAR       cPad1[MQ_CACHELINE - sizeof(ULNG)];
+    ULNG        lHead;                 /* Next position to take, consumer */
+    UCHAR       cPad2[MQ_CACHELINE - sizeof(ULNG)];
+    UINT        nWaiting;              /* Consumer is blocked in MQ_Wait */
+    UINT        nFlags;                /* Options given at creation */
+    ULNG        lMask;                 /* Slots - 1, slots being a power of 2 */
+    int         nWakeFd[2];            /* Read, write side of wakeup, or -1 */
+    MQ_SLOT     *spSlot;               /* Ring of slots */
+    void        *spBase;               /* Allocation holding this queue */
+} MQ_QUEUE;
+
+/* Prototypes for internal functions.
+*/
+ULNG        _MQ_GetTimeMs( void );
+void        _MQ_Wake( MQ_QUEUE * );
+void        _MQ_Drain( MQ_QUEUE * );
+
+/* Prototypes for API functions.
+*/
+MQ_QUEUE    *MQ_Create( UINT, UINT );
+int         MQ_Destroy( MQ_QUEUE * );
+int         MQ_Push( MQ_QUEUE *, void * );
+UINT        MQ_PushBatch( MQ_QUEUE *, void **, UINT );
+void        *MQ_Pop( MQ_QUEUE * );
+UINT        MQ_PopBatch( MQ_QUEUE *, void **, UINT );
+UINT        MQ_Count( MQ_QUEUE * );
+int         MQ_Wait( MQ_QUEUE *, ULNG );
+
+#endif    /* UX_QUEUE_H */
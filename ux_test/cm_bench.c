@@ -0,0 +1,309 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          cm_bench.c
+ * Description:   A Test Harness program to benchmark compression across
+ *                threads. Each thread owns an LZW context and repeatedly
+ *                compresses and decompresses the same buffer, the run is
+ *                repeated for 1 up to the given number of threads so that
+ *                the throughput at each count can be set against one thread.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1996-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Bring in system header files.
+*/
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <ctype.h>
+#include    <stdarg.h>
+#include    <string.h>
+
+/* Bring in UX header files.
+*/
+#include    <ux.h>
+
+/* Specials for Solaris.
+*/
+#if defined(SOLARIS) || defined(LINUX) || defined(ZPU)
+#include    <sys/types.h>
+#include    <sys/time.h>
+#include    <pthread.h>
+#endif
+#if defined(_WIN32)
+#include    <sys/timeb.h>
+#endif
+
+/* Indicate that we are a C module for any header specifics.
+*/
+#define     CM_BENCH_C
+
+/* Bring in local specific header files.
+*/
+#include    "cm_bench.h"
+
+/******************************************************************************
+ * Function:    _BNCH_GetTimeUs
+ * Description: Get the current time in microseconds.
+ * 
+ * Returns:     Current time in uS.
+ ******************************************************************************/
+ULNG    _BNCH_GetTimeUs( void )
+{
+    /* Local variables.
+    */
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    struct timeval  sTv;
+
+    gettimeofday(&sTv, NULL);
+    return((ULNG)sTv.tv_sec * 1000000L + (ULNG)sTv.tv_usec);
+#endif
+#if defined(_WIN32)
+    struct timeb    sTp;
+
+    ftime(&sTp);
+    return((ULNG)sTp.time * 1000000L + (ULNG)sTp.millitm * 1000L);
+#endif
+}
+
+/******************************************************************************
+ * Function:    GetConfig
+ * Description: Get configuration information from the OS or command line
+ *              flags.
+ * 
+ * Returns:     R_OK    - Configuration obtained.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    GetConfig( int      argc,          /* I: CLI argument count */
+                  UCHAR    **argv,        /* I: CLI argument contents */
+                  char     **envp,        /* I: Environment variables */
+                  UCHAR    *szErrMsg )    /* O: Any generated error message */
+{
+    /* Setup defaults.
+    */
+    BNCH.nIterations = DEF_ITERATIONS;
+    BNCH.nThreads = DEF_THREADS;
+    BNCH.nBufSize = DEF_BUFSIZE;
+
+    /* Optional parameters.
+    */
+    GetCLIParam(argc, argv, FLG_ITERATIONS, T_INT, (UCHAR *)&BNCH.nIterations,
+                0, 0);
+    GetCLIParam(argc, argv, FLG_THREADS, T_INT, (UCHAR *)&BNCH.nThreads, 0, 0);
+    GetCLIParam(argc, argv, FLG_BUFSIZE, T_INT, (UCHAR *)&BNCH.nBufSize, 0, 0);
+    if(BNCH.nIterations == 0 || BNCH.nThreads == 0 ||
+       BNCH.nThreads > MAX_THREADS || BNCH.nBufSize < MIN_COMPRESSLEN)
+    {
+        sprintf(szErrMsg, "Iterations must be non zero, threads 1..%d and "
+                "buffer size at least %d", MAX_THREADS, MIN_COMPRESSLEN);
+        return(R_FAIL);
+    }
+
+    /* Finished, get out!
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    BNCHWorker
+ * Description: Body of each benchmark thread. Compress and decompress the
+ *              test data with the threads own context, checking that every
+ *              round trip gives back what went in.
+ * 
+ * Returns:     NULL.
+ ******************************************************************************/
+void    *BNCHWorker( void    *spArg )    /* I: BNCH_WORKER of thread */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    UINT        nLen;
+    UCHAR       *spCmp;
+    UCHAR       *spOut;
+    BNCH_WORKER *spWorker = (BNCH_WORKER *)spArg;
+
+    for(nNdx=0; nNdx < BNCH.nIterations; nNdx++)
+    {
+        nLen = BNCH.nBufSize;
+        if((spCmp=CompressCtx(spWorker->spCtx, BNCH.spData, &nLen)) == NULL ||
+           spCmp == BNCH.spData)
+        {
+            spWorker->nFailed++;
+            continue;
+        }
+        if((spOut=DecompressCtx(spWorker->spCtx, spCmp, &nLen)) == NULL ||
+           nLen != BNCH.nBufSize || memcmp(spOut, BNCH.spData, nLen) != 0)
+        {
+            spWorker->nFailed++;
+        }
+        if(spOut != NULL && spOut != spCmp) free(spOut);
+        free(spCmp);
+    }
+    return(NULL);
+}
+
+/******************************************************************************
+ * Function:    BNCHRun
+ * Description: Run the given number of worker threads to completion.
+ * 
+ * Returns:     Megabytes of input compressed and decompressed per second,
+ *              or 0 on failure.
+ ******************************************************************************/
+double    BNCHRun( UINT    nThreads )    /* I: Number of threads to run */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    UINT        nFailed = 0;
+    ULNG        lStartUs;
+    ULNG        lElapsedUs;
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    pthread_t   sThread[MAX_THREADS];
+#endif
+
+    lStartUs = _BNCH_GetTimeUs();
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    for(nNdx=0; nNdx < nThreads; nNdx++)
+    {
+        if(pthread_create(&sThread[nNdx], NULL, BNCHWorker,
+                          &BNCH.sWorker[nNdx]) != 0)
+            return(0.0);
+    }
+    for(nNdx=0; nNdx < nThreads; nNdx++)
+        pthread_join(sThread[nNdx], NULL);
+#else
+    /* No threads here, run the workers one after the other.
+    */
+    for(nNdx=0; nNdx < nThreads; nNdx++)
+        BNCHWorker(&BNCH.sWorker[nNdx]);
+#endif
+    lElapsedUs = _BNCH_GetTimeUs() - lStartUs;
+
+    for(nNdx=0; nNdx < nThreads; nNdx++)
+    {
+        nFailed += BNCH.sWorker[nNdx].nFailed;
+        BNCH.sWorker[nNdx].nFailed = 0;
+    }
+    if(nFailed != 0)
+        return(0.0);
+
+    return((double)BNCH.nBufSize * BNCH.nIterations * nThreads /
+           (double)(lElapsedUs > 0 ? lElapsedUs : 1));
+}
+
+/******************************************************************************
+ * Function:    main
+ * Description: Entry point into the benchmark program. Build the test data,
+ *              run each thread count and report the scaling.
+ * 
+ * Returns:     0     - Program completed successfully without errors.
+ *              -1    - Program terminated with errors.
+ ******************************************************************************/
+int    main( int     argc,       /* I: Count of available arguments */
+             char    **argv,     /* I: Array of arguments */
+             char    **envp )    /* I: Array of environment parameters */
+{
+    /* Local variables.
+    */
+    UINT            nNdx;
+    UINT            nPos;
+    UINT            nThreads;
+    UINT            nLen;
+    UCHAR           *spCmp;
+    double          dRate;
+    double          dBase = 0.0;
+    UCHAR           szRow[MAX_ERRMSG_LEN];
+    UCHAR           szErrMsg[MAX_ERRMSG_LEN];
+
+    /* Bring in any configuration parameters passed on the command line etc.
+    */
+    if( GetConfig(argc, (UCHAR **)argv, envp, szErrMsg) == R_FAIL )
+    {
+        printf( "%s\n"
+                "Usage:                 %s <parameters>\n"
+                "<parameters>:          -n<Iterations per thread>\n"
+                "                       -t<Most threads>\n"
+                "                       -s<Buffer size>\n",
+                szErrMsg, argv[0]);
+        exit(-1);
+    }
+
+    /* Test data is a run of result set rows, as a driver would send back.
+    */
+    if((BNCH.spData=(UCHAR *)malloc(BNCH.nBufSize+1)) == NULL)
+    {
+        printf("%s: Couldnt allocate data\n", argv[0]);
+        exit(-1);
+    }
+    for(nPos=0, nNdx=0; nPos < BNCH.nBufSize; nNdx++)
+    {
+        sprintf(szRow, "%u|CUST%06u|%s|%u.%02u|2019-%02u-%02u\n", nNdx,
+                (nNdx * 7919) % 100000,
+                (nNdx % 3 == 0 ? "OPEN" : (nNdx % 3 == 1 ? "CLOSED" : "HELD")),
+                (nNdx * 37) % 10000, nNdx % 100, nNdx % 12 + 1, nNdx % 28 + 1);
+        for(nLen=0; szRow[nLen] != '\0' && nPos < BNCH.nBufSize; nLen++)
+            BNCH.spData[nPos++] = szRow[nLen];
+    }
+    BNCH.nCmpLen = BNCH.nBufSize;
+    if((spCmp=Compress(BNCH.spData, &BNCH.nCmpLen)) != BNCH.spData &&
+       spCmp != NULL)
+        free(spCmp);
+
+    for(nNdx=0; nNdx < BNCH.nThreads; nNdx++)
+    {
+        if((BNCH.sWorker[nNdx].spCtx=LZW_CreateCtx()) == NULL)
+        {
+            printf("%s: Couldnt create context, Errno=%d\n", argv[0], Errno);
+            exit(-1);
+        }
+    }
+
+    printf("Buffer %u bytes compressing to %u, %u round trips per thread\n\n",
+           BNCH.nBufSize, BNCH.nCmpLen, BNCH.nIterations);
+    printf("%-8s %12s %10s %10s\n", "Threads", "MB/s", "Speedup", "Per thread");
+    for(nThreads=1; nThreads <= BNCH.nThreads; nThreads++)
+    {
+        if((dRate = BNCHRun(nThreads)) == 0.0)
+        {
+            printf("%s: Run failed with (%u) threads\n", argv[0], nThreads);
+            exit(-1);
+        }
+        if(nThreads == 1)
+            dBase = dRate;
+        printf("%-8u %12.2f %9.2fx %9.0f%%\n", nThreads, dRate, dRate / dBase,
+               dRate / dBase / nThreads * 100.0);
+    }
+
+    for(nNdx=0; nNdx < BNCH.nThreads; nNdx++)
+        LZW_FreeCtx(BNCH.sWorker[nNdx].spCtx);
+    free(BNCH.spData);
+
+    /* All done, go bye bye's.
+    */
+    return(0);
+}
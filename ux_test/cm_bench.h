@@ -0,0 +1,90 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          cm_bench.h
+ * Description:   Header file for declaration of structures, datatypes etc for
+ *                the multi-threaded compression benchmark program.
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D.Smart, 1996-2019.
+ *
+ * History:       1.0 - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    CM_BENCH_H
+#define    CM_BENCH_H
+
+/* Definitions for maxims etc.
+*/
+#define    MAX_ERRMSG_LEN        256
+#define    MAX_THREADS           64
+
+/* Definitions for defaults.
+*/
+#define    DEF_ITERATIONS        2000    /* Compress/decompress pairs/thread */
+#define    DEF_THREADS           4       /* Highest thread count run */
+#define    DEF_BUFSIZE           16384   /* Bytes in the test buffer */
+
+/* Define command line flags.
+*/
+#define    FLG_ITERATIONS        "-n"
+#define    FLG_THREADS           "-t"
+#define    FLG_BUFSIZE           "-s"
+
+/* Work given to each thread.
+*/
+typedef struct {
+    LZW_CTX        *spCtx;               /* Threads own compression context */
+    UINT           nFailed;              /* Round trips which did not match */
+} BNCH_WORKER;
+
+/* Globals (yuggghhh!).
+*/
+typedef struct {
+    UINT           nIterations;
+    UINT           nThreads;
+    UINT           nBufSize;
+    UCHAR          *spData;              /* Test data, shared read only */
+    UINT           nCmpLen;              /* Compressed size of test data */
+    BNCH_WORKER    sWorker[MAX_THREADS];
+} BNCH_GLOBALS;
+
+/* Declare any globals required by the program, or any specifics to the
+ * C module.
+*/
+#if defined(CM_BENCH_C)
+    static    BNCH_GLOBALS    BNCH;
+#endif
+
+/* Prototypes for functions.
+*/
+ULNG       _BNCH_GetTimeUs( void );
+int        GetConfig( int, UCHAR **, char **, UCHAR * );
+void       *BNCHWorker( void * );
+double     BNCHRun( UINT );
+int        main( int, char **, char ** );
+
+#endif    /* CM_BENCH_H */
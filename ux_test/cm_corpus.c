@@ -0,0 +1,1066 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          cm_corpus.c
+ * Description:   A Test Harness program to benchmark every codec and mode
+ *                of the compression library over a fixed corpus of the
+ *                content it sees: padded result rows, log text, binaries,
+ *                data already compressed, tiny control messages and a
+ *                large reply. Each item is compressed and decompressed in
+ *                each mode, checking every round trip, and the ratio,
+ *                throughput in each direction and allocations per call
+ *                are written as CSV records, which can be appended to a
+ *                file run after run so that regressions show.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1996-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Bring in system header files.
+*/
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <ctype.h>
+#include    <stdarg.h>
+#include    <string.h>
+#include    <time.h>
+
+/* Bring in UX header files.
+*/
+#include    <ux.h>
+
+/* Specials for Solaris.
+*/
+#if defined(SOLARIS) || defined(LINUX) || defined(ZPU)
+#include    <sys/types.h>
+#include    <sys/time.h>
+#endif
+#if defined(_WIN32)
+#include    <sys/timeb.h>
+#endif
+
+/* Indicate that we are a C module for any header specifics.
+*/
+#define     CM_CORPUS_C
+
+/* Bring in local specific header files.
+*/
+#include    "cm_corpus.h"
+
+/* The corpus, in the order it is reported.
+*/
+static CORP_GENERATOR    Generator[]={
+    { "rows",       CORP_ROWSEP,    CORPRows },
+    { "log",        '\0',           CORPLog },
+    { "binary",     '\0',           CORPBinary },
+    { "compressed", '\0',           CORPCompressed },
+    { "control",    '\0',           CORPControl },
+    { "bulk",       '\0',           CORPBulk },
+    { NULL,         '\0',           NULL }
+};
+
+/* The modes measured on each item.
+*/
+static CORP_MODE        Mode[]={
+    { "lzw",           CMP_LZW,     0 },
+    { "flz",           CMP_FLZ,     0 },
+    { "flzs",          CMP_FLZS,    0 },
+    { "flzs-into",     CMP_FLZS,    CORP_INTO },
+    { "flzs-adaptive", CMP_FLZS,    CORP_ADAPTIVE },
+    { "flzd",          CMP_FLZ,     CORP_DICT },
+    { "flzs-dict",     CMP_FLZS,    CORP_DICT },
+    { "flz-par",       CMP_FLZ,     CORP_PARALLEL },
+    { "rows-flzs",     CMP_FLZS,    CORP_ROWCODE },
+    { NULL,            0,           0 }
+};
+
+/* Words the generated content is made of.
+*/
+static char    *szFirst[]={ "JOHN", "MARY", "PETER", "SUSAN", "DAVID", "ANNE",
+                            "PHILIP", "CLAIRE", "IAN", "HELEN", "MARK", "JANE" };
+static char    *szLast[]={ "SMITH", "JONES", "TAYLOR", "BROWN", "WILLIAMS",
+                           "WILSON", "JOHNSON", "DAVIES", "ROBINSON", "WRIGHT" };
+static char    *szCity[]={ "LONDON", "MANCHESTER", "BIRMINGHAM", "LEEDS",
+                           "GLASGOW", "BRISTOL", "CARDIFF", "EDINBURGH" };
+static char    *szStatus[]={ "OPEN", "CLOSED", "HELD", "PENDING" };
+static char    *szNote[]={ "Priority customer", "Awaiting credit check",
+                           "Account transferred from branch",
+                           "Do not contact before noon" };
+static char    *szTable[]={ "CUSTOMER", "ORDERS", "INVOICE", "STOCK", "BRANCH" };
+static char    *szFunc[]={ "_ODBC_RunSql", "MDC_ReturnData", "_MDC_ServerDataCB",
+                           "VDWDProcessRequest", "SL_Poll", "_SL_Send" };
+static UCHAR   szOpcode[][4]={ { 1, 0x55 }, { 3, 0x48, 0x89, 0xe5 },
+                               { 3, 0x48, 0x83, 0xec }, { 1, 0xe8 },
+                               { 2, 0x8b, 0x45 }, { 1, 0xc3 }, { 2, 0x0f, 0x84 },
+                               { 2, 0x89, 0x7d }, { 2, 0x31, 0xc0 } };
+static UINT    nOperand[]={ 0, 0, 1, 4, 1, 0, 4, 1, 0 };
+
+#define    NUM(a)                (sizeof(a) / sizeof(a[0]))
+
+/******************************************************************************
+ * Function:    _CORP_GetTimeUs
+ * Description: Get the current time in microseconds.
+ * 
+ * Returns:     Current time in uS.
+ ******************************************************************************/
+ULNG    _CORP_GetTimeUs( void )
+{
+    /* Local variables.
+    */
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    struct timeval  sTv;
+
+    gettimeofday(&sTv, NULL);
+    return((ULNG)sTv.tv_sec * 1000000L + (ULNG)sTv.tv_usec);
+#endif
+#if defined(_WIN32)
+    struct timeb    sTp;
+
+    ftime(&sTp);
+    return((ULNG)sTp.time * 1000000L + (ULNG)sTp.millitm * 1000L);
+#endif
+}
+
+/******************************************************************************
+ * Function:    _CORP_Rand
+ * Description: Next number from the corpus generator, the same on every
+ *              platform for the same seed.
+ * 
+ * Returns:     Number from 0 to nRange-1.
+ ******************************************************************************/
+UINT    _CORP_Rand( UINT    nRange )    /* I: Numbers wanted */
+{
+    CORP.lRand = (CORP.lRand * 1103515245L + 12345L) & 0x7fffffffL;
+    return((UINT)((CORP.lRand >> 8) % (nRange > 0 ? nRange : 1)));
+}
+
+/******************************************************************************
+ * Function:    _CORP_Add
+ * Description: Add a message to a corpus item.
+ * 
+ * Returns:     R_OK    - Message added.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    _CORP_Add( CORP_ITEM    *spItem,    /* IO: Item to add to */
+                  UCHAR        *spMsg,     /* I: Message */
+                  UINT         nLen )      /* I: Length of message */
+{
+    /* Local variables.
+    */
+    UINT        nSize;
+    UINT        *nNewOff;
+    UINT        *nNewLen;
+
+    if(spItem->nCnt == spItem->nOffSize)
+    {
+        nSize = (spItem->nOffSize > 0 ? spItem->nOffSize * 2 : 1024);
+        if((nNewOff=(UINT *)realloc(spItem->nOff, nSize * sizeof(UINT)))
+                                                                    == NULL)
+            return(R_FAIL);
+        spItem->nOff = nNewOff;
+        if((nNewLen=(UINT *)realloc(spItem->nMsgLen, nSize * sizeof(UINT)))
+                                                                    == NULL)
+            return(R_FAIL);
+        spItem->nMsgLen = nNewLen;
+        spItem->nOffSize = nSize;
+    }
+    spItem->nOff[spItem->nCnt] = spItem->nLen;
+    spItem->nMsgLen[spItem->nCnt] = 0;
+    spItem->nCnt++;
+    return(_CORP_Append(spItem, spMsg, nLen));
+}
+
+/******************************************************************************
+ * Function:    _CORP_Append
+ * Description: Add bytes to the end of the last message of a corpus item.
+ * 
+ * Returns:     R_OK    - Bytes added.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    _CORP_Append( CORP_ITEM    *spItem,    /* IO: Item to add to */
+                     UCHAR        *spMsg,     /* I: Bytes to add */
+                     UINT         nLen )      /* I: Number of bytes */
+{
+    /* Local variables.
+    */
+    UINT        nPos;
+    UINT        nLast = spItem->nCnt - 1;
+    UINT        nSize;
+    UCHAR       *spNew;
+
+    nPos = spItem->nOff[nLast] + spItem->nMsgLen[nLast];
+    if(nPos + nLen + 1 > spItem->nSize)
+    {
+        for(nSize=(spItem->nSize > 0 ? spItem->nSize : 65536);
+            nSize < nPos + nLen + 1; nSize *= 2);
+        if((spNew=(UCHAR *)realloc(spItem->spData, nSize)) == NULL)
+            return(R_FAIL);
+        spItem->spData = spNew;
+        spItem->nSize = nSize;
+    }
+    memcpy(&spItem->spData[nPos], spMsg, nLen);
+    spItem->nMsgLen[nLast] += nLen;
+    spItem->nLen = nPos + nLen + 1;
+    spItem->spData[spItem->nLen - 1] = '\0';
+    if(spItem->nMsgLen[nLast] > spItem->nMaxMsg)
+        spItem->nMaxMsg = spItem->nMsgLen[nLast];
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    _CORP_Blocks
+ * Description: Add a buffer to a corpus item as messages of CORP_BLOCKLEN.
+ * 
+ * Returns:     R_OK    - Buffer added.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    _CORP_Blocks( CORP_ITEM    *spItem,    /* IO: Item to add to */
+                     UCHAR        *spBuf,     /* I: Buffer */
+                     UINT         nLen )      /* I: Length of buffer */
+{
+    /* Local variables.
+    */
+    UINT        nPos;
+
+    for(nPos=0; nPos < nLen; nPos += CORP_BLOCKLEN)
+    {
+        if(_CORP_Add(spItem, &spBuf[nPos], (nLen - nPos < CORP_BLOCKLEN ?
+                                            nLen - nPos : CORP_BLOCKLEN)) == R_FAIL)
+            return(R_FAIL);
+    }
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    _CORP_Free
+ * Description: Release the contents of a corpus item.
+ * 
+ * Returns:     Non.
+ ******************************************************************************/
+void    _CORP_Free( CORP_ITEM    *spItem )    /* IO: Item to release */
+{
+    if(spItem->spData != NULL) free(spItem->spData);
+    if(spItem->nOff != NULL) free(spItem->nOff);
+    if(spItem->nMsgLen != NULL) free(spItem->nMsgLen);
+    if(spItem->spDict != NULL) free(spItem->spDict);
+    memset((UCHAR *)spItem, '\0', sizeof(CORP_ITEM));
+}
+
+/******************************************************************************
+ * Function:    _CORP_Row
+ * Description: Generate a result row as the database drivers send them,
+ *              every column padded out to its width.
+ * 
+ * Returns:     Length of the row.
+ ******************************************************************************/
+UINT    _CORP_Row( UCHAR    *szRow,     /* O: Row, CORP_MAXROW bytes */
+                   UINT     nRow )      /* I: Row number */
+{
+    /* Local variables.
+    */
+    UCHAR       szName[64];
+    UCHAR       szAmount[32];
+    UCHAR       szDate[32];
+
+    sprintf(szName, "%s %s", szFirst[_CORP_Rand(NUM(szFirst))],
+            szLast[_CORP_Rand(NUM(szLast))]);
+    sprintf(szAmount, "%u.%02u", _CORP_Rand(100000), _CORP_Rand(100));
+    sprintf(szDate, "1996-%02u-%02u %02u:%02u:%02u", nRow / 400 % 12 + 1,
+            nRow / 16 % 28 + 1, _CORP_Rand(24), _CORP_Rand(60), _CORP_Rand(60));
+    return((UINT)sprintf(szRow, "%-10u|%-30s|%-20s|%14s|%-19s|%-8s|%-40s",
+                         1000000 + nRow, szName, szCity[_CORP_Rand(NUM(szCity))],
+                         szAmount, szDate, szStatus[_CORP_Rand(NUM(szStatus))],
+                         (_CORP_Rand(4) == 0 ? szNote[_CORP_Rand(NUM(szNote))]
+                                             : "")));
+}
+
+/******************************************************************************
+ * Function:    _CORP_LogLine
+ * Description: Generate a line of log text as Lgr writes it.
+ * 
+ * Returns:     Length of the line.
+ ******************************************************************************/
+UINT    _CORP_LogLine( UCHAR    *szLine,    /* O: Line, CORP_MAXROW bytes */
+                       UINT     nLine )     /* I: Line number */
+{
+    /* Local variables.
+    */
+    UINT        nLen;
+    UINT        nSecs = nLine / 20;
+
+    nLen = (UINT)sprintf(szLine, "[%u %02u/%02u/%02u %02u:%02u:%02u %s] ",
+                         _CORP_Rand(4) + 2, nSecs / 86400 % 28 + 1, 12, 96,
+                         nSecs / 3600 % 24, nSecs / 60 % 60, nSecs % 60,
+                         szFunc[_CORP_Rand(NUM(szFunc))]);
+    switch(_CORP_Rand(6))
+    {
+        case 0:
+            nLen += sprintf(&szLine[nLen], "Row %u sent, (%u) bytes\n",
+                            nLine, 150 + _CORP_Rand(60));
+            break;
+
+        case 1:
+            nLen += sprintf(&szLine[nLen],
+                            "New service: PPID=%u, PID=%u, Chan=%u, Port=%u, "
+                            "IPaddr=10.0.%u.%u\n", 812, 20000 + _CORP_Rand(9999),
+                            1000 + _CORP_Rand(16), 17346, _CORP_Rand(4),
+                            _CORP_Rand(255));
+            break;
+
+        case 2:
+            nLen += sprintf(&szLine[nLen],
+                            "Executing: select * from %s where id = %u\n",
+                            szTable[_CORP_Rand(NUM(szTable))], _CORP_Rand(100000));
+            break;
+
+        case 3:
+            nLen += sprintf(&szLine[nLen], "Couldnt compress data (%u)\n",
+                            _CORP_Rand(64));
+            break;
+
+        case 4:
+            nLen += sprintf(&szLine[nLen],
+                            "Channel %u compression: blocks=%u, tried=%u, "
+                            "shrunk=%u, skipped=0, cpu=%uuS, saved=0uS\n",
+                            1000 + _CORP_Rand(16), nLine, nLine, nLine / 2,
+                            _CORP_Rand(100000));
+            break;
+
+        default:
+            nLen += sprintf(&szLine[nLen],
+                            "Link temporarily down, Chan=%u, Port=%u\n",
+                            1000 + _CORP_Rand(16), 17346);
+            break;
+    }
+    return(nLen);
+}
+
+/******************************************************************************
+ * Function:    GetConfig
+ * Description: Get configuration information from the OS or command line
+ *              flags.
+ * 
+ * Returns:     R_OK    - Configuration obtained.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    GetConfig( int      argc,          /* I: CLI argument count */
+                  UCHAR    **argv,        /* I: CLI argument contents */
+                  char     **envp,        /* I: Environment variables */
+                  UCHAR    *szErrMsg )    /* O: Any generated error message */
+{
+    /* Setup defaults.
+    */
+    CORP.nPasses = DEF_PASSES;
+    CORP.szOutFile[0] = '\0';
+    CORP.szWriteDir[0] = '\0';
+
+    /* Optional parameters.
+    */
+    GetCLIParam(argc, argv, FLG_PASSES, T_INT, (UCHAR *)&CORP.nPasses, 0, 0);
+    GetCLIParam(argc, argv, FLG_OUTFILE, T_STR, CORP.szOutFile,
+                MAX_LOGFILELEN, FALSE);
+    GetCLIParam(argc, argv, FLG_WRITEDIR, T_STR, CORP.szWriteDir,
+                MAX_LOGFILELEN - 32, FALSE);
+    if(CORP.nPasses == 0)
+    {
+        sprintf(szErrMsg, "Passes must be non zero");
+        return(R_FAIL);
+    }
+
+    /* Finished, get out!
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    CORPRows
+ * Description: Generate the result rows item, one row to a message as a
+ *              driver returns them.
+ * 
+ * Returns:     R_OK    - Item generated.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    CORPRows( CORP_ITEM    *spItem,    /* IO: Item to generate */
+                 ULNG         lSeed )     /* I: Generator seed */
+{
+    /* Local variables.
+    */
+    UINT        nRow;
+    UCHAR       szRow[CORP_MAXROW];
+
+    CORP.lRand = lSeed;
+    for(nRow=0; nRow < CORP_ROWS; nRow++)
+    {
+        if(_CORP_Add(spItem, szRow, _CORP_Row(szRow, nRow)) == R_FAIL)
+            return(R_FAIL);
+    }
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    CORPLog
+ * Description: Generate the log text item, in blocks.
+ * 
+ * Returns:     R_OK    - Item generated.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    CORPLog( CORP_ITEM    *spItem,    /* IO: Item to generate */
+                ULNG         lSeed )     /* I: Generator seed */
+{
+    /* Local variables.
+    */
+    UINT        nPos;
+    UINT        nLine;
+    int         nReturn;
+    UCHAR       *spText;
+
+    if((spText=(UCHAR *)malloc(CORP_TEXTLEN + CORP_MAXROW)) == NULL)
+        return(R_FAIL);
+    CORP.lRand = lSeed;
+    for(nPos=0, nLine=0; nPos < CORP_TEXTLEN; nLine++)
+        nPos += _CORP_LogLine(&spText[nPos], nLine);
+    nReturn = _CORP_Blocks(spItem, spText, CORP_TEXTLEN);
+    free(spText);
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    CORPBinary
+ * Description: Generate the binary item, in blocks. It is made in sections
+ *              as an executable is, machine code, tables of integers, zero
+ *              filled space and strings.
+ * 
+ * Returns:     R_OK    - Item generated.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    CORPBinary( CORP_ITEM    *spItem,    /* IO: Item to generate */
+                   ULNG         lSeed )     /* I: Generator seed */
+{
+    /* Local variables.
+    */
+    UINT        nPos;
+    UINT        nEnd;
+    UINT        nOp;
+    UINT        nVal;
+    int         nReturn;
+    UCHAR       *spBin;
+
+    if((spBin=(UCHAR *)malloc(CORP_TEXTLEN + 4096)) == NULL)
+        return(R_FAIL);
+    CORP.lRand = lSeed;
+    for(nPos=0; nPos < CORP_TEXTLEN; )
+    {
+        nEnd = nPos + 256 + _CORP_Rand(1792);
+        switch(_CORP_Rand(4))
+        {
+            case 0:
+                while(nPos < nEnd)
+                {
+                    nOp = _CORP_Rand(NUM(nOperand));
+                    memcpy(&spBin[nPos], &szOpcode[nOp][1], szOpcode[nOp][0]);
+                    nPos += szOpcode[nOp][0];
+                    nVal = _CORP_Rand(65536) - 32768;
+                    memcpy(&spBin[nPos], "\0\0\0\0", nOperand[nOp]);
+                    if(nOperand[nOp] == 1)
+                        spBin[nPos] = (UCHAR)(0xf8 + _CORP_Rand(8) * 0x04);
+                    if(nOperand[nOp] == 4)
+                        spBin[nPos] = (UCHAR)(nVal & 0xff),
+                        spBin[nPos+1] = (UCHAR)(nVal >> 8 & 0xff),
+                        spBin[nPos+2] = spBin[nPos+3] =
+                                        (UCHAR)(nVal & 0x8000 ? 0xff : 0x00);
+                    nPos += nOperand[nOp];
+                }
+                break;
+
+            case 1:
+                for(; nPos < nEnd; nPos += 4)
+                {
+                    nVal = (_CORP_Rand(2) ? _CORP_Rand(1000)
+                                          : 0x08048000 + _CORP_Rand(65536) * 4);
+                    spBin[nPos] = (UCHAR)(nVal & 0xff);
+                    spBin[nPos+1] = (UCHAR)(nVal >> 8 & 0xff);
+                    spBin[nPos+2] = (UCHAR)(nVal >> 16 & 0xff);
+                    spBin[nPos+3] = (UCHAR)(nVal >> 24 & 0xff);
+                }
+                break;
+
+            case 2:
+                nEnd = nPos + _CORP_Rand(512);
+                memset(&spBin[nPos], '\0', nEnd - nPos);
+                nPos = nEnd;
+                break;
+
+            default:
+                while(nPos < nEnd)
+                {
+                    nPos += sprintf(&spBin[nPos], "%s", 
+                                    szFunc[_CORP_Rand(NUM(szFunc))]) + 1;
+                }
+                break;
+        }
+    }
+    nReturn = _CORP_Blocks(spItem, spBin, CORP_TEXTLEN);
+    free(spBin);
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    CORPCompressed
+ * Description: Generate the item of data already compressed, log text
+ *              compressed with LZW, in blocks.
+ * 
+ * Returns:     R_OK    - Item generated.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    CORPCompressed( CORP_ITEM    *spItem,    /* IO: Item to generate */
+                       ULNG         lSeed )     /* I: Generator seed */
+{
+    /* Local variables.
+    */
+    UINT        nPos;
+    UINT        nLine;
+    UINT        nLen = 4 * CORP_TEXTLEN;
+    int         nReturn = R_FAIL;
+    UCHAR       *spText;
+    UCHAR       *spCmp;
+
+    if((spText=(UCHAR *)malloc(nLen + CORP_MAXROW)) == NULL)
+        return(R_FAIL);
+    CORP.lRand = lSeed;
+    for(nPos=0, nLine=0; nPos < nLen; nLine++)
+        nPos += _CORP_LogLine(&spText[nPos], nLine);
+    /* The header is left off, data compressed elsewhere doesnt start with
+     * the markers of this library.
+    */
+    if((spCmp=CompressCodec(CMP_LZW, spText, &nLen)) != NULL && spCmp != spText)
+    {
+        nLen -= CMP_HDRLEN;
+        nReturn = _CORP_Blocks(spItem, &spCmp[CMP_HDRLEN],
+                               (nLen < CORP_TEXTLEN ? nLen : CORP_TEXTLEN));
+        free(spCmp);
+    }
+    free(spText);
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    CORPControl
+ * Description: Generate the control message item, the acknowledgements,
+ *              requests and commands of the MDC protocol, each a message.
+ * 
+ * Returns:     R_OK    - Item generated.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    CORPControl( CORP_ITEM    *spItem,    /* IO: Item to generate */
+                    ULNG         lSeed )     /* I: Generator seed */
+{
+    /* Local variables.
+    */
+    UINT        nMsg;
+    UINT        nLen;
+    UCHAR       szMsg[CORP_MAXROW];
+
+    CORP.lRand = lSeed;
+    for(nMsg=0; nMsg < CORP_CONTROLS; nMsg++)
+    {
+        switch(_CORP_Rand(8))
+        {
+            case 0:
+                nLen = sprintf(szMsg, "A");
+                break;
+
+            case 1:
+                szMsg[0] = 'A';
+                szMsg[1] = (UCHAR)_CORP_Rand(3);
+                szMsg[2] = (UCHAR)_CORP_Rand(2);
+                nLen = 3;
+                break;
+
+            case 2:
+                nLen = sprintf(szMsg, "NS0004: Couldnt execute statement on %s",
+                               szTable[_CORP_Rand(NUM(szTable))]);
+                break;
+
+            case 3:
+                nLen = sprintf(szMsg, "Pselect * from %s where id = %u",
+                               szTable[_CORP_Rand(NUM(szTable))],
+                               _CORP_Rand(100000));
+                break;
+
+            case 4:
+                nLen = sprintf(szMsg, "B");
+                break;
+
+            case 5:
+                nLen = sprintf(szMsg, "E");
+                break;
+
+            case 6:
+                nLen = sprintf(szMsg, "IO%-8s%-8s%-16s%-8s", "vdw", "secret",
+                               szCity[_CORP_Rand(NUM(szCity))], "master");
+                break;
+
+            default:
+                nLen = sprintf(szMsg, "D%u|%s", _CORP_Rand(100000),
+                               szStatus[_CORP_Rand(NUM(szStatus))]);
+                break;
+        }
+        if(_CORP_Add(spItem, szMsg, nLen) == R_FAIL)
+            return(R_FAIL);
+    }
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    CORPBulk
+ * Description: Generate the bulk item, a single reply of rows large enough
+ *              to be compressed in parallel.
+ * 
+ * Returns:     R_OK    - Item generated.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    CORPBulk( CORP_ITEM    *spItem,    /* IO: Item to generate */
+                 ULNG         lSeed )     /* I: Generator seed */
+{
+    /* Local variables.
+    */
+    UINT        nRow;
+    UINT        nLen;
+    UCHAR       szRow[CORP_MAXROW];
+
+    CORP.lRand = lSeed;
+    if(_CORP_Add(spItem, szRow, 0) == R_FAIL)
+        return(R_FAIL);
+    for(nRow=0; spItem->nLen < CORP_BULKLEN; nRow++)
+    {
+        nLen = _CORP_Row(szRow, nRow);
+        szRow[nLen++] = '\n';
+        if(_CORP_Append(spItem, szRow, nLen) == R_FAIL)
+            return(R_FAIL);
+    }
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    CORPBuild
+ * Description: Generate an item of the corpus, and its dictionary from the
+ *              same generator given another seed.
+ * 
+ * Returns:     R_OK    - Item generated.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    CORPBuild( CORP_GENERATOR    *spGen,     /* I: Generator of item */
+                  CORP_ITEM         *spItem )   /* O: Item */
+{
+    /* Local variables.
+    */
+    UINT        nMsg;
+    UINT        nLen;
+    CORP_ITEM   sSample;
+
+    memset((UCHAR *)spItem, '\0', sizeof(CORP_ITEM));
+    memset((UCHAR *)&sSample, '\0', sizeof(CORP_ITEM));
+    spItem->szName = spGen->szName;
+    spItem->cSep = spGen->cSep;
+    if(spGen->fGenerate(spItem, CORP_SEED) == R_FAIL ||
+       spGen->fGenerate(&sSample, CORP_SEED + 1) == R_FAIL ||
+       (spItem->spDict=(UCHAR *)malloc(CMP_MAXDICTLEN)) == NULL)
+    {
+        _CORP_Free(&sSample);
+        return(R_FAIL);
+    }
+    for(nMsg=0; nMsg < sSample.nCnt && spItem->nDictLen < CMP_MAXDICTLEN;
+        nMsg++)
+    {
+        nLen = sSample.nMsgLen[nMsg];
+        if(nLen > CMP_MAXDICTLEN - spItem->nDictLen)
+            nLen = CMP_MAXDICTLEN - spItem->nDictLen;
+        memcpy(&spItem->spDict[spItem->nDictLen],
+               &sSample.spData[sSample.nOff[nMsg]], nLen);
+        spItem->nDictLen += nLen;
+    }
+    _CORP_Free(&sSample);
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    CORPWrite
+ * Description: Write the corpus out, an item to a file named after it and
+ *              the corpus version, each message held as a 4 byte length
+ *              followed by its bytes.
+ * 
+ * Returns:     R_OK    - Corpus written.
+ *              R_FAIL  - Couldnt write a file.
+ ******************************************************************************/
+int    CORPWrite( void )
+{
+    /* Local variables.
+    */
+    UINT        nItem;
+    UINT        nMsg;
+    UCHAR       szLen[4];
+    UCHAR       szFile[MAX_LOGFILELEN];
+    FILE        *spFile;
+
+    for(nItem=0; nItem < CORP.nItems; nItem++)
+    {
+        sprintf(szFile, "%s/%s.v%d", CORP.szWriteDir,
+                CORP.sItem[nItem].szName, CORP_VERSION);
+        if((spFile=fopen(szFile, "wb")) == NULL)
+            return(R_FAIL);
+        for(nMsg=0; nMsg < CORP.sItem[nItem].nCnt; nMsg++)
+        {
+            PutCharFromLong(szLen, (ULNG)CORP.sItem[nItem].nMsgLen[nMsg]);
+            fwrite(szLen, 1, 4, spFile);
+            fwrite(&CORP.sItem[nItem].spData[CORP.sItem[nItem].nOff[nMsg]], 1,
+                   CORP.sItem[nItem].nMsgLen[nMsg], spFile);
+        }
+        if(fclose(spFile) != 0)
+            return(R_FAIL);
+    }
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    CORPRun
+ * Description: Compress every message of an item in a mode and decompress
+ *              them all again, as many times as there are passes, timing
+ *              each direction and counting the allocations made. Stream
+ *              contexts start over on each pass, as on a new connection.
+ * 
+ * Returns:     R_OK    - Run complete, results added to spResult.
+ *              R_FAIL  - Couldnt set up the run.
+ ******************************************************************************/
+int    CORPRun( CORP_ITEM      *spItem,     /* I: Corpus item */
+                CORP_MODE      *spMode,     /* I: Mode of compression */
+                CORP_RESULT    *spResult )  /* IO: Results */
+{
+    /* Local variables.
+    */
+    UINT        nPass;
+    UINT        nMsg;
+    UINT        nLen;
+    UINT        nRowPos;
+    UINT        nRowSize = 0;
+    ULNG        lStartUs;
+    ULNG        lAllocs;
+    UCHAR       *spIn;
+    UCHAR       *spExp;
+    UCHAR       **spOut = NULL;
+    UINT        *nOutLen = NULL;
+    UCHAR       *spRows = NULL;
+    UCHAR       *spBuf = NULL;
+    UCHAR       *spRowBuf = NULL;
+    LZW_CTX     *spCmpCtx = LZW_CreateCtx();
+    LZW_CTX     *spDecCtx = LZW_CreateCtx();
+    ROW_CTX     *spRowEnc = ROW_CreateCtx();
+    ROW_CTX     *spRowDec = ROW_CreateCtx();
+    int         nReturn = R_OK;
+
+    /* Everything the run needs is set up ahead of the clock, rows are
+     * coded into slots of their own so each stays where the compressor
+     * may hand it back as is.
+    */
+    for(nMsg=0; nMsg < spItem->nCnt; nMsg++)
+        nRowSize += ROW_MAXLEN(spItem->nMsgLen[nMsg]) + 1;
+    if(spCmpCtx == NULL || spDecCtx == NULL || spRowEnc == NULL ||
+       spRowDec == NULL ||
+       (spOut=(UCHAR **)malloc(spItem->nCnt * sizeof(UCHAR *))) == NULL ||
+       (nOutLen=(UINT *)malloc(spItem->nCnt * sizeof(UINT))) == NULL ||
+       (spBuf=(UCHAR *)malloc(ROW_MAXLEN(spItem->nMaxMsg) + 1)) == NULL ||
+       (spRowBuf=(UCHAR *)malloc(spItem->nMaxMsg + 1)) == NULL ||
+       ((spMode->nFlags & CORP_ROWCODE) &&
+        (spRows=(UCHAR *)malloc(nRowSize)) == NULL))
+        nReturn = R_FAIL;
+    if(nReturn == R_OK && (spMode->nFlags & CORP_ADAPTIVE))
+        nReturn = LZW_SetAdaptive(spCmpCtx, TRUE);
+    if(nReturn == R_OK && (spMode->nFlags & CORP_PARALLEL))
+        nReturn = LZW_SetParallel(spCmpCtx, TRUE);
+    if(nReturn == R_OK && (spMode->nFlags & CORP_DICT) &&
+       (LZW_LoadDict(CORP_DICTID, spItem->spDict, spItem->nDictLen) == R_FAIL ||
+        LZW_SetDict(spCmpCtx, CORP_DICTID) == R_FAIL ||
+        LZW_SetDict(spDecCtx, CORP_DICTID) == R_FAIL))
+        nReturn = R_FAIL;
+
+    for(nPass=0; nReturn == R_OK && nPass < CORP.nPasses; nPass++)
+    {
+        LZW_SetCodec(spCmpCtx, spMode->nCodec);
+        LZW_SetCodec(spDecCtx, spMode->nCodec);
+        ROW_ResetCtx(spRowEnc);
+        ROW_ResetCtx(spRowDec);
+
+        /* A message which couldnt be compressed counts as a failed round
+         * trip.
+        */
+        lAllocs = CORP.lAllocs;
+        lStartUs = _CORP_GetTimeUs();
+        for(nMsg=0, nRowPos=0; nMsg < spItem->nCnt; nMsg++)
+        {
+            spIn = &spItem->spData[spItem->nOff[nMsg]];
+            nLen = spItem->nMsgLen[nMsg];
+            if(spMode->nFlags & CORP_ROWCODE)
+            {
+                ROW_Encode(spRowEnc, spItem->cSep, spIn, nLen, &spRows[nRowPos],
+                           &nLen);
+                spIn = &spRows[nRowPos];
+                nRowPos += ROW_MAXLEN(spItem->nMsgLen[nMsg]) + 1;
+            }
+            spOut[nMsg] = CompressCtx(spCmpCtx, spIn, &nLen);
+            nOutLen[nMsg] = nLen;
+            spResult->dBytesIn += spItem->nMsgLen[nMsg];
+            spResult->dBytesOut += nLen;
+        }
+        spResult->lCmpUs += _CORP_GetTimeUs() - lStartUs;
+        spResult->lCmpAllocs += CORP.lAllocs - lAllocs;
+        spResult->lCalls += spItem->nCnt;
+
+        lAllocs = CORP.lAllocs;
+        lStartUs = _CORP_GetTimeUs();
+        for(nMsg=0; nMsg < spItem->nCnt; nMsg++)
+        {
+            nLen = nOutLen[nMsg];
+            if(spOut[nMsg] == NULL)
+            {
+                spExp = NULL;
+            } else
+            if(spMode->nFlags & CORP_INTO)
+            {
+                spExp = spBuf;
+                if(DecompressInto(spDecCtx, spOut[nMsg], nLen, spExp,
+                                  ROW_MAXLEN(spItem->nMaxMsg), &nLen) == R_FAIL)
+                    spExp = NULL;
+            } else
+             {
+                spExp = DecompressCtx(spDecCtx, spOut[nMsg], &nLen);
+            }
+            if(spExp != NULL && (spMode->nFlags & CORP_ROWCODE))
+            {
+                if(ROW_Decode(spRowDec, spExp, nLen, spRowBuf, spItem->nMaxMsg,
+                              &nLen) == R_FAIL)
+                    nLen = 0;
+                if(spExp != spOut[nMsg] && spExp != spBuf)
+                    free(spExp);
+                spExp = spRowBuf;
+            }
+            if(spExp == NULL || nLen != spItem->nMsgLen[nMsg] ||
+               memcmp(spExp, &spItem->spData[spItem->nOff[nMsg]], nLen) != 0)
+                spResult->nFailed++;
+            if(spExp != NULL && spExp != spOut[nMsg] && spExp != spBuf &&
+               spExp != spRowBuf)
+                free(spExp);
+        }
+        spResult->lDecUs += _CORP_GetTimeUs() - lStartUs;
+        spResult->lDecAllocs += CORP.lAllocs - lAllocs;
+
+        /* Release the compressed copies, those handed back as they were
+         * belong to the corpus.
+        */
+        for(nMsg=0, nRowPos=0; nMsg < spItem->nCnt; nMsg++)
+        {
+            if(spOut[nMsg] != NULL &&
+               spOut[nMsg] != &spItem->spData[spItem->nOff[nMsg]] &&
+               (spRows == NULL || spOut[nMsg] != &spRows[nRowPos]))
+                free(spOut[nMsg]);
+            nRowPos += ROW_MAXLEN(spItem->nMsgLen[nMsg]) + 1;
+        }
+    }
+
+    /* Tidy up, a dictionary is only loaded for the length of a run.
+    */
+    if(spMode->nFlags & CORP_DICT)
+        LZW_FreeDict(CORP_DICTID);
+    LZW_FreeCtx(spCmpCtx);
+    LZW_FreeCtx(spDecCtx);
+    ROW_FreeCtx(spRowEnc);
+    ROW_FreeCtx(spRowDec);
+    if(spOut != NULL) free(spOut);
+    if(nOutLen != NULL) free(nOutLen);
+    if(spRows != NULL) free(spRows);
+    if(spBuf != NULL) free(spBuf);
+    if(spRowBuf != NULL) free(spRowBuf);
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    main
+ * Description: Entry point into the benchmark program. Build the corpus,
+ *              run each mode over each item it applies to and write the
+ *              results.
+ * 
+ * Returns:     0     - Program completed successfully without errors.
+ *              -1    - Program terminated with errors.
+ ******************************************************************************/
+int    main( int     argc,       /* I: Count of available arguments */
+             char    **argv,     /* I: Array of arguments */
+             char    **envp )    /* I: Array of environment parameters */
+{
+    /* Local variables.
+    */
+    UINT            nItem;
+    UINT            nMode;
+    UINT            nFailed = 0;
+    ULNG            lRun = (ULNG)time(NULL);
+    CORP_ITEM       *spItem;
+    CORP_RESULT     sResult;
+    FILE            *spOutFile = NULL;
+    UCHAR           szRec[MAX_ERRMSG_LEN];
+    UCHAR           szAllocs[64];
+    UCHAR           szErrMsg[MAX_ERRMSG_LEN];
+    char            *szHeader = "run,version,item,mode,calls,bytes_in,"
+                                "bytes_out,ratio,cmp_mbs,dec_mbs,"
+                                "cmp_allocs,dec_allocs,failed\n";
+
+    /* Bring in any configuration parameters passed on the command line etc.
+    */
+    if( GetConfig(argc, (UCHAR **)argv, envp, szErrMsg) == R_FAIL )
+    {
+        printf( "%s\n"
+                "Usage:                 %s <parameters>\n"
+                "<parameters>:          -n <Passes over each item>\n"
+                "                       -o <File to append results to>\n"
+                "                       -w <Directory to write corpus to>\n",
+                szErrMsg, argv[0]);
+        exit(-1);
+    }
+
+    /* The library only logs failures here, it would otherwise swamp the
+     * results and the timings.
+    */
+    Lgr(LOG_CONFIG, LGM_STDOUT, LOG_ALERT, "");
+
+    for(nItem=0; Generator[nItem].szName != NULL && nItem < MAX_ITEMS; nItem++)
+    {
+        if(CORPBuild(&Generator[nItem], &CORP.sItem[nItem]) == R_FAIL)
+        {
+            printf("%s: Couldnt generate (%s)\n", argv[0],
+                   Generator[nItem].szName);
+            exit(-1);
+        }
+    }
+    CORP.nItems = nItem;
+    if(CORP.szWriteDir[0] != '\0' && CORPWrite() == R_FAIL)
+    {
+        printf("%s: Couldnt write corpus to (%s)\n", argv[0], CORP.szWriteDir);
+        exit(-1);
+    }
+
+    /* Results go to stdout, and are appended to the output file if one is
+     * given, its header written only when its new.
+    */
+    if(CORP.szOutFile[0] != '\0')
+    {
+        if((spOutFile=fopen(CORP.szOutFile, "a")) == NULL)
+        {
+            printf("%s: Couldnt open (%s)\n", argv[0], CORP.szOutFile);
+            exit(-1);
+        }
+        fseek(spOutFile, 0L, SEEK_END);
+        if(ftell(spOutFile) == 0)
+            fputs(szHeader, spOutFile);
+    }
+    fputs(szHeader, stdout);
+
+    LZW_StartPool(0);
+    for(nItem=0; nItem < CORP.nItems; nItem++)
+    {
+        spItem = &CORP.sItem[nItem];
+        for(nMode=0; Mode[nMode].szName != NULL; nMode++)
+        {
+            /* Rows are only coded where there are rows, and only a large
+             * message is compressed in parallel.
+            */
+            if(((Mode[nMode].nFlags & CORP_ROWCODE) && spItem->cSep == '\0') ||
+               ((Mode[nMode].nFlags & CORP_PARALLEL) &&
+                spItem->nMaxMsg < CMP_PARMIN))
+                continue;
+
+            memset((UCHAR *)&sResult, '\0', sizeof(CORP_RESULT));
+            if(CORPRun(spItem, &Mode[nMode], &sResult) == R_FAIL)
+            {
+                printf("%s: Couldnt run (%s) on (%s), Errno=%d\n", argv[0],
+                       Mode[nMode].szName, spItem->szName, Errno);
+                exit(-1);
+            }
+            nFailed += sResult.nFailed;
+
+#if defined(LINUX)
+            sprintf(szAllocs, "%.2f,%.2f",
+                    (double)sResult.lCmpAllocs / sResult.lCalls,
+                    (double)sResult.lDecAllocs / sResult.lCalls);
+#else
+            sprintf(szAllocs, "NA,NA");
+#endif
+            sprintf(szRec, "%lu,%d,%s,%s,%lu,%.0f,%.0f,%.4f,%.2f,%.2f,%s,%u\n",
+                    lRun, CORP_VERSION, spItem->szName, Mode[nMode].szName,
+                    sResult.lCalls, sResult.dBytesIn, sResult.dBytesOut,
+                    sResult.dBytesOut / sResult.dBytesIn,
+                    sResult.dBytesIn / (sResult.lCmpUs > 0 ? sResult.lCmpUs : 1),
+                    sResult.dBytesIn / (sResult.lDecUs > 0 ? sResult.lDecUs : 1),
+                    szAllocs, sResult.nFailed);
+            fputs(szRec, stdout);
+            fflush(stdout);
+            if(spOutFile != NULL)
+                fputs(szRec, spOutFile);
+        }
+    }
+    LZW_StopPool();
+
+    if(spOutFile != NULL)
+        fclose(spOutFile);
+    for(nItem=0; nItem < CORP.nItems; nItem++)
+        _CORP_Free(&CORP.sItem[nItem]);
+
+    /* All done, go bye bye's, failing if any round trip didnt match.
+    */
+    return(nFailed == 0 ? 0 : -1);
+}
+
+/* Counters of the allocations made by the library, which the linker points
+ * its calls to malloc and friends at. The pool workers allocate too, so
+ * the count is kept atomically.
+*/
+#if defined(LINUX)
+void    *__wrap_malloc( size_t    nSize )
+{
+    __sync_fetch_and_add(&CORP.lAllocs, 1);
+    return(__real_malloc(nSize));
+}
+
+void    *__wrap_realloc( void    *spPtr,
+                         size_t  nSize )
+{
+    __sync_fetch_and_add(&CORP.lAllocs, 1);
+    return(__real_realloc(spPtr, nSize));
+}
+
+void    *__wrap_calloc( size_t    nCnt,
+                        size_t    nSize )
+{
+    __sync_fetch_and_add(&CORP.lAllocs, 1);
+    return(__real_calloc(nCnt, nSize));
+}
+#endif
@@ -0,0 +1,186 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          cm_corpus.h
+ * Description:   Header file for declaration of structures, datatypes etc for
+ *                the compression corpus benchmark.
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D.Smart, 1996-2019.
+ *
+ * History:       1.0 - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    CM_CORPUS_H
+#define    CM_CORPUS_H
+
+/* Definitions for maxims etc.
+*/
+#define    MAX_ERRMSG_LEN        256
+#define    MAX_LOGFILELEN        256
+#define    MAX_ITEMS             8
+
+/* Definitions for defaults.
+*/
+#define    DEF_PASSES            3       /* Passes over each item and mode */
+
+/* Version of the corpus. The corpus is generated from a fixed seed so
+ * every build measures the same bytes, bump the version whenever a
+ * generator changes so that results from before are not compared with
+ * those after.
+*/
+#define    CORP_VERSION          1
+#define    CORP_SEED             19961207L
+#define    CORP_DICTID           1       /* Dictionary id used by flzd */
+
+/* Shape of the corpus items.
+*/
+#define    CORP_ROWS             4000    /* Padded result rows */
+#define    CORP_TEXTLEN          (512 * 1024) /* Log, binary and compressed */
+#define    CORP_BLOCKLEN         16384   /* Message size of those items */
+#define    CORP_CONTROLS         5000    /* Tiny control messages */
+#define    CORP_BULKLEN          (4 * 1024 * 1024) /* One large reply */
+#define    CORP_ROWSEP           '|'     /* As DEF_COLSEP of the drivers */
+#define    CORP_MAXROW           256     /* Longest generated row or line */
+
+/* Modes of compression measured, flags of each. Every mode is run on
+ * every item it applies to.
+*/
+#define    CORP_ADAPTIVE         0x01    /* Adaptive skipping on */
+#define    CORP_DICT             0x02    /* Shared dictionary of the item */
+#define    CORP_PARALLEL         0x04    /* Large messages on the pool */
+#define    CORP_ROWCODE          0x08    /* Rows coded before compressing */
+#define    CORP_INTO             0x10    /* Decompressed into a given buffer */
+
+/* Define command line flags.
+*/
+#define    FLG_PASSES            "-n"
+#define    FLG_OUTFILE           "-o"
+#define    FLG_WRITEDIR          "-w"
+
+/* An item of the corpus, a set of messages each given to one call, held
+ * one after another with a spare byte after each, as DecompressCtx
+ * terminates a buffer it finds isnt compressed. The dictionary is a
+ * sample of the same content generated from another seed.
+*/
+typedef struct {
+    char           *szName;              /* Name in the results */
+    UCHAR          cSep;                 /* Row field separator, 0 = none */
+    UCHAR          *spData;              /* Messages */
+    UINT           nLen;                 /* Bytes held */
+    UINT           nSize;                /* Size of spData */
+    UINT           *nOff;                /* Start of each message */
+    UINT           *nMsgLen;             /* Length of each message */
+    UINT           nCnt;                 /* Messages held */
+    UINT           nOffSize;             /* Entries in nOff and nMsgLen */
+    UINT           nMaxMsg;              /* Longest message */
+    UCHAR          *spDict;              /* Dictionary sample */
+    UINT           nDictLen;             /* Its length */
+} CORP_ITEM;
+
+/* A generator of a corpus item.
+*/
+typedef struct {
+    char           *szName;              /* Name of the item */
+    UCHAR          cSep;                 /* Row field separator, 0 = none */
+    int            (*fGenerate)( CORP_ITEM *, ULNG );
+} CORP_GENERATOR;
+
+/* A mode of compression.
+*/
+typedef struct {
+    char           *szName;              /* Name in the results */
+    UINT           nCodec;               /* Codec of the contexts */
+    UINT           nFlags;               /* CORP_ flags */
+} CORP_MODE;
+
+/* Results of one item in one mode.
+*/
+typedef struct {
+    ULNG           lCalls;               /* Messages compressed, all passes */
+    double         dBytesIn;             /* Bytes offered */
+    double         dBytesOut;            /* Bytes written */
+    ULNG           lCmpUs;               /* Time compressing */
+    ULNG           lDecUs;               /* Time expanding */
+    ULNG           lCmpAllocs;           /* Allocations compressing */
+    ULNG           lDecAllocs;           /* Allocations expanding */
+    UINT           nFailed;              /* Round trips which did not match */
+} CORP_RESULT;
+
+/* Globals (yuggghhh!).
+*/
+typedef struct {
+    UINT           nPasses;
+    UCHAR          szOutFile[MAX_LOGFILELEN];
+    UCHAR          szWriteDir[MAX_LOGFILELEN];
+    ULNG           lRand;                /* Generator state */
+    ULNG           lAllocs;              /* Allocations made by the library */
+    CORP_ITEM      sItem[MAX_ITEMS];
+    UINT           nItems;
+} CORP_GLOBALS;
+
+/* Declare any globals required by the program, or any specifics to the
+ * C module.
+*/
+#if defined(CM_CORPUS_C)
+    static    CORP_GLOBALS    CORP;
+#endif
+
+/* Prototypes for functions.
+*/
+ULNG       _CORP_GetTimeUs( void );
+UINT       _CORP_Rand( UINT );
+int        _CORP_Add( CORP_ITEM *, UCHAR *, UINT );
+int        _CORP_Append( CORP_ITEM *, UCHAR *, UINT );
+int        _CORP_Blocks( CORP_ITEM *, UCHAR *, UINT );
+void       _CORP_Free( CORP_ITEM * );
+UINT       _CORP_Row( UCHAR *, UINT );
+UINT       _CORP_LogLine( UCHAR *, UINT );
+int        GetConfig( int, UCHAR **, char **, UCHAR * );
+int        CORPRows( CORP_ITEM *, ULNG );
+int        CORPLog( CORP_ITEM *, ULNG );
+int        CORPBinary( CORP_ITEM *, ULNG );
+int        CORPCompressed( CORP_ITEM *, ULNG );
+int        CORPControl( CORP_ITEM *, ULNG );
+int        CORPBulk( CORP_ITEM *, ULNG );
+int        CORPBuild( CORP_GENERATOR *, CORP_ITEM * );
+int        CORPWrite( void );
+int        CORPRun( CORP_ITEM *, CORP_MODE *, CORP_RESULT * );
+int        main( int, char **, char ** );
+
+/* Allocations made by the library are counted where the linker can wrap
+ * them, see the Makefile.
+*/
+#if defined(LINUX)
+void       *__real_malloc( size_t );
+void       *__real_realloc( void *, size_t );
+void       *__real_calloc( size_t, size_t );
+void       *__wrap_malloc( size_t );
+void       *__wrap_realloc( void *, size_t );
+void       *__wrap_calloc( size_t, size_t );
+#endif
+
+#endif    /* CM_CORPUS_H */
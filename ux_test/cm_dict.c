@@ -0,0 +1,629 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          cm_dict.c
+ * Description:   A Test Harness program to build the shared compression
+ *                dictionaries of each type of service from traffic captured
+ *                by the socket library (SL_CaptureStart, vdwd -c). Each
+ *                channel is expanded as its peers did and its packets
+ *                filed under the service it asked for, then the pieces of
+ *                packet whose strings recur in the most packets are chosen
+ *                for the dictionary, those with the best score last. The
+ *                dictionaries are written where vdwd -d and
+ *                MDC_SetDictionary expect them, and measured against
+ *                packets held back from building them.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1996-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Bring in system header files.
+*/
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <ctype.h>
+#include    <stdarg.h>
+#include    <string.h>
+
+/* Bring in UX and MDC header files, the latter for the packet types.
+*/
+#include    <ux.h>
+#include    <mdc.h>
+
+/* Indicate that we are a C module for any header specifics.
+*/
+#define     CM_DICT_C
+
+/* Bring in local specific header files.
+*/
+#include    "cm_dict.h"
+
+/* Hash of the DICT_KMER bytes at a position.
+*/
+#define DICT_HASH(p) (((((UINT)(p)[0] | ((UINT)(p)[1] << 8) | \
+                         ((UINT)(p)[2] << 16) | ((UINT)(p)[3] << 24)) * \
+                        2654435761U) ^ \
+                       (((UINT)(p)[4] | ((UINT)(p)[5] << 8) | \
+                         ((UINT)(p)[6] << 16) | ((UINT)(p)[7] << 24)) * \
+                        2246822519U)) >> (32 - DICT_HASHBITS))
+
+/******************************************************************************
+ * Function:    GetConfig
+ * Description: Get configuration information from the OS or command line
+ *              flags.
+ * 
+ * Returns:     R_OK    - Configuration obtained.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    GetConfig( int      argc,          /* I: CLI argument count */
+                  UCHAR    **argv,        /* I: CLI argument contents */
+                  char     **envp,        /* I: Environment variables */
+                  UCHAR    *szErrMsg )    /* O: Any generated error message */
+{
+    /* Setup defaults.
+    */
+    strcpy(DICT.szOutDir, DEF_OUTDIR);
+    DICT.nDictSize = DEF_DICTSIZE;
+
+    /* Name of capture file is mandatory.
+    */
+    if( GetCLIParam(argc, argv, FLG_CAPFILE, T_STR, DICT.szCapFile,
+                    MAX_LOGFILELEN, FALSE) != R_OK )
+    {
+        sprintf(szErrMsg, "No capture file given");
+        return(R_FAIL);
+    }
+
+    /* Optional parameters.
+    */
+    GetCLIParam(argc, argv, FLG_OUTDIR, T_STR, DICT.szOutDir,
+                MAX_LOGFILELEN - 8, FALSE);
+    GetCLIParam(argc, argv, FLG_DICTSIZE, T_INT, (UCHAR *)&DICT.nDictSize, 0, 0);
+    if(DICT.nDictSize < DICT_SEGLEN || DICT.nDictSize > CMP_MAXDICTLEN)
+    {
+        sprintf(szErrMsg, "Dictionary size must be %d..%d", DICT_SEGLEN,
+                CMP_MAXDICTLEN);
+        return(R_FAIL);
+    }
+
+    /* Finished, get out!
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    _DICT_AddSample
+ * Description: Add the start of a packet to a set of samples.
+ * 
+ * Returns:     R_OK    - Sample added, or the set is full.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    _DICT_AddSample( DICT_SAMPLES    *spSet,    /* IO: Set of samples */
+                        UCHAR           *spData,   /* I: Packet */
+                        UINT            nLen )     /* I: Length of packet */
+{
+    /* Local variables.
+    */
+    UINT        nSize;
+    UINT        *nNewOff;
+    UCHAR       *spNew;
+
+    if(nLen > DICT_SAMPLELEN)
+        nLen = DICT_SAMPLELEN;
+    if(spSet->nLen + nLen > DEF_MAXSAMPLES)
+        return(R_OK);
+
+    /* Grow the data and the offsets, which keep one more for the end.
+    */
+    if(spSet->nLen + nLen > spSet->nSize)
+    {
+        nSize = spSet->nSize * 2 + DICT_SAMPLELEN * 64;
+        if((spNew=(UCHAR *)realloc(spSet->spData, nSize)) == NULL)
+            return(R_FAIL);
+        spSet->spData = spNew;
+        spSet->nSize = nSize;
+    }
+    if(spSet->nCnt + 2 > spSet->nOffSize)
+    {
+        nSize = spSet->nOffSize * 2 + 1024;
+        if((nNewOff=(UINT *)realloc(spSet->nOff, sizeof(UINT) * nSize)) == NULL)
+            return(R_FAIL);
+        spSet->nOff = nNewOff;
+        spSet->nOffSize = nSize;
+    }
+
+    memcpy(spSet->spData + spSet->nLen, spData, nLen);
+    spSet->nOff[spSet->nCnt++] = spSet->nLen;
+    spSet->nLen += nLen;
+    spSet->nOff[spSet->nCnt] = spSet->nLen;
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    DICTFrame
+ * Description: Take one captured frame, expanding it with the stream of its
+ *              channel and direction. A service request or change names
+ *              the service the packets of the channel belong to, and a
+ *              request starts the streams of the channel again as it did
+ *              for the peers.
+ * 
+ * Returns:     R_OK    - Frame taken, or skipped if it couldnt be expanded.
+ *              R_FAIL  - Memory exhausted, see error message.
+ ******************************************************************************/
+int    DICTFrame( UINT     nChanId,       /* I: Channel Id at capture time */
+                  UCHAR    cDir,          /* I: SLCAP_RECV or SLCAP_SEND */
+                  UCHAR    *spData,       /* I: Frame */
+                  UINT     nDataLen,      /* I: Length of frame */
+                  UCHAR    *szErrMsg )    /* O: Generated error message */
+{
+    /* Local variables.
+    */
+    UINT            nDir = (cDir == SLCAP_RECV ? 0 : 1);
+    UINT            nLen;
+    UCHAR           *spPkt;
+    DICT_CHANNEL    *spChan;
+    DICT_SERVICE    *spSrv;
+
+    DICT.lFrames++;
+
+    /* First sighting of this channel, it gets a stream each way.
+    */
+    if((spChan=(DICT_CHANNEL *)FindItem(DICT.spChanHead, &nChanId, NULL, NULL))
+                                                                      == NULL)
+    {
+        if((spChan=(DICT_CHANNEL *)malloc(sizeof(DICT_CHANNEL))) == NULL ||
+           (spChan->spCtx[0]=LZW_CreateCtx()) == NULL ||
+           (spChan->spCtx[1]=LZW_CreateCtx()) == NULL ||
+           AddItem(&DICT.spChanHead, &DICT.spChanTail, SORT_NONE, &nChanId,
+                   NULL, NULL, spChan) == R_FAIL)
+        {
+            sprintf(szErrMsg, "Couldnt create channel (%d)", nChanId);
+            return(R_FAIL);
+        }
+        spChan->nChanId = nChanId;
+        spChan->cServiceType = '\0';
+        LZW_SetCodec(spChan->spCtx[0], CMP_FLZS);
+        LZW_SetCodec(spChan->spCtx[1], CMP_FLZS);
+    }
+
+    /* Expand the frame, a stream which has lost a frame stays unreadable
+     * until the next service request.
+    */
+    if(DecompressSize(spData, nDataLen, &nLen) == R_FAIL ||
+       (spPkt=(UCHAR *)malloc(nLen + 1)) == NULL)
+    {
+        DICT.lBadFrames++;
+        return(R_OK);
+    }
+    if(DecompressInto(spChan->spCtx[nDir], spData, nDataLen, spPkt, nLen,
+                      &nLen) == R_FAIL || nLen == 0)
+    {
+        DICT.lBadFrames++;
+        free(spPkt);
+        return(R_OK);
+    }
+
+    /* A request carries the service details, the service type first.
+    */
+    if((spPkt[0] == MDC_INIT || spPkt[0] == MDC_CHANGE) && nLen > 1)
+    {
+        spChan->cServiceType = spPkt[1];
+        if(spPkt[0] == MDC_INIT)
+        {
+            LZW_ResetCtx(spChan->spCtx[0]);
+            LZW_ResetCtx(spChan->spCtx[1]);
+        }
+    }
+
+    /* File the packet under its service, holding back some to test with.
+    */
+    if(spChan->cServiceType != '\0')
+    {
+        if((spSrv=DICT.spService[spChan->cServiceType]) == NULL &&
+           (spSrv=DICT.spService[spChan->cServiceType]=
+                  (DICT_SERVICE *)calloc(1, sizeof(DICT_SERVICE))) == NULL)
+        {
+            sprintf(szErrMsg, "Couldnt create service (%c)",
+                    spChan->cServiceType);
+            free(spPkt);
+            return(R_FAIL);
+        }
+        if(_DICT_AddSample(++spSrv->nPackets % DICT_HOLDOUT == 0 ?
+                           &spSrv->sTest : &spSrv->sTrain, spPkt, nLen) == R_FAIL)
+        {
+            sprintf(szErrMsg, "Couldnt store sample of (%d) bytes", nLen);
+            free(spPkt);
+            return(R_FAIL);
+        }
+    }
+    free(spPkt);
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    DICTLoad
+ * Description: Read every frame of the capture file, in both directions.
+ * 
+ * Returns:     R_OK    - Capture read.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    DICTLoad( UCHAR    *szErrMsg )    /* O: Generated error message */
+{
+    /* Local variables.
+    */
+    int             nReturn = R_OK;
+    UINT            nChanId;
+    UINT            nDataLen;
+    UINT            nBufSize = 0;
+    UCHAR           szHdr[SLCAP_RECHDRLEN];
+    UCHAR           *spBuf = NULL;
+    UCHAR           *spNew;
+    FILE            *fp;
+
+    /* Open and validate the capture file.
+    */
+    if((fp=fopen(DICT.szCapFile, "rb")) == NULL)
+    {
+        sprintf(szErrMsg, "Cannot open capture file (%s)", DICT.szCapFile);
+        return(R_FAIL);
+    }
+    if(fread(szHdr, SLCAP_HDRLEN, 1, fp) != 1 ||
+       memcmp(szHdr, SLCAP_MAGIC, strlen(SLCAP_MAGIC)) != 0 ||
+       szHdr[strlen(SLCAP_MAGIC)] != SLCAP_VERSION)
+    {
+        sprintf(szErrMsg, "Not a version %d capture file (%s)",
+                SLCAP_VERSION, DICT.szCapFile);
+        fclose(fp);
+        return(R_FAIL);
+    }
+
+    /* Take each frame in turn, through one buffer grown as needed.
+    */
+    while(nReturn == R_OK && fread(szHdr, SLCAP_RECHDRLEN, 1, fp) == 1)
+    {
+        nChanId  = (UINT)GetLongFromChar(&szHdr[8]);
+        nDataLen = (UINT)GetLongFromChar(&szHdr[13]);
+        if(nDataLen > nBufSize)
+        {
+            if((spNew=(UCHAR *)realloc(spBuf, nDataLen)) == NULL)
+            {
+                sprintf(szErrMsg, "Couldnt malloc (%d) bytes", nDataLen);
+                nReturn = R_FAIL;
+                break;
+            }
+            spBuf = spNew;
+            nBufSize = nDataLen;
+        }
+        if(nDataLen > 0 && fread(spBuf, nDataLen, 1, fp) != 1)
+            break;
+        if(nDataLen > 0)
+            nReturn = DICTFrame(nChanId, szHdr[12], spBuf, nDataLen, szErrMsg);
+    }
+    if(spBuf != NULL)
+        free(spBuf);
+    fclose(fp);
+
+    /* Finished, get out!
+    */
+    return(nReturn);
+}
+
+/******************************************************************************
+ * Function:    _DICT_CompareScore
+ * Description: qsort comparator putting segments in rising score order.
+ * 
+ * Returns:     <0, 0, >0 as per qsort.
+ ******************************************************************************/
+int    _DICT_CompareScore( const void    *spA,    /* I: First segment */
+                           const void    *spB )   /* I: Second segment */
+{
+    if(((DICT_SEGMENT *)spA)->lScore < ((DICT_SEGMENT *)spB)->lScore) return(-1);
+    if(((DICT_SEGMENT *)spA)->lScore > ((DICT_SEGMENT *)spB)->lScore) return(1);
+    return(0);
+}
+
+/******************************************************************************
+ * Function:    DICTBuild
+ * Description: Build a dictionary from a set of samples. Every string of
+ *              DICT_KMER bytes is counted once for each packet it appears
+ *              in. The samples are then cut into as many stretches as the
+ *              dictionary has segments, and from each stretch the segment
+ *              whose strings have the highest count is chosen, the counts
+ *              of its strings being cleared so that later stretches dont
+ *              choose the same content again. Samples smaller than the
+ *              dictionary are used whole.
+ * 
+ * Returns:     R_OK    - Dictionary built, nDictLen set.
+ *              R_FAIL  - Memory exhausted.
+ ******************************************************************************/
+int    DICTBuild( DICT_SAMPLES    *spSet,      /* I: Samples to build from */
+                  UCHAR           *spDict,     /* O: Dictionary */
+                  UINT            *nDictLen )  /* O: Length of dictionary */
+{
+    /* Local variables.
+    */
+    UINT            nPos;
+    UINT            nEnd;
+    UINT            nSmp;
+    UINT            nK;
+    UINT            nEpoch;
+    UINT            nEpochLen;
+    UINT            nEpochEnd;
+    UINT            nSegs;
+    UINT            nChosen = 0;
+    UINT            nBest;
+    ULNG            lScore;
+    ULNG            lBest;
+    UINT            *nCount = NULL;
+    UINT            *nSeen = NULL;
+    UINT            *nHash = NULL;
+    DICT_SEGMENT    *spSeg = NULL;
+
+    /* Few samples, take them all.
+    */
+    if(spSet->nLen <= DICT.nDictSize)
+    {
+        memcpy(spDict, spSet->spData, spSet->nLen);
+        *nDictLen = spSet->nLen;
+        return(R_OK);
+    }
+
+    nSegs = DICT.nDictSize / DICT_SEGLEN;
+    if((nCount=(UINT *)calloc(1 << DICT_HASHBITS, sizeof(UINT))) == NULL ||
+       (nSeen=(UINT *)calloc(1 << DICT_HASHBITS, sizeof(UINT))) == NULL ||
+       (nHash=(UINT *)malloc(sizeof(UINT) * spSet->nLen)) == NULL ||
+       (spSeg=(DICT_SEGMENT *)malloc(sizeof(DICT_SEGMENT) * nSegs)) == NULL)
+    {
+        if(nCount != NULL) free(nCount);
+        if(nSeen != NULL) free(nSeen);
+        if(nHash != NULL) free(nHash);
+        return(R_FAIL);
+    }
+
+    /* Count the packets each string appears in.
+    */
+    for(nSmp=0; nSmp < spSet->nCnt; nSmp++)
+    {
+        nEnd = spSet->nOff[nSmp+1];
+        for(nPos=spSet->nOff[nSmp]; nPos + DICT_KMER <= nEnd; nPos++)
+        {
+            nHash[nPos] = DICT_HASH(spSet->spData + nPos);
+            if(nSeen[nHash[nPos]] != nSmp + 1)
+            {
+                nSeen[nHash[nPos]] = nSmp + 1;
+                nCount[nHash[nPos]]++;
+            }
+        }
+    }
+
+    /* Choose the best segment of each stretch. A segment lies within one
+     * sample, its score slides along with it.
+    */
+    nEpochLen = spSet->nLen / nSegs;
+    for(nEpoch=0, nSmp=0; nEpoch < nSegs; nEpoch++)
+    {
+        nPos = nEpoch * nEpochLen;
+        nEpochEnd = nEpoch == nSegs - 1 ? spSet->nLen : nPos + nEpochLen;
+        lBest = 0L;
+        nBest = 0;
+        while(nPos < nEpochEnd)
+        {
+            while(spSet->nOff[nSmp+1] <= nPos)
+                nSmp++;
+            nEnd = spSet->nOff[nSmp+1];
+            if(nPos + DICT_SEGLEN > nEnd)
+            {
+                nPos = nEnd;
+                continue;
+            }
+
+            for(lScore=0L, nK=0; nK + DICT_KMER <= DICT_SEGLEN; nK++)
+                lScore += nCount[nHash[nPos + nK]];
+            for(;;)
+            {
+                if(lScore > lBest)
+                {
+                    lBest = lScore;
+                    nBest = nPos;
+                }
+                if(nPos + 1 >= nEpochEnd || nPos + 1 + DICT_SEGLEN > nEnd)
+                    break;
+                lScore += nCount[nHash[nPos + DICT_SEGLEN - DICT_KMER + 1]];
+                lScore -= nCount[nHash[nPos]];
+                nPos++;
+            }
+            nPos++;
+        }
+
+        /* Keep the winner and clear its strings.
+        */
+        if(lBest > 0L)
+        {
+            spSeg[nChosen].nPos = nBest;
+            spSeg[nChosen++].lScore = lBest;
+            for(nPos=nBest; nPos + DICT_KMER <= nBest + DICT_SEGLEN; nPos++)
+                nCount[nHash[nPos]] = 0;
+        }
+    }
+
+    /* Best segments go last, nearest the packets and the last to go if a
+     * dictionary is cut down.
+    */
+    qsort(spSeg, nChosen, sizeof(DICT_SEGMENT), _DICT_CompareScore);
+    for(nPos=0, *nDictLen=0; nPos < nChosen; nPos++)
+    {
+        memcpy(spDict + *nDictLen, spSet->spData + spSeg[nPos].nPos,
+               DICT_SEGLEN);
+        *nDictLen += DICT_SEGLEN;
+    }
+
+    free(nCount);
+    free(nSeen);
+    free(nHash);
+    free(spSeg);
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    DICTMeasure
+ * Description: Compress the packets held back from a dictionary one at a
+ *              time, as separate messages, without and with it, and report
+ *              the difference.
+ * 
+ * Returns:     Non.
+ ******************************************************************************/
+void    DICTMeasure( UCHAR           cServiceType, /* I: Service type */
+                     DICT_SAMPLES    *spSet,       /* I: Packets held back */
+                     UCHAR           *spDict,      /* I: Dictionary */
+                     UINT            nDictLen )    /* I: Length of dictionary */
+{
+    /* Local variables.
+    */
+    UINT        nSmp;
+    UINT        nLen;
+    UINT        nUse;
+    ULNG        lOut[2];
+    UCHAR       *spIn;
+    UCHAR       *spOut;
+    LZW_CTX     *spCtx[2];
+
+    if(spSet->nCnt == 0 ||
+       LZW_LoadDict((UINT)cServiceType, spDict, nDictLen) == R_FAIL ||
+       (spCtx[0]=LZW_CreateCtx()) == NULL)
+    {
+        printf("%c: Nothing to measure with\n", cServiceType);
+        return;
+    }
+    if((spCtx[1]=LZW_CreateCtx()) == NULL)
+    {
+        LZW_FreeCtx(spCtx[0]);
+        return;
+    }
+    LZW_SetCodec(spCtx[0], CMP_FLZ);
+    LZW_SetCodec(spCtx[1], CMP_FLZ);
+    LZW_SetDict(spCtx[1], (UINT)cServiceType);
+
+    for(nSmp=0, lOut[0]=lOut[1]=0L; nSmp < spSet->nCnt; nSmp++)
+    {
+        spIn = spSet->spData + spSet->nOff[nSmp];
+        for(nUse=0; nUse < 2; nUse++)
+        {
+            nLen = spSet->nOff[nSmp+1] - spSet->nOff[nSmp];
+            if((spOut=CompressCtx(spCtx[nUse], spIn, &nLen)) != spIn &&
+               spOut != NULL)
+                free(spOut);
+            lOut[nUse] += nLen;
+        }
+    }
+    printf("%c: %u test packets, %u bytes, to %lu bytes alone, %lu with "
+           "the dictionary (%.1f%%)\n", cServiceType, spSet->nCnt, spSet->nLen,
+           lOut[0], lOut[1], lOut[1] * 100.0 / spSet->nLen);
+
+    LZW_FreeCtx(spCtx[0]);
+    LZW_FreeCtx(spCtx[1]);
+    LZW_FreeDict((UINT)cServiceType);
+}
+
+/******************************************************************************
+ * Function:    main
+ * Description: Entry point into the dictionary builder. Load the capture,
+ *              build, write and measure a dictionary for each service.
+ * 
+ * Returns:     0     - Program completed successfully without errors.
+ *              -1    - Program terminated with errors.
+ ******************************************************************************/
+int    main( int     argc,       /* I: Count of available arguments */
+             char    **argv,     /* I: Array of arguments */
+             char    **envp )    /* I: Array of environment parameters */
+{
+    /* Local variables.
+    */
+    UINT            nSrv;
+    UINT            nDictLen;
+    UINT            nBuilt = 0;
+    UCHAR           *spDict;
+    FILE            *fp;
+    DICT_SERVICE    *spSrv;
+    UCHAR           szFile[MAX_LOGFILELEN + 8];
+    UCHAR           szErrMsg[MAX_ERRMSG_LEN];
+
+    /* Bring in any configuration parameters passed on the command line etc.
+    */
+    if( GetConfig(argc, (UCHAR **)argv, envp, szErrMsg) == R_FAIL )
+    {
+        printf( "%s\n"
+                "Usage:                 %s <parameters>\n"
+                "<parameters>:          -f<Capture File Name>\n"
+                "                       -o<Output Directory>\n"
+                "                       -s<Dictionary size>\n",
+                szErrMsg, argv[0]);
+        exit(-1);
+    }
+
+    /* Sort the captured packets by service.
+    */
+    if( DICTLoad(szErrMsg) == R_FAIL ||
+        (spDict=(UCHAR *)malloc(DICT.nDictSize)) == NULL )
+    {
+        printf("%s: %s\n", argv[0], szErrMsg);
+        exit(-1);
+    }
+    printf("%lu frames read, %lu couldnt be expanded\n\n", DICT.lFrames,
+           DICT.lBadFrames);
+
+    /* One dictionary per service seen.
+    */
+    for(nSrv=1; nSrv < MAX_SERVICES; nSrv++)
+    {
+        if((spSrv=DICT.spService[nSrv]) == NULL || spSrv->sTrain.nLen == 0)
+            continue;
+        if(DICTBuild(&spSrv->sTrain, spDict, &nDictLen) == R_FAIL)
+        {
+            printf("%s: Couldnt build dictionary for (%c)\n", argv[0], nSrv);
+            exit(-1);
+        }
+        sprintf(szFile, DICT_FILEFMT, DICT.szOutDir, nSrv);
+        if((fp=fopen(szFile, "wb")) == NULL ||
+           fwrite(spDict, 1, nDictLen, fp) != nDictLen)
+        {
+            printf("%s: Couldnt write (%s)\n", argv[0], szFile);
+            exit(-1);
+        }
+        fclose(fp);
+        printf("%c: %u packets, %u bytes sampled, %u byte dictionary in %s\n",
+               nSrv, spSrv->nPackets, spSrv->sTrain.nLen, nDictLen, szFile);
+        DICTMeasure((UCHAR)nSrv, &spSrv->sTest, spDict, nDictLen);
+        nBuilt++;
+    }
+    if(nBuilt == 0)
+        printf("No service requests in capture file (%s)\n", DICT.szCapFile);
+    free(spDict);
+
+    /* All done, go bye bye's.
+    */
+    return(0);
+}
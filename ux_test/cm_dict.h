@@ -0,0 +1,134 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          cm_dict.h
+ * Description:   Header file for declaration of structures, datatypes etc for
+ *                the shared compression dictionary builder.
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D.Smart, 1996-2019.
+ *
+ * History:       1.0 - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    CM_DICT_H
+#define    CM_DICT_H
+
+/* Definitions for maxims etc.
+*/
+#define    MAX_ERRMSG_LEN        256
+#define    MAX_LOGFILELEN        256
+#define    MAX_SERVICES          256     /* One per service type byte */
+
+/* Definitions for defaults.
+*/
+#define    DEF_DICTSIZE          16384   /* Bytes in each dictionary */
+#define    DEF_OUTDIR            "."
+#define    DEF_MAXSAMPLES        (4 * 1024 * 1024) /* Sample bytes/service */
+
+/* Define constants etc. Only the start of each packet is sampled, later
+ * bytes find their matches within the packet itself. Every DICT_HOLDOUT
+ * packet is kept back to measure the dictionary on.
+*/
+#define    DICT_SAMPLELEN        1024    /* Bytes sampled from each packet */
+#define    DICT_KMER             8       /* Bytes in the strings counted */
+#define    DICT_SEGLEN           32      /* Bytes in each piece chosen */
+#define    DICT_HASHBITS         20      /* Bits of the string count table */
+#define    DICT_HOLDOUT          10      /* 1 in n packets tested, not used */
+#define    DICT_FILEFMT          "%s/%c.dct" /* As vdwd -d expects */
+
+/* Define command line flags.
+*/
+#define    FLG_CAPFILE           "-f"
+#define    FLG_OUTDIR            "-o"
+#define    FLG_DICTSIZE          "-s"
+
+/* A set of packets sampled, held end to end.
+*/
+typedef struct {
+    UCHAR          *spData;              /* Packets */
+    UINT           nLen;                 /* Bytes held */
+    UINT           nSize;                /* Size of spData */
+    UINT           *nOff;                /* Start of each packet, and end */
+    UINT           nCnt;                 /* Packets held */
+    UINT           nOffSize;             /* Entries in nOff */
+} DICT_SAMPLES;
+
+/* The packets of one type of service.
+*/
+typedef struct {
+    UINT           nPackets;             /* Packets seen */
+    DICT_SAMPLES   sTrain;               /* Packets the dictionary is built on */
+    DICT_SAMPLES   sTest;                /* Packets held back to measure it */
+} DICT_SERVICE;
+
+/* A captured channel, one stream context for each direction.
+*/
+typedef struct {
+    UINT           nChanId;              /* Channel Id at capture time */
+    UCHAR          cServiceType;         /* Service requested, 0 until known */
+    LZW_CTX        *spCtx[2];            /* Received and sent streams */
+} DICT_CHANNEL;
+
+/* A piece of sample chosen for a dictionary.
+*/
+typedef struct {
+    UINT           nPos;                 /* Start in the training samples */
+    ULNG           lScore;               /* Packets its strings appeared in */
+} DICT_SEGMENT;
+
+/* Globals (yuggghhh!).
+*/
+typedef struct {
+    UINT           nDictSize;
+    UCHAR          szCapFile[MAX_LOGFILELEN];
+    UCHAR          szOutDir[MAX_LOGFILELEN];
+    LINKLIST       *spChanHead;          /* Captured channels */
+    LINKLIST       *spChanTail;
+    DICT_SERVICE   *spService[MAX_SERVICES];
+    ULNG           lFrames;              /* Frames read */
+    ULNG           lBadFrames;           /* Frames which couldnt be expanded */
+} DICT_GLOBALS;
+
+/* Declare any globals required by the program, or any specifics to the
+ * C module.
+*/
+#if defined(CM_DICT_C)
+    static    DICT_GLOBALS    DICT;
+#endif
+
+/* Prototypes for functions.
+*/
+int        GetConfig( int, UCHAR **, char **, UCHAR * );
+int        _DICT_AddSample( DICT_SAMPLES *, UCHAR *, UINT );
+int        DICTFrame( UINT, UCHAR, UCHAR *, UINT, UCHAR * );
+int        DICTLoad( UCHAR * );
+int        _DICT_CompareScore( const void *, const void * );
+int        DICTBuild( DICT_SAMPLES *, UCHAR *, UINT * );
+void       DICTMeasure( UCHAR, DICT_SAMPLES *, UCHAR *, UINT );
+int        main( int, char **, char ** );
+
+#endif    /* CM_DICT_H */
@@ -0,0 +1,318 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          lg_stress.c
+ * Description:   A Test Harness program to stress the asynchronous logger.
+ *                More threads than a writer pass gathers into one write
+ *                each log a line, then many lines, and the log file is read
+ *                back to check that every line arrived once and in order.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1996-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Bring in system header files.
+*/
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <ctype.h>
+#include    <stdarg.h>
+#include    <string.h>
+
+/* Bring in UX header files.
+*/
+#include    <ux.h>
+
+/* Specials for Solaris.
+*/
+#if defined(SOLARIS) || defined(LINUX) || defined(ZPU)
+#include    <sys/types.h>
+#include    <pthread.h>
+#endif
+
+/* Indicate that we are a C module for any header specifics.
+*/
+#define     LG_STRESS_C
+
+/* Bring in local specific header files.
+*/
+#include    "lg_stress.h"
+
+/******************************************************************************
+ * Function:    GetConfig
+ * Description: Get configuration information from the OS or command line
+ *              flags.
+ * 
+ * Returns:     R_OK    - Configuration obtained.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    GetConfig( int      argc,          /* I: CLI argument count */
+                  UCHAR    **argv,        /* I: CLI argument contents */
+                  char     **envp,        /* I: Environment variables */
+                  UCHAR    *szErrMsg )    /* O: Any generated error message */
+{
+    /* Setup defaults.
+    */
+    LGS.nThreads = DEF_THREADS;
+    LGS.nLines = DEF_LINES;
+    strcpy(LGS.szLogFile, DEF_LOGFILE);
+
+    /* Optional parameters.
+    */
+    GetCLIParam(argc, argv, FLG_THREADS, T_INT, (UCHAR *)&LGS.nThreads, 0, 0);
+    GetCLIParam(argc, argv, FLG_LINES, T_INT, (UCHAR *)&LGS.nLines, 0, 0);
+    GetCLIParam(argc, argv, FLG_LOGFILE, T_STR, LGS.szLogFile,
+                MAX_ERRMSG_LEN, FALSE);
+    if(LGS.nThreads == 0 || LGS.nThreads > MAX_THREADS || LGS.nLines == 0)
+    {
+        sprintf(szErrMsg, "Threads must be 1..%d and lines non zero",
+                MAX_THREADS);
+        return(R_FAIL);
+    }
+
+    /* Finished, get out!
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    LGSWorker
+ * Description: Body of each logging thread. Wait for the gate to open so
+ *              that all threads log together, then log the lines asked for.
+ * 
+ * Returns:     NULL.
+ ******************************************************************************/
+void    *LGSWorker( void    *spArg )    /* I: LGS_WORKER of thread */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    LGS_WORKER  *spWorker = (LGS_WORKER *)spArg;
+
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    pthread_mutex_lock(&LGS.sLock);
+    while(LGS.nGo == FALSE)
+        pthread_cond_wait(&LGS.sGo, &LGS.sLock);
+    pthread_mutex_unlock(&LGS.sLock);
+#endif
+
+    for(nNdx=0; nNdx < spWorker->nLines; nNdx++)
+    {
+        Lgr(LOG_MESSAGE, "LGSWorker", "Pass %u thread %u line %u",
+            spWorker->nPass, spWorker->nThread, nNdx);
+    }
+    return(NULL);
+}
+
+/******************************************************************************
+ * Function:    LGSRun
+ * Description: Run a pass of all the threads, each logging the given number
+ *              of lines, and wait for the lines to reach the log file.
+ * 
+ * Returns:     R_OK    - Pass run.
+ *              R_FAIL  - Couldnt start a thread.
+ ******************************************************************************/
+int    LGSRun( UINT    nPass,     /* I: Number of pass */
+               UINT    nLines )   /* I: Lines logged by each thread */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    UINT        nStarted;
+    pthread_t   sThread[MAX_THREADS];
+#endif
+
+    for(nNdx=0; nNdx < LGS.nThreads; nNdx++)
+    {
+        LGS.sWorker[nNdx].nThread = nNdx;
+        LGS.sWorker[nNdx].nPass = nPass;
+        LGS.sWorker[nNdx].nLines = nLines;
+    }
+
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    /* Hold the threads at the gate until all exist, so their rings all
+     * fill before the writer next passes.
+    */
+    LGS.nGo = FALSE;
+    for(nStarted=0; nStarted < LGS.nThreads; nStarted++)
+    {
+        if(pthread_create(&sThread[nStarted], NULL, LGSWorker,
+                          &LGS.sWorker[nStarted]) != 0)
+            break;
+    }
+    pthread_mutex_lock(&LGS.sLock);
+    LGS.nGo = TRUE;
+    pthread_cond_broadcast(&LGS.sGo);
+    pthread_mutex_unlock(&LGS.sLock);
+    for(nNdx=0; nNdx < nStarted; nNdx++)
+        pthread_join(sThread[nNdx], NULL);
+    if(nStarted < LGS.nThreads)
+        return(R_FAIL);
+#else
+    /* No threads here, run the workers one after the other.
+    */
+    for(nNdx=0; nNdx < LGS.nThreads; nNdx++)
+        LGSWorker(&LGS.sWorker[nNdx]);
+#endif
+    LgrFlush();
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    LGSCheck
+ * Description: Read back the log file and check that every thread logged
+ *              each of its lines for the pass once, in the order logged.
+ * 
+ * Returns:     R_OK    - All lines present and in order.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    LGSCheck( UINT     nPass,       /* I: Number of pass */
+                 UINT     nLines,      /* I: Lines logged by each thread */
+                 UCHAR    *szErrMsg )  /* O: Any generated error message */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    UINT        nLinePass;
+    UINT        nThread;
+    UINT        nLine;
+    UCHAR       *spPos;
+    UCHAR       szLine[MAX_ERRMSG_LEN];
+    FILE        *spFile;
+
+    if((spFile=fopen(LGS.szLogFile, "r")) == NULL)
+    {
+        sprintf(szErrMsg, "Couldnt open log file (%s)", LGS.szLogFile);
+        return(R_FAIL);
+    }
+    for(nNdx=0; nNdx < LGS.nThreads; nNdx++)
+        LGS.nNext[nNdx] = 0;
+
+    while(fgets(szLine, MAX_ERRMSG_LEN, spFile) != NULL)
+    {
+        if((spPos=strstr(szLine, "] Pass ")) == NULL ||
+           sscanf(spPos, "] Pass %u thread %u line %u", &nLinePass, &nThread,
+                  &nLine) != 3 || nLinePass != nPass)
+            continue;
+        if(nThread >= LGS.nThreads || nLine != LGS.nNext[nThread])
+        {
+            sprintf(szErrMsg, "Pass %u thread %u line %u out of order, "
+                    "expected line %u", nPass, nThread, nLine,
+                    nThread < LGS.nThreads ? LGS.nNext[nThread] : 0);
+            fclose(spFile);
+            return(R_FAIL);
+        }
+        LGS.nNext[nThread]++;
+    }
+    fclose(spFile);
+
+    for(nNdx=0; nNdx < LGS.nThreads; nNdx++)
+    {
+        if(LGS.nNext[nNdx] != nLines)
+        {
+            sprintf(szErrMsg, "Pass %u thread %u wrote %u of %u lines",
+                    nPass, nNdx, LGS.nNext[nNdx], nLines);
+            return(R_FAIL);
+        }
+    }
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    main
+ * Description: Entry point into the stress program. Log a single line from
+ *              each thread, so a writer pass finds as many rings as
+ *              threads, then many lines from each, checking the log file
+ *              after each pass.
+ * 
+ * Returns:     0     - Program completed successfully without errors.
+ *              -1    - Program terminated with errors.
+ ******************************************************************************/
+int    main( int     argc,       /* I: Count of available arguments */
+             char    **argv,     /* I: Array of arguments */
+             char    **envp )    /* I: Array of environment parameters */
+{
+    /* Local variables.
+    */
+    UINT            nPass;
+    UINT            nLines;
+    UCHAR           szErrMsg[MAX_ERRMSG_LEN];
+
+    /* Bring in any configuration parameters passed on the command line etc.
+    */
+    if( GetConfig(argc, (UCHAR **)argv, envp, szErrMsg) == R_FAIL )
+    {
+        printf( "%s\n"
+                "Usage:                 %s <parameters>\n"
+                "<parameters>:          -t<Threads>\n"
+                "                       -n<Lines per thread>\n"
+                "                       -f<Log file>\n",
+                szErrMsg, argv[0]);
+        exit(-1);
+    }
+
+    /* Start from an empty log, logging asynchronously and waiting for room
+     * rather than dropping lines.
+    */
+    remove(LGS.szLogFile);
+    Lgr(LOG_CONFIG, LGM_FLATFILE, LOG_DEBUG, LGS.szLogFile);
+    if(LgrStart(0, LGR_BLOCK) == R_FAIL)
+    {
+        printf("%s: Couldnt start asynchronous logging, Errno=%d\n", argv[0],
+               Errno);
+        exit(-1);
+    }
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    pthread_mutex_init(&LGS.sLock, NULL);
+    pthread_cond_init(&LGS.sGo, NULL);
+#endif
+
+    printf("%u threads logging to %s\n\n", LGS.nThreads, LGS.szLogFile);
+    printf("%-6s %16s %8s\n", "Pass", "Lines per thread", "Result");
+    for(nPass=1; nPass <= 2; nPass++)
+    {
+        nLines = (nPass == 1 ? 1 : LGS.nLines);
+        if(LGSRun(nPass, nLines) == R_FAIL)
+        {
+            printf("%s: Couldnt start (%u) threads\n", argv[0], LGS.nThreads);
+            exit(-1);
+        }
+        if(LGSCheck(nPass, nLines, szErrMsg) == R_FAIL)
+        {
+            printf("%-6u %16u %8s\n%s: %s\n", nPass, nLines, "FAILED",
+                   argv[0], szErrMsg);
+            exit(-1);
+        }
+        printf("%-6u %16u %8s\n", nPass, nLines, "OK");
+    }
+    LgrStop();
+
+    /* All done, go bye bye's.
+    */
+    return(0);
+}
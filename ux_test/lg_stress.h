@@ -0,0 +1,95 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          lg_stress.h
+ * Description:   Header file for declaration of structures, datatypes etc for
+ *                the multi-threaded logger stress program.
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D.Smart, 1996-2019.
+ *
+ * History:       1.0 - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    LG_STRESS_H
+#define    LG_STRESS_H
+
+/* Definitions for maxims etc.
+*/
+#define    MAX_ERRMSG_LEN        256
+#define    MAX_THREADS           256
+
+/* Definitions for defaults.
+*/
+#define    DEF_THREADS           48      /* Threads logging at once */
+#define    DEF_LINES             200     /* Lines per thread, second pass */
+#define    DEF_LOGFILE           "lg_stress.log"
+
+/* Define command line flags.
+*/
+#define    FLG_THREADS           "-t"
+#define    FLG_LINES             "-n"
+#define    FLG_LOGFILE           "-f"
+
+/* Work given to each thread.
+*/
+typedef struct {
+    UINT           nThread;              /* Number of thread, from 0 */
+    UINT           nPass;                /* Pass being run */
+    UINT           nLines;               /* Lines to log */
+} LGS_WORKER;
+
+/* Globals (yuggghhh!).
+*/
+typedef struct {
+    UINT           nThreads;
+    UINT           nLines;
+    UCHAR          szLogFile[MAX_ERRMSG_LEN];
+    UINT           nNext[MAX_THREADS];   /* Next line expected of thread */
+    LGS_WORKER     sWorker[MAX_THREADS];
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    pthread_mutex_t sLock;               /* Guards the start gate */
+    pthread_cond_t  sGo;                 /* Gate opened */
+    UINT           nGo;                  /* Threads may start logging */
+#endif
+} LGS_GLOBALS;
+
+/* Declare any globals required by the program, or any specifics to the
+ * C module.
+*/
+#if defined(LG_STRESS_C)
+    static    LGS_GLOBALS    LGS;
+#endif
+
+/* Prototypes for functions.
+*/
+int        GetConfig( int, UCHAR **, char **, UCHAR * );
+void       *LGSWorker( void * );
+int        LGSRun( UINT, UINT );
+int        LGSCheck( UINT, UINT, UCHAR * );
+int        main( int, char **, char ** );
+
+#endif    /* LG_STRESS_H */
@@ -0,0 +1,264 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          ll_bench.c
+ * Description:   A Test Harness program to benchmark the linked list element
+ *                allocator. A FIFO of list elements is churned, one addition
+ *                and one deletion per iteration as the MDC and comms queues
+ *                do, with elements allocated from slabs and then singly from
+ *                the system, for each style of key.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1996-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Bring in system header files.
+*/
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <ctype.h>
+#include    <stdarg.h>
+#include    <string.h>
+
+/* Bring in UX header files.
+*/
+#include    <ux.h>
+
+/* Specials for Solaris.
+*/
+#if defined(SOLARIS) || defined(LINUX) || defined(ZPU)
+#include    <sys/types.h>
+#include    <sys/time.h>
+#endif
+#if defined(_WIN32)
+#include    <sys/timeb.h>
+#endif
+
+/* Indicate that we are a C module for any header specifics.
+*/
+#define     LL_BENCH_C
+
+/* Bring in local specific header files.
+*/
+#include    "ll_bench.h"
+
+/******************************************************************************
+ * Function:    _BNCH_GetTimeUs
+ * Description: Get the current time in microseconds.
+ * 
+ * Returns:     Current time in uS.
+ ******************************************************************************/
+ULNG    _BNCH_GetTimeUs( void )
+{
+    /* Local variables.
+    */
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    struct timeval  sTv;
+
+    gettimeofday(&sTv, NULL);
+    return((ULNG)sTv.tv_sec * 1000000L + (ULNG)sTv.tv_usec);
+#endif
+#if defined(_WIN32)
+    struct timeb    sTp;
+
+    ftime(&sTp);
+    return((ULNG)sTp.time * 1000000L + (ULNG)sTp.millitm * 1000L);
+#endif
+}
+
+/******************************************************************************
+ * Function:    GetConfig
+ * Description: Get configuration information from the OS or command line
+ *              flags.
+ * 
+ * Returns:     R_OK    - Configuration obtained.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    GetConfig( int      argc,          /* I: CLI argument count */
+                  UCHAR    **argv,        /* I: CLI argument contents */
+                  char     **envp,        /* I: Environment variables */
+                  UCHAR    *szErrMsg )    /* O: Any generated error message */
+{
+    /* Setup defaults.
+    */
+    BNCH.nIterations = DEF_ITERATIONS;
+    BNCH.nDepth = DEF_DEPTH;
+
+    /* Optional parameters.
+    */
+    GetCLIParam(argc, argv, FLG_ITERATIONS, T_INT, (UCHAR *)&BNCH.nIterations,
+                0, 0);
+    GetCLIParam(argc, argv, FLG_DEPTH, T_INT, (UCHAR *)&BNCH.nDepth, 0, 0);
+    if(BNCH.nIterations == 0 || BNCH.nDepth == 0)
+    {
+        sprintf(szErrMsg, "Iterations and depth must be non zero");
+        return(R_FAIL);
+    }
+
+    /* Finished, get out!
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    BNCHRun
+ * Description: Churn the FIFO with the given allocator and key style. The
+ *              oldest element is deleted and a new one added at the tail on
+ *              each iteration.
+ * 
+ * Returns:     Iterations per second, or 0 on failure.
+ ******************************************************************************/
+double    BNCHRun( UINT    nAlloc,     /* I: LLA_SLAB or LLA_MALLOC */
+                   UINT    nStyle )    /* I: Style of key, BNCH_KEY... */
+{
+    /* Local variables.
+    */
+    UINT        nNdx;
+    UINT        nSlot;
+    ULNG        lStartUs;
+    ULNG        lElapsedUs;
+    UCHAR       **spKeys;
+    UCHAR       szKey[MAX_ERRMSG_LEN];
+
+    if(SetListAlloc(nAlloc) == R_FAIL)
+        return(0.0);
+
+    /* Keys are built up front so only list handling is timed.
+    */
+    if((spKeys=(UCHAR **)malloc(sizeof(UCHAR *) * BNCH.nDepth)) == NULL)
+        return(0.0);
+    for(nNdx=0; nNdx < BNCH.nDepth; nNdx++)
+    {
+        if(nStyle == BNCH_KEYSHORT)
+            sprintf(szKey, "CH%06u", nNdx);
+        else
+            sprintf(szKey, "CHANNEL-STATUS-RECORD-%010u", nNdx);
+        spKeys[nNdx] = (UCHAR *)strdup(szKey);
+    }
+
+    /* Fill the FIFO.
+    */
+    BNCH.spHead = BNCH.spTail = NULL;
+    for(nNdx=0; nNdx < BNCH.nDepth; nNdx++)
+    {
+        AddItem(&BNCH.spHead, &BNCH.spTail, SORT_NONE, &nNdx, NULL,
+                (nStyle == BNCH_KEYINT ? NULL : spKeys[nNdx]),
+                &BNCH.spData[nNdx]);
+    }
+
+    /* Churn.
+    */
+    lStartUs = _BNCH_GetTimeUs();
+    for(nNdx=0; nNdx < BNCH.nIterations; nNdx++)
+    {
+        nSlot = nNdx % BNCH.nDepth;
+        DelItem(&BNCH.spHead, &BNCH.spTail, &BNCH.spData[nSlot], NULL, NULL,
+                NULL);
+        AddItem(&BNCH.spHead, &BNCH.spTail, SORT_NONE, &nNdx, NULL,
+                (nStyle == BNCH_KEYINT ? NULL : spKeys[nSlot]),
+                &BNCH.spData[nSlot]);
+    }
+    lElapsedUs = _BNCH_GetTimeUs() - lStartUs;
+
+    /* Drain, the carried data is not ours to free.
+    */
+    DelListWithFree(&BNCH.spHead, &BNCH.spTail, NULL);
+    for(nNdx=0; nNdx < BNCH.nDepth; nNdx++)
+        free(spKeys[nNdx]);
+    free(spKeys);
+
+    return((double)BNCH.nIterations * 1000000.0 /
+           (double)(lElapsedUs > 0 ? lElapsedUs : 1));
+}
+
+/******************************************************************************
+ * Function:    main
+ * Description: Entry point into the benchmark program. Run each key style
+ *              under each allocator and report.
+ * 
+ * Returns:     0     - Program completed successfully without errors.
+ *              -1    - Program terminated with errors.
+ ******************************************************************************/
+int    main( int     argc,       /* I: Count of available arguments */
+             char    **argv,     /* I: Array of arguments */
+             char    **envp )    /* I: Array of environment parameters */
+{
+    /* Local variables.
+    */
+    UINT            nStyle;
+    double          dMalloc;
+    double          dSlab;
+    UCHAR           szErrMsg[MAX_ERRMSG_LEN];
+    LISTALLOCSTATS  sStats;
+    static char     *szStyle[] = { "integer", "short string", "long string" };
+
+    /* Bring in any configuration parameters passed on the command line etc.
+    */
+    if( GetConfig(argc, (UCHAR **)argv, envp, szErrMsg) == R_FAIL )
+    {
+        printf( "%s\n"
+                "Usage:                 %s <parameters>\n"
+                "<parameters>:          -n<Iterations>\n"
+                "                       -q<FIFO depth>\n",
+                szErrMsg, argv[0]);
+        exit(-1);
+    }
+    if((BNCH.spData=(UINT *)malloc(sizeof(UINT) * BNCH.nDepth)) == NULL)
+    {
+        printf("%s: Couldnt allocate data\n", argv[0]);
+        exit(-1);
+    }
+
+    printf("FIFO depth %u, %u add/delete pairs per run\n\n",
+           BNCH.nDepth, BNCH.nIterations);
+    printf("%-14s %14s %14s %8s\n", "Key", "malloc pairs/s", "slab pairs/s",
+           "Gain");
+    for(nStyle=BNCH_KEYINT; nStyle <= BNCH_KEYLONG; nStyle++)
+    {
+        dMalloc = BNCHRun(LLA_MALLOC, nStyle);
+        dSlab = BNCHRun(LLA_SLAB, nStyle);
+        if(dMalloc == 0.0 || dSlab == 0.0)
+        {
+            printf("%s: Run failed, Errno=%d\n", argv[0], Errno);
+            exit(-1);
+        }
+        printf("%-14s %14.0f %14.0f %7.2fx\n", szStyle[nStyle], dMalloc,
+               dSlab, dSlab / dMalloc);
+    }
+
+    /* Allocator counters over all runs.
+    */
+    GetListAllocStats(&sStats);
+    printf("\nAllocator: allocs=%lu frees=%lu inuse=%lu free=%lu "
+           "slabs=%lu keys inline=%lu alloc=%lu\n",
+           sStats.lAllocs, sStats.lFrees, sStats.lInUse, sStats.lFree,
+           sStats.lSlabs, sStats.lKeysInline, sStats.lKeysAlloc);
+
+    /* All done, go bye bye's.
+    */
+    return(0);
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          ll_bench.h
+ * Description:   Header file for declaration of structures, datatypes etc for
+ *                the linked list allocator benchmark program.
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D.Smart, 1996-2019.
+ *
+ * History:       1.0 - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    LL_BENCH_H
+#define    LL_BENCH_H
+
+/* Definitions for maxims etc.
+*/
+#define    MAX_ERRMSG_LEN        256
+
+/* Definitions for defaults.
+*/
+#define    DEF_ITERATIONS        2000000 /* Add/delete pairs per run */
+#define    DEF_DEPTH             1000    /* Elements held in the FIFO */
+
+/* Define command line flags.
+*/
+#define    FLG_ITERATIONS        "-n"
+#define    FLG_DEPTH             "-q"
+
+/* Key styles exercised.
+*/
+#define    BNCH_KEYINT           0       /* Integer key only */
+#define    BNCH_KEYSHORT         1       /* String key held inline */
+#define    BNCH_KEYLONG          2       /* String key too long for inline */
+
+/* Globals (yuggghhh!).
+*/
+typedef struct {
+    UINT           nIterations;
+    UINT           nDepth;
+    LINKLIST       *spHead;
+    LINKLIST       *spTail;
+    UINT           *spData;              /* Carried data, one per element */
+} BNCH_GLOBALS;
+
+/* Declare any globals required by the program, or any specifics to the
+ * C module.
+*/
+#if defined(LL_BENCH_C)
+    static    BNCH_GLOBALS    BNCH;
+#endif
+
+/* Prototypes for functions.
+*/
+ULNG       _BNCH_GetTimeUs( void );
+int        GetConfig( int, UCHAR **, char **, UCHAR * );
+double     BNCHRun( UINT, UINT );
+int        main( int, char **, char ** );
+
+#endif    /* LL_BENCH_H */
@@ -0,0 +1,684 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          sl_replay.c
+ * Description:   A Test Harness program to replay traffic captured by the
+ *                socket library (SL_CaptureStart, vdwd -c) against a live
+ *                server, typically a local vdwd. Requests are replayed at
+ *                their original pace, a scaled pace or as fast as replies
+ *                allow, and the throughput and reply latency percentiles are
+ *                reported so changes can be benchmarked against real traffic.
+ *
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D. Smart, 1996-2019.
+ *
+ * History:       1.0  - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Bring in system header files.
+*/
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <ctype.h>
+#include    <stdarg.h>
+#include    <string.h>
+
+/* Bring in UX header files.
+*/
+#include    <ux.h>
+
+/* Specials for Solaris.
+*/
+#if defined(SOLARIS) || defined(LINUX) || defined(ZPU)
+#include    <sys/types.h>
+#include    <sys/time.h>
+#endif
+#if defined(_WIN32)
+#include    <sys/timeb.h>
+#endif
+
+/* Indicate that we are a C module for any header specifics.
+*/
+#define     SL_REPLAY_C
+
+/* Bring in local specific header files.
+*/
+#include    "sl_replay.h"
+
+/******************************************************************************
+ * Function:    _RPLY_GetTimeUs
+ * Description: Get the current time in microseconds.
+ * 
+ * Returns:     Current time in uS.
+ ******************************************************************************/
+ULNG    _RPLY_GetTimeUs( void )
+{
+    /* Local variables.
+    */
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+    struct timeval  sTv;
+
+    gettimeofday(&sTv, NULL);
+    return((ULNG)sTv.tv_sec * 1000000L + (ULNG)sTv.tv_usec);
+#endif
+#if defined(_WIN32)
+    struct timeb    sTp;
+
+    ftime(&sTp);
+    return((ULNG)sTp.time * 1000000L + (ULNG)sTp.millitm * 1000L);
+#endif
+}
+
+/******************************************************************************
+ * Function:    _RPLY_DataCB
+ * Description: Call back for data arriving on a replay connection. The first
+ *              data after a request is taken to be its reply and the
+ *              latency recorded.
+ * 
+ * Returns:     Non.
+ ******************************************************************************/
+void    _RPLY_DataCB( UINT     nChanId,    /* I: Channel data arrived on */
+                      UCHAR    *szData,    /* I: Data */
+                      UINT     nDataLen )  /* I: Length of data */
+{
+    /* Local variables.
+    */
+    LINKLIST        *spNext;
+    RPLY_CHANNEL    *spChan;
+
+    /* Locate the replay channel.
+    */
+    for(spChan=(RPLY_CHANNEL *)StartItem(RPLY.spChanHead, &spNext);
+        spChan != NULL && spChan->nChanId != nChanId;
+        spChan=(RPLY_CHANNEL *)NextItem(&spNext));
+    if(spChan == NULL)
+        return;
+
+    /* Account and record latency if this is a reply.
+    */
+    RPLY.lBytesRecv += nDataLen;
+    if(spChan->nPending == TRUE && RPLY.nLatCnt < RPLY.nRecCnt)
+    {
+        RPLY.lLatency[RPLY.nLatCnt++] = _RPLY_GetTimeUs() - spChan->lSentUs;
+    }
+    spChan->nPending = FALSE;
+}
+
+/******************************************************************************
+ * Function:    _RPLY_CntrlCB
+ * Description: Call back for connection events on replay connections.
+ * 
+ * Returns:     Non.
+ ******************************************************************************/
+void    _RPLY_CntrlCB( int    nType,    /* I: Type of callback */
+                       ... )            /* I: Varargs */
+{
+    /* Local variables.
+    */
+    UINT            nChanId;
+    va_list         pArgs;
+    LINKLIST        *spNext;
+    RPLY_CHANNEL    *spChan;
+    char            *szFunc = "_RPLY_CntrlCB";
+
+    /* All events carry the channel Id first.
+    */
+    va_start(pArgs, nType);
+    nChanId = va_arg(pArgs, UINT);
+    va_end(pArgs);
+
+    for(spChan=(RPLY_CHANNEL *)StartItem(RPLY.spChanHead, &spNext);
+        spChan != NULL && spChan->nChanId != nChanId;
+        spChan=(RPLY_CHANNEL *)NextItem(&spNext));
+    if(spChan == NULL)
+        return;
+
+    /* Track link state.
+    */
+    switch(nType)
+    {
+        case SLC_CONNECT:
+            spChan->nUp = TRUE;
+            break;
+
+        case SLC_LINKDOWN:
+        case SLC_LINKFAIL:
+            Lgr(LOG_DEBUG, szFunc, "Replay channel (%d) for (%d) went down",
+                nChanId, spChan->nOrigChanId);
+            spChan->nUp = FALSE;
+            spChan->nPending = FALSE;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/******************************************************************************
+ * Function:    _RPLY_CompareUs
+ * Description: qsort comparator for latency values.
+ * 
+ * Returns:     <0, 0, >0 as per qsort.
+ ******************************************************************************/
+int    _RPLY_CompareUs( const void    *spA,    /* I: First value */
+                        const void    *spB )   /* I: Second value */
+{
+    if(*(ULNG *)spA < *(ULNG *)spB) return(-1);
+    if(*(ULNG *)spA > *(ULNG *)spB) return(1);
+    return(0);
+}
+
+/******************************************************************************
+ * Function:    GetConfig
+ * Description: Get configuration information from the OS or command line
+ *              flags.
+ * 
+ * Returns:     R_OK    - Configuration obtained.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    GetConfig( int      argc,          /* I: CLI argument count */
+                  UCHAR    **argv,        /* I: CLI argument contents */
+                  char     **envp,        /* I: Environment variables */
+                  UCHAR    *szErrMsg )    /* O: Any generated error message */
+{
+    /* Local variables.
+    */
+    UCHAR    szDir[MAX_LOGFILELEN];
+
+    /* Setup defaults.
+    */
+    strcpy(RPLY.szLogFile, DEF_LOGFILE);
+    strcpy(RPLY.szHost, DEF_HOST);
+    RPLY.nLogMode = LOG_MESSAGE;
+    RPLY.nSpeed = DEF_SPEED;
+    RPLY.cDirection = SLCAP_SEND;
+    RPLY.nPortNo = 0;
+
+    /* Name of capture file is mandatory.
+    */
+    if( GetCLIParam(argc, argv, FLG_CAPFILE, T_STR, RPLY.szCapFile,
+                    MAX_LOGFILELEN, FALSE) != R_OK )
+    {
+        sprintf(szErrMsg, "No capture file given");
+        return(R_FAIL);
+    }
+
+    /* Optional parameters.
+    */
+    GetCLIParam(argc, argv, FLG_LOGFILE, T_STR, RPLY.szLogFile,
+                MAX_LOGFILELEN, FALSE);
+    GetCLIParam(argc, argv, FLG_LOGMODE, T_INT, (UCHAR *)&RPLY.nLogMode, 0, 0);
+    GetCLIParam(argc, argv, FLG_HOST, T_STR, RPLY.szHost, MAX_MACHINENAME,
+                FALSE);
+    GetCLIParam(argc, argv, FLG_PORT, T_INT, (UCHAR *)&RPLY.nPortNo, 0, 0);
+    GetCLIParam(argc, argv, FLG_SPEED, T_INT, (UCHAR *)&RPLY.nSpeed, 0, 0);
+
+    /* Which direction holds the requests? A capture taken on a client
+     * holds them as sent frames, one taken on vdwd as received frames.
+    */
+    if( GetCLIParam(argc, argv, FLG_DIRECTION, T_STR, szDir,
+                    MAX_LOGFILELEN, FALSE) == R_OK )
+    {
+        RPLY.cDirection = (UCHAR)toupper(szDir[0]);
+        if(RPLY.cDirection != SLCAP_SEND && RPLY.cDirection != SLCAP_RECV)
+        {
+            sprintf(szErrMsg, "Illegal direction (%s), use S or R", szDir);
+            return(R_FAIL);
+        }
+    }
+
+    /* Finished, get out!
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    RPLYLoad
+ * Description: Load the requests from the capture file into memory, creating
+ *              a replay channel record for each captured channel.
+ * 
+ * Returns:     R_OK    - Capture loaded.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    RPLYLoad( UCHAR    *szErrMsg )    /* O: Generated error message */
+{
+    /* Local variables.
+    */
+    UINT            nOrigChanId;
+    UINT            nDataLen;
+    UINT            nFirst = TRUE;
+    ULNG            lSec;
+    ULNG            lUsec;
+    ULNG            lSec0 = 0L;
+    ULNG            lUsec0 = 0L;
+    UCHAR           szHdr[SLCAP_RECHDRLEN];
+    FILE            *fp;
+    RPLY_RECORD     *spRec;
+    RPLY_CHANNEL    *spChan;
+
+    /* Open and validate the capture file.
+    */
+    if((fp=fopen(RPLY.szCapFile, "rb")) == NULL)
+    {
+        sprintf(szErrMsg, "Cannot open capture file (%s)", RPLY.szCapFile);
+        return(R_FAIL);
+    }
+    if(fread(szHdr, SLCAP_HDRLEN, 1, fp) != 1 ||
+       memcmp(szHdr, SLCAP_MAGIC, strlen(SLCAP_MAGIC)) != 0 ||
+       szHdr[strlen(SLCAP_MAGIC)] != SLCAP_VERSION)
+    {
+        sprintf(szErrMsg, "Not a version %d capture file (%s)",
+                SLCAP_VERSION, RPLY.szCapFile);
+        fclose(fp);
+        return(R_FAIL);
+    }
+
+    /* Read all records, keeping those in the request direction.
+    */
+    while(fread(szHdr, SLCAP_RECHDRLEN, 1, fp) == 1)
+    {
+        lSec        = GetLongFromChar(&szHdr[0]);
+        lUsec       = GetLongFromChar(&szHdr[4]);
+        nOrigChanId = (UINT)GetLongFromChar(&szHdr[8]);
+        nDataLen    = (UINT)GetLongFromChar(&szHdr[13]);
+
+        /* Not a request, skip it.
+        */
+        if(szHdr[12] != RPLY.cDirection)
+        {
+            if(fseek(fp, nDataLen, SEEK_CUR) != 0)
+                break;
+            continue;
+        }
+
+        /* Allocate the record and its data in one block.
+        */
+        if((spRec=(RPLY_RECORD *)malloc(sizeof(RPLY_RECORD)+nDataLen+1))
+                                                                      == NULL)
+        {
+            sprintf(szErrMsg, "Couldnt malloc (%d) bytes",
+                    sizeof(RPLY_RECORD)+nDataLen+1);
+            fclose(fp);
+            return(R_FAIL);
+        }
+        spRec->spData = (UCHAR *)(spRec + 1);
+        spRec->nDataLen = nDataLen;
+        spRec->nOrigChanId = nOrigChanId;
+        if(nDataLen > 0 && fread(spRec->spData, nDataLen, 1, fp) != 1)
+        {
+            free(spRec);
+            break;
+        }
+
+        /* Timestamps are kept relative to the first request.
+        */
+        if(nFirst == TRUE)
+        {
+            lSec0 = lSec;
+            lUsec0 = lUsec;
+            nFirst = FALSE;
+        }
+        spRec->lTimeUs = (lSec - lSec0) * 1000000L + lUsec - lUsec0;
+
+        /* Store request in capture order.
+        */
+        if(AddItem(&RPLY.spRecHead, &RPLY.spRecTail, SORT_NONE, NULL, NULL,
+                   NULL, spRec) == R_FAIL)
+        {
+            sprintf(szErrMsg, "Couldnt store capture record");
+            fclose(fp);
+            return(R_FAIL);
+        }
+        RPLY.nRecCnt++;
+
+        /* First sighting of this channel, create a replay channel for it.
+        */
+        if(FindItem(RPLY.spChanHead, &nOrigChanId, NULL, NULL) == NULL)
+        {
+            if((spChan=(RPLY_CHANNEL *)malloc(sizeof(RPLY_CHANNEL))) == NULL ||
+               AddItem(&RPLY.spChanHead, &RPLY.spChanTail, SORT_NONE,
+                       &nOrigChanId, NULL, NULL, spChan) == R_FAIL)
+            {
+                sprintf(szErrMsg, "Couldnt create replay channel");
+                fclose(fp);
+                return(R_FAIL);
+            }
+            memset((UCHAR *)spChan, '\0', sizeof(RPLY_CHANNEL));
+            spChan->nOrigChanId = nOrigChanId;
+        }
+    }
+    fclose(fp);
+
+    /* Nothing to do?
+    */
+    if(RPLY.nRecCnt == 0)
+    {
+        sprintf(szErrMsg, "No (%c) frames in capture file (%s)",
+                RPLY.cDirection, RPLY.szCapFile);
+        return(R_FAIL);
+    }
+
+    /* Space for one latency per request.
+    */
+    if((RPLY.lLatency=(ULNG *)malloc(sizeof(ULNG) * RPLY.nRecCnt)) == NULL)
+    {
+        sprintf(szErrMsg, "Couldnt malloc (%d) bytes",
+                sizeof(ULNG) * RPLY.nRecCnt);
+        return(R_FAIL);
+    }
+
+    /* Finished, get out!
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    RPLYConnect
+ * Description: Open one connection to the server for each captured channel
+ *              and wait for them all to come up.
+ * 
+ * Returns:     R_OK    - All connections up.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    RPLYConnect( UCHAR    *szErrMsg )    /* O: Generated error message */
+{
+    /* Local variables.
+    */
+    int             nChanId;
+    UINT            nUp;
+    UINT            nChanCnt = 0;
+    ULNG            lIPaddr;
+    ULNG            lStartUs;
+    LINKLIST        *spNext;
+    RPLY_CHANNEL    *spChan;
+
+    /* Resolve the server.
+    */
+    if(SL_GetIPaddr(RPLY.szHost, &lIPaddr) == R_FAIL)
+    {
+        sprintf(szErrMsg, "Cannot resolve host (%s)", RPLY.szHost);
+        return(R_FAIL);
+    }
+    if(RPLY.nPortNo == 0 &&
+       SL_GetService(DEF_SERVICENAME, &RPLY.nPortNo) == R_FAIL)
+    {
+        sprintf(szErrMsg, "No port given and no (%s) service entry",
+                DEF_SERVICENAME);
+        return(R_FAIL);
+    }
+
+    /* Create the client connections.
+    */
+    for(spChan=(RPLY_CHANNEL *)StartItem(RPLY.spChanHead, &spNext);
+        spChan != NULL; spChan=(RPLY_CHANNEL *)NextItem(&spNext))
+    {
+        if((nChanId=SL_AddClient(RPLY.nPortNo, lIPaddr, RPLY.szHost,
+                                 _RPLY_DataCB, _RPLY_CntrlCB)) < 0)
+        {
+            sprintf(szErrMsg, "Couldnt add client for channel (%d)",
+                    spChan->nOrigChanId);
+            return(R_FAIL);
+        }
+        spChan->nChanId = (UINT)nChanId;
+        nChanCnt++;
+    }
+
+    /* Wait for them to connect.
+    */
+    lStartUs = _RPLY_GetTimeUs();
+    do {
+        SL_Poll(10);
+        for(nUp=0, spChan=(RPLY_CHANNEL *)StartItem(RPLY.spChanHead, &spNext);
+            spChan != NULL; spChan=(RPLY_CHANNEL *)NextItem(&spNext))
+        {
+            if(spChan->nUp == TRUE)
+                nUp++;
+        }
+    } while(nUp < nChanCnt &&
+            (_RPLY_GetTimeUs() - lStartUs) < DEF_CONNECTWAIT * 1000L);
+
+    if(nUp < nChanCnt)
+    {
+        sprintf(szErrMsg, "Only (%d) of (%d) connections to (%s:%d) came up",
+                nUp, nChanCnt, RPLY.szHost, RPLY.nPortNo);
+        return(R_FAIL);
+    }
+
+    /* Finished, get out!
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    RPLYRun
+ * Description: Replay the loaded requests. At a non-zero speed, requests are
+ *              sent on the original schedule scaled by speed/100, regardless
+ *              of replies (open loop). At speed zero, each request waits for
+ *              the reply to the previous request on its channel (closed
+ *              loop), giving maximum sustainable throughput.
+ * 
+ * Returns:     R_OK    - Replay completed.
+ *              R_FAIL  - Failure, see error message.
+ ******************************************************************************/
+int    RPLYRun( UCHAR    *szErrMsg )    /* O: Generated error message */
+{
+    /* Local variables.
+    */
+    UINT            nPending;
+    ULNG            lStartUs;
+    ULNG            lNowUs;
+    ULNG            lTargetUs;
+    ULNG            lWaitMs;
+    LINKLIST        *spNext;
+    LINKLIST        *spChanNext;
+    RPLY_RECORD     *spRec;
+    RPLY_CHANNEL    *spChan;
+    char            *szFunc = "RPLYRun";
+
+    lStartUs = _RPLY_GetTimeUs();
+    for(spRec=(RPLY_RECORD *)StartItem(RPLY.spRecHead, &spNext);
+        spRec != NULL; spRec=(RPLY_RECORD *)NextItem(&spNext))
+    {
+        spChan = (RPLY_CHANNEL *)FindItem(RPLY.spChanHead, &spRec->nOrigChanId,
+                                          NULL, NULL);
+        if(spChan == NULL || spChan->nUp == FALSE)
+            continue;
+
+        if(RPLY.nSpeed == 0)
+        {
+            /* Closed loop, wait for the previous reply.
+            */
+            while(spChan->nPending == TRUE && spChan->nUp == TRUE &&
+                  (_RPLY_GetTimeUs() - spChan->lSentUs) < DEF_REPLYWAIT*1000L)
+            {
+                SL_Poll(1);
+            }
+        } else
+         {
+            /* Open loop, wait for the scaled capture time.
+            */
+            lTargetUs = (spRec->lTimeUs / RPLY.nSpeed) * 100L +
+                        ((spRec->lTimeUs % RPLY.nSpeed) * 100L) / RPLY.nSpeed;
+            while((lNowUs=_RPLY_GetTimeUs() - lStartUs) < lTargetUs)
+            {
+                lWaitMs = (lTargetUs - lNowUs) / 1000L;
+                SL_Poll(lWaitMs > 10 ? 10 : lWaitMs);
+            }
+        }
+
+        /* Send the request, riding out busy periods.
+        */
+        while(SL_SendData(spChan->nChanId, spRec->spData, spRec->nDataLen)
+                                                                    == R_FAIL)
+        {
+            if(Errno != E_BUSY)
+            {
+                Lgr(LOG_DEBUG, szFunc, "Send failed on channel (%d), Errno=%d",
+                    spChan->nChanId, Errno);
+                break;
+            }
+            SL_Poll(0);
+        }
+        RPLY.lBytesSent += spRec->nDataLen;
+
+        /* Only the oldest outstanding request is timed, replies cant be
+         * matched to pipelined requests.
+        */
+        if(spChan->nPending == FALSE)
+        {
+            spChan->nPending = TRUE;
+            spChan->lSentUs = _RPLY_GetTimeUs();
+        }
+        SL_Poll(0);
+    }
+
+    /* Wait for any outstanding replies.
+    */
+    lStartUs = _RPLY_GetTimeUs();
+    do {
+        SL_Poll(1);
+        for(nPending=0,
+            spChan=(RPLY_CHANNEL *)StartItem(RPLY.spChanHead, &spChanNext);
+            spChan != NULL; spChan=(RPLY_CHANNEL *)NextItem(&spChanNext))
+        {
+            if(spChan->nPending == TRUE && spChan->nUp == TRUE)
+                nPending++;
+        }
+    } while(nPending > 0 &&
+            (_RPLY_GetTimeUs() - lStartUs) < DEF_DRAINWAIT * 1000L);
+
+    /* Finished, get out!
+    */
+    return(R_OK);
+}
+
+/******************************************************************************
+ * Function:    RPLYReport
+ * Description: Print the throughput and latency percentiles of the replay.
+ * 
+ * Returns:     Non.
+ ******************************************************************************/
+void    RPLYReport( ULNG    lElapsedUs )    /* I: Duration of replay in uS */
+{
+    /* Local variables.
+    */
+    double      dSecs;
+
+    dSecs = (lElapsedUs > 0 ? (double)lElapsedUs / 1000000.0 : 1.0);
+
+    printf("Capture file:     %s (%c frames)\n", RPLY.szCapFile,
+           RPLY.cDirection);
+    printf("Speed:            %s%d%%\n", (RPLY.nSpeed == 0 ? "max, " : ""),
+           RPLY.nSpeed);
+    printf("Requests:         %d in %.3fs, %.1f req/s\n",
+           RPLY.nRecCnt, dSecs, (double)RPLY.nRecCnt / dSecs);
+    printf("Throughput:       %.1f KB/s sent, %.1f KB/s received\n",
+           (double)RPLY.lBytesSent / 1024.0 / dSecs,
+           (double)RPLY.lBytesRecv / 1024.0 / dSecs);
+
+    /* Latency percentiles.
+    */
+    if(RPLY.nLatCnt > 0)
+    {
+        qsort(RPLY.lLatency, RPLY.nLatCnt, sizeof(ULNG), _RPLY_CompareUs);
+        printf("Replies timed:    %d\n", RPLY.nLatCnt);
+        printf("Latency (uS):     p50=%lu p90=%lu p99=%lu max=%lu\n",
+               RPLY.lLatency[(RPLY.nLatCnt-1) * 50 / 100],
+               RPLY.lLatency[(RPLY.nLatCnt-1) * 90 / 100],
+               RPLY.lLatency[(RPLY.nLatCnt-1) * 99 / 100],
+               RPLY.lLatency[RPLY.nLatCnt-1]);
+    } else
+     {
+        printf("Replies timed:    0\n");
+    }
+}
+
+/******************************************************************************
+ * Function:    main
+ * Description: Entry point into the replay program. Load the capture,
+ *              connect, replay and report.
+ * 
+ * Returns:     0     - Program completed successfully without errors.
+ *              -1    - Program terminated with errors, see logged message.
+ ******************************************************************************/
+int    main( int     argc,       /* I: Count of available arguments */
+             char    **argv,     /* I: Array of arguments */
+             char    **envp )    /* I: Array of environment parameters */
+{
+    /* Local variables.
+    */
+    ULNG         lStartUs;
+    UCHAR        szErrMsg[MAX_ERRMSG_LEN];
+    UCHAR        *szFunc = "main";
+
+    /* Bring in any configuration parameters passed on the command line etc.
+    */
+    if( GetConfig(argc, (UCHAR **)argv, envp, szErrMsg) == R_FAIL )
+    {
+        printf( "%s\n"
+                "Usage:                 %s <parameters>\n"
+                "<parameters>:          -f<Capture File Name>\n"
+                "                       -h<Server Host>\n"
+                "                       -p<Server TCP Port No>\n"
+                "                       -d<Request direction S or R>\n"
+                "                       -x<Speed %%, 0 = max>\n"
+                "                       -l<LogFile Name>\n"
+                "                       -m<Logging Mode>\n",
+                szErrMsg, argv[0]);
+        exit(-1);
+    }
+
+    /* Setup logger and comms.
+    */
+    Lgr(LOG_CONFIG, LGM_FLATFILE, RPLY.nLogMode, RPLY.szLogFile);
+    if(SL_Init(RPLY_KEEPALIVE, (UCHAR *)NULL) != R_OK)
+    {
+        Lgr(LOG_DIRECT, szFunc, "%s: SL_Init failed", argv[0]);
+        exit(-1);
+    }
+
+    /* Load, connect and replay.
+    */
+    if( RPLYLoad(szErrMsg) == R_FAIL || RPLYConnect(szErrMsg) == R_FAIL )
+    {
+        Lgr(LOG_DIRECT, szFunc, "%s: %s", argv[0], szErrMsg);
+        exit(-1);
+    }
+    lStartUs = _RPLY_GetTimeUs();
+    if( RPLYRun(szErrMsg) == R_FAIL )
+    {
+        Lgr(LOG_DIRECT, szFunc, "%s: %s", argv[0], szErrMsg);
+        exit(-1);
+    }
+    RPLYReport(_RPLY_GetTimeUs() - lStartUs);
+
+    /* Tidy up.
+    */
+    SL_Exit(NULL);
+
+    /* All done, go bye bye's.
+    */
+    return(0);
+}
@@ -0,0 +1,134 @@
+/******************************************************************************
+ * Product:
+ * ####### #######  #####  #######       #####  #     #   ###   ####### #######
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #       #          #         #       #     #    #       #    #
+ *    #    #####    #####     #          #####  #     #    #       #    #####
+ *    #    #             #    #               # #     #    #       #    #
+ *    #    #       #     #    #         #     # #     #    #       #    #
+ *    #    #######  #####     #   #####  #####   #####    ###      #    #######
+ *
+ * File:          sl_replay.h
+ * Description:   Header file for declaration of structures, datatypes etc for
+ *                the SL traffic capture replay program.
+ * Version:       %I%
+ * Dated:         %D%
+ * Copyright:     P.D.Smart, 1996-2019.
+ *
+ * History:       1.0 - Initial Release.
+ *
+ ******************************************************************************
+ * This source file is free software: you can redistribute it and#or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This source file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/* Ensure file is only included once - avoid compile loops.
+*/
+#ifndef    SL_REPLAY_H
+#define    SL_REPLAY_H
+
+/* Definitions for maxims etc.
+*/
+#define    MAX_ERRMSG_LEN        256
+#define    MAX_LOGFILELEN        256
+
+/* Definitions for defaults.
+*/
+#define    DEF_HOST              "localhost"
+#define    DEF_SERVICENAME       "vdwd"
+#define    DEF_SPEED             100     /* Percentage of original speed */
+#define    DEF_CONNECTWAIT       10000   /* mS to wait for all connections */
+#define    DEF_REPLYWAIT         30000   /* mS to wait for a reply */
+#define    DEF_DRAINWAIT         5000    /* mS to wait for stragglers at end */
+#if defined(SOLARIS) || defined(SUNOS) || defined(LINUX) || defined(ZPU)
+#define    DEF_LOGFILE           "/tmp/sl_replay.log"
+#endif
+#if defined(_WIN32)
+#define    DEF_LOGFILE           "\\SL_REPLAY.LOG"
+#endif
+
+/* Define constants etc.
+*/
+#define    RPLY_KEEPALIVE        1000    /* TCP/IP keep alive */
+
+/* Define command line flags.
+*/
+#define    FLG_LOGFILE           "-l"
+#define    FLG_LOGMODE           "-m"
+#define    FLG_CAPFILE           "-f"
+#define    FLG_HOST              "-h"
+#define    FLG_PORT              "-p"
+#define    FLG_DIRECTION         "-d"
+#define    FLG_SPEED             "-x"
+
+/* A single request frame loaded from the capture file.
+*/
+typedef struct {
+    ULNG           lTimeUs;              /* Capture time relative to first */
+    UINT           nOrigChanId;          /* Channel Id at capture time */
+    UINT           nDataLen;             /* Length of frame data */
+    UCHAR          *spData;              /* Frame data */
+} RPLY_RECORD;
+
+/* A replay connection standing in for one captured channel.
+*/
+typedef struct {
+    UINT           nOrigChanId;          /* Channel Id at capture time */
+    UINT           nChanId;              /* Channel Id of replay connection */
+    UINT           nUp;                  /* Connection is up */
+    UINT           nPending;             /* Awaiting reply to a request */
+    ULNG           lSentUs;              /* Time pending request was sent */
+} RPLY_CHANNEL;
+
+/* Globals (yuggghhh!).
+*/
+typedef struct {
+    UINT           nPortNo;
+    UINT           nSpeed;
+    UINT           nLogMode;
+    UCHAR          cDirection;
+    UCHAR          szCapFile[MAX_LOGFILELEN];
+    UCHAR          szHost[MAX_MACHINENAME+1];
+    UCHAR          szLogFile[MAX_LOGFILELEN];
+    LINKLIST       *spRecHead;           /* Requests, in capture order */
+    LINKLIST       *spRecTail;
+    LINKLIST       *spChanHead;          /* Replay connections */
+    LINKLIST       *spChanTail;
+    UINT           nRecCnt;              /* Number of requests loaded */
+    UINT           nLatCnt;              /* Number of latencies measured */
+    ULNG           *lLatency;            /* Reply latencies, uS */
+    ULNG           lBytesSent;
+    ULNG           lBytesRecv;
+} RPLY_GLOBALS;
+
+/* Declare any globals required by the program, or any specifics to the
+ * C module.
+*/
+#if defined(SL_REPLAY_C)
+    static    RPLY_GLOBALS    RPLY;
+#endif
+
+/* Prototypes for functions.
+*/
+ULNG       _RPLY_GetTimeUs( void );
+void       _RPLY_DataCB( UINT, UCHAR *, UINT );
+void       _RPLY_CntrlCB( int, ... );
+int        _RPLY_CompareUs( const void *, const void * );
+int        GetConfig( int, UCHAR **, char **, UCHAR * );
+int        RPLYLoad( UCHAR * );
+int        RPLYConnect( UCHAR * );
+int        RPLYRun( UCHAR * );
+void       RPLYReport( ULNG );
+int        main( int, char **, char ** );
+
+#endif    /* SL_REPLAY_H */